@@ -38,10 +38,13 @@
 ****************************************************************************/
 
 #include "qaudiobuffer.h"
+#include "qabstractaudiobuffer_p.h"
 
 #include <QObject>
 #include <QDebug>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QAudioBufferPrivate : public QSharedData
@@ -53,9 +56,24 @@ public:
         startTime(start)
     {
     }
+    QAudioBufferPrivate(const QAudioFormat &f, QAbstractAudioBuffer *b, qint64 start)
+        : format(f),
+        buffer(b),
+        startTime(start)
+    {
+    }
+
+    // The external buffer is used until someone asks for writable data
+    bool usesBuffer() const { return buffer && data.isNull(); }
+    const char *constData() const
+    {
+        return usesBuffer() ? static_cast<const char *>(buffer->constData()) : data.constData();
+    }
+    qsizetype size() const { return usesBuffer() ? buffer->byteCount() : data.size(); }
 
     QAudioFormat format;
     QByteArray data;
+    std::unique_ptr<QAbstractAudioBuffer> buffer;
     qint64 startTime;
 };
 
@@ -64,7 +82,13 @@ QT_DEFINE_QESDP_SPECIALIZATION_DTOR(QAudioBufferPrivate);
 /*!
     \class QAbstractAudioBuffer
     \internal
+
+    QAbstractAudioBuffer lets a QAudioBuffer use sample memory it doesn't own, such as a
+    mapped media framework buffer, without copying it. The memory has to stay valid and
+    unchanged until the QAbstractAudioBuffer is destroyed, which happens when the last
+    QAudioBuffer referencing it goes away.
 */
+QAbstractAudioBuffer::~QAbstractAudioBuffer() = default;
 
 /*!
     \class QAudioBuffer
@@ -133,6 +157,27 @@ QAudioBuffer::QAudioBuffer(int numFrames, const QAudioFormat &format, qint64 sta
     d = new QAudioBufferPrivate(format, data, startTime);
 }
 
+/*!
+    \internal
+
+    Creates a new audio buffer that uses the samples held by \a buffer, in the given
+    \a format, without copying them. The audio buffer takes ownership of \a buffer.
+
+    \a startTime (in microseconds) indicates when this buffer
+    starts in the stream.
+    If this buffer is not part of a stream, set it to -1.
+ */
+QAudioBuffer::QAudioBuffer(QAbstractAudioBuffer *buffer, const QAudioFormat &format, qint64 startTime)
+{
+    if (!buffer)
+        return;
+    if (!format.isValid() || !buffer->byteCount()) {
+        delete buffer;
+        return;
+    }
+    d = new QAudioBufferPrivate(format, buffer, startTime);
+}
+
 /*!
     \fn QAudioBuffer::QAudioBuffer(QAudioBuffer &&other)
 
@@ -168,7 +213,7 @@ void QAudioBuffer::detach()
 {
     if (!d)
         return;
-    d = new QAudioBufferPrivate(*d);
+    d = new QAudioBufferPrivate(d->format, QByteArray(d->constData(), d->size()), d->startTime);
 }
 
 /*!
@@ -195,7 +240,7 @@ qsizetype QAudioBuffer::frameCount() const noexcept
 {
     if (!d)
         return 0;
-    return d->format.framesForBytes(d->data.size());
+    return d->format.framesForBytes(d->size());
 }
 
 /*!
@@ -219,7 +264,7 @@ qsizetype QAudioBuffer::sampleCount() const noexcept
  */
 qsizetype QAudioBuffer::byteCount() const noexcept
 {
-    return d ? d->data.size() : 0;
+    return d ? d->size() : 0;
 }
 
 /*!
@@ -265,7 +310,7 @@ const void* QAudioBuffer::constData() const noexcept
 {
     if (!d)
         return nullptr;
-    return d->data.constData();
+    return d->constData();
 }
 
 /*!
@@ -288,7 +333,7 @@ const void* QAudioBuffer::data() const noexcept
 {
     if (!d)
         return nullptr;
-    return d->data.constData();
+    return d->constData();
 }
 
 
@@ -318,6 +363,11 @@ void *QAudioBuffer::data()
 {
     if (!d)
         return nullptr;
+    if (d->usesBuffer()) {
+        // The external buffer is read only, switch to a copy. The buffer stays
+        // alive, so pointers handed out before remain valid.
+        d->data = QByteArray(d->constData(), d->size());
+    }
     return d->data.data();
 }
 
@@ -328,4 +378,87 @@ void *QAudioBuffer::data()
     channel is a \e {signed short}.
 */
 
+/*!
+    \class QAudioFrameSpan
+    \inmodule QtMultimedia
+    \ingroup multimedia
+    \ingroup multimedia_audio
+    \since 6.3
+    \brief The QAudioFrameSpan class is a non-owning view on a block of interleaved audio frames.
+
+    QAudioFrameSpan is what QAudioSink and QAudioSource hand to their render and
+    capture callbacks. It points straight at the memory the audio backend transfers,
+    often the device buffer itself, so it is only valid for the duration of the
+    callback. Creating and copying a span never allocates.
+
+    The samples are laid out as described by format(). Use the templatized data()
+    function to access them with the matching sample type:
+
+    \code
+    // With a stereo float format:
+    QAudioBuffer::F32S *frames = span.data<QAudioBuffer::F32S>();
+    for (qsizetype i = 0; i < span.frameCount(); ++i)
+        frames[i] = { next(), next() };
+    \endcode
+
+    \sa QAudioSink::start(), QAudioSource::start()
+*/
+
+/*!
+    \fn QAudioFrameSpan::QAudioFrameSpan()
+
+    Creates an empty span.
+*/
+
+/*!
+    \fn QAudioFrameSpan::QAudioFrameSpan(void *data, qsizetype frameCount, const QAudioFormat &format)
+
+    Creates a span over \a frameCount frames of \a format starting at \a data.
+*/
+
+/*!
+    \fn bool QAudioFrameSpan::isEmpty() const
+
+    Returns \c true if the span holds no frames.
+*/
+
+/*!
+    \fn QAudioFormat QAudioFrameSpan::format() const
+
+    Returns the format of the frames in the span.
+*/
+
+/*!
+    \fn qsizetype QAudioFrameSpan::frameCount() const
+
+    Returns the number of frames in the span.
+*/
+
+/*!
+    \fn qsizetype QAudioFrameSpan::sampleCount() const
+
+    Returns the number of samples in the span, that is frameCount() times the
+    channel count of format().
+*/
+
+/*!
+    \fn qsizetype QAudioFrameSpan::byteCount() const
+
+    Returns the size of the span in bytes.
+*/
+
+/*!
+    \fn void *QAudioFrameSpan::data() const
+
+    Returns a pointer to the first frame of the span.
+*/
+
+/*!
+    \fn template <typename T> T *QAudioFrameSpan::data() const
+
+    Returns a pointer to the first frame of the span as type \c T. Note that
+    there is no checking done on the format of the span, \c T must match the
+    sample format and, for frame types, the channel layout of format().
+*/
+
 QT_END_NAMESPACE
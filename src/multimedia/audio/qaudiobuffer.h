@@ -145,6 +145,7 @@ using QAudioFrameSurround7Dot1 = QAudioFrame<QAudioFormat::ChannelConfigSurround
 
 
 class QAudioBufferPrivate;
+class QAbstractAudioBuffer;
 QT_DECLARE_QESDP_SPECIALIZATION_DTOR_WITH_EXPORT(QAudioBufferPrivate, Q_MULTIMEDIA_EXPORT)
 
 class Q_MULTIMEDIA_EXPORT QAudioBuffer
@@ -154,6 +155,7 @@ public:
     QAudioBuffer(const QAudioBuffer &other) noexcept;
     QAudioBuffer(const QByteArray &data, const QAudioFormat &format, qint64 startTime = -1);
     QAudioBuffer(int numFrames, const QAudioFormat &format, qint64 startTime = -1); // Initialized to empty
+    QAudioBuffer(QAbstractAudioBuffer *buffer, const QAudioFormat &format, qint64 startTime = -1);
     ~QAudioBuffer();
 
     QAudioBuffer& operator=(const QAudioBuffer &other);
@@ -204,6 +206,33 @@ private:
     QExplicitlySharedDataPointer<QAudioBufferPrivate> d;
 };
 
+class QAudioFrameSpan
+{
+public:
+    constexpr QAudioFrameSpan() noexcept = default;
+    constexpr QAudioFrameSpan(void *data, qsizetype frameCount, const QAudioFormat &format) noexcept
+        : m_data(data), m_frameCount(frameCount), m_format(format)
+    {}
+
+    constexpr bool isEmpty() const noexcept { return m_frameCount == 0; }
+
+    constexpr QAudioFormat format() const noexcept { return m_format; }
+
+    constexpr qsizetype frameCount() const noexcept { return m_frameCount; }
+    constexpr qsizetype sampleCount() const noexcept { return m_frameCount * m_format.channelCount(); }
+    constexpr qsizetype byteCount() const noexcept { return m_frameCount * m_format.bytesPerFrame(); }
+
+    constexpr void *data() const noexcept { return m_data; }
+    template <typename T> T* data() const noexcept {
+        return static_cast<T*>(m_data);
+    }
+
+private:
+    void *m_data = nullptr;
+    qsizetype m_frameCount = 0;
+    QAudioFormat m_format;
+};
+
 QT_END_NAMESPACE
 
 Q_DECLARE_METATYPE(QAudioBuffer)
@@ -0,0 +1,793 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudioconverter_p.h"
+
+#include <private/qsimd_p.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Samples are converted through normalized floats in [-1, 1]
+void QT_FASTCALL int16ToFloat(const qint16 *src, float *dst, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        dst[i] = src[i] * (1.f / 0x8000);
+}
+
+void QT_FASTCALL floatToInt16(const float *src, qint16 *dst, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i) {
+        const float v = qBound(-1.f, src[i], 1.f) * 0x8000;
+        dst[i] = qint16(qMin(std::lrint(v), long(0x7fff)));
+    }
+}
+
+// Sums the products of n floats, n has to be a multiple of 8
+float QT_FASTCALL dotProduct(const float *a, const float *b, int n)
+{
+    float acc[4] = {};
+    for (int i = 0; i < n; i += 4) {
+        acc[0] += a[i] * b[i];
+        acc[1] += a[i + 1] * b[i + 1];
+        acc[2] += a[i + 2] * b[i + 2];
+        acc[3] += a[i + 3] * b[i + 3];
+    }
+    return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+}
+
+typedef void (QT_FASTCALL *Int16ToFloatFunc)(const qint16 *src, float *dst, qsizetype count);
+typedef void (QT_FASTCALL *FloatToInt16Func)(const float *src, qint16 *dst, qsizetype count);
+typedef float (QT_FASTCALL *DotProductFunc)(const float *a, const float *b, int n);
+
+Int16ToFloatFunc qInt16ToFloat = int16ToFloat;
+FloatToInt16Func qFloatToInt16 = floatToInt16;
+DotProductFunc qDotProduct = dotProduct;
+
+} // namespace
+
+static void qInitAudioConverterFuncsAsm()
+{
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    extern void QT_FASTCALL qt_audio_int16_to_float_sse2(const qint16 *src, float *dst, qsizetype count);
+    extern void QT_FASTCALL qt_audio_float_to_int16_sse2(const float *src, qint16 *dst, qsizetype count);
+    extern float QT_FASTCALL qt_audio_dot_product_sse2(const float *a, const float *b, int n);
+    if (qCpuHasFeature(SSE2)) {
+        qInt16ToFloat = qt_audio_int16_to_float_sse2;
+        qFloatToInt16 = qt_audio_float_to_int16_sse2;
+        qDotProduct = qt_audio_dot_product_sse2;
+    }
+#endif
+#if defined(__ARM_NEON)
+    extern void QT_FASTCALL qt_audio_int16_to_float_neon(const qint16 *src, float *dst, qsizetype count);
+    extern float QT_FASTCALL qt_audio_dot_product_neon(const float *a, const float *b, int n);
+    qInt16ToFloat = qt_audio_int16_to_float_neon;
+    qDotProduct = qt_audio_dot_product_neon;
+#endif
+}
+
+static void initAudioConverterFuncs()
+{
+    static bool initDone = false;
+    if (!initDone) {
+        qInitAudioConverterFuncsAsm();
+        initDone = true;
+    }
+}
+
+namespace {
+
+void toFloat(QAudioFormat::SampleFormat format, const void *src, float *dst, qsizetype count)
+{
+    switch (format) {
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        break;
+    case QAudioFormat::UInt8: {
+        const quint8 *s = static_cast<const quint8 *>(src);
+        for (qsizetype i = 0; i < count; ++i)
+            dst[i] = (int(s[i]) - 0x80) * (1.f / 0x80);
+        break;
+    }
+    case QAudioFormat::Int16:
+        qInt16ToFloat(static_cast<const qint16 *>(src), dst, count);
+        break;
+    case QAudioFormat::Int32: {
+        const qint32 *s = static_cast<const qint32 *>(src);
+        for (qsizetype i = 0; i < count; ++i)
+            dst[i] = float(s[i] * (1. / 0x80000000u));
+        break;
+    }
+    case QAudioFormat::Float:
+        memcpy(dst, src, count * sizeof(float));
+        break;
+    }
+}
+
+void fromFloat(QAudioFormat::SampleFormat format, const float *src, void *dst, qsizetype count)
+{
+    switch (format) {
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        break;
+    case QAudioFormat::UInt8: {
+        quint8 *d = static_cast<quint8 *>(dst);
+        for (qsizetype i = 0; i < count; ++i) {
+            const float v = qBound(-1.f, src[i], 1.f) * 0x80;
+            d[i] = quint8(qMin(std::lrint(v) + 0x80, long(0xff)));
+        }
+        break;
+    }
+    case QAudioFormat::Int16:
+        qFloatToInt16(src, static_cast<qint16 *>(dst), count);
+        break;
+    case QAudioFormat::Int32: {
+        qint32 *d = static_cast<qint32 *>(dst);
+        for (qsizetype i = 0; i < count; ++i) {
+            const double v = qBound(-1., double(src[i]), 1.) * 0x80000000u;
+            d[i] = qint32(qMin(std::llrint(v), 0x7fffffffLL));
+        }
+        break;
+    }
+    case QAudioFormat::Float:
+        memcpy(dst, src, count * sizeof(float));
+        break;
+    }
+}
+
+void mixChannels(const QList<float> &matrix, const float *src, int inChannels,
+                 float *dst, int outChannels, qsizetype frames)
+{
+    for (qsizetype f = 0; f < frames; ++f) {
+        const float *m = matrix.constData();
+        for (int o = 0; o < outChannels; ++o) {
+            float sum = 0.f;
+            for (int i = 0; i < inChannels; ++i)
+                sum += m[i] * src[i];
+            dst[o] = sum;
+            m += inChannels;
+        }
+        src += inChannels;
+        dst += outChannels;
+    }
+}
+
+using Position = QAudioFormat::AudioChannelPosition;
+
+int channelOffset(QAudioFormat::ChannelConfig config, Position position)
+{
+    if (!(config & (1u << position)))
+        return -1;
+    return qPopulationCount(uint(config) & ((1u << position) - 1));
+}
+
+// Where to fold a channel the output doesn't have, in order of preference.
+// A route only applies if the output has all of its channels.
+struct Route
+{
+    Position first;
+    Position second;
+    float gain;
+};
+
+QVarLengthArray<Route, 4> routesFor(Position position)
+{
+    constexpr float Sqrt1_2 = float(M_SQRT1_2);
+    switch (position) {
+    case QAudioFormat::FrontLeft:
+    case QAudioFormat::FrontRight:
+        return { { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, 1.f } };
+    case QAudioFormat::FrontCenter:
+        return { { QAudioFormat::FrontLeft, QAudioFormat::FrontRight, Sqrt1_2 } };
+    case QAudioFormat::LFE:
+        return { { QAudioFormat::LFE2, QAudioFormat::UnknownPosition, 1.f } };
+    case QAudioFormat::LFE2:
+        return { { QAudioFormat::LFE, QAudioFormat::UnknownPosition, 1.f } };
+    case QAudioFormat::BackLeft:
+        return { { QAudioFormat::SideLeft, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontLeft, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::BackRight:
+        return { { QAudioFormat::SideRight, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontRight, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::SideLeft:
+        return { { QAudioFormat::BackLeft, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontLeft, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::SideRight:
+        return { { QAudioFormat::BackRight, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontRight, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::FrontLeftOfCenter:
+        return { { QAudioFormat::FrontLeft, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, 1.f } };
+    case QAudioFormat::FrontRightOfCenter:
+        return { { QAudioFormat::FrontRight, QAudioFormat::UnknownPosition, 1.f },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, 1.f } };
+    case QAudioFormat::BackCenter:
+        return { { QAudioFormat::BackLeft, QAudioFormat::BackRight, Sqrt1_2 },
+                 { QAudioFormat::SideLeft, QAudioFormat::SideRight, Sqrt1_2 },
+                 { QAudioFormat::FrontLeft, QAudioFormat::FrontRight, 0.5f },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::TopFrontLeft:
+    case QAudioFormat::TopBackLeft:
+    case QAudioFormat::TopSideLeft:
+    case QAudioFormat::BottomFrontLeft:
+        return { { QAudioFormat::FrontLeft, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::TopFrontRight:
+    case QAudioFormat::TopBackRight:
+    case QAudioFormat::TopSideRight:
+    case QAudioFormat::BottomFrontRight:
+        return { { QAudioFormat::FrontRight, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 } };
+    case QAudioFormat::TopFrontCenter:
+    case QAudioFormat::TopCenter:
+    case QAudioFormat::TopBackCenter:
+    case QAudioFormat::BottomFrontCenter:
+        return { { QAudioFormat::FrontCenter, QAudioFormat::UnknownPosition, Sqrt1_2 },
+                 { QAudioFormat::FrontLeft, QAudioFormat::FrontRight, 0.5f } };
+    case QAudioFormat::UnknownPosition:
+        break;
+    }
+    return {};
+}
+
+} // namespace
+
+/*
+    Polyphase windowed sinc resampler working on interleaved float frames.
+
+    The input is kept per channel in m_history. The output frame n sits at input
+    position n * m_down / m_up, stored as the frame m_position plus the fraction
+    m_phase / m_up. Each phase has its own set of filter taps, centered on that
+    fraction, so every output sample is a single dot product.
+*/
+class QAudioResampler
+{
+public:
+    QAudioResampler(int inputRate, int outputRate, int channels);
+
+    qsizetype maximumOutputFrames(qsizetype inputFrames) const;
+    qsizetype process(const float *input, qsizetype frames, float *output);
+    qsizetype flush(float *output);
+    void reset();
+
+    int halfTaps() const { return m_halfTaps; }
+
+private:
+    void append(const float *input, qsizetype frames);
+    qsizetype run(float *output, qint64 maximumFrames);
+
+    // Phases beyond this are rounded to the closest one we have taps for
+    static constexpr int MaximumPhases = 1024;
+
+    int m_channels;
+    qint64 m_up;
+    qint64 m_down;
+    int m_halfTaps;
+    int m_taps;
+    int m_phases;
+    QList<float> m_filter;
+    QList<QList<float>> m_history;
+    qsizetype m_position = 0;
+    qint64 m_phase = 0;
+    qint64 m_inputFrames = 0;
+    qint64 m_outputFrames = 0;
+};
+
+QAudioResampler::QAudioResampler(int inputRate, int outputRate, int channels)
+    : m_channels(channels)
+{
+    const int gcd = std::gcd(inputRate, outputRate);
+    m_up = outputRate / gcd;
+    m_down = inputRate / gcd;
+    m_phases = int(qMin(m_up, qint64(MaximumPhases)));
+
+    // Band limit to the lower of the two rates. When downsampling the filter gets
+    // longer so that the transition band stays equally steep.
+    const double scale = qMin(1., double(m_up) / m_down);
+    constexpr int BaseHalfTaps = 32;
+    m_halfTaps = qMin(qCeil(BaseHalfTaps / scale), 256);
+    m_halfTaps = (m_halfTaps + 3) & ~3;
+    m_taps = 2 * m_halfTaps;
+    const double cutoff = scale * (0.5 - 1. / BaseHalfTaps);
+
+    m_filter.resize(m_phases * m_taps);
+    for (int p = 0; p < m_phases; ++p) {
+        float *taps = m_filter.data() + p * m_taps;
+        const double fraction = double(p) / m_phases;
+        double sum = 0.;
+        for (int j = 0; j < m_taps; ++j) {
+            const double x = j - m_halfTaps + 1 - fraction;
+            const double sinc = x == 0. ? 1. : std::sin(2 * M_PI * cutoff * x) / (2 * M_PI * cutoff * x);
+            // Blackman-Harris window
+            const double u = M_PI * x / m_halfTaps;
+            const double window = 0.35875 + 0.48829 * std::cos(u) + 0.14128 * std::cos(2 * u)
+                    + 0.01168 * std::cos(3 * u);
+            const double tap = qAbs(x) < m_halfTaps ? sinc * window : 0.;
+            taps[j] = float(tap);
+            sum += tap;
+        }
+        // unity gain at DC for every phase
+        for (int j = 0; j < m_taps; ++j)
+            taps[j] = float(taps[j] / sum);
+    }
+
+    m_history.resize(m_channels);
+    reset();
+}
+
+void QAudioResampler::reset()
+{
+    // Start with m_halfTaps - 1 frames of silence, so that the first output frame
+    // is centered on the first input frame
+    for (QList<float> &channel : m_history)
+        channel.fill(0.f, m_halfTaps - 1);
+    m_position = m_halfTaps - 1;
+    m_phase = 0;
+    m_inputFrames = 0;
+    m_outputFrames = 0;
+}
+
+qsizetype QAudioResampler::maximumOutputFrames(qsizetype inputFrames) const
+{
+    const qint64 available = m_history.first().size() + inputFrames - m_halfTaps - m_position;
+    if (available <= 0)
+        return 0;
+    return (available * m_up + m_down - 1) / m_down + 1;
+}
+
+void QAudioResampler::append(const float *input, qsizetype frames)
+{
+    for (int c = 0; c < m_channels; ++c) {
+        QList<float> &channel = m_history[c];
+        const qsizetype offset = channel.size();
+        channel.resize(offset + frames);
+        float *out = channel.data() + offset;
+        if (input) {
+            for (qsizetype f = 0; f < frames; ++f)
+                out[f] = input[f * m_channels + c];
+        } else {
+            std::fill(out, out + frames, 0.f);
+        }
+    }
+}
+
+qsizetype QAudioResampler::run(float *output, qint64 maximumFrames)
+{
+    const qsizetype available = m_history.first().size();
+    qsizetype produced = 0;
+    while (m_position + m_halfTaps < available && produced < maximumFrames) {
+        const qint64 phase = m_phases == m_up ? m_phase : m_phase * m_phases / m_up;
+        const float *taps = m_filter.constData() + phase * m_taps;
+        const qsizetype start = m_position - m_halfTaps + 1;
+        for (int c = 0; c < m_channels; ++c)
+            *output++ = qDotProduct(m_history.at(c).constData() + start, taps, m_taps);
+        ++produced;
+
+        m_phase += m_down;
+        m_position += m_phase / m_up;
+        m_phase %= m_up;
+    }
+    m_outputFrames += produced;
+
+    // Drop the frames no longer covered by the filter
+    const qsizetype consumed = qMin(m_position - m_halfTaps + 1, available);
+    if (consumed > 0) {
+        for (QList<float> &channel : m_history)
+            channel.remove(0, consumed);
+        m_position -= consumed;
+    }
+    return produced;
+}
+
+qsizetype QAudioResampler::process(const float *input, qsizetype frames, float *output)
+{
+    append(input, frames);
+    m_inputFrames += frames;
+    return run(output, std::numeric_limits<qint64>::max());
+}
+
+// Pushes silence through the filter until the output covers all of the input
+qsizetype QAudioResampler::flush(float *output)
+{
+    const qint64 expected = (m_inputFrames * m_up + m_down - 1) / m_down;
+    append(nullptr, m_halfTaps + 1);
+    const qsizetype produced = run(output, expected - m_outputFrames);
+    reset();
+    return produced;
+}
+
+/*!
+    \class QAudioConverter
+    \internal
+
+    QAudioConverter converts audio from one QAudioFormat to another. The sample
+    format, the channel layout and the sample rate can all differ.
+
+    Samples go through normalized floats. Channels are up or down mixed with the
+    matrix returned by channelMatrix(), and the sample rate is changed with a
+    polyphase windowed sinc filter. The resampler delays the signal by a few
+    frames, so when a stream ends flush() has to be called to get the remaining
+    output; the total output then has exactly the duration of the input.
+*/
+QAudioConverter::QAudioConverter() = default;
+
+QAudioConverter::QAudioConverter(const QAudioFormat &inputFormat, const QAudioFormat &outputFormat)
+{
+    setFormats(inputFormat, outputFormat);
+}
+
+QAudioConverter::~QAudioConverter()
+{
+    delete m_resampler;
+}
+
+/*!
+    Sets the formats to convert between to \a inputFormat and \a outputFormat.
+    This discards any state kept from earlier input.
+*/
+void QAudioConverter::setFormats(const QAudioFormat &inputFormat, const QAudioFormat &outputFormat)
+{
+    initAudioConverterFuncs();
+
+    m_inputFormat = inputFormat;
+    m_outputFormat = outputFormat;
+    m_matrix.clear();
+    m_mixChannels = false;
+    delete m_resampler;
+    m_resampler = nullptr;
+    m_startTime = -1;
+    m_outputFrames = 0;
+    if (!isValid())
+        return;
+
+    const int inChannels = inputFormat.channelCount();
+    const int outChannels = outputFormat.channelCount();
+    m_matrix = channelMatrix(inputFormat, outputFormat);
+    if (inChannels == outChannels) {
+        for (int o = 0; o < outChannels && !m_mixChannels; ++o) {
+            for (int i = 0; i < inChannels; ++i) {
+                if (m_matrix.at(o * inChannels + i) != (o == i ? 1.f : 0.f)) {
+                    m_mixChannels = true;
+                    break;
+                }
+            }
+        }
+    } else {
+        m_mixChannels = true;
+    }
+
+    if (inputFormat.sampleRate() != outputFormat.sampleRate())
+        m_resampler = new QAudioResampler(inputFormat.sampleRate(), outputFormat.sampleRate(),
+                                          outChannels);
+}
+
+/*!
+    Returns \c true if the input can be copied to the output unchanged.
+*/
+bool QAudioConverter::isPassthrough() const
+{
+    return isValid() && m_inputFormat.sampleFormat() == m_outputFormat.sampleFormat()
+            && !m_mixChannels && !m_resampler;
+}
+
+/*!
+    Returns the largest number of frames convert() can produce from \a inputFrames
+    frames of input.
+*/
+qsizetype QAudioConverter::maximumOutputFrames(qsizetype inputFrames) const
+{
+    return m_resampler ? m_resampler->maximumOutputFrames(inputFrames) : inputFrames;
+}
+
+/*!
+    Converts \a inputFrames frames from \a input and writes the result to \a output,
+    which must have room for maximumOutputFrames() frames. Returns the number of
+    frames written.
+*/
+qsizetype QAudioConverter::convert(const void *input, qsizetype inputFrames, void *output)
+{
+    if (!isValid() || inputFrames <= 0)
+        return 0;
+
+    if (isPassthrough()) {
+        memcpy(output, input, inputFrames * m_inputFormat.bytesPerFrame());
+        return inputFrames;
+    }
+
+    // Work in small pieces to keep the intermediate buffers in cache
+    constexpr qsizetype ChunkFrames = 1024;
+    const char *in = static_cast<const char *>(input);
+    char *out = static_cast<char *>(output);
+    qsizetype written = 0;
+    for (qsizetype offset = 0; offset < inputFrames; offset += ChunkFrames) {
+        const qsizetype frames = qMin(ChunkFrames, inputFrames - offset);
+        const qsizetype converted = convertChunk(in + offset * m_inputFormat.bytesPerFrame(),
+                                                 frames, out);
+        out += converted * m_outputFormat.bytesPerFrame();
+        written += converted;
+    }
+    return written;
+}
+
+qsizetype QAudioConverter::convertChunk(const void *input, qsizetype frames, void *output)
+{
+    const int inChannels = m_inputFormat.channelCount();
+    const int outChannels = m_outputFormat.channelCount();
+
+    const float *samples = static_cast<const float *>(input);
+    if (m_inputFormat.sampleFormat() != QAudioFormat::Float) {
+        m_samples.resize(frames * inChannels);
+        toFloat(m_inputFormat.sampleFormat(), input, m_samples.data(), frames * inChannels);
+        samples = m_samples.constData();
+    }
+    if (m_mixChannels) {
+        m_mixed.resize(frames * outChannels);
+        mixChannels(m_matrix, samples, inChannels, m_mixed.data(), outChannels, frames);
+        samples = m_mixed.constData();
+    }
+    if (m_resampler) {
+        m_resampled.resize(m_resampler->maximumOutputFrames(frames) * outChannels);
+        frames = m_resampler->process(samples, frames, m_resampled.data());
+        samples = m_resampled.constData();
+    }
+    fromFloat(m_outputFormat.sampleFormat(), samples, output, frames * outChannels);
+    m_outputFrames += frames;
+    return frames;
+}
+
+/*!
+    \overload
+
+    Converts \a data and returns the converted samples.
+*/
+QByteArray QAudioConverter::convert(QByteArrayView data)
+{
+    if (!isValid())
+        return {};
+    const qsizetype frames = data.size() / m_inputFormat.bytesPerFrame();
+    QByteArray result(maximumOutputFrames(frames) * m_outputFormat.bytesPerFrame(),
+                      Qt::Uninitialized);
+    const qsizetype written = convert(data.data(), frames, result.data());
+    result.resize(written * m_outputFormat.bytesPerFrame());
+    return result;
+}
+
+/*!
+    \overload
+
+    Converts \a buffer, which has to be in the input format. The start time of the
+    result accounts for the delay of the resampler.
+*/
+QAudioBuffer QAudioConverter::convert(const QAudioBuffer &buffer)
+{
+    if (!buffer.isValid() || buffer.format() != m_inputFormat)
+        return {};
+
+    if (m_startTime < 0 && m_outputFrames == 0)
+        m_startTime = buffer.startTime();
+    qint64 startTime = buffer.startTime();
+    if (m_resampler && m_startTime >= 0)
+        startTime = m_startTime + m_outputFormat.durationForFrames(m_outputFrames);
+
+    const QByteArray data = convert(QByteArrayView(buffer.constData<char>(), buffer.byteCount()));
+    return QAudioBuffer(data, m_outputFormat, startTime);
+}
+
+/*!
+    Returns the output still held back by the resampler, and resets the converter
+    for a new stream.
+*/
+QByteArray QAudioConverter::flush()
+{
+    QByteArray result;
+    if (m_resampler) {
+        const int outChannels = m_outputFormat.channelCount();
+        m_resampled.resize(m_resampler->maximumOutputFrames(m_resampler->halfTaps() + 1)
+                           * outChannels);
+        const qsizetype frames = m_resampler->flush(m_resampled.data());
+        result.resize(frames * m_outputFormat.bytesPerFrame());
+        fromFloat(m_outputFormat.sampleFormat(), m_resampled.constData(), result.data(),
+                  frames * outChannels);
+    }
+    m_startTime = -1;
+    m_outputFrames = 0;
+    return result;
+}
+
+/*!
+    Discards any state kept from earlier input.
+*/
+void QAudioConverter::reset()
+{
+    if (m_resampler)
+        m_resampler->reset();
+    m_startTime = -1;
+    m_outputFrames = 0;
+}
+
+/*!
+    Converts all of \a data from \a inputFormat to \a outputFormat.
+*/
+QByteArray QAudioConverter::convert(QByteArrayView data, const QAudioFormat &inputFormat,
+                                    const QAudioFormat &outputFormat)
+{
+    QAudioConverter converter(inputFormat, outputFormat);
+    if (!converter.isValid())
+        return {};
+    if (converter.isPassthrough())
+        return data.toByteArray();
+    QByteArray result = converter.convert(data);
+    result += converter.flush();
+    return result;
+}
+
+/*!
+    Returns the channel configuration of \a format. If the format doesn't have one
+    set, the usual layout for its channel count is assumed.
+*/
+QAudioFormat::ChannelConfig QAudioConverter::channelConfig(const QAudioFormat &format)
+{
+    const QAudioFormat::ChannelConfig config = format.channelConfig();
+    if (config != QAudioFormat::ChannelConfigUnknown
+        && qPopulationCount(uint(config)) == uint(format.channelCount())) {
+        return config;
+    }
+    switch (format.channelCount()) {
+    case 1:
+        return QAudioFormat::ChannelConfigMono;
+    case 2:
+        return QAudioFormat::ChannelConfigStereo;
+    case 3:
+        return QAudioFormat::ChannelConfig2Dot1;
+    case 5:
+        return QAudioFormat::ChannelConfigSurround5Dot0;
+    case 6:
+        return QAudioFormat::ChannelConfigSurround5Dot1;
+    case 7:
+        return QAudioFormat::ChannelConfigSurround7Dot0;
+    case 8:
+        return QAudioFormat::ChannelConfigSurround7Dot1;
+    default:
+        return QAudioFormat::ChannelConfigUnknown;
+    }
+}
+
+/*!
+    Returns the gains used to mix the channels of \a inputFormat into the channels
+    of \a outputFormat, one row of input channel gains per output channel.
+
+    Mono is copied to the front channels. Channels missing in the output are
+    folded into their nearest neighbours, and if that could clip, all gains are
+    scaled down. LFE channels are dropped when the output has none.
+*/
+QList<float> QAudioConverter::channelMatrix(const QAudioFormat &inputFormat,
+                                            const QAudioFormat &outputFormat)
+{
+    const int inChannels = inputFormat.channelCount();
+    const int outChannels = outputFormat.channelCount();
+    QList<float> matrix(inChannels * outChannels, 0.f);
+    if (matrix.isEmpty())
+        return matrix;
+    auto gain = [&](int out, int in) -> float & { return matrix[out * inChannels + in]; };
+
+    const QAudioFormat::ChannelConfig inConfig = channelConfig(inputFormat);
+    const QAudioFormat::ChannelConfig outConfig = channelConfig(outputFormat);
+
+    if (inChannels == 1) {
+        const int center = channelOffset(outConfig, QAudioFormat::FrontCenter);
+        const int left = channelOffset(outConfig, QAudioFormat::FrontLeft);
+        const int right = channelOffset(outConfig, QAudioFormat::FrontRight);
+        if (center >= 0) {
+            gain(center, 0) = 1.f;
+        } else if (left >= 0 && right >= 0) {
+            gain(left, 0) = 1.f;
+            gain(right, 0) = 1.f;
+        } else {
+            for (int o = 0; o < outChannels; ++o)
+                gain(o, 0) = 1.f;
+        }
+        return matrix;
+    }
+
+    if (inConfig == QAudioFormat::ChannelConfigUnknown
+        || outConfig == QAudioFormat::ChannelConfigUnknown) {
+        // Nothing known about the layout, match channels by index
+        if (outChannels == 1) {
+            for (int i = 0; i < inChannels; ++i)
+                gain(0, i) = 1.f / inChannels;
+        } else {
+            for (int i = 0; i < qMin(inChannels, outChannels); ++i)
+                gain(i, i) = 1.f;
+        }
+        return matrix;
+    }
+
+    int in = 0;
+    for (int bit = 0; bit < 32; ++bit) {
+        if (!(inConfig & (1u << bit)))
+            continue;
+        const Position position = Position(bit);
+        const int out = channelOffset(outConfig, position);
+        if (out >= 0) {
+            gain(out, in) += 1.f;
+        } else {
+            for (const Route &route : routesFor(position)) {
+                const int first = channelOffset(outConfig, route.first);
+                const int second = route.second == QAudioFormat::UnknownPosition
+                        ? -2 : channelOffset(outConfig, route.second);
+                if (first < 0 || second == -1)
+                    continue;
+                gain(first, in) += route.gain;
+                if (second >= 0)
+                    gain(second, in) += route.gain;
+                break;
+            }
+        }
+        ++in;
+    }
+
+    float maximumGain = 0.f;
+    for (int o = 0; o < outChannels; ++o) {
+        float sum = 0.f;
+        for (int i = 0; i < inChannels; ++i)
+            sum += gain(o, i);
+        maximumGain = qMax(maximumGain, sum);
+    }
+    if (maximumGain > 1.f) {
+        for (float &g : matrix)
+            g /= maximumGain;
+    }
+    return matrix;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QAUDIOCONVERTER_P_H
+#define QAUDIOCONVERTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qlist.h>
+#include <qaudiobuffer.h>
+#include <qaudioformat.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioResampler;
+
+// Converts a stream of audio between two formats: sample format, channel
+// layout and sample rate can all differ. Keeps state between calls when
+// resampling, so the input can be fed in arbitrary pieces.
+class Q_MULTIMEDIA_EXPORT QAudioConverter
+{
+public:
+    QAudioConverter();
+    QAudioConverter(const QAudioFormat &inputFormat, const QAudioFormat &outputFormat);
+    ~QAudioConverter();
+
+    void setFormats(const QAudioFormat &inputFormat, const QAudioFormat &outputFormat);
+    QAudioFormat inputFormat() const { return m_inputFormat; }
+    QAudioFormat outputFormat() const { return m_outputFormat; }
+
+    bool isValid() const { return m_inputFormat.isValid() && m_outputFormat.isValid(); }
+    bool isPassthrough() const;
+
+    qsizetype maximumOutputFrames(qsizetype inputFrames) const;
+    qsizetype convert(const void *input, qsizetype inputFrames, void *output);
+
+    QByteArray convert(QByteArrayView data);
+    QAudioBuffer convert(const QAudioBuffer &buffer);
+    QByteArray flush();
+    void reset();
+
+    static QByteArray convert(QByteArrayView data, const QAudioFormat &inputFormat,
+                              const QAudioFormat &outputFormat);
+
+    static QAudioFormat::ChannelConfig channelConfig(const QAudioFormat &format);
+    static QList<float> channelMatrix(const QAudioFormat &inputFormat,
+                                      const QAudioFormat &outputFormat);
+
+private:
+    Q_DISABLE_COPY(QAudioConverter)
+
+    qsizetype convertChunk(const void *input, qsizetype inputFrames, void *output);
+    qsizetype outputSamples(const float *samples, qsizetype frames, void *output);
+
+    QAudioFormat m_inputFormat;
+    QAudioFormat m_outputFormat;
+    QList<float> m_matrix;
+    bool m_mixChannels = false;
+    QAudioResampler *m_resampler = nullptr;
+    QList<float> m_samples;
+    QList<float> m_mixed;
+    QList<float> m_resampled;
+    qint64 m_startTime = -1;
+    qint64 m_outputFrames = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOCONVERTER_P_H
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudioconverter_p.h"
+
+#include <private/qsimd_p.h>
+
+#include <cmath>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+void QT_FASTCALL qt_audio_int16_to_float_sse2(const qint16 *src, float *dst, qsizetype count)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 0x8000);
+    qsizetype i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        // sign extend by moving the samples to the upper half of each 32 bit lane
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < count; ++i)
+        dst[i] = src[i] * (1.f / 0x8000);
+}
+
+// _mm_cvtps_epi32 rounds to nearest even like lrint, and the pack saturates
+// 0x8000 to 0x7fff
+void QT_FASTCALL qt_audio_float_to_int16_sse2(const float *src, qint16 *dst, qsizetype count)
+{
+    const __m128 min = _mm_set1_ps(-1.f);
+    const __m128 max = _mm_set1_ps(1.f);
+    const __m128 scale = _mm_set1_ps(float(0x8000));
+    qsizetype i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128 s0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), min), max);
+        const __m128 s1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), min), max);
+        const __m128i i0 = _mm_cvtps_epi32(_mm_mul_ps(s0, scale));
+        const __m128i i1 = _mm_cvtps_epi32(_mm_mul_ps(s1, scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(i0, i1));
+    }
+    for (; i < count; ++i) {
+        const float v = qBound(-1.f, src[i], 1.f) * 0x8000;
+        dst[i] = qint16(qMin(std::lrint(v), long(0x7fff)));
+    }
+}
+
+float QT_FASTCALL qt_audio_dot_product_sse2(const float *a, const float *b, int n)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(acc);
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -39,61 +39,189 @@
 
 #include "qaudiohelpers_p.h"
 
+#include <private/qsimd_p.h>
 #include <QDebug>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
 
-template<class T> void adjustSamples(qreal factor, const void *src, void *dst, int samples)
+// Attenuation (0 <= factor < 1) runs in fixed point on integer samples, which
+// lets the SIMD kernels below use rounding high multiplies: the gain is Q15
+// for 16 bit and Q31 for 32 bit samples, and every kernel computes
+// (sample * gain + half) >> shift, so all of them produce identical output.
+
+static void QT_FASTCALL multiplyInt16(const qint16 *src, qint16 *dst, int count, int gain)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = qint16((src[i] * gain + 0x4000) >> 15);
+}
+
+static void QT_FASTCALL multiplyInt32(const qint32 *src, qint32 *dst, int count, qint32 gain)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = qint32((qint64(src[i]) * gain + (Q_INT64_C(1) << 30)) >> 31);
+}
+
+static void QT_FASTCALL multiplyFloat(const float *src, float *dst, int count, float gain)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = src[i] * gain;
+}
+
+// Unsigned samples are biased around 0x80
+static void multiplyUInt8(const quint8 *src, quint8 *dst, int count, int gain)
 {
-    const T *pSrc = (const T *)src;
-    T *pDst = (T*)dst;
-    for ( int i = 0; i < samples; i++ )
-        pDst[i] = pSrc[i] * factor;
+    for (int i = 0; i < count; ++i)
+        dst[i] = quint8((((int(src[i]) - 0x80) * gain + 0x4000) >> 15) + 0x80);
 }
 
-// Unsigned samples are biased around 0x80/0x8000 :/
-// This makes a pure template solution a bit unwieldy but possible
-template<class T> struct signedVersion {};
-template<> struct signedVersion<quint8>
+// Gains outside of [0, 1) can overflow the sample type, so clamp the result.
+template<class T> void multiplySaturated(qreal factor, const void *src, void *dst, int samples)
 {
-    using TS = qint8;
-    static constexpr int offset = 0x80;
-};
+    const T *pSrc = static_cast<const T *>(src);
+    T *pDst = static_cast<T *>(dst);
+    constexpr qreal min = std::numeric_limits<T>::min();
+    constexpr qreal max = std::numeric_limits<T>::max();
+    for (int i = 0; i < samples; ++i)
+        pDst[i] = T(qRound64(qBound(min, pSrc[i] * factor, max)));
+}
 
-template<class T> void adjustUnsignedSamples(qreal factor, const void *src, void *dst, int samples)
+static void multiplyUInt8Saturated(qreal factor, const void *src, void *dst, int samples)
 {
-    const T *pSrc = (const T *)src;
-    T *pDst = (T*)dst;
-    for ( int i = 0; i < samples; i++ ) {
-        pDst[i] = signedVersion<T>::offset + ((typename signedVersion<T>::TS)(pSrc[i] - signedVersion<T>::offset) * factor);
+    const quint8 *pSrc = static_cast<const quint8 *>(src);
+    quint8 *pDst = static_cast<quint8 *>(dst);
+    for (int i = 0; i < samples; ++i)
+        pDst[i] = quint8(qBound(0, qRound((int(pSrc[i]) - 0x80) * factor) + 0x80, 0xff));
+}
+
+static MultiplyInt16Func qMultiplyInt16 = multiplyInt16;
+static MultiplyInt32Func qMultiplyInt32 = multiplyInt32;
+static MultiplyFloatFunc qMultiplyFloat = multiplyFloat;
+
+static void qInitMultiplyFuncsAsm()
+{
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    extern void QT_FASTCALL qt_multiply_int16_sse2(const qint16 *src, qint16 *dst, int count, int gain);
+    extern void QT_FASTCALL qt_multiply_float_sse2(const float *src, float *dst, int count, float gain);
+    if (qCpuHasFeature(SSE2)) {
+        qMultiplyInt16 = qt_multiply_int16_sse2;
+        qMultiplyFloat = qt_multiply_float_sse2;
+    }
+#endif
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+    extern void QT_FASTCALL qt_multiply_int16_avx2(const qint16 *src, qint16 *dst, int count, int gain);
+    extern void QT_FASTCALL qt_multiply_int32_avx2(const qint32 *src, qint32 *dst, int count, qint32 gain);
+    extern void QT_FASTCALL qt_multiply_float_avx2(const float *src, float *dst, int count, float gain);
+    if (qCpuHasFeature(AVX2)) {
+        qMultiplyInt16 = qt_multiply_int16_avx2;
+        qMultiplyInt32 = qt_multiply_int32_avx2;
+        qMultiplyFloat = qt_multiply_float_avx2;
+    }
+#endif
+#if defined(__ARM_NEON)
+    extern void QT_FASTCALL qt_multiply_int16_neon(const qint16 *src, qint16 *dst, int count, int gain);
+    extern void QT_FASTCALL qt_multiply_int32_neon(const qint32 *src, qint32 *dst, int count, qint32 gain);
+    extern void QT_FASTCALL qt_multiply_float_neon(const float *src, float *dst, int count, float gain);
+    qMultiplyInt16 = qt_multiply_int16_neon;
+    qMultiplyInt32 = qt_multiply_int32_neon;
+    qMultiplyFloat = qt_multiply_float_neon;
+#endif
+}
+
+static void initMultiplyFuncs()
+{
+    static bool initDone = false;
+    if (!initDone) {
+        qInitMultiplyFuncsAsm();
+        initDone = true;
     }
 }
 
 void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src, void* dest, int len)
 {
     const int samplesCount = len / qMax(1, format.bytesPerSample());
+    if (samplesCount <= 0)
+        return;
 
+    if (factor == 1.) {
+        if (src != dest)
+            memmove(dest, src, samplesCount * format.bytesPerSample());
+        return;
+    }
+
+    initMultiplyFuncs();
+
+    const bool attenuate = factor >= 0. && factor < 1.;
     switch (format.sampleFormat()) {
     case QAudioFormat::Unknown:
     case QAudioFormat::NSampleFormats:
         return;
     case QAudioFormat::UInt8:
-        QAudioHelperInternal::adjustUnsignedSamples<quint8>(factor,src,dest,samplesCount);
+        if (attenuate)
+            multiplyUInt8(static_cast<const quint8 *>(src), static_cast<quint8 *>(dest),
+                          samplesCount, qMin(qRound(factor * 0x8000), 0x7fff));
+        else
+            multiplyUInt8Saturated(factor, src, dest, samplesCount);
         break;
     case QAudioFormat::Int16:
-        QAudioHelperInternal::adjustSamples<qint16>(factor,src,dest,samplesCount);
+        if (attenuate)
+            qMultiplyInt16(static_cast<const qint16 *>(src), static_cast<qint16 *>(dest),
+                           samplesCount, qMin(qRound(factor * 0x8000), 0x7fff));
+        else
+            multiplySaturated<qint16>(factor, src, dest, samplesCount);
         break;
     case QAudioFormat::Int32:
-        QAudioHelperInternal::adjustSamples<qint32>(factor,src,dest,samplesCount);
+        if (attenuate)
+            qMultiplyInt32(static_cast<const qint32 *>(src), static_cast<qint32 *>(dest),
+                           samplesCount,
+                           qint32(qMin(qRound64(factor * 2147483648.), qint64(0x7fffffff))));
+        else
+            multiplySaturated<qint32>(factor, src, dest, samplesCount);
         break;
     case QAudioFormat::Float:
-        QAudioHelperInternal::adjustSamples<float>(factor,src,dest,samplesCount);
+        qMultiplyFloat(static_cast<const float *>(src), static_cast<float *>(dest),
+                       samplesCount, float(factor));
         break;
     }
 }
+
+/*!
+    \internal
+
+    Scales \a len bytes of samples from \a src into \a dest, moving the gain
+    linearly from \a startFactor to \a endFactor over the buffer. This avoids
+    the audible clicks ("zipper noise") of jumping to a new volume in one step.
+
+    The gain is kept constant over small blocks of frames so that the vectorized
+    kernels can be used for each block. The last block is scaled by
+    \a endFactor exactly.
+*/
+void qMultiplySamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                      const void *src, void *dest, int len)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (startFactor == endFactor || bytesPerFrame <= 0) {
+        qMultiplySamples(endFactor, format, src, dest, len);
+        return;
+    }
+
+    constexpr int framesPerBlock = 32;
+    const int frames = len / bytesPerFrame;
+    const int blocks = (frames + framesPerBlock - 1) / framesPerBlock;
+    const char *in = static_cast<const char *>(src);
+    char *out = static_cast<char *>(dest);
+    for (int i = 0; i < blocks; ++i) {
+        const qreal factor = startFactor + (endFactor - startFactor) * (i + 1) / blocks;
+        const int bytes = qMin(framesPerBlock, frames - i * framesPerBlock) * bytesPerFrame;
+        qMultiplySamples(factor, format, in, out, bytes);
+        in += bytes;
+        out += bytes;
+    }
+}
 }
 
 QT_END_NAMESPACE
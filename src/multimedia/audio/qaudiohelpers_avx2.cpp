@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+// _mm256_mulhrs_epi16 computes (s * g + 0x4000) >> 15, same as the scalar code.
+void QT_FASTCALL qt_multiply_int16_avx2(const qint16 *src, qint16 *dst, int count, int gain)
+{
+    const __m256i g = _mm256_set1_epi16(short(gain));
+    int i = 0;
+    for (; i <= count - 16; i += 16) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_mulhrs_epi16(s, g));
+    }
+    for (; i < count; ++i)
+        dst[i] = qint16((src[i] * gain + 0x4000) >> 15);
+}
+
+// Multiplies the even and odd lanes into 64 bit products. There is no 64 bit
+// arithmetic shift, but bits 31..62 of the rounded product are the same for a
+// logical one, and the result always fits in the low 32 bits.
+void QT_FASTCALL qt_multiply_int32_avx2(const qint32 *src, qint32 *dst, int count, qint32 gain)
+{
+    const __m256i g = _mm256_set1_epi32(gain);
+    const __m256i round = _mm256_set1_epi64x(Q_INT64_C(1) << 30);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i even = _mm256_mul_epi32(s, g);
+        __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(s, 32), g);
+        even = _mm256_srli_epi64(_mm256_add_epi64(even, round), 31);
+        odd = _mm256_slli_epi64(_mm256_srli_epi64(_mm256_add_epi64(odd, round), 31), 32);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_blend_epi32(even, odd, 0xaa));
+    }
+    for (; i < count; ++i)
+        dst[i] = qint32((qint64(src[i]) * gain + (Q_INT64_C(1) << 30)) >> 31);
+}
+
+void QT_FASTCALL qt_multiply_float_avx2(const float *src, float *dst, int count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i <= count - 16; i += 16) {
+        const __m256 s0 = _mm256_loadu_ps(src + i);
+        const __m256 s1 = _mm256_loadu_ps(src + i + 8);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(s0, g));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(s1, g));
+    }
+    for (; i < count; ++i)
+        dst[i] = src[i] * gain;
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
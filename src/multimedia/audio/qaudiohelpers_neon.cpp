@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiohelpers_p.h"
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+// vqrdmulh computes (2 * s * g + (1 << (bits - 1))) >> bits, which is the same
+// rounded Q15/Q31 product as the scalar code. It only saturates for
+// s == g == min, and the gain is never negative.
+void QT_FASTCALL qt_multiply_int16_neon(const qint16 *src, qint16 *dst, int count, int gain)
+{
+    const int16x8_t g = vdupq_n_s16(int16_t(gain));
+    int i = 0;
+    for (; i <= count - 8; i += 8)
+        vst1q_s16(dst + i, vqrdmulhq_s16(vld1q_s16(src + i), g));
+    for (; i < count; ++i)
+        dst[i] = qint16((src[i] * gain + 0x4000) >> 15);
+}
+
+void QT_FASTCALL qt_multiply_int32_neon(const qint32 *src, qint32 *dst, int count, qint32 gain)
+{
+    const int32x4_t g = vdupq_n_s32(gain);
+    int i = 0;
+    for (; i <= count - 4; i += 4)
+        vst1q_s32(dst + i, vqrdmulhq_s32(vld1q_s32(src + i), g));
+    for (; i < count; ++i)
+        dst[i] = qint32((qint64(src[i]) * gain + (Q_INT64_C(1) << 30)) >> 31);
+}
+
+void QT_FASTCALL qt_multiply_float_neon(const float *src, float *dst, int count, float gain)
+{
+    const float32x4_t g = vdupq_n_f32(gain);
+    int i = 0;
+    for (; i <= count - 4; i += 4)
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+    for (; i < count; ++i)
+        dst[i] = src[i] * gain;
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
@@ -57,7 +57,14 @@ QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
-void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                                          const void *src, void *dest, int len);
+
+// Gains are Q15 for 16 bit and Q31 for 32 bit integer samples and must be in [0, 1).
+typedef void (QT_FASTCALL *MultiplyInt16Func)(const qint16 *src, qint16 *dst, int count, int gain);
+typedef void (QT_FASTCALL *MultiplyInt32Func)(const qint32 *src, qint32 *dst, int count, qint32 gain);
+typedef void (QT_FASTCALL *MultiplyFloatFunc)(const float *src, float *dst, int count, float gain);
 }
 
 QT_END_NAMESPACE
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+// SSE2 has no rounding high multiply, so build the full 32 bit products from
+// the low and high halves and round and shift them like the scalar code.
+void QT_FASTCALL qt_multiply_int16_sse2(const qint16 *src, qint16 *dst, int count, int gain)
+{
+    const __m128i g = _mm_set1_epi16(short(gain));
+    const __m128i round = _mm_set1_epi32(0x4000);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i lo = _mm_mullo_epi16(s, g);
+        const __m128i hi = _mm_mulhi_epi16(s, g);
+        __m128i p0 = _mm_unpacklo_epi16(lo, hi);
+        __m128i p1 = _mm_unpackhi_epi16(lo, hi);
+        p0 = _mm_srai_epi32(_mm_add_epi32(p0, round), 15);
+        p1 = _mm_srai_epi32(_mm_add_epi32(p1, round), 15);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(p0, p1));
+    }
+    for (; i < count; ++i)
+        dst[i] = qint16((src[i] * gain + 0x4000) >> 15);
+}
+
+void QT_FASTCALL qt_multiply_float_sse2(const float *src, float *dst, int count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128 s0 = _mm_loadu_ps(src + i);
+        const __m128 s1 = _mm_loadu_ps(src + i + 4);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(s0, g));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(s1, g));
+    }
+    for (; i < count; ++i)
+        dst[i] = src[i] * gain;
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
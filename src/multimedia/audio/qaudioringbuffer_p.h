@@ -0,0 +1,168 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QAUDIORINGBUFFER_P_H
+#define QAUDIORINGBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+// Lock-free byte ring shared by exactly one producer and one consumer thread,
+// for example the audio thread of a backend and the thread the user's
+// QIODevice lives in. Data can be copied in and out or accessed in place
+// through writeRegion()/commit() and readRegion()/consume().
+//
+// Positions run from 0 to twice the capacity, so that a full ring can be told
+// apart from an empty one without wasting a byte.
+class QAudioRingBuffer
+{
+public:
+    struct Region
+    {
+        char *data = nullptr;
+        qsizetype size = 0;
+    };
+
+    QAudioRingBuffer() = default;
+    explicit QAudioRingBuffer(qsizetype capacity) { resize(capacity); }
+
+    // Not thread safe, neither side may be running
+    void resize(qsizetype capacity)
+    {
+        m_data.resize(capacity);
+        m_begin = m_data.data();
+        clear();
+    }
+    void clear()
+    {
+        m_readPos.storeRelaxed(0);
+        m_writePos.storeRelaxed(0);
+    }
+
+    qsizetype capacity() const { return m_data.size(); }
+    qsizetype used() const { return distance(m_readPos.loadAcquire(), m_writePos.loadAcquire()); }
+    qsizetype free() const { return capacity() - used(); }
+    bool isEmpty() const { return used() == 0; }
+
+    // Producer side
+    Region writeRegion() const
+    {
+        const qsizetype w = m_writePos.loadRelaxed();
+        const qsizetype free = capacity() - distance(m_readPos.loadAcquire(), w);
+        const qsizetype offset = index(w);
+        return { m_begin + offset, qMin(free, capacity() - offset) };
+    }
+    void commit(qsizetype bytes) { m_writePos.storeRelease(advance(m_writePos.loadRelaxed(), bytes)); }
+    qsizetype write(const char *data, qsizetype len)
+    {
+        qsizetype written = 0;
+        while (written < len) {
+            const Region region = writeRegion();
+            const qsizetype n = qMin(region.size, len - written);
+            if (n <= 0)
+                break;
+            memcpy(region.data, data + written, n);
+            commit(n);
+            written += n;
+        }
+        return written;
+    }
+
+    // Consumer side
+    Region readRegion() const
+    {
+        const qsizetype r = m_readPos.loadRelaxed();
+        const qsizetype used = distance(r, m_writePos.loadAcquire());
+        const qsizetype offset = index(r);
+        return { m_begin + offset, qMin(used, capacity() - offset) };
+    }
+    void consume(qsizetype bytes) { m_readPos.storeRelease(advance(m_readPos.loadRelaxed(), bytes)); }
+    qsizetype read(char *data, qsizetype len)
+    {
+        qsizetype read = 0;
+        while (read < len) {
+            const Region region = readRegion();
+            const qsizetype n = qMin(region.size, len - read);
+            if (n <= 0)
+                break;
+            memcpy(data + read, region.data, n);
+            consume(n);
+            read += n;
+        }
+        return read;
+    }
+
+private:
+    qsizetype index(qsizetype pos) const { return pos >= capacity() ? pos - capacity() : pos; }
+    qsizetype advance(qsizetype pos, qsizetype bytes) const
+    {
+        pos += bytes;
+        return pos >= 2 * capacity() ? pos - 2 * capacity() : pos;
+    }
+    qsizetype distance(qsizetype from, qsizetype to) const
+    {
+        return to >= from ? to - from : to + 2 * capacity() - from;
+    }
+
+    QByteArray m_data;
+    char *m_begin = nullptr;
+    QAtomicInteger<qsizetype> m_readPos = 0;
+    QAtomicInteger<qsizetype> m_writePos = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIORINGBUFFER_P_H
@@ -195,6 +195,48 @@ QIODevice* QAudioSink::start()
     return d->start();
 }
 
+/*!
+    \typedef QAudioSink::RenderCallback
+    \since 6.3
+
+    The function type used by start(RenderCallback). It is called with a
+    QAudioFrameSpan that has to be filled completely with audio data.
+*/
+
+/*!
+    \since 6.3
+
+    Starts rendering audio by calling \a callback whenever the audio device needs
+    more data. The callback receives a QAudioFrameSpan in format() and must fill
+    all of its frames; write silence if there is nothing to play.
+
+    Where the backend supports it, the callback is called on the backend's audio
+    thread, once per period, with the span pointing into the buffer that is handed
+    to the device. No locks are taken and no memory is allocated around the call,
+    so the callback itself should not block or allocate either. It must not call
+    back into this QAudioSink. Other backends call it from the thread this object
+    lives in.
+
+    volume() is applied to the span after the callback returns, so the callback
+    should render at full scale.
+
+    If the QAudioSink is able to successfully output audio data, state() returns
+    QAudio::ActiveState, error() returns QAudio::NoError
+    and the stateChanged() signal is emitted.
+
+    If a problem occurs during this process, error() returns QAudio::OpenError,
+    state() returns QAudio::StoppedState and the stateChanged() signal is emitted.
+
+    \sa QAudioFrameSpan
+*/
+void QAudioSink::start(RenderCallback callback)
+{
+    if (!d || !callback)
+        return;
+    d->elapsedTime.restart();
+    d->startRendering(std::move(callback));
+}
+
 /*!
     Stops the audio output, detaching from the system resource.
 
@@ -300,6 +342,57 @@ qint64 QAudioSink::elapsedUSecs() const
     return state() == QAudio::StoppedState ? 0 : d->elapsedTime.nsecsElapsed()/1000;
 }
 
+/*!
+    Returns how often the audio device ran out of audio data to play since start() was called.
+
+    These underruns are audible as glitches. Backends that cannot detect them
+    always return 0.
+
+    \since 6.3
+*/
+int QAudioSink::xrunCount() const
+{
+    return d ? d->xrunCount() : 0;
+}
+
+/*!
+    Returns the time in microseconds it takes for audio data written now to be
+    heard, including the buffers of the audio device. Returns -1 if it is not
+    known, for example because the sink is stopped.
+
+    \since 6.3
+    \sa presentationUSecs()
+*/
+qint64 QAudioSink::latencyUSecs() const
+{
+    if (!d || state() == QAudio::StoppedState)
+        return -1;
+    return d->latencyUSecs();
+}
+
+/*!
+    Returns when the audio frame \a frame, counted from start(), is heard.
+
+    The time is in microseconds on the clock of elapsedUSecs(), so frame \a frame
+    reaches the speaker when elapsedUSecs() returns this value. Frames still to be
+    written map to a time in the future. This can be used to keep video or other
+    output in sync with the audio to better than the size of the audio buffer.
+
+    Returns -1 if the backend cannot report it.
+
+    \since 6.3
+    \sa latencyUSecs(), elapsedUSecs()
+*/
+qint64 QAudioSink::presentationUSecs(qint64 frame) const
+{
+    if (!d || state() == QAudio::StoppedState)
+        return -1;
+    const QAudioTimestamp timestamp = d->timestamp();
+    if (!timestamp.isValid())
+        return -1;
+    return timestamp.usecsForFrame(frame, d->format().sampleRate());
+}
+
 /*!
     Returns the error state.
 */
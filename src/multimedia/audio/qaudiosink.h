@@ -48,6 +48,9 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudiobuffer.h>
+
+#include <functional>
 
 
 QT_BEGIN_NAMESPACE
@@ -61,6 +64,8 @@ class Q_MULTIMEDIA_EXPORT QAudioSink : public QObject
     Q_OBJECT
 
 public:
+    using RenderCallback = std::function<void(QAudioFrameSpan frames)>;
+
     explicit QAudioSink(const QAudioFormat &format = QAudioFormat(), QObject *parent = nullptr);
     explicit QAudioSink(const QAudioDevice &audioDeviceInfo, const QAudioFormat &format = QAudioFormat(), QObject *parent = nullptr);
     ~QAudioSink();
@@ -71,6 +76,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+    void start(RenderCallback callback);
 
     void stop();
     void reset();
@@ -84,6 +90,9 @@ public:
 
     qint64 processedUSecs() const;
     qint64 elapsedUSecs() const;
+    int xrunCount() const;
+    qint64 latencyUSecs() const;
+    qint64 presentationUSecs(qint64 frame) const;
 
     QAudio::Error error() const;
     QAudio::State state() const;
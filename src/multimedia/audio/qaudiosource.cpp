@@ -198,6 +198,47 @@ QIODevice* QAudioSource::start()
     return d->start();
 }
 
+/*!
+    \typedef QAudioSource::CaptureCallback
+    \since 6.3
+
+    The function type used by start(CaptureCallback). It is called with a
+    QAudioFrameSpan holding newly captured audio data.
+*/
+
+/*!
+    \since 6.3
+
+    Starts capturing audio and calls \a callback with every block of audio data
+    that arrives from the device. The callback receives a QAudioFrameSpan in
+    format(); its data must be treated as read-only and is only valid during the
+    call.
+
+    Where the backend supports it, the callback is called on the backend's audio
+    thread with the span pointing straight at the captured data. No locks are
+    taken and no memory is allocated around the call, so the callback itself
+    should not block or allocate either. It must not call back into this
+    QAudioSource. Other backends call it from the thread this object lives in.
+
+    The captured data is scaled by volume() before it is handed to the callback.
+
+    If the QAudioSource is able to successfully get audio data, state() returns
+    QAudio::ActiveState, error() returns QAudio::NoError
+    and the stateChanged() signal is emitted.
+
+    If a problem occurs during this process, error() returns QAudio::OpenError,
+    state() returns QAudio::StoppedState and the stateChanged() signal is emitted.
+
+    \sa QAudioFrameSpan
+*/
+void QAudioSource::start(CaptureCallback callback)
+{
+    if (!d || !callback)
+        return;
+    d->elapsedTime.start();
+    d->startCapturing(std::move(callback));
+}
+
 /*!
     Returns the QAudioFormat being used.
 */
@@ -360,6 +401,55 @@ qint64 QAudioSource::elapsedUSecs() const
     return state() == QAudio::StoppedState ? 0 : d->elapsedTime.nsecsElapsed()/1000;
 }
 
+/*!
+    Returns how often the audio device dropped audio because it was not read in time since start() was called.
+
+    These overruns are audible as glitches. Backends that cannot detect them
+    always return 0.
+
+    \since 6.3
+*/
+int QAudioSource::xrunCount() const
+{
+    return d ? d->xrunCount() : 0;
+}
+
+/*!
+    Returns the time in microseconds from sound reaching the audio device until
+    it is delivered, including the buffers of the device. Returns -1 if it is not
+    known, for example because the source is stopped.
+
+    \since 6.3
+    \sa captureUSecs()
+*/
+qint64 QAudioSource::latencyUSecs() const
+{
+    if (!d || state() == QAudio::StoppedState)
+        return -1;
+    return d->latencyUSecs();
+}
+
+/*!
+    Returns when the audio frame \a frame, counted from start(), was captured.
+
+    The time is in microseconds on the clock of elapsedUSecs(), so frame \a frame
+    was recorded when elapsedUSecs() returned this value.
+
+    Returns -1 if the backend cannot report it.
+
+    \since 6.3
+    \sa latencyUSecs(), elapsedUSecs()
+*/
+qint64 QAudioSource::captureUSecs(qint64 frame) const
+{
+    if (!d || state() == QAudio::StoppedState)
+        return -1;
+    const QAudioTimestamp timestamp = d->timestamp();
+    if (!timestamp.isValid())
+        return -1;
+    return timestamp.usecsForFrame(frame, d->format().sampleRate());
+}
+
 /*!
     Returns the error state.
 */
@@ -48,6 +48,9 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudiobuffer.h>
+
+#include <functional>
 
 
 QT_BEGIN_NAMESPACE
@@ -59,6 +62,8 @@ class Q_MULTIMEDIA_EXPORT QAudioSource : public QObject
     Q_OBJECT
 
 public:
+    using CaptureCallback = std::function<void(QAudioFrameSpan frames)>;
+
     explicit QAudioSource(const QAudioFormat &format = QAudioFormat(), QObject *parent = nullptr);
     explicit QAudioSource(const QAudioDevice &audioDeviceInfo, const QAudioFormat &format = QAudioFormat(), QObject *parent = nullptr);
     ~QAudioSource();
@@ -69,6 +74,7 @@ public:
 
     void start(QIODevice *device);
     QIODevice* start();
+    void start(CaptureCallback callback);
 
     void stop();
     void reset();
@@ -85,6 +91,9 @@ public:
 
     qint64 processedUSecs() const;
     qint64 elapsedUSecs() const;
+    int xrunCount() const;
+    qint64 latencyUSecs() const;
+    qint64 captureUSecs(qint64 frame) const;
 
     QAudio::Error error() const;
     QAudio::State state() const;
@@ -40,8 +40,48 @@
 #include <private/qtmultimediaglobal_p.h>
 #include "qaudiosystem_p.h"
 
+#include <QtCore/qiodevice.h>
+
 QT_BEGIN_NAMESPACE
 
+namespace {
+
+// Adapts a render or capture callback to the QIODevice based start(QIODevice *)
+// of backends that have no native callback support
+class QAudioCallbackDevice : public QIODevice
+{
+public:
+    QAudioCallbackDevice(std::function<void(QAudioFrameSpan)> &&callback,
+                         const QAudioFormat &format, QObject *parent)
+        : QIODevice(parent), m_callback(std::move(callback)), m_format(format)
+    {}
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 len) override
+    {
+        const qsizetype frames = len / m_format.bytesPerFrame();
+        if (frames > 0)
+            m_callback(QAudioFrameSpan(data, frames, m_format));
+        return frames * m_format.bytesPerFrame();
+    }
+
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        const qsizetype frames = len / m_format.bytesPerFrame();
+        if (frames > 0)
+            m_callback(QAudioFrameSpan(const_cast<char *>(data), frames, m_format));
+        return len;
+    }
+
+private:
+    std::function<void(QAudioFrameSpan)> m_callback;
+    QAudioFormat m_format;
+};
+
+}
+
 
 /*!
     \class QPlatformAudioSink
@@ -142,6 +182,52 @@ QT_BEGIN_NAMESPACE
     Returns the volume in the range 0.0 and 1.0.
 */
 
+/*!
+    Starts the audio output and calls \a callback for every block of audio data
+    the device needs.
+
+    Backends that can call the callback on their own audio thread reimplement this.
+    The default implementation wraps the callback into a QIODevice and passes it to
+    start(QIODevice *), so the callback is called on the thread of the sink.
+*/
+void QPlatformAudioSink::startRendering(QAudioSink::RenderCallback &&callback)
+{
+    QIODevice *previous = m_callbackDevice;
+    m_callbackDevice = new QAudioCallbackDevice(std::move(callback), format(), this);
+    m_callbackDevice->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    // start() closes the previous stream before the old device goes away
+    start(m_callbackDevice);
+    delete previous;
+}
+
+/*!
+    \fn int QPlatformAudioSink::xrunCount() const
+    Returns the number of underruns of the device since start(), or 0 if the
+    backend does not detect them.
+*/
+
+/*!
+    \fn qint64 QPlatformAudioSink::latencyUSecs() const
+    Returns the time in microseconds until audio data written now is heard,
+    or -1 if the backend cannot tell.
+*/
+
+/*!
+    Returns which frame of the stream is heard at which time on elapsedTime.
+
+    The default implementation assumes that the data processed so far is heard
+    after latencyUSecs(), and returns an invalid timestamp if the latency is
+    not known. Backends that get timestamps from the device reimplement this.
+*/
+QAudioTimestamp QPlatformAudioSink::timestamp() const
+{
+    const qint64 latency = latencyUSecs();
+    if (latency < 0 || !elapsedTime.isValid())
+        return {};
+    const qint64 played = qMax<qint64>(processedUSecs() - latency, 0);
+    return { played * format().sampleRate() / 1000000, elapsedTime.nsecsElapsed() / 1000 };
+}
+
 /*!
     \fn QPlatformAudioSink::errorChanged(QAudio::Error error)
     This signal is emitted when the \a error state has changed.
@@ -241,6 +327,52 @@ QT_BEGIN_NAMESPACE
     Returns the QAudioFormat being used
 */
 
+/*!
+    Starts the audio input and calls \a callback with every block of captured
+    audio data.
+
+    Backends that can call the callback on their own audio thread reimplement this.
+    The default implementation wraps the callback into a QIODevice and passes it to
+    start(QIODevice *), so the callback is called on the thread of the source.
+*/
+void QPlatformAudioSource::startCapturing(QAudioSource::CaptureCallback &&callback)
+{
+    QIODevice *previous = m_callbackDevice;
+    m_callbackDevice = new QAudioCallbackDevice(std::move(callback), format(), this);
+    m_callbackDevice->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    // start() closes the previous stream before the old device goes away
+    start(m_callbackDevice);
+    delete previous;
+}
+
+/*!
+    \fn int QPlatformAudioSource::xrunCount() const
+    Returns the number of overruns of the device since start(), or 0 if the
+    backend does not detect them.
+*/
+
+/*!
+    \fn qint64 QPlatformAudioSource::latencyUSecs() const
+    Returns the time in microseconds from audio reaching the device until it
+    is delivered, or -1 if the backend cannot tell.
+*/
+
+/*!
+    Returns which frame of the stream was captured at which time on elapsedTime.
+
+    The default implementation assumes that the last frame processed was
+    captured latencyUSecs() ago, and returns an invalid timestamp if the latency
+    is not known. Backends that get timestamps from the device reimplement this.
+*/
+QAudioTimestamp QPlatformAudioSource::timestamp() const
+{
+    const qint64 latency = latencyUSecs();
+    if (latency < 0 || !elapsedTime.isValid())
+        return {};
+    const qint64 frames = processedUSecs() * format().sampleRate() / 1000000;
+    return { frames, elapsedTime.nsecsElapsed() / 1000 - latency };
+}
+
 /*!
     \fn QPlatformAudioSource::errorChanged(QAudio::Error error)
     This signal is emitted when the \a error state has changed.
@@ -56,6 +56,8 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qaudiosource.h>
 
 #include <QtCore/qelapsedtimer.h>
 
@@ -63,6 +65,19 @@ QT_BEGIN_NAMESPACE
 
 class QIODevice;
 
+// Frame number \c frame of the stream, counted from start(), reaches the
+// speaker (or left the microphone) \c usecs microseconds after elapsedTime
+// was started.
+struct QAudioTimestamp
+{
+    qint64 frame = -1;
+    qint64 usecs = 0;
+
+    bool isValid() const { return frame >= 0; }
+    qint64 usecsForFrame(qint64 f, int sampleRate) const
+    { return usecs + (f - frame) * 1000000 / sampleRate; }
+};
+
 class Q_MULTIMEDIA_EXPORT QAudioStateChangeNotifier : public QObject
 {
     Q_OBJECT
@@ -96,8 +111,15 @@ public:
     virtual QAudioFormat format() const = 0;
     virtual void setVolume(qreal) {}
     virtual qreal volume() const;
+    virtual void startRendering(QAudioSink::RenderCallback &&callback);
+    virtual int xrunCount() const { return 0; }
+    virtual qint64 latencyUSecs() const { return -1; }
+    virtual QAudioTimestamp timestamp() const;
 
     QElapsedTimer elapsedTime;
+
+private:
+    QIODevice *m_callbackDevice = nullptr;
 };
 
 class Q_MULTIMEDIA_EXPORT QPlatformAudioSource : public QAudioStateChangeNotifier
@@ -121,9 +143,15 @@ public:
     virtual QAudioFormat format() const = 0;
     virtual void setVolume(qreal) = 0;
     virtual qreal volume() const = 0;
+    virtual void startCapturing(QAudioSource::CaptureCallback &&callback);
+    virtual int xrunCount() const { return 0; }
+    virtual qint64 latencyUSecs() const { return -1; }
+    virtual QAudioTimestamp timestamp() const;
 
     QElapsedTimer elapsedTime;
 
+private:
+    QIODevice *m_callbackDevice = nullptr;
 
 };
 
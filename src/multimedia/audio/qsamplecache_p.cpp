@@ -45,6 +45,8 @@
 #include <QtNetwork/QNetworkRequest>
 
 #include <QtCore/QDebug>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qloggingcategory.h>
 
 Q_LOGGING_CATEGORY(qLcSampleCache, "qt.multimedia.samplecache")
@@ -97,6 +99,14 @@ QT_BEGIN_NAMESPACE
            m_sample = 0;
        }
     \endcode
+
+    With a positive capacity, released samples stay in the cache and are evicted
+    least recently used first once the usage exceeds the capacity.
+
+    Samples are loaded by a small pool of threads, see setLoaderThreadCount().
+    Local PCM WAV files whose sample data can be used as-is are memory mapped
+    instead of being copied; QSample::data() must then only be accessed while
+    the sample is referenced.
 */
 
 QSampleCache::QSampleCache(QObject *parent)
@@ -104,9 +114,9 @@ QSampleCache::QSampleCache(QObject *parent)
     , m_networkAccessManager(nullptr)
     , m_capacity(0)
     , m_usage(0)
+    , m_loaderThreadCount(qBound(1, QThread::idealThreadCount(), 4))
     , m_loadingRefCount(0)
 {
-    m_loadingThread.setObjectName(QLatin1String("QSampleCache::LoadingThread"));
 }
 
 QNetworkAccessManager& QSampleCache::networkAccessManager()
@@ -120,10 +130,12 @@ QSampleCache::~QSampleCache()
 {
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
-    m_loadingThread.quit();
-    m_loadingThread.wait();
+    for (QThread *thread : qAsConst(m_loadingThreads))
+        thread->quit();
+    for (QThread *thread : qAsConst(m_loadingThreads))
+        thread->wait();
 
-    // Killing the loading thread means that no samples can be
+    // Killing the loading threads means that no samples can be
     // deleted using deleteLater.  And some samples that had deleteLater
     // already called won't have been processed (m_staleSamples)
     for (auto it = m_samples.cbegin(), end = m_samples.cend(); it != end; ++it)
@@ -134,6 +146,36 @@ QSampleCache::~QSampleCache()
         delete sample;
 
     delete m_networkAccessManager;
+    qDeleteAll(m_loadingThreads);
+}
+
+// Called in application thread, returns a running thread for loading \a url
+QThread *QSampleCache::loadingThread(const QUrl &url)
+{
+    QMutexLocker locker(&m_loadingMutex);
+    // The network access manager lives in the first thread
+    const int index = url.isLocalFile() ? m_nextLoadingThread++ % m_loaderThreadCount : 0;
+    while (m_loadingThreads.size() <= index) {
+        QThread *thread = new QThread;
+        thread->setObjectName(QLatin1String("QSampleCache::LoadingThread"));
+        m_loadingThreads.append(thread);
+    }
+    QThread *thread = m_loadingThreads.at(index);
+    if (!thread->isRunning())
+        thread->start();
+    return thread;
+}
+
+// Called in application thread
+void QSampleCache::waitForLoadingThreads()
+{
+    m_loadingMutex.lock();
+    const QList<QThread *> threads = m_loadingThreads;
+    m_loadingMutex.unlock();
+    for (QThread *thread : threads) {
+        if (thread->isRunning())
+            thread->wait();
+    }
 }
 
 void QSampleCache::loadingRelease()
@@ -141,19 +183,43 @@ void QSampleCache::loadingRelease()
     QMutexLocker locker(&m_loadingMutex);
     m_loadingRefCount--;
     if (m_loadingRefCount == 0) {
-        if (m_loadingThread.isRunning()) {
-            if (m_networkAccessManager) {
-                m_networkAccessManager->deleteLater();
-                m_networkAccessManager = nullptr;
-            }
-            m_loadingThread.exit();
+        if (m_networkAccessManager) {
+            m_networkAccessManager->deleteLater();
+            m_networkAccessManager = nullptr;
+        }
+        for (QThread *thread : qAsConst(m_loadingThreads)) {
+            if (thread->isRunning())
+                thread->exit();
         }
     }
 }
 
 bool QSampleCache::isLoading() const
 {
-    return m_loadingThread.isRunning();
+    QMutexLocker locker(&m_loadingMutex);
+    for (const QThread *thread : m_loadingThreads) {
+        if (thread->isRunning())
+            return true;
+    }
+    return false;
+}
+
+/*!
+    Sets the maximum number of threads used to load samples to \a count.
+
+    Samples from local files are distributed over the threads, samples
+    fetched through the network are always loaded by the first one.
+*/
+void QSampleCache::setLoaderThreadCount(int count)
+{
+    QMutexLocker locker(&m_loadingMutex);
+    m_loaderThreadCount = qMax(1, count);
+}
+
+int QSampleCache::loaderThreadCount() const
+{
+    QMutexLocker locker(&m_loadingMutex);
+    return m_loaderThreadCount;
 }
 
 bool QSampleCache::isCached(const QUrl &url) const
@@ -171,16 +237,17 @@ QSample* QSampleCache::requestSample(const QUrl& url)
 
     qCDebug(qLcSampleCache) << "QSampleCache: request sample [" << url << "]";
     std::unique_lock<QRecursiveMutex> locker(m_mutex);
-    QMap<QUrl, QSample*>::iterator it = m_samples.find(url);
+    QHash<QUrl, QSample*>::iterator it = m_samples.find(url);
     QSample* sample;
     if (it == m_samples.end()) {
-        if (!m_loadingThread.isRunning())
-            m_loadingThread.start();
+        QThread *thread = loadingThread(url);
         sample = new QSample(url, this);
         m_samples.insert(url, sample);
-        sample->moveToThread(&m_loadingThread);
+        sample->moveToThread(thread);
     } else {
         sample = *it;
+        if (sample->m_ref == 0)
+            lruRemove(sample);
     }
 
     sample->addRef();
@@ -197,14 +264,9 @@ void QSampleCache::setCapacity(qint64 capacity)
         return;
     qCDebug(qLcSampleCache) << "QSampleCache: capacity changes from " << m_capacity << "to " << capacity;
     if (m_capacity > 0 && capacity <= 0) { //memory management strategy changed
-        for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
-            QSample* sample = *it;
-            if (sample->m_ref == 0) {
-                unloadSample(sample);
-                it = m_samples.erase(it);
-            } else {
-                ++it;
-            }
+        while (QSample *sample = m_lruFirst) {
+            m_samples.remove(sample->m_url);
+            unloadSample(sample);
         }
     }
 
@@ -212,9 +274,45 @@ void QSampleCache::setCapacity(qint64 capacity)
     refresh(0);
 }
 
+qint64 QSampleCache::usage() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    return m_usage;
+}
+
+// Called locked
+void QSampleCache::lruAppend(QSample *sample)
+{
+    sample->m_lruPrevious = m_lruLast;
+    sample->m_lruNext = nullptr;
+    if (m_lruLast)
+        m_lruLast->m_lruNext = sample;
+    else
+        m_lruFirst = sample;
+    m_lruLast = sample;
+}
+
+// Called locked
+void QSampleCache::lruRemove(QSample *sample)
+{
+    if (sample != m_lruFirst && !sample->m_lruPrevious)
+        return; // not in the list
+    if (sample->m_lruPrevious)
+        sample->m_lruPrevious->m_lruNext = sample->m_lruNext;
+    else
+        m_lruFirst = sample->m_lruNext;
+    if (sample->m_lruNext)
+        sample->m_lruNext->m_lruPrevious = sample->m_lruPrevious;
+    else
+        m_lruLast = sample->m_lruPrevious;
+    sample->m_lruPrevious = nullptr;
+    sample->m_lruNext = nullptr;
+}
+
 // Called locked
 void QSampleCache::unloadSample(QSample *sample)
 {
+    lruRemove(sample);
     m_usage -= sample->m_soundData.size();
     m_staleSamples.insert(sample);
     sample->deleteLater();
@@ -230,16 +328,11 @@ void QSampleCache::refresh(qint64 usageChange)
 
     qint64 recoveredSize = 0;
 
-    //free unused samples to keep usage under capacity limit.
-    for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
-        QSample* sample = *it;
-        if (sample->m_ref > 0) {
-            ++it;
-            continue;
-        }
+    //free the least recently used samples to keep usage under capacity limit.
+    while (QSample *sample = m_lruFirst) {
         recoveredSize += sample->m_soundData.size();
+        m_samples.remove(sample->m_url);
         unloadSample(sample);
-        it = m_samples.erase(it);
         if (m_usage <= m_capacity)
             return;
     }
@@ -276,6 +369,9 @@ void QSample::loadIfNecessary()
 {
     QMutexLocker locker(&m_mutex);
     if (m_state == QSample::Error || m_state == QSample::Creating) {
+        // A failed sample may be loaded again after its thread has finished
+        if (!thread()->isRunning())
+            thread()->start();
         m_state = QSample::Loading;
         QMetaObject::invokeMethod(this, "load", Qt::QueuedConnection);
     } else {
@@ -286,13 +382,15 @@ void QSample::loadIfNecessary()
 // Called in application thread
 bool QSampleCache::notifyUnreferencedSample(QSample* sample)
 {
-    if (m_loadingThread.isRunning())
-        m_loadingThread.wait();
+    waitForLoadingThreads();
 
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
-    if (m_capacity > 0)
+    if (m_capacity > 0) {
+        // Evicted by the next refresh() once the cache runs out of capacity
+        lruAppend(sample);
         return false;
+    }
     m_samples.remove(sample->m_url);
     unloadSample(sample);
     return true;
@@ -358,6 +456,11 @@ void QSample::decoderReady()
     qCDebug(qLcSampleCache) << "QSample: decoder ready";
     m_parent->refresh(m_waveDecoder->size());
 
+    if (mapSampleData()) {
+        onReady();
+        return;
+    }
+
     m_soundData.resize(m_waveDecoder->size());
     m_sampleReadLength = 0;
     qint64 read = m_waveDecoder->read(m_soundData.data(), m_waveDecoder->size());
@@ -368,6 +471,41 @@ void QSample::decoderReady()
         onReady();
 }
 
+// Called in loading thread, locked.
+// Uses the data chunk of a local little endian WAV file in place when it
+// holds exactly the samples the decoder would return.
+bool QSample::mapSampleData()
+{
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+        return false;
+    QFile *file = qobject_cast<QFile *>(m_stream);
+    if (!file)
+        return false;
+
+    // The decoder stops reading at the start of the data chunk
+    const qint64 offset = file->pos();
+    const qint64 size = m_waveDecoder->size();
+    if (offset < 12 || size <= 0 || offset + size > file->size())
+        return false;
+
+    uchar *map = file->map(0, offset + size);
+    if (!map)
+        return false;
+    if (memcmp(map, "RIFF", 4) != 0 || qFromLittleEndian<quint32>(map + offset - 4) != size) {
+        file->unmap(map);
+        return false;
+    }
+
+    m_soundData = QByteArray::fromRawData(reinterpret_cast<const char *>(map + offset), size);
+    m_sampleReadLength = size;
+    // Keep the mapping alive for the lifetime of the sample
+    file->disconnect(this);
+    m_mappedFile = file;
+    m_stream = nullptr;
+    qCDebug(qLcSampleCache) << "QSample: mapped" << size << "bytes of" << file->fileName();
+    return true;
+}
+
 // Called in all threads
 QSample::State QSample::state() const
 {
@@ -381,14 +519,36 @@ void QSample::load()
 {
     Q_ASSERT(QThread::currentThread()->objectName() == QLatin1String("QSampleCache::LoadingThread"));
     qCDebug(qLcSampleCache) << "QSample: load [" << m_url << "]";
-    m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
-    connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+    if (m_url.isLocalFile()) {
+        // Local files don't need the network access manager, which also
+        // allows them to be loaded by any of the loading threads
+        QFile *file = new QFile(m_url.toLocalFile(), this);
+        if (!file->open(QIODevice::ReadOnly)) {
+            delete file;
+            decoderError();
+            return;
+        }
+        m_stream = file;
+    } else {
+        m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
+        connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+    }
     m_waveDecoder = new QWaveDecoder(m_stream);
     connect(m_waveDecoder, SIGNAL(formatKnown()), SLOT(decoderReady()));
     connect(m_waveDecoder, SIGNAL(parsingError()), SLOT(decoderError()));
     connect(m_waveDecoder, SIGNAL(readyRead()), SLOT(readSample()));
 
     m_waveDecoder->open(QIODevice::ReadOnly);
+
+    if (m_url.isLocalFile()) {
+        // A file never emits readyRead(), and the decoder waits for it when
+        // the RIFF header claims more data than there is. Let it parse what
+        // the file holds; if that is not enough, no more data will come.
+        if (state() == QSample::Loading)
+            QMetaObject::invokeMethod(m_waveDecoder, "handleData", Qt::DirectConnection);
+        if (state() == QSample::Loading)
+            decoderError();
+    }
 }
 
 void QSample::loadingError(QNetworkReply::NetworkError errorCode)
@@ -431,6 +591,7 @@ QSample::QSample(const QUrl& url, QSampleCache *parent)
     : m_parent(parent)
     , m_stream(nullptr)
     , m_waveDecoder(nullptr)
+    , m_mappedFile(nullptr)
     , m_url(url)
     , m_sampleReadLength(0)
     , m_state(Creating)
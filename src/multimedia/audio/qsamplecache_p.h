@@ -55,13 +55,15 @@
 #include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
 #include <QtCore/qmutex.h>
-#include <QtCore/qmap.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qset.h>
 #include <qaudioformat.h>
 #include <qnetworkreply.h>
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
 class QIODevice;
 class QNetworkAccessManager;
 class QSampleCache;
@@ -107,6 +109,7 @@ private:
     void cleanup();
     void addRef();
     void loadIfNecessary();
+    bool mapSampleData();
     QSample();
     ~QSample();
 
@@ -116,10 +119,16 @@ private:
     QAudioFormat m_audioFormat;
     QIODevice    *m_stream;
     QWaveDecoder *m_waveDecoder;
+    QFile        *m_mappedFile;
     QUrl         m_url;
     qint64       m_sampleReadLength;
     State        m_state;
     int          m_ref;
+
+    // Unreferenced samples kept in the cache, least recently used first.
+    // Guarded by the mutex of the cache.
+    QSample      *m_lruPrevious = nullptr;
+    QSample      *m_lruNext = nullptr;
 };
 
 class Q_MULTIMEDIA_EXPORT QSampleCache : public QObject
@@ -133,28 +142,42 @@ public:
 
     QSample* requestSample(const QUrl& url);
     void setCapacity(qint64 capacity);
+    qint64 usage() const;
+
+    void setLoaderThreadCount(int count);
+    int loaderThreadCount() const;
 
     bool isLoading() const;
     bool isCached(const QUrl& url) const;
 
 private:
-    QMap<QUrl, QSample*> m_samples;
+    QHash<QUrl, QSample*> m_samples;
     QSet<QSample*> m_staleSamples;
+    QSample *m_lruFirst = nullptr;
+    QSample *m_lruLast = nullptr;
     QNetworkAccessManager *m_networkAccessManager;
     mutable QRecursiveMutex m_mutex;
     qint64 m_capacity;
     qint64 m_usage;
-    QThread m_loadingThread;
 
     QNetworkAccessManager& networkAccessManager();
     void refresh(qint64 usageChange);
     bool notifyUnreferencedSample(QSample* sample);
     void removeUnreferencedSample(QSample* sample);
     void unloadSample(QSample* sample);
+    void lruAppend(QSample *sample);
+    void lruRemove(QSample *sample);
 
+    QThread *loadingThread(const QUrl &url);
+    void waitForLoadingThreads();
     void loadingRelease();
+    // Local files are spread over all loading threads, everything going through
+    // the network access manager is loaded by the first one.
+    QList<QThread *> m_loadingThreads;
+    int m_loaderThreadCount;
+    int m_nextLoadingThread = 0;
     int m_loadingRefCount;
-    QMutex m_loadingMutex;
+    mutable QMutex m_loadingMutex;
 };
 
 QT_END_NAMESPACE
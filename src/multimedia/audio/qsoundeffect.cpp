@@ -40,8 +40,8 @@
 #include <QtMultimedia/private/qtmultimediaglobal_p.h>
 #include "qsoundeffect.h"
 #include "qsamplecache_p.h"
+#include "qsoundeffectmixer_p.h"
 #include "qaudiodevice.h"
-#include "qaudiosink.h"
 #include "qmediadevices.h"
 #include <QtCore/qloggingcategory.h>
 
@@ -51,32 +51,12 @@ QT_BEGIN_NAMESPACE
 
 Q_GLOBAL_STATIC(QSampleCache, sampleCache)
 
-class QSoundEffectPrivate : public QIODevice
+class QSoundEffectPrivate : public QObject
 {
 public:
     QSoundEffectPrivate(QSoundEffect *q, const QAudioDevice &audioDevice = QAudioDevice());
     ~QSoundEffectPrivate() override = default;
 
-    qint64 readData(char *data, qint64 len) override;
-    qint64 writeData(const char *data, qint64 len) override;
-    qint64 size() const override {
-        if (m_sample->state() != QSample::Ready)
-            return 0;
-        return m_loopCount == QSoundEffect::Infinite ? 0 : m_loopCount * m_sample->data().size();
-    }
-    qint64 bytesAvailable() const override {
-        if (m_sample->state() != QSample::Ready)
-            return 0;
-        return m_loopCount == QSoundEffect::Infinite
-                   ? std::numeric_limits<qint64>::max() : m_runningCount * m_sample->data().size() - m_offset;
-    }
-    bool isSequential() const override {
-        return m_loopCount == QSoundEffect::Infinite;
-    }
-    bool atEnd() const override {
-        return m_runningCount == 0;
-    }
-
     void setLoopsRemaining(int loopsRemaining);
     void setStatus(QSoundEffect::Status status);
     void setPlaying(bool playing);
@@ -84,7 +64,8 @@ public:
 public Q_SLOTS:
     void sampleReady();
     void decoderError();
-    void stateChanged(QAudio::State);
+    void voiceLoopsRemainingChanged();
+    void voiceFinished();
 
 public:
     QSoundEffect *q_ptr;
@@ -93,21 +74,19 @@ public:
     int m_runningCount = 0;
     bool m_playing = false;
     QSoundEffect::Status  m_status = QSoundEffect::Null;
-    QAudioSink *m_audioOutput = nullptr;
+    QSoundEffectVoice *m_voice = nullptr;
     QSample *m_sample = nullptr;
     bool m_muted = false;
     float m_volume = 1.0;
     bool m_sampleReady = false;
-    qint64 m_offset = 0;
     QAudioDevice m_audioDevice;
 };
 
 QSoundEffectPrivate::QSoundEffectPrivate(QSoundEffect *q, const QAudioDevice &audioDevice)
-    : QIODevice(q)
+    : QObject(q)
     , q_ptr(q)
     , m_audioDevice(audioDevice)
 {
-    open(QIODevice::ReadOnly);
 }
 
 void QSoundEffectPrivate::sampleReady()
@@ -118,20 +97,21 @@ void QSoundEffectPrivate::sampleReady()
     qCDebug(qLcSoundEffect) << this << "sampleReady: sample size:" << m_sample->data().size();
     disconnect(m_sample, &QSample::error, this, &QSoundEffectPrivate::decoderError);
     disconnect(m_sample, &QSample::ready, this, &QSoundEffectPrivate::sampleReady);
-    if (!m_audioOutput) {
-        m_audioOutput = new QAudioSink(m_audioDevice, m_sample->format());
-        connect(m_audioOutput, &QAudioSink::stateChanged, this, &QSoundEffectPrivate::stateChanged);
-        if (!m_muted)
-            m_audioOutput->setVolume(m_volume);
-        else
-            m_audioOutput->setVolume(0);
+    if (!m_voice) {
+        m_voice = new QSoundEffectVoice(this);
+        connect(m_voice, &QSoundEffectVoice::loopsRemainingChanged,
+                this, &QSoundEffectPrivate::voiceLoopsRemainingChanged);
+        connect(m_voice, &QSoundEffectVoice::finished, this, &QSoundEffectPrivate::voiceFinished);
+        m_voice->setVolume(m_volume);
+        m_voice->setMuted(m_muted);
     }
+    m_voice->setSample(m_audioDevice, m_sample->format(), m_sample->data());
     m_sampleReady = true;
     setStatus(QSoundEffect::Ready);
 
-    if (m_playing && m_audioOutput->state() == QAudio::StoppedState) {
-        qCDebug(qLcSoundEffect) << this << "starting playback on audiooutput";
-        m_audioOutput->start(this);
+    if (m_playing && !m_voice->isPlaying()) {
+        qCDebug(qLcSoundEffect) << this << "starting playback on the mixer";
+        m_voice->play(m_runningCount);
     }
 }
 
@@ -144,50 +124,15 @@ void QSoundEffectPrivate::decoderError()
     setStatus(QSoundEffect::Error);
 }
 
-void QSoundEffectPrivate::stateChanged(QAudio::State state)
+void QSoundEffectPrivate::voiceLoopsRemainingChanged()
 {
-    qCDebug(qLcSoundEffect) << this << "stateChanged " << state;
-    if ((state == QAudio::IdleState && m_runningCount == 0) || state == QAudio::StoppedState)
-        emit q_ptr->stop();
+    setLoopsRemaining(m_voice->loopsRemaining());
 }
 
-qint64 QSoundEffectPrivate::readData(char *data, qint64 len)
+void QSoundEffectPrivate::voiceFinished()
 {
-    qCDebug(qLcSoundEffect) << this << "readData" << len << m_runningCount;
-    if (!len)
-        return 0;
-    if (m_sample->state() != QSample::Ready)
-        return 0;
-    if (m_runningCount == 0 || !m_playing)
-        return 0;
-
-    qint64 bytesWritten = 0;
-
-    const int   sampleSize = m_sample->data().size();
-    const char* sampleData = m_sample->data().constData();
-
-    while (len && m_runningCount) {
-        int toWrite = qMin(sampleSize - m_offset, len);
-        memcpy(data, sampleData + m_offset, toWrite);
-        bytesWritten += toWrite;
-        data += toWrite;
-        len -= toWrite;
-        m_offset += toWrite;
-        if (m_offset >= sampleSize) {
-            if (m_runningCount > 0 && m_runningCount != QSoundEffect::Infinite)
-                setLoopsRemaining(m_runningCount - 1);
-            m_offset = 0;
-        }
-    }
-
-    return bytesWritten;
-}
-
-qint64 QSoundEffectPrivate::writeData(const char *data, qint64 len)
-{
-    Q_UNUSED(data);
-    Q_UNUSED(len);
-    return 0;
+    qCDebug(qLcSoundEffect) << this << "voiceFinished";
+    q_ptr->stop();
 }
 
 void QSoundEffectPrivate::setLoopsRemaining(int loopsRemaining)
@@ -214,19 +159,17 @@ void QSoundEffectPrivate::setStatus(QSoundEffect::Status status)
 void QSoundEffectPrivate::setPlaying(bool playing)
 {
     qCDebug(qLcSoundEffect) << this << "setPlaying(" << playing << ")" << m_playing;
-    if (m_audioOutput) {
-        m_audioOutput->stop();
-        if (playing && !m_sampleReady)
-            return;
+    if (m_voice && m_sampleReady) {
+        if (playing)
+            m_voice->play(m_runningCount);
+        else
+            m_voice->stop();
     }
 
     if (m_playing == playing)
         return;
     m_playing = playing;
 
-    if (m_audioOutput && playing)
-        m_audioOutput->start(this);
-
     emit q_ptr->playingChanged();
 }
 
@@ -256,9 +199,9 @@ void QSoundEffectPrivate::setPlaying(bool playing)
 
     \snippet multimedia-snippets/qsound.cpp 3
 
-    Since QSoundEffect requires slightly more resources to achieve lower
-    latency playback, the platform may limit the number of simultaneously playing
-    sound effects.
+    All sound effects that play on the same audio device with the same audio
+    format are mixed into a single audio stream, so playing many of them at
+    once is cheap.
 */
 
 
@@ -288,9 +231,9 @@ void QSoundEffectPrivate::setPlaying(bool playing)
 
     \snippet multimedia-snippets/soundeffect.qml complete snippet
 
-    Since SoundEffect requires slightly more resources to achieve lower
-    latency playback, the platform may limit the number of simultaneously playing
-    sound effects.
+    All sound effects that play on the same audio device with the same audio
+    format are mixed into a single audio stream, so playing many of them at
+    once is cheap.
 */
 
 /*!
@@ -316,11 +259,8 @@ QSoundEffect::QSoundEffect(const QAudioDevice &audioDevice, QObject *parent)
 QSoundEffect::~QSoundEffect()
 {
     stop();
-    if (d->m_audioOutput) {
-        d->m_audioOutput->stop();
-        d->m_audioOutput->deleteLater();
+    if (d->m_voice)
         d->m_sample->release();
-    }
     delete d;
 }
 
@@ -398,11 +338,11 @@ void QSoundEffect::setSource(const QUrl &url)
         d->m_sample = nullptr;
     }
 
-    if (d->m_audioOutput) {
-        QObject::disconnect(d->m_audioOutput, &QAudioSink::stateChanged, d, &QSoundEffectPrivate::stateChanged);
-        d->m_audioOutput->stop();
-        d->m_audioOutput->deleteLater();
-        d->m_audioOutput = nullptr;
+    if (d->m_voice) {
+        QObject::disconnect(d->m_voice, nullptr, d, nullptr);
+        d->m_voice->stop();
+        d->m_voice->deleteLater();
+        d->m_voice = nullptr;
     }
 
     d->setStatus(QSoundEffect::Loading);
@@ -481,8 +421,11 @@ void QSoundEffect::setLoopCount(int loopCount)
         return;
 
     d->m_loopCount = loopCount;
-    if (d->m_playing)
+    if (d->m_playing) {
+        if (d->m_voice)
+            d->m_voice->setLoopsRemaining(loopCount);
         d->setLoopsRemaining(loopCount);
+    }
     emit loopCountChanged();
 }
 
@@ -495,8 +438,9 @@ void QSoundEffect::setAudioDevice(const QAudioDevice &device)
 {
     if (d->m_audioDevice == device)
         return;
-    // ### recreate the QAudioSink if needed
     d->m_audioDevice = device;
+    if (d->m_voice && d->m_sampleReady)
+        d->m_voice->setSample(device, d->m_sample->format(), d->m_sample->data());
     emit audioDeviceChanged();
 }
 
@@ -544,9 +488,6 @@ int QSoundEffect::loopsRemaining() const
  */
 float QSoundEffect::volume() const
 {
-    if (d->m_audioOutput && !d->m_muted)
-        return d->m_audioOutput->volume();
-
     return d->m_volume;
 }
 
@@ -570,8 +511,8 @@ void QSoundEffect::setVolume(float volume)
 
     d->m_volume = volume;
 
-    if (d->m_audioOutput && !d->m_muted)
-        d->m_audioOutput->setVolume(volume);
+    if (d->m_voice)
+        d->m_voice->setVolume(volume);
 
     emit volumeChanged();
 }
@@ -606,10 +547,8 @@ void QSoundEffect::setMuted(bool muted)
     if (d->m_muted == muted)
         return;
 
-    if (muted && d->m_audioOutput)
-        d->m_audioOutput->setVolume(0);
-    else if (!muted && d->m_audioOutput && d->m_muted)
-        d->m_audioOutput->setVolume(d->m_volume);
+    if (d->m_voice)
+        d->m_voice->setMuted(muted);
 
     d->m_muted = muted;
     emit mutedChanged();
@@ -648,7 +587,6 @@ bool QSoundEffect::isLoaded() const
 */
 void QSoundEffect::play()
 {
-    d->m_offset = 0;
     d->setLoopsRemaining(d->m_loopCount);
     qCDebug(qLcSoundEffect) << this << "play" << d->m_loopCount << d->m_runningCount;
     if (d->m_status == QSoundEffect::Null || d->m_status == QSoundEffect::Error) {
@@ -732,7 +670,6 @@ void QSoundEffect::stop()
     if (!d->m_playing)
         return;
     qCDebug(qLcSoundEffect) << "stop()";
-    d->m_offset = 0;
 
     d->setPlaying(false);
 }
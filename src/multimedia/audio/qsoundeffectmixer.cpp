@@ -0,0 +1,373 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsoundeffectmixer_p.h"
+#include "qaudioconverter_p.h"
+#include "qaudiosink.h"
+#include "qmediadevices.h"
+#include "qsoundeffect.h"
+
+#include <QtCore/qpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// The mix loops are kept trivial, so that the compiler can vectorize them
+
+template<typename T>
+void accumulate(float *mix, const T *samples, qsizetype count, float gain, float bias)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        mix[i] += (float(samples[i]) - bias) * gain;
+}
+
+void accumulateSamples(QAudioFormat::SampleFormat format, float *mix, const char *samples,
+                       qsizetype count, float volume)
+{
+    switch (format) {
+    case QAudioFormat::UInt8:
+        accumulate(mix, reinterpret_cast<const quint8 *>(samples), count, volume / 128.f, 128.f);
+        break;
+    case QAudioFormat::Int16:
+        accumulate(mix, reinterpret_cast<const qint16 *>(samples), count, volume / 32768.f, 0.f);
+        break;
+    case QAudioFormat::Int32:
+        accumulate(mix, reinterpret_cast<const qint32 *>(samples), count, volume / 2147483648.f, 0.f);
+        break;
+    case QAudioFormat::Float:
+        accumulate(mix, reinterpret_cast<const float *>(samples), count, volume, 0.f);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename T>
+void store(T *samples, const float *mix, qsizetype count, float scale, float bias, float min, float max)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        samples[i] = T(qBound(min, mix[i] * scale + bias, max));
+}
+
+// Converts the mix back to the output format, saturating samples that overflow
+void storeSamples(QAudioFormat::SampleFormat format, char *samples, const float *mix, qsizetype count)
+{
+    switch (format) {
+    case QAudioFormat::UInt8:
+        store(reinterpret_cast<quint8 *>(samples), mix, count, 128.f, 128.f, 0.f, 255.f);
+        break;
+    case QAudioFormat::Int16:
+        store(reinterpret_cast<qint16 *>(samples), mix, count, 32768.f, 0.f, -32768.f, 32767.f);
+        break;
+    case QAudioFormat::Int32:
+        // 2147483520 is the largest float below 2^31
+        store(reinterpret_cast<qint32 *>(samples), mix, count, 2147483648.f, 0.f,
+              -2147483648.f, 2147483520.f);
+        break;
+    case QAudioFormat::Float:
+        store(reinterpret_cast<float *>(samples), mix, count, 1.f, 0.f, -1.f, 1.f);
+        break;
+    default:
+        break;
+    }
+}
+
+// Mixers are shared by the voices of one thread only, so that mixing needs no locking
+QList<QWeakPointer<QSoundEffectMixer>> &threadMixers()
+{
+    static thread_local QList<QWeakPointer<QSoundEffectMixer>> mixers;
+    return mixers;
+}
+
+}
+
+/*!
+    \class QSoundEffectVoice
+    \internal
+
+    QSoundEffectVoice plays a sample through the QSoundEffectMixer for its device and
+    format, with its own volume, mute state and loop count.
+*/
+QSoundEffectVoice::QSoundEffectVoice(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QSoundEffectVoice::~QSoundEffectVoice()
+{
+    if (m_playing && m_mixer)
+        m_mixer->removeVoice(this);
+}
+
+/*!
+    Sets the sample \a data to play, in \a format, on \a device.
+
+    The sample is converted to the preferred format of \a device, or of the default
+    output if \a device is null, so that all sound effects on a device share one mixer
+    and the device is opened at its native format.
+    This moves the voice to the mixer for \a device and that format, creating the mixer
+    if needed. A playing voice keeps playing.
+*/
+void QSoundEffectVoice::setSample(const QAudioDevice &device, const QAudioFormat &sampleFormat,
+                                  const QByteArray &sampleData)
+{
+    // A null device plays on the default output, so convert to the format of that one
+    const QAudioDevice output = device.isNull() ? QMediaDevices::defaultAudioOutput() : device;
+    QAudioFormat format = sampleFormat;
+    QByteArray data = sampleData;
+    const QAudioFormat deviceFormat = output.isNull() ? QAudioFormat() : output.preferredFormat();
+    if (deviceFormat.isValid() && deviceFormat != format) {
+        data = QAudioConverter::convert(sampleData, sampleFormat, deviceFormat);
+        format = deviceFormat;
+    }
+
+    QSharedPointer<QSoundEffectMixer> mixer = QSoundEffectMixer::instance(output, format);
+    if (mixer != m_mixer) {
+        if (m_playing && m_mixer)
+            m_mixer->removeVoice(this);
+        m_mixer = mixer;
+        if (m_playing)
+            m_mixer->addVoice(this);
+    }
+
+    m_data = data;
+    m_frames = format.bytesPerFrame() > 0 ? data.size() / format.bytesPerFrame() : 0;
+    if (m_offset >= m_frames)
+        m_offset = 0;
+    if (m_frames == 0)
+        stop();
+}
+
+/*!
+    Starts playing the sample from the beginning, \a loops times or forever if \a loops
+    is QSoundEffect::Infinite.
+*/
+void QSoundEffectVoice::play(int loops)
+{
+    if (!m_mixer || m_frames == 0 || loops == 0)
+        return;
+
+    m_offset = 0;
+    m_loopsRemaining = loops;
+    m_loopsChanged = false;
+    if (!m_playing) {
+        m_playing = true;
+        m_mixer->addVoice(this);
+    }
+}
+
+/*!
+    Stops playing. This doesn't emit finished().
+*/
+void QSoundEffectVoice::stop()
+{
+    m_offset = 0;
+    if (!m_playing)
+        return;
+
+    m_playing = false;
+    if (m_mixer)
+        m_mixer->removeVoice(this);
+}
+
+void QSoundEffectVoice::setLoopsRemaining(int loops)
+{
+    m_loopsRemaining = loops;
+}
+
+void QSoundEffectVoice::setVolume(float volume)
+{
+    m_volume = volume;
+}
+
+void QSoundEffectVoice::setMuted(bool muted)
+{
+    m_muted = muted;
+}
+
+// Adds up to frames frames of the sample to buffer and returns how many were added
+qint64 QSoundEffectVoice::mix(float *buffer, qint64 frames)
+{
+    const QAudioFormat format = m_mixer->format();
+    const int channels = format.channelCount();
+    const int bytesPerFrame = format.bytesPerFrame();
+    const float gain = m_muted ? 0.f : m_volume;
+
+    qint64 mixed = 0;
+    while (m_playing && mixed < frames) {
+        const qint64 count = qMin(m_frames - m_offset, frames - mixed);
+        if (gain > 0.f) {
+            accumulateSamples(format.sampleFormat(), buffer + mixed * channels,
+                              m_data.constData() + m_offset * bytesPerFrame, count * channels, gain);
+        }
+        mixed += count;
+        m_offset += count;
+
+        if (m_offset >= m_frames) {
+            m_offset = 0;
+            if (m_loopsRemaining != QSoundEffect::Infinite) {
+                --m_loopsRemaining;
+                m_loopsChanged = true;
+                if (m_loopsRemaining <= 0)
+                    m_playing = false;
+            }
+        }
+    }
+    return mixed;
+}
+
+/*!
+    \class QSoundEffectMixer
+    \internal
+
+    QSoundEffectMixer mixes the playing voices for one audio device and format into a
+    single QAudioSink, so that sound effects don't need a platform stream each. The sink
+    is started with the first voice and kept open while the mixer exists, to avoid the
+    stream setup latency when the next sound effect starts.
+
+    The mixer lives in the thread that created it, and is only shared with the voices
+    of that thread.
+*/
+QSoundEffectMixer::QSoundEffectMixer(const QAudioDevice &device, const QAudioFormat &format)
+    : m_device(device)
+    , m_format(format)
+{
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    m_sink = new QAudioSink(device, format, this);
+}
+
+QSoundEffectMixer::~QSoundEffectMixer()
+{
+    m_sink->stop();
+    delete m_sink;
+}
+
+/*!
+    Returns the mixer of the current thread for \a device and \a format, creating it
+    if needed. The mixer is destroyed when the last reference to it is dropped.
+*/
+QSharedPointer<QSoundEffectMixer> QSoundEffectMixer::instance(const QAudioDevice &device,
+                                                              const QAudioFormat &format)
+{
+    auto &mixers = threadMixers();
+    for (auto it = mixers.begin(); it != mixers.end();) {
+        QSharedPointer<QSoundEffectMixer> mixer = it->toStrongRef();
+        if (!mixer) {
+            it = mixers.erase(it);
+            continue;
+        }
+        if (mixer->device() == device && mixer->format() == format)
+            return mixer;
+        ++it;
+    }
+
+    // deleteLater(), as the last voice might go away from within readData()
+    QSharedPointer<QSoundEffectMixer> mixer(new QSoundEffectMixer(device, format),
+                                            &QObject::deleteLater);
+    mixers.append(mixer);
+    return mixer;
+}
+
+void QSoundEffectMixer::addVoice(QSoundEffectVoice *voice)
+{
+    if (!m_voices.contains(voice))
+        m_voices.append(voice);
+    if (m_sink->state() == QAudio::StoppedState)
+        m_sink->start(this);
+}
+
+void QSoundEffectMixer::removeVoice(QSoundEffectVoice *voice)
+{
+    m_voices.removeOne(voice);
+}
+
+qint64 QSoundEffectMixer::readData(char *data, qint64 len)
+{
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    const qint64 frames = bytesPerFrame > 0 ? len / bytesPerFrame : 0;
+    if (frames == 0 || m_voices.isEmpty())
+        return 0;
+
+    const int channels = m_format.channelCount();
+    m_mixBuffer.resize(frames * channels);
+    m_mixBuffer.fill(0.f);
+
+    qint64 mixed = 0;
+    for (QSoundEffectVoice *voice : qAsConst(m_voices))
+        mixed = qMax(mixed, voice->mix(m_mixBuffer.data(), frames));
+
+    storeSamples(m_format.sampleFormat(), data, m_mixBuffer.constData(), mixed * channels);
+
+    // Notify once the mix is done, the signals may start or stop voices
+    QList<QPointer<QSoundEffectVoice>> loopsChanged;
+    QList<QPointer<QSoundEffectVoice>> finished;
+    for (QSoundEffectVoice *voice : qAsConst(m_voices)) {
+        if (voice->m_loopsChanged) {
+            voice->m_loopsChanged = false;
+            loopsChanged.append(voice);
+        }
+        if (!voice->m_playing)
+            finished.append(voice);
+    }
+    m_voices.removeIf([](QSoundEffectVoice *voice) { return !voice->m_playing; });
+
+    for (const auto &voice : qAsConst(loopsChanged)) {
+        if (voice)
+            emit voice->loopsRemainingChanged();
+    }
+    for (const auto &voice : qAsConst(finished)) {
+        if (voice && !voice->m_playing)
+            emit voice->finished();
+    }
+
+    return mixed * bytesPerFrame;
+}
+
+qint64 QSoundEffectMixer::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return 0;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qsoundeffectmixer_p.cpp"
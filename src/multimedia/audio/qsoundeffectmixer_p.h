@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSOUNDEFFECTMIXER_P_H
+#define QSOUNDEFFECTMIXER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qiodevice.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qsharedpointer.h>
+#include <qaudiodevice.h>
+#include <qaudioformat.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioSink;
+class QSoundEffectMixer;
+
+// A sample played through the QSoundEffectMixer shared by all voices with the
+// same device and format. Lives in the thread of its mixer.
+class Q_MULTIMEDIA_EXPORT QSoundEffectVoice : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QSoundEffectVoice(QObject *parent = nullptr);
+    ~QSoundEffectVoice();
+
+    void setSample(const QAudioDevice &device, const QAudioFormat &sampleFormat,
+                   const QByteArray &sampleData);
+    QSoundEffectMixer *mixer() const { return m_mixer.data(); }
+
+    void play(int loops);
+    void stop();
+    bool isPlaying() const { return m_playing; }
+
+    int loopsRemaining() const { return m_loopsRemaining; }
+    void setLoopsRemaining(int loops);
+
+    float volume() const { return m_volume; }
+    void setVolume(float volume);
+    bool isMuted() const { return m_muted; }
+    void setMuted(bool muted);
+
+Q_SIGNALS:
+    void loopsRemainingChanged();
+    void finished();
+
+private:
+    friend class QSoundEffectMixer;
+    qint64 mix(float *buffer, qint64 frames);
+
+    QSharedPointer<QSoundEffectMixer> m_mixer;
+    QByteArray m_data;
+    qint64 m_frames = 0;
+    qint64 m_offset = 0;
+    int m_loopsRemaining = 0;
+    float m_volume = 1.;
+    bool m_muted = false;
+    bool m_playing = false;
+    bool m_loopsChanged = false;
+};
+
+// Mixes all playing voices into a single QAudioSink
+class Q_MULTIMEDIA_EXPORT QSoundEffectMixer : public QIODevice
+{
+    Q_OBJECT
+public:
+    QSoundEffectMixer(const QAudioDevice &device, const QAudioFormat &format);
+    ~QSoundEffectMixer();
+
+    static QSharedPointer<QSoundEffectMixer> instance(const QAudioDevice &device,
+                                                      const QAudioFormat &format);
+
+    QAudioDevice device() const { return m_device; }
+    QAudioFormat format() const { return m_format; }
+    QAudioSink *sink() const { return m_sink; }
+    qsizetype playingVoices() const { return m_voices.size(); }
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    friend class QSoundEffectVoice;
+    void addVoice(QSoundEffectVoice *voice);
+    void removeVoice(QSoundEffectVoice *voice);
+
+    QAudioDevice m_device;
+    QAudioFormat m_format;
+    QAudioSink *m_sink = nullptr;
+    QList<QSoundEffectVoice *> m_voices;
+    QList<float> m_mixBuffer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOUNDEFFECTMIXER_P_H
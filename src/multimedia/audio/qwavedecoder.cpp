@@ -41,34 +41,94 @@
 
 #include <QtCore/qtimer.h>
 #include <QtCore/qendian.h>
+#include <private/qsimd_p.h>
 #include <limits.h>
 #include <qdebug.h>
 
 QT_BEGIN_NAMESPACE
 
-namespace  {
+namespace QWaveDecoderInternal
+{
+
+enum {
+    WaveFormatPcm = 0x0001,
+    WaveFormatIeeeFloat = 0x0003,
+    WaveFormatExtensible = 0xfffe
+};
+
+typedef void (QT_FASTCALL *Bswap16Func)(quint16 *data, qsizetype count);
+typedef void (QT_FASTCALL *Bswap32Func)(quint32 *data, qsizetype count);
+typedef void (QT_FASTCALL *Expand24Func)(const uchar *src, qint32 *dst, qsizetype count);
+
+static void QT_FASTCALL bswap16(quint16 *data, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
 
-void bswap2(char *data, qsizetype count) noexcept
+static void QT_FASTCALL bswap32(quint32 *data, qsizetype count)
 {
-    for (qsizetype i = 0; i < count; ++i) {
-        qSwap(data[0], data[1]);
-        ++count;
-        data += 2;
+    for (qsizetype i = 0; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
+
+// 24 bit samples become the upper three bytes of a native 32 bit sample
+static void QT_FASTCALL expand24le(const uchar *src, qint32 *dst, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i, src += 3)
+        dst[i] = qint32((quint32(src[2]) << 24) | (quint32(src[1]) << 16) | (quint32(src[0]) << 8));
+}
+
+static void QT_FASTCALL expand24be(const uchar *src, qint32 *dst, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i, src += 3)
+        dst[i] = qint32((quint32(src[0]) << 24) | (quint32(src[1]) << 16) | (quint32(src[2]) << 8));
+}
+
+static Bswap16Func qBswap16 = bswap16;
+static Bswap32Func qBswap32 = bswap32;
+static Expand24Func qExpand24le = expand24le;
+static Expand24Func qExpand24be = expand24be;
+
+static void qInitWaveFuncsAsm()
+{
+#ifdef QT_COMPILER_SUPPORTS_SSSE3
+    extern void QT_FASTCALL qt_wav_bswap16_ssse3(quint16 *data, qsizetype count);
+    extern void QT_FASTCALL qt_wav_bswap32_ssse3(quint32 *data, qsizetype count);
+    extern void QT_FASTCALL qt_wav_expand24le_ssse3(const uchar *src, qint32 *dst, qsizetype count);
+    extern void QT_FASTCALL qt_wav_expand24be_ssse3(const uchar *src, qint32 *dst, qsizetype count);
+    if (qCpuHasFeature(SSSE3)) {
+        qBswap16 = qt_wav_bswap16_ssse3;
+        qBswap32 = qt_wav_bswap32_ssse3;
+        qExpand24le = qt_wav_expand24le_ssse3;
+        qExpand24be = qt_wav_expand24be_ssse3;
     }
+#endif
+#if defined(__ARM_NEON) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    extern void QT_FASTCALL qt_wav_bswap16_neon(quint16 *data, qsizetype count);
+    extern void QT_FASTCALL qt_wav_bswap32_neon(quint32 *data, qsizetype count);
+    extern void QT_FASTCALL qt_wav_expand24le_neon(const uchar *src, qint32 *dst, qsizetype count);
+    extern void QT_FASTCALL qt_wav_expand24be_neon(const uchar *src, qint32 *dst, qsizetype count);
+    qBswap16 = qt_wav_bswap16_neon;
+    qBswap32 = qt_wav_bswap32_neon;
+    qExpand24le = qt_wav_expand24le_neon;
+    qExpand24be = qt_wav_expand24be_neon;
+#endif
 }
 
-void bswap4(char *data, qsizetype count) noexcept
+static void initWaveFuncs()
 {
-    for (qsizetype i = 0; i < count; ++i) {
-        qSwap(data[0], data[3]);
-        qSwap(data[1], data[2]);
-        ++count;
-        data += 4;
+    static bool initDone = false;
+    if (!initDone) {
+        qInitWaveFuncsAsm();
+        initDone = true;
     }
 }
 
 }
 
+using namespace QWaveDecoderInternal;
+
 QWaveDecoder::QWaveDecoder(QIODevice *device, QObject *parent)
     : QIODevice(parent),
       device(device)
@@ -150,8 +210,8 @@ qint64 QWaveDecoder::size() const
     if (openMode() & QIODevice::ReadOnly) {
         if (!haveFormat)
             return 0;
-        if (bps == 24)
-            return dataSize*2/3;
+        if (bps == 24 || bps == 64)
+            return dataSize / (bps / 8) * format.bytesPerSample();
         return dataSize;
     } else {
         return device->size();
@@ -165,7 +225,11 @@ bool QWaveDecoder::isSequential() const
 
 qint64 QWaveDecoder::bytesAvailable() const
 {
-    return haveFormat ? device->bytesAvailable() : 0;
+    if (!haveFormat)
+        return 0;
+    if (bps == 24 || bps == 64)
+        return device->bytesAvailable() / (bps / 8) * format.bytesPerSample();
+    return device->bytesAvailable();
 }
 
 qint64 QWaveDecoder::headerLength()
@@ -178,26 +242,10 @@ qint64 QWaveDecoder::readData(char *data, qint64 maxlen)
     if (!haveFormat || format.bytesPerSample() == 0)
         return 0;
 
-    if (bps == 24) {
-        // 24 bit WAV, read in as 16 bit
-        qint64 l = 0;
-        while (l < maxlen - 1) {
-            char tmp[3];
-            device->read(tmp, 3);
-            if (byteSwap)
-                qSwap(tmp[0], tmp[2]);
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-            data[0] = tmp[0];
-            data[1] = tmp[1];
-#else
-            data[0] = tmp[1];
-            data[1] = tmp[2];
-#endif
-            data += 2;
-            l += 2;
-        }
-        return l;
-    }
+    initWaveFuncs();
+
+    if (bps == 24 || bps == 64)
+        return readConverted(data, maxlen);
 
     qint64 nSamples = maxlen / format.bytesPerSample();
     maxlen = nSamples * format.bytesPerSample();
@@ -209,10 +257,10 @@ qint64 QWaveDecoder::readData(char *data, qint64 maxlen)
     nSamples = read / format.bytesPerSample();
     switch (format.bytesPerSample()) {
     case 2:
-        bswap2(data, nSamples);
+        qBswap16(reinterpret_cast<quint16 *>(data), nSamples);
         break;
     case 4:
-        bswap4(data, nSamples);
+        qBswap32(reinterpret_cast<quint32 *>(data), nSamples);
         break;
     default:
         Q_UNREACHABLE();
@@ -221,6 +269,48 @@ qint64 QWaveDecoder::readData(char *data, qint64 maxlen)
 
 }
 
+// Reads 24 bit integer and 64 bit float samples, which are expanded to 32 bit
+// integers and narrowed to 32 bit floats respectively. Only whole samples are
+// taken from the device, through a block sized scratch buffer.
+qint64 QWaveDecoder::readConverted(char *data, qint64 maxlen)
+{
+    const int sourceBytes = bps / 8;
+    const int targetBytes = format.bytesPerSample();
+    alignas(16) uchar buffer[6144];
+
+    qint64 samples = qMin(maxlen / targetBytes, device->bytesAvailable() / sourceBytes);
+    qint64 written = 0;
+    while (samples > 0) {
+        const qint64 blockSamples = qMin(samples, qint64(sizeof(buffer) / sourceBytes));
+        const qint64 read = device->read(reinterpret_cast<char *>(buffer), blockSamples * sourceBytes);
+        const qint64 readSamples = read > 0 ? read / sourceBytes : 0;
+        if (readSamples == 0)
+            break;
+
+        if (bps == 24) {
+            const Expand24Func expand = bigEndian ? qExpand24be : qExpand24le;
+            expand(buffer, reinterpret_cast<qint32 *>(data + written), readSamples);
+        } else {
+            float *out = reinterpret_cast<float *>(data + written);
+            for (qsizetype i = 0; i < readSamples; ++i) {
+                quint64 bits;
+                memcpy(&bits, buffer + i * sizeof(bits), sizeof(bits));
+                if (byteSwap)
+                    bits = qbswap(bits);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                out[i] = float(value);
+            }
+        }
+
+        written += readSamples * targetBytes;
+        samples -= readSamples;
+        if (readSamples < blockSamples)
+            break;
+    }
+    return written;
+}
+
 qint64 QWaveDecoder::writeData(const char *data, qint64 len)
 {
     if (!haveHeader)
@@ -358,9 +448,6 @@ void QWaveDecoder::handleData()
             WAVEHeader wave;
             device->read(reinterpret_cast<char *>(&wave), sizeof(WAVEHeader));
 
-            if (rawChunkSize > sizeof(WAVEHeader))
-                discardBytes(rawChunkSize - sizeof(WAVEHeader));
-
             // Swizzle this
             if (bigEndian) {
                 wave.audioFormat = qFromBigEndian<quint16>(wave.audioFormat);
@@ -368,9 +455,25 @@ void QWaveDecoder::handleData()
                 wave.audioFormat = qFromLittleEndian<quint16>(wave.audioFormat);
             }
 
-            if (wave.audioFormat != 0 && wave.audioFormat != 1) {
-                // 32bit wave files have format == 0xFFFE (WAVE_FORMAT_EXTENSIBLE).
-                // but don't support them at the moment.
+            // WAVE_FORMAT_EXTENSIBLE (used for more than 16 bits or 2 channels)
+            // stores the actual format in the first two bytes of the sub format GUID
+            if (wave.audioFormat == WaveFormatExtensible) {
+                if (rawChunkSize < sizeof(WAVEHeader) + sizeof(WAVEExtension)) {
+                    parsingFailed();
+                    return;
+                }
+                WAVEExtension extension;
+                device->read(reinterpret_cast<char *>(&extension), sizeof(WAVEExtension));
+                rawChunkSize -= sizeof(WAVEExtension);
+                wave.audioFormat = bigEndian ? qFromBigEndian<quint16>(extension.subFormat)
+                                             : qFromLittleEndian<quint16>(extension.subFormat);
+            }
+
+            if (rawChunkSize > sizeof(WAVEHeader))
+                discardBytes(rawChunkSize - sizeof(WAVEHeader));
+
+            if (wave.audioFormat != 0 && wave.audioFormat != WaveFormatPcm
+                    && wave.audioFormat != WaveFormatIeeeFloat) {
                 parsingFailed();
                 return;
             }
@@ -387,20 +490,25 @@ void QWaveDecoder::handleData()
                 channels = qFromLittleEndian<quint16>(wave.numChannels);
             }
 
+            // 24 bit samples are expanded to 32 bit and 64 bit floats are
+            // narrowed to 32 bit while reading, see readConverted()
             QAudioFormat::SampleFormat fmt = QAudioFormat::Unknown;
-            switch(bps) {
-            case 8:
-                fmt = QAudioFormat::UInt8;
-                break;
-            case 16:
-                fmt = QAudioFormat::Int16;
-                break;
-            case 24:
-                fmt = QAudioFormat::Int16;
-                break;
-            case 32:
-                fmt = QAudioFormat::Int32;
-                break;
+            if (wave.audioFormat == WaveFormatIeeeFloat) {
+                if (bps == 32 || bps == 64)
+                    fmt = QAudioFormat::Float;
+            } else {
+                switch(bps) {
+                case 8:
+                    fmt = QAudioFormat::UInt8;
+                    break;
+                case 16:
+                    fmt = QAudioFormat::Int16;
+                    break;
+                case 24:
+                case 32:
+                    fmt = QAudioFormat::Int32;
+                    break;
+                }
             }
             if (fmt == QAudioFormat::Unknown || rate == 0 || channels == 0) {
                 parsingFailed();
@@ -408,8 +516,8 @@ void QWaveDecoder::handleData()
             }
 
             format.setSampleFormat(fmt);
-            format.setSampleRate(/*qFromBigEndian<quint32>*/(wave.sampleRate));
-            format.setChannelCount(/*qFromBigEndian<quint16>*/(wave.numChannels));
+            format.setSampleRate(rate);
+            format.setChannelCount(channels);
 
             state = QWaveDecoder::WaitingForDataState;
         }
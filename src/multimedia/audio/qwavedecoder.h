@@ -89,6 +89,7 @@ private:
     bool findChunk(const char *chunkId);
     void discardBytes(qint64 numBytes);
     void parsingFailed();
+    qint64 readConverted(char *data, qint64 maxlen);
 
     enum State {
         InitialState,
@@ -119,6 +120,16 @@ private:
         quint16     bitsPerSample;
     };
 
+    // Follows the WAVEHeader of WAVE_FORMAT_EXTENSIBLE files
+    struct WAVEExtension
+    {
+        quint16     extensionSize;
+        quint16     validBitsPerSample;
+        quint32     channelMask;
+        quint16     subFormat;
+        char        subFormatGuid[14];
+    };
+
     struct DATAHeader
     {
         chunk       descriptor;
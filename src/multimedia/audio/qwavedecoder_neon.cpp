@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwavedecoder.h"
+
+#include <QtCore/qendian.h>
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QWaveDecoderInternal
+{
+
+void QT_FASTCALL qt_wav_bswap16_neon(quint16 *data, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(data + i), vrev16q_u8(v));
+    }
+    for (; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
+
+void QT_FASTCALL qt_wav_bswap32_neon(quint32 *data, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(data + i), vrev32q_u8(v));
+    }
+    for (; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
+
+// vld3 splits sixteen packed samples into their three bytes, vst4 interleaves
+// them again below a zero low byte.
+template<bool BigEndian>
+static inline void expand24(const uchar *src, qint32 *dst, qsizetype count)
+{
+    const uint8x16_t zero = vdupq_n_u8(0);
+    qsizetype i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x3_t s = vld3q_u8(src + 3 * i);
+        uint8x16x4_t d;
+        d.val[0] = zero;
+        d.val[1] = BigEndian ? s.val[2] : s.val[0];
+        d.val[2] = s.val[1];
+        d.val[3] = BigEndian ? s.val[0] : s.val[2];
+        vst4q_u8(reinterpret_cast<uint8_t *>(dst + i), d);
+    }
+    for (; i < count; ++i) {
+        const uchar *s = src + 3 * i;
+        dst[i] = BigEndian
+                ? qint32((quint32(s[0]) << 24) | (quint32(s[1]) << 16) | (quint32(s[2]) << 8))
+                : qint32((quint32(s[2]) << 24) | (quint32(s[1]) << 16) | (quint32(s[0]) << 8));
+    }
+}
+
+void QT_FASTCALL qt_wav_expand24le_neon(const uchar *src, qint32 *dst, qsizetype count)
+{
+    expand24<false>(src, dst, count);
+}
+
+void QT_FASTCALL qt_wav_expand24be_neon(const uchar *src, qint32 *dst, qsizetype count)
+{
+    expand24<true>(src, dst, count);
+}
+
+} // namespace QWaveDecoderInternal
+
+QT_END_NAMESPACE
+
+#endif
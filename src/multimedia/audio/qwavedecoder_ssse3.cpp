@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwavedecoder.h"
+
+#include <QtCore/qendian.h>
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSSE3
+
+QT_BEGIN_NAMESPACE
+
+namespace QWaveDecoderInternal
+{
+
+void QT_FASTCALL qt_wav_bswap16_ssse3(quint16 *data, qsizetype count)
+{
+    const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i *p = reinterpret_cast<__m128i *>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+    }
+    for (; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
+
+void QT_FASTCALL qt_wav_bswap32_ssse3(quint32 *data, qsizetype count)
+{
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i *p = reinterpret_cast<__m128i *>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+    }
+    for (; i < count; ++i)
+        data[i] = qbswap(data[i]);
+}
+
+// Each iteration expands four packed samples (12 bytes) but loads 16 bytes,
+// so the vector loop stops while at least six samples are left.
+template<bool BigEndian>
+static inline void expand24(const uchar *src, qint32 *dst, qsizetype count)
+{
+    const __m128i mask = BigEndian
+            ? _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9)
+            : _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    qsizetype i = 0;
+    for (; i + 6 <= count; i += 4) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(s, mask));
+    }
+    for (; i < count; ++i) {
+        const uchar *s = src + 3 * i;
+        dst[i] = BigEndian
+                ? qint32((quint32(s[0]) << 24) | (quint32(s[1]) << 16) | (quint32(s[2]) << 8))
+                : qint32((quint32(s[2]) << 24) | (quint32(s[1]) << 16) | (quint32(s[0]) << 8));
+    }
+}
+
+void QT_FASTCALL qt_wav_expand24le_ssse3(const uchar *src, qint32 *dst, qsizetype count)
+{
+    expand24<false>(src, dst, count);
+}
+
+void QT_FASTCALL qt_wav_expand24be_ssse3(const uchar *src, qint32 *dst, qsizetype count)
+{
+    expand24<true>(src, dst, count);
+}
+
+} // namespace QWaveDecoderInternal
+
+QT_END_NAMESPACE
+
+#endif
@@ -330,6 +330,78 @@ int QImageCapture::capture()
     return -1;
 }
 
+/*!
+    \since 6.3
+
+    Captures \a count consecutive frames from the camera at its full frame
+    rate and saves them to \a location. The first frame is saved like with
+    captureToFile(), the following ones get \c _1, \c _2, ... appended to
+    the base name of the first file.
+
+    The frames are assigned consecutive capture ids. The id of the first
+    frame is returned and each frame is reported through the imageExposed(),
+    imageAvailable(), imageCaptured() and imageSaved() signals.
+
+    Returns -1 and emits errorOccurred() if \a count is not positive, the
+    capture is not ready or the backend doesn't support burst capture.
+
+    \sa captureBurst(), captureToFile()
+*/
+int QImageCapture::captureBurstToFile(int count, const QString &location)
+{
+    Q_D(QImageCapture);
+
+    d->unsetError();
+
+    if (!d->control) {
+        d->_q_error(-1, NotSupportedFeatureError, QPlatformImageCapture::msgCameraNotReady());
+        return -1;
+    }
+
+    if (count < 1) {
+        d->_q_error(-1, NotSupportedFeatureError, tr("Invalid burst length %1").arg(count));
+        return -1;
+    }
+
+    if (!isReadyForCapture()) {
+        d->_q_error(-1, NotReadyError, tr("Could not capture in stopped state"));
+        return -1;
+    }
+
+    return d->control->captureBurst(count, location);
+}
+
+/*!
+    \since 6.3
+
+    Captures \a count consecutive frames from the camera at its full frame
+    rate and makes them available through imageAvailable() and
+    imageCaptured() without saving them.
+
+    Returns the capture id of the first frame, the other frames have the
+    following ids. Returns -1 on error.
+
+    \sa captureBurstToFile(), capture()
+*/
+int QImageCapture::captureBurst(int count)
+{
+    Q_D(QImageCapture);
+
+    d->unsetError();
+
+    if (!d->control) {
+        d->_q_error(-1, NotSupportedFeatureError, tr("Device does not support images capture."));
+        return -1;
+    }
+
+    if (count < 1) {
+        d->_q_error(-1, NotSupportedFeatureError, tr("Invalid burst length %1").arg(count));
+        return -1;
+    }
+
+    return d->control->captureBurstToBuffer(count);
+}
+
 /*!
     \enum QImageCapture::Error
 
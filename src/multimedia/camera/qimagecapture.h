@@ -132,6 +132,8 @@ public:
 public Q_SLOTS:
     int captureToFile(const QString &location = QString());
     int capture();
+    int captureBurstToFile(int count, const QString &location = QString());
+    int captureBurst(int count);
 
 Q_SIGNALS:
     void errorChanged();
@@ -53,6 +53,8 @@
 #include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudiosink_p.h"
 #include "qalsaaudiodevice_p.h"
+#include "qalsaaudiothread_p.h"
+#include "qalsahelpers_p.h"
 #include <QLoggingCategory>
 
 QT_BEGIN_NAMESPACE
@@ -80,8 +82,11 @@ QAlsaAudioSink::QAlsaAudioSink(const QByteArray &device)
     pullMode = true;
     resuming = false;
     opened = false;
+    xruns = 0;
+    ioThread = nullptr;
 
     m_volume = 1.0f;
+    m_appliedVolume = 1.0f;
 
     m_device = device;
 
@@ -100,6 +105,8 @@ QAlsaAudioSink::~QAlsaAudioSink()
 void QAlsaAudioSink::setVolume(qreal vol)
 {
     m_volume = vol;
+    if (ioThread)
+        ioThread->setVolume(vol);
 }
 
 qreal QAlsaAudioSink::volume() const
@@ -129,6 +136,7 @@ int QAlsaAudioSink::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++xruns;
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -212,6 +220,8 @@ void QAlsaAudioSink::start(QIODevice* device)
 
     pullMode = true;
     audioSource = device;
+    renderCallback = nullptr;
+    xruns = 0;
 
     deviceState = QAudio::ActiveState;
 
@@ -238,6 +248,8 @@ QIODevice* QAlsaAudioSink::start()
     audioSource = new AlsaOutputPrivate(this);
     audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
     pullMode = false;
+    renderCallback = nullptr;
+    xruns = 0;
 
     deviceState = QAudio::IdleState;
 
@@ -248,6 +260,35 @@ QIODevice* QAlsaAudioSink::start()
     return audioSource;
 }
 
+void QAlsaAudioSink::startRendering(QAudioSink::RenderCallback &&callback)
+{
+    if(deviceState != QAudio::StoppedState)
+        deviceState = QAudio::StoppedState;
+
+    errorState = QAudio::NoError;
+
+    // Handle change of mode
+    if(audioSource && !pullMode) {
+        delete audioSource;
+        audioSource = 0;
+    }
+
+    close();
+
+    // The callback always runs on the I/O thread, whether or not
+    // QT_ALSA_IO_THREAD is set
+    pullMode = true;
+    audioSource = nullptr;
+    renderCallback = std::move(callback);
+    xruns = 0;
+
+    deviceState = QAudio::ActiveState;
+
+    open();
+
+    emit stateChanged(deviceState);
+}
+
 void QAlsaAudioSink::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -325,7 +366,10 @@ bool QAlsaAudioSink::open()
         }
     }
     if ( !fatal ) {
-        err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        access = QAlsaHelpers::useMmap() ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
+        err = QAlsaHelpers::setAccess(handle, hwparams, &access);
+        if (QAlsaHelpers::useMmap() && access != SND_PCM_ACCESS_MMAP_INTERLEAVED)
+            qCDebug(lcAlsaOutput) << "mmap access refused, using read/write access";
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSink: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -437,19 +481,60 @@ bool QAlsaAudioSink::open()
     snd_pcm_sw_params_set_start_threshold(handle,swparams,period_frames);
     snd_pcm_sw_params_set_stop_threshold(handle,swparams,buffer_frames);
     snd_pcm_sw_params_set_avail_min(handle, swparams,period_frames);
+    QAlsaHelpers::enableTimestamps(handle, swparams);
     snd_pcm_sw_params(handle, swparams);
 
     // Step 4: Prepare audio
     if(audioBuffer == 0)
         audioBuffer = new char[snd_pcm_frames_to_bytes(handle,buffer_frames)];
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+
+    if (renderCallback || QAlsaAudioThread::isEnabled()) {
+        // The ring lets the user side stall for as long as it lasts instead
+        // of a single period. The I/O thread starts the device once it has
+        // written the first period.
+        const int bytesPerFrame = settings.bytesPerFrame();
+        if (renderCallback) {
+            ioRing.clear();
+        } else {
+            const qsizetype ringSize = qMax<qsizetype>(4 * buffer_size, settings.bytesForDuration(250000));
+            ioRing.resize(ringSize - ringSize % bytesPerFrame);
+        }
+        ioThread = new QAlsaAudioThread(handle, SND_PCM_STREAM_PLAYBACK, bytesPerFrame,
+                                        period_frames, period_time, access, &ioRing, this);
+        ioThread->setVolume(m_volume);
+        if (renderCallback)
+            ioThread->setCallback(QAlsaAudioThread::Callback(renderCallback), settings);
+        else
+            connect(ioThread, &QAlsaAudioThread::progress, this, &QAlsaAudioSink::ioProgress);
+        connect(ioThread, &QAlsaAudioThread::xrun, this, &QAlsaAudioSink::ioXrun);
+        connect(ioThread, &QAlsaAudioThread::ioError, this, &QAlsaAudioSink::ioError);
+        if (!ioThread->startIo()) {
+            delete ioThread;
+            ioThread = nullptr;
+            if (renderCallback) {
+                // There is no other thread to render on
+                snd_pcm_close(handle);
+                handle = 0;
+                delete [] audioBuffer;
+                audioBuffer = 0;
+                errorState = QAudio::OpenError;
+                emit errorChanged(errorState);
+                deviceState = QAudio::StoppedState;
+                return false;
+            }
+        }
+    }
+    if (!ioThread)
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
     bytesAvailable = bytesFree();
 
-    // Step 6: Start audio processing
-    timer->start(period_time/1000);
+    // Step 6: Start audio processing. With the I/O thread the timer only
+    // polls a pull mode source that had no data for a while.
+    if (!ioThread || (pullMode && !renderCallback))
+        timer->start(period_time/1000);
 
     timeStamp.restart();
     elapsedTimeOffset = 0;
@@ -464,6 +549,16 @@ void QAlsaAudioSink::close()
 {
     timer->stop();
 
+    if (ioThread) {
+        // Play what is left in the ring before draining the device
+        ioThread->stopIo(true);
+        totalTimeValue += ioThread->framesTransferred();
+        xruns += ioThread->xrunCount();
+        delete ioThread;
+        ioThread = nullptr;
+        qCDebug(lcAlsaOutput) << "xruns:" << xruns;
+    }
+
     if ( handle ) {
         snd_pcm_drain( handle );
         snd_pcm_close( handle );
@@ -480,6 +575,15 @@ void QAlsaAudioSink::close()
 
 qsizetype QAlsaAudioSink::bytesFree() const
 {
+    if (ioThread) {
+        if (renderCallback)
+            return 0;
+        if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+            return 0;
+        const qsizetype free = ioRing.free();
+        return free - free % settings.bytesPerFrame();
+    }
+
     if(resuming)
         return period_size;
 
@@ -509,6 +613,10 @@ qint64 QAlsaAudioSink::write( const char *data, qint64 len )
     // Write out some audio data
     if ( !handle )
         return 0;
+    if (ioThread)
+        return writeToRing(data, len);
+    if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        return mmapWrite(data, len);
 #ifdef DEBUG_AUDIO
     qDebug()<<"frames to write out = "<<
         snd_pcm_bytes_to_frames( handle, (int)len )<<" ("<<len<<") bytes";
@@ -524,13 +632,16 @@ qint64 QAlsaAudioSink::write( const char *data, qint64 len )
 
     frames = snd_pcm_bytes_to_frames(handle, space);
 
-    if (m_volume < 1.0f) {
+    if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
+        // Ramp from the previously applied volume to avoid clicks on volume changes
         QVarLengthArray<char, 4096> out(space);
-        QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, out.data(), space);
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, settings,
+                                               data, out.data(), space);
         err = snd_pcm_writei(handle, out.constData(), frames);
     } else {
         err = snd_pcm_writei(handle, data, frames);
     }
+    m_appliedVolume = m_volume;
 
     if(err > 0) {
         totalTimeValue += err;
@@ -565,9 +676,57 @@ qsizetype QAlsaAudioSink::bufferSize() const
     return buffer_size;
 }
 
+qint64 QAlsaAudioSink::framesWritten() const
+{
+    return totalTimeValue + (ioThread ? ioThread->framesTransferred() : 0);
+}
+
 qint64 QAlsaAudioSink::processedUSecs() const
 {
-    return qint64(1000000) * totalTimeValue / settings.sampleRate();
+    return qint64(1000000) * framesWritten() / settings.sampleRate();
+}
+
+qint64 QAlsaAudioSink::latencyUSecs() const
+{
+    if (!handle)
+        return -1;
+
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(handle, &delay) < 0)
+        return -1;
+    qint64 frames = qMax<snd_pcm_sframes_t>(delay, 0);
+    // Data in the ring has not been handed to the device yet
+    if (ioThread && !renderCallback)
+        frames += ioRing.used() / settings.bytesPerFrame();
+    return qint64(1000000) * frames / settings.sampleRate();
+}
+
+QAudioTimestamp QAlsaAudioSink::timestamp() const
+{
+    if (!handle)
+        return {};
+
+    snd_pcm_uframes_t avail = 0;
+    snd_htimestamp_t tstamp;
+    qint64 written = 0;
+    // The I/O thread may write a period between the two calls; avail is
+    // only meaningful together with the matching frame count.
+    do {
+        written = framesWritten();
+        if (snd_pcm_htimestamp(handle, &avail, &tstamp) < 0)
+            return {};
+    } while (written != framesWritten());
+
+    const qint64 usecs = QAlsaHelpers::elapsedUSecs(elapsedTime, tstamp);
+    if (usecs < 0)
+        return {};
+    const qint64 queued = qMax<qint64>(qint64(buffer_frames) - qint64(avail), 0);
+    return { qMax<qint64>(written - queued, 0), usecs };
+}
+
+int QAlsaAudioSink::xrunCount() const
+{
+    return xruns + (ioThread ? ioThread->xrunCount() : 0);
 }
 
 void QAlsaAudioSink::resume()
@@ -580,9 +739,13 @@ void QAlsaAudioSink::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (ioThread) {
+                ioThread->startIo();
+            } else {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = (int)snd_pcm_frames_to_bytes(handle, buffer_frames);
         }
@@ -591,7 +754,8 @@ void QAlsaAudioSink::resume()
         deviceState = pullMode ? QAudio::ActiveState : QAudio::IdleState;
 
         errorState = QAudio::NoError;
-        timer->start(period_time/1000);
+        if (!ioThread || (pullMode && !renderCallback))
+            timer->start(period_time/1000);
         emit stateChanged(deviceState);
     }
 }
@@ -610,6 +774,9 @@ QAudioFormat QAlsaAudioSink::format() const
 void QAlsaAudioSink::suspend()
 {
     if(deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState || resuming) {
+        // Whatever is still in the ring is played after resume()
+        if (ioThread)
+            ioThread->stopIo();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -634,6 +801,13 @@ void QAlsaAudioSink::userFeed()
 
 bool QAlsaAudioSink::deviceReady()
 {
+    if (ioThread) {
+        // The I/O thread reports underruns through ioXrun()
+        if (pullMode)
+            fillRing();
+        return true;
+    }
+
     if(pullMode) {
         int l = 0;
         int chunks = bytesAvailable/period_size;
@@ -648,7 +822,11 @@ bool QAlsaAudioSink::deviceReady()
         int input = period_frames*chunks;
         if(input > (int)buffer_frames)
             input = buffer_frames;
-        l = audioSource->read(audioBuffer,snd_pcm_frames_to_bytes(handle, input));
+        const bool mmap = access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+        if (mmap) // reads straight into the hardware buffer
+            l = mmapWrite(nullptr, snd_pcm_frames_to_bytes(handle, input));
+        else
+            l = audioSource->read(audioBuffer,snd_pcm_frames_to_bytes(handle, input));
 
         // reading can take a while and stream may have been stopped
         if (!handle)
@@ -658,9 +836,11 @@ bool QAlsaAudioSink::deviceReady()
             // Got some data to output
             if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
                 return true;
-            qint64 bytesWritten = write(audioBuffer,l);
-            if (bytesWritten != l)
-                audioSource->seek(audioSource->pos()-(l-bytesWritten));
+            if (!mmap) {
+                qint64 bytesWritten = write(audioBuffer,l);
+                if (bytesWritten != l)
+                    audioSource->seek(audioSource->pos()-(l-bytesWritten));
+            }
             bytesAvailable = bytesFree();
 
         } else if(l == 0) {
@@ -704,12 +884,224 @@ bool QAlsaAudioSink::deviceReady()
 
 void QAlsaAudioSink::reset()
 {
+    if (ioThread) {
+        ioThread->stopIo();
+        ioRing.clear();
+    }
     if(handle)
         snd_pcm_reset(handle);
 
     stop();
 }
 
+/*
+    Copies \a data into the hardware buffer, applying the volume on the way.
+    Without \a data the user's device is read straight into the hardware
+    buffer instead. Returns the number of bytes written, or -1 when reading
+    from the user's device failed.
+*/
+qint64 QAlsaAudioSink::mmapWrite(const char *data, qint64 len)
+{
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+    if (avail < 0) {
+        if (xrun_recovery(int(avail)) < 0) {
+            close();
+            errorState = QAudio::FatalError;
+            emit errorChanged(errorState);
+            deviceState = QAudio::StoppedState;
+            emit stateChanged(deviceState);
+            return 0;
+        }
+        avail = snd_pcm_avail_update(handle);
+        if (avail < 0)
+            return 0;
+    }
+
+    snd_pcm_uframes_t frames = qMin<snd_pcm_uframes_t>(avail, snd_pcm_bytes_to_frames(handle, len));
+    const qreal startVolume = m_appliedVolume;
+    const bool scale = m_volume < 1.0f || m_appliedVolume < 1.0f;
+    m_appliedVolume = m_volume;
+    qint64 written = 0;
+    qint64 l = 0;
+    while (frames > 0) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames;
+        int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0) {
+            xrun_recovery(err);
+            break;
+        }
+        char *area = QAlsaHelpers::mmapAddress(areas, offset);
+        const qint64 bytes = snd_pcm_frames_to_bytes(handle, count);
+        // Ramp from the previously applied volume to avoid clicks on volume changes
+        const qreal from = written ? m_volume : startVolume;
+
+        if (data) {
+            l = bytes;
+            if (scale)
+                QAudioHelperInternal::qMultiplySamples(from, m_volume, settings, data + written, area, int(l));
+            else
+                memcpy(area, data + written, l);
+        } else {
+            l = audioSource->read(area, bytes);
+            if (l > 0 && scale)
+                QAudioHelperInternal::qMultiplySamples(from, m_volume, settings, area, area, int(l));
+        }
+
+        const snd_pcm_uframes_t filled = l > 0 ? snd_pcm_bytes_to_frames(handle, l) : 0;
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, filled);
+        const qint64 committedBytes = committed > 0 ? snd_pcm_frames_to_bytes(handle, committed) : 0;
+        // As in deviceReady(), give back what was read but not committed, such
+        // as the tail of a partial frame
+        if (!data && l > committedBytes)
+            audioSource->seek(audioSource->pos() - (l - committedBytes));
+        if (committed < 0 || snd_pcm_uframes_t(committed) != filled) {
+            xrun_recovery(committed < 0 ? int(committed) : -EPIPE);
+            break;
+        }
+        written += committedBytes;
+        frames -= committed;
+        if (l < bytes)
+            break;
+    }
+
+    if (l < 0 && written == 0)
+        return -1;
+    if (written <= 0)
+        return 0;
+
+    // Unlike snd_pcm_writei(), committing doesn't start the stream
+    if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED)
+        snd_pcm_start(handle);
+
+    totalTimeValue += snd_pcm_bytes_to_frames(handle, written);
+    resuming = false;
+    errorState = QAudio::NoError;
+    if (deviceState != QAudio::ActiveState) {
+        deviceState = QAudio::ActiveState;
+        emit stateChanged(deviceState);
+    }
+    return written;
+}
+
+void QAlsaAudioSink::fillRing()
+{
+    // Read from the user's device straight into the ring
+    const int bytesPerFrame = settings.bytesPerFrame();
+    qint64 total = 0;
+    qint64 l = 0;
+    while (true) {
+        const QAudioRingBuffer::Region region = ioRing.writeRegion();
+        const qint64 len = region.size - region.size % bytesPerFrame;
+        if (len <= 0)
+            break;
+        l = audioSource->read(region.data, len);
+        // reading can take a while and stream may have been stopped
+        if (!ioThread)
+            return;
+        if (l <= 0)
+            break;
+        if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
+            QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, settings,
+                                                   region.data, region.data, int(l));
+            m_appliedVolume = m_volume;
+        }
+        ioRing.commit(l);
+        total += l;
+        if (l < len)
+            break;
+    }
+
+    if (total > 0) {
+        ioThread->wake();
+        resuming = false;
+        if (deviceState != QAudio::ActiveState) {
+            errorState = QAudio::NoError;
+            deviceState = QAudio::ActiveState;
+            emit stateChanged(deviceState);
+        }
+    } else if (l < 0) {
+        close();
+        deviceState = QAudio::StoppedState;
+        errorState = QAudio::IOError;
+        emit errorChanged(errorState);
+        emit stateChanged(deviceState);
+    } else if (ioRing.isEmpty() && deviceState == QAudio::ActiveState) {
+        // Underrun
+        errorState = QAudio::UnderrunError;
+        emit errorChanged(errorState);
+        deviceState = QAudio::IdleState;
+        emit stateChanged(deviceState);
+    }
+}
+
+qint64 QAlsaAudioSink::writeToRing(const char *data, qint64 len)
+{
+    if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return 0;
+
+    len = qMin<qint64>(len, bytesFree());
+    qint64 written = 0;
+    while (written < len) {
+        const QAudioRingBuffer::Region region = ioRing.writeRegion();
+        const qint64 chunk = qMin<qint64>(region.size, len - written);
+        if (chunk <= 0)
+            break;
+        if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
+            // Ramp from the previously applied volume to avoid clicks on volume changes
+            QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, settings,
+                                                   data + written, region.data, int(chunk));
+            m_appliedVolume = m_volume;
+        } else {
+            memcpy(region.data, data + written, chunk);
+        }
+        ioRing.commit(chunk);
+        written += chunk;
+    }
+
+    if (written > 0) {
+        ioThread->wake();
+        resuming = false;
+        errorState = QAudio::NoError;
+        if (deviceState != QAudio::ActiveState) {
+            deviceState = QAudio::ActiveState;
+            emit stateChanged(deviceState);
+        }
+    }
+    return written;
+}
+
+void QAlsaAudioSink::ioProgress()
+{
+    if (!ioThread)
+        return;
+    ioThread->acknowledge();
+    if (pullMode && (deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState))
+        fillRing();
+}
+
+void QAlsaAudioSink::ioXrun()
+{
+    errorState = QAudio::UnderrunError;
+    emit errorChanged(errorState);
+    // The callback renders again right away, so it stays active
+    if (!renderCallback && ioRing.isEmpty() && deviceState == QAudio::ActiveState) {
+        deviceState = QAudio::IdleState;
+        emit stateChanged(deviceState);
+    }
+}
+
+void QAlsaAudioSink::ioError(int error)
+{
+    qWarning() << "QAudioSink: I/O error:" << snd_strerror(error);
+    close();
+    errorState = QAudio::FatalError;
+    emit errorChanged(errorState);
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
+}
+
 AlsaOutputPrivate::AlsaOutputPrivate(QAlsaAudioSink* audio)
 {
     audioDevice = qobject_cast<QAlsaAudioSink*>(audio);
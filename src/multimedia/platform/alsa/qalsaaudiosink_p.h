@@ -64,9 +64,12 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodevice.h>
 #include <private/qaudiosystem_p.h>
+#include <private/qaudioringbuffer_p.h>
 
 QT_BEGIN_NAMESPACE
 
+class QAlsaAudioThread;
+
 class QAlsaAudioSink : public QPlatformAudioSink
 {
     friend class AlsaOutputPrivate;
@@ -79,6 +82,7 @@ public:
 
     void start(QIODevice* device) override;
     QIODevice* start() override;
+    void startRendering(QAudioSink::RenderCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -87,6 +91,8 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
+    QAudioTimestamp timestamp() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat& fmt) override;
@@ -94,6 +100,7 @@ public:
     void setVolume(qreal) override;
     qreal volume() const override;
 
+    int xrunCount() const override;
 
     QIODevice* audioSource;
     QAudioFormat settings;
@@ -103,6 +110,9 @@ public:
 private slots:
     void userFeed();
     bool deviceReady();
+    void ioProgress();
+    void ioXrun();
+    void ioError(int error);
 
 signals:
     void processMore();
@@ -123,17 +133,29 @@ private:
     int setFormat();
     bool open();
     void close();
+    qint64 framesWritten() const;
+    void fillRing();
+    qint64 writeToRing(const char *data, qint64 len);
+    qint64 mmapWrite(const char *data, qint64 len);
 
     QTimer* timer;
+    QElapsedTimer timeStamp;
     QByteArray m_device;
     int bytesAvailable;
     qint64 elapsedTimeOffset;
+    int xruns;
+    // Only used with the I/O thread
+    QAudioRingBuffer ioRing;
+    QAlsaAudioThread *ioThread;
+    // Rendered on the I/O thread instead of pulling from audioSource
+    QAudioSink::RenderCallback renderCallback;
     char* audioBuffer;
     snd_pcm_t* handle;
     snd_pcm_access_t access;
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
     qreal m_volume;
+    qreal m_appliedVolume;
 };
 
 class AlsaOutputPrivate : public QIODevice
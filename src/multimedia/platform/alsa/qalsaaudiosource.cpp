@@ -53,9 +53,13 @@
 #include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudiosource_p.h"
 #include "qalsaaudiodevice_p.h"
+#include "qalsaaudiothread_p.h"
+#include "qalsahelpers_p.h"
+#include <QLoggingCategory>
 
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(lcAlsaInput, "qt.multimedia.alsa.input")
 //#define DEBUG_AUDIO 1
 
 QAlsaAudioSource::QAlsaAudioSource(const QByteArray &device)
@@ -74,6 +78,8 @@ QAlsaAudioSource::QAlsaAudioSource(const QByteArray &device)
     audioSource = 0;
     pullMode = true;
     resuming = false;
+    xruns = 0;
+    ioThread = nullptr;
 
     m_volume = 1.0f;
 
@@ -94,6 +100,8 @@ QAlsaAudioSource::~QAlsaAudioSource()
 void QAlsaAudioSource::setVolume(qreal vol)
 {
     m_volume = vol;
+    if (ioThread)
+        ioThread->setVolume(vol);
 }
 
 qreal QAlsaAudioSource::volume() const
@@ -134,6 +142,7 @@ int QAlsaAudioSource::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++xruns;
         errorState = QAudio::UnderrunError;
         err = snd_pcm_prepare(handle);
         if(err < 0)
@@ -212,6 +221,8 @@ void QAlsaAudioSource::start(QIODevice* device)
 
     pullMode = true;
     audioSource = device;
+    captureCallback = nullptr;
+    xruns = 0;
 
     deviceState = QAudio::ActiveState;
 
@@ -232,6 +243,8 @@ QIODevice* QAlsaAudioSource::start()
     pullMode = false;
     audioSource = new AlsaInputPrivate(this);
     audioSource->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    captureCallback = nullptr;
+    xruns = 0;
 
     deviceState = QAudio::IdleState;
 
@@ -243,6 +256,29 @@ QIODevice* QAlsaAudioSource::start()
     return audioSource;
 }
 
+void QAlsaAudioSource::startCapturing(QAudioSource::CaptureCallback &&callback)
+{
+    if(deviceState != QAudio::StoppedState)
+        close();
+
+    if(!pullMode && audioSource)
+        delete audioSource;
+
+    // The callback always runs on the I/O thread, whether or not
+    // QT_ALSA_IO_THREAD is set
+    pullMode = true;
+    audioSource = nullptr;
+    captureCallback = std::move(callback);
+    xruns = 0;
+
+    deviceState = QAudio::ActiveState;
+
+    if( !open() )
+        return;
+
+    emit stateChanged(deviceState);
+}
+
 void QAlsaAudioSource::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -318,7 +354,10 @@ bool QAlsaAudioSource::open()
         }
     }
     if ( !fatal ) {
-        err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        access = QAlsaHelpers::useMmap() ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
+        err = QAlsaHelpers::setAccess(handle, hwparams, &access);
+        if (QAlsaHelpers::useMmap() && access != SND_PCM_ACCESS_MMAP_INTERLEAVED)
+            qCDebug(lcAlsaInput) << "mmap access refused, using read/write access";
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSource: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -394,22 +433,60 @@ bool QAlsaAudioSource::open()
     snd_pcm_sw_params_set_start_threshold(handle,swparams,period_frames);
     snd_pcm_sw_params_set_stop_threshold(handle,swparams,buffer_frames);
     snd_pcm_sw_params_set_avail_min(handle, swparams,period_frames);
+    QAlsaHelpers::enableTimestamps(handle, swparams);
     snd_pcm_sw_params(handle, swparams);
 
     // Step 4: Prepare audio
     ringBuffer.resize(buffer_size);
+    volumeBuffer.resize(period_size);
     snd_pcm_prepare( handle );
     snd_pcm_start(handle);
 
+    if (captureCallback || QAlsaAudioThread::isEnabled()) {
+        // The ring lets the user side stall for as long as it lasts instead
+        // of a single period
+        const int bytesPerFrame = settings.bytesPerFrame();
+        if (captureCallback) {
+            ioRing.clear();
+        } else {
+            const qsizetype ringSize = qMax<qsizetype>(4 * buffer_size, settings.bytesForDuration(250000));
+            ioRing.resize(ringSize - ringSize % bytesPerFrame);
+        }
+        ioThread = new QAlsaAudioThread(handle, SND_PCM_STREAM_CAPTURE, bytesPerFrame,
+                                        period_frames, period_time, access, &ioRing, this);
+        ioThread->setVolume(m_volume);
+        if (captureCallback)
+            ioThread->setCallback(QAlsaAudioThread::Callback(captureCallback), settings);
+        else
+            connect(ioThread, &QAlsaAudioThread::progress, this, &QAlsaAudioSource::ioProgress);
+        connect(ioThread, &QAlsaAudioThread::xrun, this, &QAlsaAudioSource::ioXrun);
+        connect(ioThread, &QAlsaAudioThread::ioError, this, &QAlsaAudioSource::ioError);
+        if (!ioThread->startIo()) {
+            delete ioThread;
+            ioThread = nullptr;
+            if (captureCallback) {
+                // There is no other thread to capture on
+                snd_pcm_drop(handle);
+                snd_pcm_close(handle);
+                handle = 0;
+                errorState = QAudio::OpenError;
+                deviceState = QAudio::StoppedState;
+                emit stateChanged(deviceState);
+                return false;
+            }
+        }
+    }
+
     // Step 5: Setup timer
     bytesAvailable = checkBytesReady();
 
-    if(pullMode)
+    if(pullMode && audioSource)
         connect(audioSource,SIGNAL(readyRead()),this,SLOT(userFeed()));
 
-    // Step 6: Start audio processing
+    // Step 6: Start audio processing. The I/O thread reports new data itself.
     chunks = buffer_size/period_size;
-    timer->start(period_time*chunks/2000);
+    if (!ioThread)
+        timer->start(period_time*chunks/2000);
 
     errorState  = QAudio::NoError;
 
@@ -422,6 +499,16 @@ void QAlsaAudioSource::close()
 {
     timer->stop();
 
+    if (ioThread) {
+        ioThread->stopIo();
+        xruns += ioThread->xrunCount();
+        if (captureCallback)
+            totalTimeValue += ioThread->framesTransferred() * settings.bytesPerFrame();
+        delete ioThread;
+        ioThread = nullptr;
+        qCDebug(lcAlsaInput) << "xruns:" << xruns;
+    }
+
     if ( handle ) {
         snd_pcm_drop( handle );
         snd_pcm_close( handle );
@@ -431,7 +518,9 @@ void QAlsaAudioSource::close()
 
 int QAlsaAudioSource::checkBytesReady()
 {
-    if(resuming)
+    if (ioThread)
+        bytesAvailable = int(ioRing.used());
+    else if(resuming)
         bytesAvailable = period_size;
     else if(deviceState != QAudio::ActiveState
             && deviceState != QAudio::IdleState)
@@ -449,16 +538,27 @@ int QAlsaAudioSource::checkBytesReady()
     return bytesAvailable;
 }
 
-int QAlsaAudioSource::bytesReady() const
+qsizetype QAlsaAudioSource::bytesReady() const
 {
+    if (ioThread)
+        return ioRing.used();
     return qMax(bytesAvailable, 0);
 }
 
+int QAlsaAudioSource::xrunCount() const
+{
+    return xruns + (ioThread ? ioThread->xrunCount() : 0);
+}
+
 qint64 QAlsaAudioSource::read(char* data, qint64 len)
 {
     // Read in some audio data and write it to QIODevice, pull mode
     if ( !handle )
         return 0;
+    if (ioThread)
+        return readFromRing(data, len);
+    if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        return mmapRead(data, len);
 
     int bytesRead = 0;
     int bytesInRingbufferBeforeRead = ringBuffer.bytesOfDataInBuffer();
@@ -614,37 +714,94 @@ void QAlsaAudioSource::resume()
                 xrun_recovery(err);
 
             bytesAvailable = buffer_size;
+            if (ioThread)
+                ioThread->startIo();
         }
         resuming = true;
         deviceState = QAudio::ActiveState;
         int chunks = buffer_size/period_size;
-        timer->start(period_time*chunks/2000);
+        if (!ioThread)
+            timer->start(period_time*chunks/2000);
         emit stateChanged(deviceState);
     }
 }
 
-void QAlsaAudioSource::setBufferSize(int value)
+void QAlsaAudioSource::setBufferSize(qsizetype value)
 {
     buffer_size = value;
 }
 
-int QAlsaAudioSource::bufferSize() const
+qsizetype QAlsaAudioSource::bufferSize() const
 {
     return buffer_size;
 }
 
 qint64 QAlsaAudioSource::processedUSecs() const
 {
-    qint64 result = qint64(1000000) * totalTimeValue /
+    qint64 bytes = totalTimeValue;
+    // The callback is handed the data without the ring counting it
+    if (captureCallback && ioThread)
+        bytes += ioThread->framesTransferred() * settings.bytesPerFrame();
+    qint64 result = qint64(1000000) * bytes /
         settings.bytesPerFrame() /
         settings.sampleRate();
 
     return result;
 }
 
+// Frames read from the device, including those not yet delivered
+qint64 QAlsaAudioSource::framesRead() const
+{
+    if (ioThread)
+        return ioThread->framesTransferred();
+    return (totalTimeValue + ringBuffer.bytesOfDataInBuffer()) / settings.bytesPerFrame();
+}
+
+qint64 QAlsaAudioSource::latencyUSecs() const
+{
+    if (!handle)
+        return -1;
+
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(handle, &delay) < 0)
+        return -1;
+    qint64 bytes = qMax<snd_pcm_sframes_t>(delay, 0) * settings.bytesPerFrame();
+    // Data read from the device but not delivered yet
+    if (ioThread)
+        bytes += captureCallback ? 0 : ioRing.used();
+    else
+        bytes += ringBuffer.bytesOfDataInBuffer();
+    return qint64(1000000) * bytes / settings.bytesPerFrame() / settings.sampleRate();
+}
+
+QAudioTimestamp QAlsaAudioSource::timestamp() const
+{
+    if (!handle)
+        return {};
+
+    snd_pcm_uframes_t avail = 0;
+    snd_htimestamp_t tstamp;
+    qint64 read = 0;
+    // The I/O thread may read a period between the two calls; avail is
+    // only meaningful together with the matching frame count.
+    do {
+        read = framesRead();
+        if (snd_pcm_htimestamp(handle, &avail, &tstamp) < 0)
+            return {};
+    } while (read != framesRead());
+
+    const qint64 usecs = QAlsaHelpers::elapsedUSecs(elapsedTime, tstamp);
+    if (usecs < 0)
+        return {};
+    // At tstamp the device had captured avail frames we have not read yet
+    return { read + qint64(avail), usecs };
+}
+
 void QAlsaAudioSource::suspend()
 {
     if(deviceState == QAudio::ActiveState||resuming) {
+        if (ioThread)
+            ioThread->stopIo();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -665,6 +822,15 @@ void QAlsaAudioSource::userFeed()
 
 bool QAlsaAudioSource::deviceReady()
 {
+    if (ioThread) {
+        // The I/O thread recovers from xruns itself
+        if (pullMode)
+            read(0, ioRing.used());
+        else
+            qobject_cast<AlsaInputPrivate*>(audioSource)->trigger();
+        return true;
+    }
+
     if(pullMode) {
         // reads some audio data and writes it to QIODevice
         read(0, buffer_size);
@@ -697,6 +863,8 @@ bool QAlsaAudioSource::deviceReady()
 
 void QAlsaAudioSource::reset()
 {
+    if (ioThread)
+        ioThread->stopIo();
     if(handle)
         snd_pcm_reset(handle);
     stop();
@@ -709,6 +877,203 @@ void QAlsaAudioSource::drain()
         snd_pcm_drain(handle);
 }
 
+qint64 QAlsaAudioSource::readFromRing(char *data, qint64 len)
+{
+    if (deviceState != QAudio::ActiveState && deviceState != QAudio::IdleState)
+        return 0;
+
+    qint64 bytesRead = 0;
+    if (pullMode) {
+        // Write from the ring straight into the user's device
+        qint64 l = 0;
+        while (!ioRing.isEmpty()) {
+            const QAudioRingBuffer::Region region = ioRing.readRegion();
+            qint64 size = region.size;
+            if (m_volume < 1.0f) {
+                // Scaled a period at a time, so nothing is allocated here
+                size = qMin<qint64>(size, volumeBuffer.size());
+                QAudioHelperInternal::qMultiplySamples(m_volume, settings, region.data,
+                                                       volumeBuffer.data(), int(size));
+                l = audioSource->write(volumeBuffer.constData(), size);
+            } else {
+                l = audioSource->write(region.data, size);
+            }
+            if (l <= 0)
+                break;
+            ioRing.consume(l);
+            bytesRead += l;
+            if (l < size)
+                break;
+        }
+
+        if (l < 0) {
+            close();
+            errorState = QAudio::IOError;
+            deviceState = QAudio::StoppedState;
+            emit stateChanged(deviceState);
+            return 0;
+        }
+        if (l == 0 && bytesRead == 0) {
+            if (deviceState != QAudio::IdleState) {
+                errorState = QAudio::NoError;
+                deviceState = QAudio::IdleState;
+                emit stateChanged(deviceState);
+            }
+            return 0;
+        }
+    } else {
+        len = qMin<qint64>(len, ioRing.used());
+        while (bytesRead < len) {
+            const QAudioRingBuffer::Region region = ioRing.readRegion();
+            const qint64 chunk = qMin<qint64>(region.size, len - bytesRead);
+            if (chunk <= 0)
+                break;
+            if (m_volume < 1.0f)
+                QAudioHelperInternal::qMultiplySamples(m_volume, settings, region.data,
+                                                       data + bytesRead, int(chunk));
+            else
+                memcpy(data + bytesRead, region.data, chunk);
+            ioRing.consume(chunk);
+            bytesRead += chunk;
+        }
+        if (bytesRead == 0)
+            return 0;
+    }
+
+    totalTimeValue += bytesRead;
+    resuming = false;
+    if (deviceState != QAudio::ActiveState) {
+        errorState = QAudio::NoError;
+        deviceState = QAudio::ActiveState;
+        emit stateChanged(deviceState);
+    }
+    return bytesRead;
+}
+
+/*
+    Delivers captured data directly from the hardware buffer: to the user's
+    device in pull mode, or into \a data otherwise. Only the frames that
+    were delivered are released to the device.
+*/
+qint64 QAlsaAudioSource::mmapRead(char *data, qint64 len)
+{
+    if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED)
+        snd_pcm_start(handle);
+
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+    if (avail < 0) {
+        xrun_recovery(int(avail));
+        if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED)
+            snd_pcm_start(handle);
+        avail = snd_pcm_avail_update(handle);
+        if (avail < 0) {
+            // recovery failed must stop and set error.
+            close();
+            errorState = QAudio::IOError;
+            deviceState = QAudio::StoppedState;
+            emit stateChanged(deviceState);
+            return 0;
+        }
+    }
+
+    snd_pcm_uframes_t frames = avail;
+    if (!pullMode)
+        frames = qMin<snd_pcm_uframes_t>(frames, snd_pcm_bytes_to_frames(handle, len));
+
+    qint64 bytesRead = 0;
+    qint64 l = 0;
+    while (frames > 0) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames;
+        // Scaled data goes through volumeBuffer, so take at most a period
+        if (pullMode && m_volume < 1.0f)
+            count = qMin<snd_pcm_uframes_t>(count, snd_pcm_bytes_to_frames(handle, volumeBuffer.size()));
+        int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0) {
+            xrun_recovery(err);
+            break;
+        }
+        const char *area = QAlsaHelpers::mmapAddress(areas, offset);
+        const qint64 bytes = snd_pcm_frames_to_bytes(handle, count);
+
+        if (pullMode) {
+            if (m_volume < 1.0f) {
+                QAudioHelperInternal::qMultiplySamples(m_volume, settings, area, volumeBuffer.data(), int(bytes));
+                l = audioSource->write(volumeBuffer.constData(), bytes);
+            } else {
+                l = audioSource->write(area, bytes);
+            }
+        } else {
+            l = bytes;
+            if (m_volume < 1.0f)
+                QAudioHelperInternal::qMultiplySamples(m_volume, settings, area, data + bytesRead, int(bytes));
+            else
+                memcpy(data + bytesRead, area, bytes);
+        }
+
+        const snd_pcm_uframes_t consumed = l > 0 ? snd_pcm_bytes_to_frames(handle, l) : 0;
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, consumed);
+        if (committed < 0 || snd_pcm_uframes_t(committed) != consumed) {
+            xrun_recovery(committed < 0 ? int(committed) : -EPIPE);
+            break;
+        }
+        bytesRead += snd_pcm_frames_to_bytes(handle, committed);
+        frames -= committed;
+        if (l < bytes)
+            break;
+    }
+
+    if (l < 0 && bytesRead == 0) {
+        close();
+        errorState = QAudio::IOError;
+        deviceState = QAudio::StoppedState;
+        emit stateChanged(deviceState);
+        return 0;
+    }
+    if (bytesRead == 0) {
+        if (pullMode && avail > 0 && deviceState != QAudio::IdleState) {
+            errorState = QAudio::NoError;
+            deviceState = QAudio::IdleState;
+            emit stateChanged(deviceState);
+        }
+        return 0;
+    }
+
+    bytesAvailable -= bytesRead;
+    totalTimeValue += bytesRead;
+    resuming = false;
+    if (deviceState != QAudio::ActiveState) {
+        errorState = QAudio::NoError;
+        deviceState = QAudio::ActiveState;
+        emit stateChanged(deviceState);
+    }
+    return bytesRead;
+}
+
+void QAlsaAudioSource::ioProgress()
+{
+    if (!ioThread)
+        return;
+    ioThread->acknowledge();
+    userFeed();
+}
+
+void QAlsaAudioSource::ioXrun()
+{
+    errorState = QAudio::UnderrunError;
+    emit errorChanged(errorState);
+}
+
+void QAlsaAudioSource::ioError(int error)
+{
+    qWarning() << "QAudioSource: I/O error:" << snd_strerror(error);
+    close();
+    errorState = QAudio::IOError;
+    deviceState = QAudio::StoppedState;
+    emit stateChanged(deviceState);
+}
+
 AlsaInputPrivate::AlsaInputPrivate(QAlsaAudioSource* audio)
 {
     audioDevice = qobject_cast<QAlsaAudioSource*>(audio);
@@ -65,9 +65,11 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodevice.h>
 #include <private/qaudiosystem_p.h>
+#include <private/qaudioringbuffer_p.h>
 
 QT_BEGIN_NAMESPACE
 
+class QAlsaAudioThread;
 
 class AlsaInputPrivate;
 
@@ -105,6 +107,7 @@ public:
 
     void start(QIODevice* device) override;
     QIODevice* start() override;
+    void startCapturing(QAudioSource::CaptureCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -113,12 +116,17 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
+    QAudioTimestamp timestamp() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat& fmt) override;
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
+
+    int xrunCount() const override;
+
     bool resuming;
     snd_pcm_t* handle;
     qint64 totalTimeValue;
@@ -130,6 +138,9 @@ public:
 private slots:
     void userFeed();
     bool deviceReady();
+    void ioProgress();
+    void ioXrun();
+    void ioError(int error);
 
 private:
     int checkBytesReady();
@@ -137,7 +148,10 @@ private:
     int setFormat();
     bool open();
     void close();
+    qint64 framesRead() const;
     void drain();
+    qint64 readFromRing(char *data, qint64 len);
+    qint64 mmapRead(char *data, qint64 len);
 
     QTimer* timer;
     qint64 elapsedTimeOffset;
@@ -155,6 +169,14 @@ private:
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
     qreal m_volume;
+    int xruns;
+    // Only used with the I/O thread
+    QAudioRingBuffer ioRing;
+    QAlsaAudioThread *ioThread;
+    // One period scaled by the volume on its way to audioSource
+    QByteArray volumeBuffer;
+    // Called on the I/O thread instead of writing to audioSource
+    QAudioSource::CaptureCallback captureCallback;
 };
 
 class AlsaInputPrivate : public QIODevice
@@ -0,0 +1,405 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qalsaaudiothread_p.h"
+#include "qalsahelpers_p.h"
+
+#include <private/qaudiohelpers_p.h>
+#include <private/qaudioringbuffer_p.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(lcAlsaThread, "qt.multimedia.alsa.thread")
+
+QAlsaAudioThread::QAlsaAudioThread(snd_pcm_t *handle, snd_pcm_stream_t stream, int bytesPerFrame,
+                                   snd_pcm_uframes_t periodFrames, unsigned int periodTime,
+                                   snd_pcm_access_t access, QAudioRingBuffer *ring, QObject *parent)
+    : QThread(parent),
+      m_handle(handle),
+      m_stream(stream),
+      m_bytesPerFrame(bytesPerFrame),
+      m_periodFrames(periodFrames),
+      // Only a safety net, poll() normally returns once per period
+      m_timeout(qMax(int(periodTime / 1000) * 4, 10)),
+      m_mmap(access == SND_PCM_ACCESS_MMAP_INTERLEAVED),
+      m_ring(ring)
+{
+    setObjectName(stream == SND_PCM_STREAM_PLAYBACK ? QStringLiteral("ALSA playback")
+                                                    : QStringLiteral("ALSA capture"));
+}
+
+QAlsaAudioThread::~QAlsaAudioThread()
+{
+    stopIo();
+    if (m_wakeFd >= 0)
+        ::close(m_wakeFd);
+}
+
+/*
+    The I/O thread is used when QT_ALSA_IO_THREAD is set to a non-zero value.
+*/
+bool QAlsaAudioThread::isEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_ALSA_IO_THREAD") != 0;
+    return enabled;
+}
+
+void QAlsaAudioThread::setCallback(Callback &&callback, const QAudioFormat &format)
+{
+    Q_ASSERT(!isRunning());
+    m_callback = std::move(callback);
+    m_format = format;
+    if (!m_mmap)
+        m_period.resize(qsizetype(m_periodFrames) * m_bytesPerFrame);
+}
+
+bool QAlsaAudioThread::startIo()
+{
+    if (m_wakeFd < 0)
+        m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        qCWarning(lcAlsaThread) << "cannot create eventfd:" << qt_error_string(errno);
+        return false;
+    }
+    // The counters keep running when the thread is restarted after a suspend
+    m_command.storeRelaxed(Run);
+    m_notifyPending.storeRelaxed(0);
+    start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void QAlsaAudioThread::stopIo(bool drain)
+{
+    if (!isRunning())
+        return;
+    m_command.storeRelease(drain ? Drain : Quit);
+    const quint64 one = 1;
+    if (::write(m_wakeFd, &one, sizeof(one)) < 0)
+        qCDebug(lcAlsaThread) << "cannot wake the I/O thread:" << qt_error_string(errno);
+    wait();
+}
+
+void QAlsaAudioThread::wake()
+{
+    if (!m_starved.loadAcquire())
+        return;
+    const quint64 one = 1;
+    if (::write(m_wakeFd, &one, sizeof(one)) < 0)
+        qCDebug(lcAlsaThread) << "cannot wake the I/O thread:" << qt_error_string(errno);
+}
+
+void QAlsaAudioThread::run()
+{
+    const int count = snd_pcm_poll_descriptors_count(m_handle);
+    if (count <= 0) {
+        emit ioError(count < 0 ? count : -EINVAL);
+        return;
+    }
+    // The last descriptor is the eventfd wake() and stopIo() write to
+    QVarLengthArray<pollfd, 4> fds(count + 1);
+    snd_pcm_poll_descriptors(m_handle, fds.data(), count);
+    fds[count].fd = m_wakeFd;
+    fds[count].events = POLLIN;
+    fds[count].revents = 0;
+
+    if (m_callback) {
+        runCallback(fds.data(), count);
+        return;
+    }
+
+    const bool playback = m_stream == SND_PCM_STREAM_PLAYBACK;
+    // Capture data that does not fit into the ring is read here and dropped
+    QVarLengthArray<char, 4096> overflow(playback || m_mmap ? 0 : qsizetype(m_periodFrames) * m_bytesPerFrame);
+
+    while (true) {
+        const int command = m_command.loadAcquire();
+        if (command == Quit || (command == Drain && !playback))
+            break;
+
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(m_handle);
+        if (avail < 0) {
+            if (!recover(int(avail)))
+                break;
+            continue;
+        }
+
+        if (playback) {
+            const snd_pcm_sframes_t pending = m_ring->used() / m_bytesPerFrame;
+            if (pending == 0) {
+                if (command == Drain)
+                    break;
+                waitForWake(&fds[count]);
+                continue;
+            }
+            if (avail < qMin(pending, snd_pcm_sframes_t(m_periodFrames))) {
+                if (!waitForDevice(fds.data(), count))
+                    break;
+                continue;
+            }
+
+            const QAudioRingBuffer::Region region = m_ring->readRegion();
+            const snd_pcm_sframes_t frames = qMin(avail, snd_pcm_sframes_t(region.size / m_bytesPerFrame));
+            const snd_pcm_sframes_t written = transfer(region.data, frames);
+            if (written < 0) {
+                if (!recover(int(written)))
+                    break;
+                continue;
+            }
+            m_ring->consume(written * m_bytesPerFrame);
+            m_frames.fetchAndAddRelaxed(written);
+            notify();
+        } else {
+            if (avail < snd_pcm_sframes_t(m_periodFrames)) {
+                if (!waitForDevice(fds.data(), count))
+                    break;
+                continue;
+            }
+
+            const QAudioRingBuffer::Region region = m_ring->writeRegion();
+            snd_pcm_sframes_t frames = qMin(avail, snd_pcm_sframes_t(region.size / m_bytesPerFrame));
+            if (frames == 0) {
+                // The user side is not reading; keep the device running and
+                // count the lost data like an overrun of the device itself
+                frames = qMin(avail, snd_pcm_sframes_t(m_periodFrames));
+                const snd_pcm_sframes_t read = m_mmap ? mmapTransfer(nullptr, frames)
+                                                      : snd_pcm_readi(m_handle, overflow.data(), frames);
+                if (read < 0) {
+                    if (!recover(int(read)))
+                        break;
+                    continue;
+                }
+                m_xruns.fetchAndAddRelaxed(1);
+                emit xrun();
+                continue;
+            }
+            const snd_pcm_sframes_t read = transfer(region.data, frames);
+            if (read < 0) {
+                if (!recover(int(read)))
+                    break;
+                continue;
+            }
+            m_ring->commit(read * m_bytesPerFrame);
+            m_frames.fetchAndAddRelaxed(read);
+            notify();
+        }
+    }
+}
+
+/*
+    Hands one period at a time to the callback: the hardware buffer itself with
+    mmap, or m_period, which snd_pcm_writei()/snd_pcm_readi() then transfer.
+*/
+void QAlsaAudioThread::runCallback(pollfd *fds, int count)
+{
+    const bool playback = m_stream == SND_PCM_STREAM_PLAYBACK;
+    m_appliedVolume = m_volume.load(std::memory_order_relaxed);
+
+    // Nothing is buffered on this side, so draining has nothing left to write
+    while (m_command.loadAcquire() == Run) {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(m_handle);
+        if (avail < 0) {
+            if (!recover(int(avail)))
+                break;
+            continue;
+        }
+        if (avail < snd_pcm_sframes_t(m_periodFrames)) {
+            if (!waitForDevice(fds, count))
+                break;
+            continue;
+        }
+
+        if (playback && !m_mmap) {
+            m_callback(QAudioFrameSpan(m_period.data(), qsizetype(m_periodFrames), m_format));
+            applyVolume(m_period.data(), qsizetype(m_periodFrames));
+        }
+        const snd_pcm_sframes_t done = transfer(m_period.data(), m_periodFrames);
+        if (done < 0) {
+            if (!recover(int(done)))
+                break;
+            continue;
+        }
+        if (!playback && !m_mmap && done > 0) {
+            applyVolume(m_period.data(), qsizetype(done));
+            m_callback(QAudioFrameSpan(m_period.data(), qsizetype(done), m_format));
+        }
+        m_frames.fetchAndAddRelaxed(done);
+        notify();
+    }
+}
+
+// Ramps from the previously applied volume like the other sink and source paths
+void QAlsaAudioThread::applyVolume(void *data, qsizetype frames)
+{
+    const qreal volume = m_volume.load(std::memory_order_relaxed);
+    if (volume < 1.0f || m_appliedVolume < 1.0f)
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, volume, m_format, data, data,
+                                               int(frames * m_bytesPerFrame));
+    m_appliedVolume = volume;
+}
+
+bool QAlsaAudioThread::waitForDevice(pollfd *fds, int count)
+{
+    const int ret = poll(fds, count + 1, m_timeout);
+    if (ret < 0 && errno != EINTR) {
+        emit ioError(-errno);
+        return false;
+    }
+    if (ret <= 0)
+        return true;
+    if (fds[count].revents)
+        clearWake();
+
+    unsigned short revents = 0;
+    snd_pcm_poll_descriptors_revents(m_handle, fds, count, &revents);
+    // An xrun shows up as POLLERR; the next snd_pcm_avail_update() reports it
+    return true;
+}
+
+void QAlsaAudioThread::waitForWake(pollfd *fd)
+{
+    m_starved.storeRelease(1);
+    // Check again, the user side may have written before it saw the flag
+    if (m_ring->isEmpty() && m_command.loadAcquire() == Run)
+        poll(fd, 1, m_timeout);
+    m_starved.storeRelease(0);
+    clearWake();
+}
+
+void QAlsaAudioThread::clearWake()
+{
+    quint64 value;
+    while (::read(m_wakeFd, &value, sizeof(value)) > 0)
+        ;
+}
+
+bool QAlsaAudioThread::recover(int error)
+{
+    if (error == -EPIPE) {
+        m_xruns.fetchAndAddRelaxed(1);
+        qCDebug(lcAlsaThread) << objectName() << "xrun";
+        emit xrun();
+    }
+    int err = snd_pcm_recover(m_handle, error, 1);
+    if (err >= 0 && m_stream == SND_PCM_STREAM_CAPTURE)
+        err = snd_pcm_start(m_handle);
+    if (err < 0) {
+        qCWarning(lcAlsaThread) << objectName() << "cannot recover:" << snd_strerror(err);
+        emit ioError(err);
+        return false;
+    }
+    return true;
+}
+
+snd_pcm_sframes_t QAlsaAudioThread::transfer(char *data, snd_pcm_uframes_t frames)
+{
+    if (m_mmap)
+        return mmapTransfer(data, frames);
+    if (m_stream == SND_PCM_STREAM_PLAYBACK)
+        return snd_pcm_writei(m_handle, data, frames);
+    return snd_pcm_readi(m_handle, data, frames);
+}
+
+/*
+    Copies between \a data and the hardware buffer, saving the copy into the
+    kernel that snd_pcm_writei()/snd_pcm_readi() would make. Captured frames
+    are skipped when \a data is null.
+*/
+snd_pcm_sframes_t QAlsaAudioThread::mmapTransfer(char *data, snd_pcm_uframes_t frames)
+{
+    const bool playback = m_stream == SND_PCM_STREAM_PLAYBACK;
+    snd_pcm_sframes_t transferred = 0;
+    while (snd_pcm_uframes_t(transferred) < frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames - transferred;
+        int err = snd_pcm_mmap_begin(m_handle, &areas, &offset, &count);
+        if (err < 0)
+            return transferred ? transferred : err;
+        if (count == 0)
+            break;
+
+        char *area = QAlsaHelpers::mmapAddress(areas, offset);
+        const qsizetype bytes = qsizetype(count) * m_bytesPerFrame;
+        if (m_callback && playback) {
+            m_callback(QAudioFrameSpan(area, qsizetype(count), m_format));
+            applyVolume(area, qsizetype(count));
+        } else if (m_callback) {
+            applyVolume(area, qsizetype(count));
+            m_callback(QAudioFrameSpan(area, qsizetype(count), m_format));
+        } else if (playback) {
+            memcpy(area, data + transferred * m_bytesPerFrame, bytes);
+        } else if (data) {
+            memcpy(data + transferred * m_bytesPerFrame, area, bytes);
+        }
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_handle, offset, count);
+        if (committed < 0 || snd_pcm_uframes_t(committed) != count)
+            return transferred ? transferred : (committed < 0 ? committed : -EPIPE);
+        transferred += committed;
+    }
+
+    // Unlike snd_pcm_writei(), committing doesn't start the stream
+    if (playback && transferred > 0 && snd_pcm_state(m_handle) == SND_PCM_STATE_PREPARED) {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(m_handle);
+        snd_pcm_uframes_t bufferFrames = 0;
+        snd_pcm_uframes_t periodFrames = 0;
+        snd_pcm_get_params(m_handle, &bufferFrames, &periodFrames);
+        if (avail >= 0 && bufferFrames - snd_pcm_uframes_t(avail) >= m_periodFrames)
+            snd_pcm_start(m_handle);
+    }
+    return transferred;
+}
+
+void QAlsaAudioThread::notify()
+{
+    if (m_notifyPending.testAndSetAcquire(0, 1))
+        emit progress();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qalsaaudiothread_p.cpp"
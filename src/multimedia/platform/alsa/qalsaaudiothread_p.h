@@ -0,0 +1,153 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QALSAAUDIOTHREAD_P_H
+#define QALSAAUDIOTHREAD_P_H
+
+#include <alsa/asoundlib.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qthread.h>
+#include <QtMultimedia/qaudiobuffer.h>
+
+#include <atomic>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioRingBuffer;
+
+// Moves audio between a PCM handle and a QAudioRingBuffer on its own thread.
+// It sleeps in poll() on the PCM descriptors, so the timing does not depend
+// on how busy the thread of the QAudioSink or QAudioSource is; that thread
+// only needs to keep the ring filled (playback) or emptied (capture).
+// With a callback set, no ring is used: the callback renders or receives
+// every period directly on this thread.
+class QAlsaAudioThread : public QThread
+{
+    Q_OBJECT
+public:
+    QAlsaAudioThread(snd_pcm_t *handle, snd_pcm_stream_t stream, int bytesPerFrame,
+                     snd_pcm_uframes_t periodFrames, unsigned int periodTime,
+                     snd_pcm_access_t access, QAudioRingBuffer *ring, QObject *parent = nullptr);
+    ~QAlsaAudioThread();
+
+    static bool isEnabled();
+
+    using Callback = std::function<void(QAudioFrameSpan)>;
+    // Must be called before startIo()
+    void setCallback(Callback &&callback, const QAudioFormat &format);
+    // Scales what the callback renders or receives, can be called from any thread
+    void setVolume(qreal volume) { m_volume.store(volume, std::memory_order_relaxed); }
+
+    bool startIo();
+    // With drain, playback only stops once everything in the ring was written
+    void stopIo(bool drain = false);
+
+    // Called from the user side after it wrote to or read from the ring
+    void wake();
+    // Allows the next progress() signal
+    void acknowledge() { m_notifyPending.storeRelease(0); }
+
+    int xrunCount() const { return m_xruns.loadRelaxed(); }
+    qint64 framesTransferred() const { return m_frames.loadRelaxed(); }
+
+Q_SIGNALS:
+    // The ring was emptied (playback) or filled (capture) some more. Not
+    // emitted again until acknowledge() is called.
+    void progress();
+    void xrun();
+    void ioError(int error);
+
+protected:
+    void run() override;
+
+private:
+    enum Command { Run, Drain, Quit };
+
+    void runCallback(struct pollfd *fds, int count);
+
+    bool waitForDevice(struct pollfd *fds, int count);
+    void waitForWake(struct pollfd *fd);
+    void clearWake();
+    bool recover(int error);
+    void notify();
+    void applyVolume(void *data, qsizetype frames);
+    snd_pcm_sframes_t transfer(char *data, snd_pcm_uframes_t frames);
+    snd_pcm_sframes_t mmapTransfer(char *data, snd_pcm_uframes_t frames);
+
+    snd_pcm_t *m_handle;
+    snd_pcm_stream_t m_stream;
+    int m_bytesPerFrame;
+    snd_pcm_uframes_t m_periodFrames;
+    int m_timeout;
+    bool m_mmap;
+    QAudioRingBuffer *m_ring;
+    int m_wakeFd = -1;
+    Callback m_callback;
+    QAudioFormat m_format;
+    // One period for the callback when not using mmap
+    QByteArray m_period;
+    std::atomic<qreal> m_volume = 1.;
+    // Only touched by the I/O thread
+    qreal m_appliedVolume = 1.;
+
+    QAtomicInt m_command = Run;
+    QAtomicInt m_starved = 0;
+    QAtomicInt m_notifyPending = 0;
+    QAtomicInt m_xruns = 0;
+    QAtomicInteger<qint64> m_frames = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QALSAAUDIOTHREAD_P_H
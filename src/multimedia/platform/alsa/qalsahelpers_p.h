@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QALSAHELPERS_P_H
+#define QALSAHELPERS_P_H
+
+#include <alsa/asoundlib.h>
+
+#include <QtCore/qglobal.h>
+#include <QtCore/qelapsedtimer.h>
+
+#include <time.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAlsaHelpers
+{
+
+// Memory mapped access is used when QT_ALSA_MMAP is set to a non-zero value.
+// Data then goes straight into (or out of) the hardware buffer instead of
+// being copied by snd_pcm_writei()/snd_pcm_readi().
+inline bool useMmap()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_ALSA_MMAP") != 0;
+    return enabled;
+}
+
+// Sets *access on the hardware parameters. A device that refuses memory
+// mapped access falls back to read/write access, and *access is updated.
+inline int setAccess(snd_pcm_t *handle, snd_pcm_hw_params_t *hwparams, snd_pcm_access_t *access)
+{
+    int err = snd_pcm_hw_params_set_access(handle, hwparams, *access);
+    if (err < 0 && *access == SND_PCM_ACCESS_MMAP_INTERLEAVED) {
+        *access = SND_PCM_ACCESS_RW_INTERLEAVED;
+        err = snd_pcm_hw_params_set_access(handle, hwparams, *access);
+    }
+    return err;
+}
+
+// With interleaved access all channels share the first area
+inline char *mmapAddress(const snd_pcm_channel_area_t *areas, snd_pcm_uframes_t offset)
+{
+    return static_cast<char *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+}
+
+// Makes snd_pcm_htimestamp() report CLOCK_MONOTONIC, the clock QElapsedTimer
+// runs on. Older alsa-lib versions only have gettimeofday() timestamps.
+inline void enableTimestamps(snd_pcm_t *handle, snd_pcm_sw_params_t *swparams)
+{
+    snd_pcm_sw_params_set_tstamp_mode(handle, swparams, SND_PCM_TSTAMP_ENABLE);
+#if SND_LIB_VERSION >= 0x01001c
+    snd_pcm_sw_params_set_tstamp_type(handle, swparams, SND_PCM_TSTAMP_TYPE_MONOTONIC);
+#endif
+}
+
+// Converts a timestamp from snd_pcm_htimestamp() into microseconds on \a timer.
+// Returns -1 if the device did not provide a timestamp.
+inline qint64 elapsedUSecs(const QElapsedTimer &timer, const snd_htimestamp_t &tstamp)
+{
+    if (!timer.isValid() || (tstamp.tv_sec == 0 && tstamp.tv_nsec == 0))
+        return -1;
+#if SND_LIB_VERSION >= 0x01001c
+    const clockid_t clock = CLOCK_MONOTONIC;
+#else
+    const clockid_t clock = CLOCK_REALTIME;
+#endif
+    timespec now;
+    clock_gettime(clock, &now);
+    const qint64 age = qint64(now.tv_sec - tstamp.tv_sec) * 1000000000 + (now.tv_nsec - tstamp.tv_nsec);
+    return (timer.nsecsElapsed() - age) / 1000;
+}
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QALSAHELPERS_P_H
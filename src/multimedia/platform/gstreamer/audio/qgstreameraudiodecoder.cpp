@@ -42,6 +42,7 @@
 #include "private/qgstreamermessage_p.h"
 
 #include <private/qgstutils_p.h>
+#include <private/qabstractaudiobuffer_p.h>
 
 #include <gst/gstvalue.h>
 #include <gst/base/gstbasesrc.h>
@@ -71,6 +72,32 @@ typedef enum {
     GST_PLAY_FLAG_BUFFERING     = 0x000000100
 } GstPlayFlags;
 
+// Keeps a GstBuffer mapped for as long as a QAudioBuffer uses its samples
+class QGstAudioBuffer : public QAbstractAudioBuffer
+{
+public:
+    explicit QGstAudioBuffer(GstBuffer *buffer)
+        : m_buffer(gst_buffer_ref(buffer))
+    {
+        m_mapped = gst_buffer_map(m_buffer, &m_mapInfo, GST_MAP_READ);
+    }
+
+    ~QGstAudioBuffer() override
+    {
+        if (m_mapped)
+            gst_buffer_unmap(m_buffer, &m_mapInfo);
+        gst_buffer_unref(m_buffer);
+    }
+
+    const void *constData() const override { return m_mapped ? m_mapInfo.data : nullptr; }
+    qsizetype byteCount() const override { return m_mapped ? qsizetype(m_mapInfo.size) : 0; }
+
+private:
+    GstBuffer *m_buffer;
+    GstMapInfo m_mapInfo;
+    bool m_mapped = false;
+};
+
 
 
 QGstreamerAudioDecoder::QGstreamerAudioDecoder(QAudioDecoder *parent)
@@ -137,6 +164,12 @@ void QGstreamerAudioDecoder::configureAppSrcElement(GObject* object, GObject *or
 }
 #endif
 
+GstMessageType QGstreamerAudioDecoder::busMessageTypes() const
+{
+    return GstMessageType(GST_MESSAGE_DURATION_CHANGED | GST_MESSAGE_STATE_CHANGED | GST_MESSAGE_EOS
+                          | GST_MESSAGE_ERROR | GST_MESSAGE_WARNING | GST_MESSAGE_INFO);
+}
+
 bool QGstreamerAudioDecoder::processBusMessage(const QGstreamerMessage &message)
 {
     GstMessage* gm = message.rawMessage();
@@ -409,29 +442,30 @@ QAudioBuffer QGstreamerAudioDecoder::read()
         if (buffersAvailable == 1)
             emit bufferAvailableChanged(false);
 
-        const char* bufferData = nullptr;
-        int bufferSize = 0;
-
         GstSample *sample = gst_app_sink_pull_sample(m_appSink);
         GstBuffer *buffer = gst_sample_get_buffer(sample);
-        GstMapInfo mapInfo;
-        gst_buffer_map(buffer, &mapInfo, GST_MAP_READ);
-        bufferData = (const char*)mapInfo.data;
-        bufferSize = mapInfo.size;
         QAudioFormat format = QGstUtils::audioFormatForSample(sample);
 
         if (format.isValid()) {
-            // XXX At the moment we have to copy data from GstBuffer into QAudioBuffer.
-            // We could improve performance by implementing QAbstractAudioBuffer for GstBuffer.
             qint64 position = getPositionFromBuffer(buffer);
-            audioBuffer = QAudioBuffer(QByteArray((const char*)bufferData, bufferSize), format, position);
+            if (buffer->pool) {
+                // Holding on to a pooled buffer could stall the decoder, copy it
+                GstMapInfo mapInfo;
+                if (gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
+                    audioBuffer = QAudioBuffer(QByteArray((const char*)mapInfo.data, mapInfo.size),
+                                               format, position);
+                    gst_buffer_unmap(buffer, &mapInfo);
+                }
+            } else {
+                // The samples stay mapped until the last copy of the QAudioBuffer is gone
+                audioBuffer = QAudioBuffer(new QGstAudioBuffer(buffer), format, position);
+            }
             position /= 1000; // convert to milliseconds
             if (position != m_position) {
                 m_position = position;
                 emit positionChanged(m_position);
             }
         }
-        gst_buffer_unmap(buffer, &mapInfo);
         gst_sample_unref(sample);
     }
 
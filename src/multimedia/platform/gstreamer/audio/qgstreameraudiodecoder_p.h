@@ -101,6 +101,7 @@ public:
 
     // GStreamerBusMessageFilter interface
     bool processBusMessage(const QGstreamerMessage &message) override;
+    GstMessageType busMessageTypes() const override;
 
 #if QT_CONFIG(gstreamer_app)
     QGstAppSrc *appsrc() const { return m_appSrc; }
@@ -135,6 +135,7 @@ void QGStreamerAudioSink::start(QIODevice *device)
 
     m_pullMode = true;
     m_audioSource = device;
+    m_renderCallback = nullptr;
 
     if (!open()) {
         m_audioSource = nullptr;
@@ -158,6 +159,7 @@ QIODevice *QGStreamerAudioSink::start()
     }
 
     m_pullMode = false;
+    m_renderCallback = nullptr;
 
     if (!open())
         return nullptr;
@@ -170,6 +172,99 @@ QIODevice *QGStreamerAudioSink::start()
     return m_audioSource;
 }
 
+void QGStreamerAudioSink::startRendering(QAudioSink::RenderCallback &&callback)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Only replace the callback once close() stopped the streaming thread
+    close();
+
+    if (!m_format.isValid()) {
+        setError(QAudio::OpenError);
+        return;
+    }
+
+    m_pullMode = true;
+    m_audioSource = nullptr;
+    m_renderCallback = std::move(callback);
+
+    if (!open()) {
+        m_renderCallback = nullptr;
+        setError(QAudio::OpenError);
+        return;
+    }
+
+    setState(QAudio::ActiveState);
+}
+
+/*!
+    \internal
+
+    Makes the appsrc ask renderNeedData() for data on its streaming thread. Every
+    request is answered with one period from a buffer pool, so after the pool has
+    warmed up rendering does not allocate.
+*/
+bool QGStreamerAudioSink::setupRendering()
+{
+    auto *appSrc = GST_APP_SRC(gstAppSrc.element());
+
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    qsizetype periodSize = m_bufferSize > 0 ? m_bufferSize / 4 : m_format.bytesForDuration(20000);
+    periodSize = qMax<qsizetype>(periodSize - periodSize % bytesPerFrame, bytesPerFrame);
+
+    m_renderPool = gst_buffer_pool_new();
+    GstStructure *config = gst_buffer_pool_get_config(m_renderPool);
+    gst_buffer_pool_config_set_params(config, nullptr, guint(periodSize), 4, 0);
+    if (!gst_buffer_pool_set_config(m_renderPool, config)
+        || !gst_buffer_pool_set_active(m_renderPool, TRUE)) {
+        qWarning() << "QAudioSink: could not set up a buffer pool for rendering";
+        gst_object_unref(m_renderPool);
+        m_renderPool = nullptr;
+        return false;
+    }
+
+    m_appSrc->setAudioFormat(m_format);
+    gst_app_src_set_stream_type(appSrc, GST_APP_STREAM_TYPE_STREAM);
+    gst_app_src_set_size(appSrc, -1);
+
+    GstAppSrcCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.need_data = &QGStreamerAudioSink::renderNeedData;
+    gst_app_src_set_callbacks(appSrc, &callbacks, this, nullptr);
+
+    m_framesRendered.storeRelaxed(0);
+    return true;
+}
+
+void QGStreamerAudioSink::renderNeedData(GstAppSrc *appSrc, guint length, gpointer userData)
+{
+    Q_UNUSED(length);
+    auto *self = static_cast<QGStreamerAudioSink *>(userData);
+
+    GstBuffer *buffer = nullptr;
+    if (gst_buffer_pool_acquire_buffer(self->m_renderPool, &buffer, nullptr) != GST_FLOW_OK)
+        return;
+
+    GstMapInfo mapInfo;
+    if (!gst_buffer_map(buffer, &mapInfo, GST_MAP_WRITE)) {
+        gst_buffer_unref(buffer);
+        return;
+    }
+    const int sampleRate = self->m_format.sampleRate();
+    const qsizetype frames = qsizetype(mapInfo.size) / self->m_format.bytesPerFrame();
+    self->m_renderCallback(QAudioFrameSpan(mapInfo.data, frames, self->m_format));
+    gst_buffer_unmap(buffer, &mapInfo);
+
+    const qint64 rendered = self->m_framesRendered.loadRelaxed();
+    GST_BUFFER_TIMESTAMP(buffer) = gst_util_uint64_scale(rendered, GST_SECOND, sampleRate);
+    GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(frames, GST_SECOND, sampleRate);
+    self->m_framesRendered.storeRelaxed(rendered + frames);
+
+    // Takes over the buffer, which returns to the pool once the device has played it
+    gst_app_src_push_buffer(appSrc, buffer);
+}
+
 #if 0
 static void padAdded(GstElement *element, GstPad *pad, gpointer data)
 {
@@ -186,6 +281,11 @@ static void padAdded(GstElement *element, GstPad *pad, gpointer data)
 }
 #endif
 
+GstMessageType QGStreamerAudioSink::busMessageTypes() const
+{
+    return GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+}
+
 bool QGStreamerAudioSink::processBusMessage(const QGstreamerMessage &message)
 {
     auto *msg = message.rawMessage();
@@ -225,8 +325,15 @@ bool QGStreamerAudioSink::open()
     }
 
 //    qDebug() << "GST caps:" << gst_caps_to_string(caps);
-    m_appSrc->setup(m_audioSource, m_audioSource ? m_audioSource->pos() : 0);
-    m_appSrc->setAudioFormat(m_format);
+    if (m_renderCallback) {
+        if (!setupRendering()) {
+            setState(QAudio::StoppedState);
+            return false;
+        }
+    } else {
+        m_appSrc->setup(m_audioSource, m_audioSource ? m_audioSource->pos() : 0);
+        m_appSrc->setAudioFormat(m_format);
+    }
 
     /* run */
     gstPipeline.setState(GST_STATE_PLAYING);
@@ -247,6 +354,13 @@ void QGStreamerAudioSink::close()
     if (!gstPipeline.setStateSync(GST_STATE_NULL))
         qWarning() << "failed to close the audio output stream";
 
+    if (m_renderPool) {
+        // Buffers still in use are freed when they are returned to the inactive pool
+        gst_buffer_pool_set_active(m_renderPool, FALSE);
+        gst_object_unref(m_renderPool);
+        m_renderPool = nullptr;
+    }
+
     if (!m_pullMode && m_audioSource)
         delete m_audioSource;
     m_audioSource = nullptr;
@@ -279,6 +393,8 @@ qsizetype QGStreamerAudioSink::bytesFree() const
 {
     if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
         return 0;
+    if (m_renderCallback)
+        return 0;
 
     return m_appSrc->canAcceptMoreData() ? 4096*4 : 0;
 }
@@ -297,6 +413,9 @@ qsizetype QGStreamerAudioSink::bufferSize() const
 
 qint64 QGStreamerAudioSink::processedUSecs() const
 {
+    if (m_renderCallback)
+        return m_framesRendered.loadRelaxed() * 1000000 / m_format.sampleRate();
+
     qint64 result = qint64(1000000) * m_bytesProcessed /
         m_format.bytesPerFrame() /
         m_format.sampleRate();
@@ -304,6 +423,30 @@ qint64 QGStreamerAudioSink::processedUSecs() const
     return result;
 }
 
+qint64 QGStreamerAudioSink::latencyUSecs() const
+{
+    const QAudioTimestamp played = timestamp();
+    if (!played.isValid())
+        return -1;
+    // Everything handed to appsrc that has not been heard yet
+    const qint64 playedUSecs = played.frame * 1000000 / m_format.sampleRate();
+    return qMax<qint64>(processedUSecs() - playedUSecs, 0);
+}
+
+QAudioTimestamp QGStreamerAudioSink::timestamp() const
+{
+    if (gstPipeline.isNull() || !elapsedTime.isValid())
+        return {};
+
+    // The audio sink answers with the position being played out, which
+    // already accounts for the delay of the device.
+    gint64 position = 0;
+    if (!gst_element_query_position(gstPipeline.element(), GST_FORMAT_TIME, &position))
+        return {};
+    const qint64 frame = gst_util_uint64_scale_int(position, m_format.sampleRate(), GST_SECOND);
+    return { frame, elapsedTime.nsecsElapsed() / 1000 };
+}
+
 void QGStreamerAudioSink::resume()
 {
     if (m_deviceState == QAudio::SuspendedState) {
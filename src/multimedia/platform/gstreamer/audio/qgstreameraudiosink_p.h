@@ -57,6 +57,7 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qatomic.h>
 #include <QtCore/private/qringbuffer_p.h>
 
 #include "qaudio.h"
@@ -65,6 +66,7 @@
 
 #include <private/qgst_p.h>
 #include <private/qgstpipeline_p.h>
+#include <gst/app/gstappsrc.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -83,6 +85,7 @@ public:
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void startRendering(QAudioSink::RenderCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -91,6 +94,8 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
+    QAudioTimestamp timestamp() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat &format) override;
@@ -108,11 +113,15 @@ private:
     void setError(QAudio::Error error);
 
     bool processBusMessage(const QGstreamerMessage &message) override;
+    GstMessageType busMessageTypes() const override;
 
     bool open();
     void close();
     qint64 write(const char *data, qint64 len);
 
+    bool setupRendering();
+    static void renderNeedData(GstAppSrc *appSrc, guint length, gpointer userData);
+
 private:
     QByteArray m_device;
     QAudioFormat m_format;
@@ -133,6 +142,11 @@ private:
     QGstElement gstVolume;
     QGstElement gstAppSrc;
     QGstAppSrc *m_appSrc = nullptr;
+
+    // Called on the appsrc streaming thread instead of pulling from m_audioSource
+    QAudioSink::RenderCallback m_renderCallback;
+    GstBufferPool *m_renderPool = nullptr;
+    QAtomicInteger<qint64> m_framesRendered = 0;
 };
 
 class GStreamerOutputPrivate : public QIODevice
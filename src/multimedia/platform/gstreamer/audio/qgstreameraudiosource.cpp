@@ -44,6 +44,7 @@
 
 #include "qgstreameraudiosource_p.h"
 #include "qgstreameraudiodevice_p.h"
+#include <private/qgstreamermessage_p.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -112,6 +113,8 @@ void QGStreamerAudioSource::start(QIODevice *device)
 
     close();
 
+    m_captureCallback = nullptr;
+
     if (!open())
         return;
 
@@ -121,6 +124,25 @@ void QGStreamerAudioSource::start(QIODevice *device)
     setState(QAudio::ActiveState);
 }
 
+void QGStreamerAudioSource::startCapturing(QAudioSource::CaptureCallback &&callback)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Only replace the callback once close() stopped the streaming thread
+    close();
+
+    m_pullMode = true;
+    m_captureCallback = std::move(callback);
+
+    if (!open()) {
+        m_captureCallback = nullptr;
+        return;
+    }
+
+    setState(QAudio::ActiveState);
+}
+
 QIODevice *QGStreamerAudioSource::start()
 {
     setState(QAudio::StoppedState);
@@ -128,6 +150,8 @@ QIODevice *QGStreamerAudioSource::start()
 
     close();
 
+    m_captureCallback = nullptr;
+
     if (!open())
         return nullptr;
 
@@ -185,10 +209,7 @@ bool QGStreamerAudioSource::open()
 #endif
 
     gstPipeline = QGstPipeline("pipeline");
-
-    auto *gstBus = gst_pipeline_get_bus(gstPipeline.pipeline());
-    gst_bus_add_watch(gstBus, &QGStreamerAudioSource::busMessage, this);
-    gst_object_unref (gstBus);
+    gstPipeline.installMessageFilter(this);
 
     gstAppSink = createAppSink();
     gstAppSink.set("caps", gstCaps);
@@ -208,6 +229,7 @@ bool QGStreamerAudioSource::open()
     m_timeStamp.restart();
     m_elapsedTimeOffset = 0;
     m_bytesWritten = 0;
+    m_framesCaptured.storeRelaxed(0);
 
     return true;
 }
@@ -230,15 +252,20 @@ void QGStreamerAudioSource::close()
     m_opened = false;
 }
 
-gboolean QGStreamerAudioSource::busMessage(GstBus *, GstMessage *msg, gpointer user_data)
+GstMessageType QGStreamerAudioSource::busMessageTypes() const
 {
-    QGStreamerAudioSource *input = static_cast<QGStreamerAudioSource *>(user_data);
+    return GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+}
+
+bool QGStreamerAudioSource::processBusMessage(const QGstreamerMessage &message)
+{
+    auto *msg = message.rawMessage();
     switch (GST_MESSAGE_TYPE (msg)) {
     case GST_MESSAGE_EOS:
-        input->stop();
+        stop();
         break;
     case GST_MESSAGE_ERROR: {
-        input->setError(QAudio::IOError);
+        setError(QAudio::IOError);
         gchar  *debug;
         GError *error;
 
@@ -297,9 +324,31 @@ qsizetype QGStreamerAudioSource::bufferSize() const
 
 qint64 QGStreamerAudioSource::processedUSecs() const
 {
+    if (m_captureCallback)
+        return m_framesCaptured.loadRelaxed() * 1000000 / m_format.sampleRate();
     return m_format.durationForBytes(m_bytesWritten);
 }
 
+qint64 QGStreamerAudioSource::latencyUSecs() const
+{
+    if (gstPipeline.isNull())
+        return -1;
+
+    // appsink forwards the query upstream and gets the capture latency
+    // of the source element.
+    qint64 latency = -1;
+    GstQuery *query = gst_query_new_latency();
+    if (gst_element_query(gstPipeline.element(), query)) {
+        gboolean live = false;
+        GstClockTime min = 0;
+        GstClockTime max = 0;
+        gst_query_parse_latency(query, &live, &min, &max);
+        latency = GST_TIME_AS_USECONDS(min);
+    }
+    gst_query_unref(query);
+    return latency;
+}
+
 void QGStreamerAudioSource::suspend()
 {
     if (m_deviceState == QAudio::ActiveState) {
@@ -364,6 +413,20 @@ GstFlowReturn QGStreamerAudioSource::new_sample(GstAppSink *sink, gpointer user_
     QGStreamerAudioSource *control = static_cast<QGStreamerAudioSource*>(user_data);
 
     GstSample *sample = gst_app_sink_pull_sample(sink);
+    if (control->m_captureCallback) {
+        // Hand the data over right here on the streaming thread
+        GstBuffer *buffer = gst_sample_get_buffer(sample);
+        GstMapInfo mapInfo;
+        if (buffer && gst_buffer_map(buffer, &mapInfo, GST_MAP_READ)) {
+            const qsizetype frames = qsizetype(mapInfo.size) / control->m_format.bytesPerFrame();
+            if (frames > 0)
+                control->m_captureCallback(QAudioFrameSpan(mapInfo.data, frames, control->m_format));
+            control->m_framesCaptured.fetchAndAddRelaxed(frames);
+            gst_buffer_unmap(buffer, &mapInfo);
+        }
+        gst_sample_unref(sample);
+        return GST_FLOW_OK;
+    }
     QMetaObject::invokeMethod(control, "newDataAvailable", Qt::AutoConnection, Q_ARG(GstSample *, sample));
 
     return GST_FLOW_OK;
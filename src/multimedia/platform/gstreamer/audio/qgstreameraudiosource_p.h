@@ -74,7 +74,8 @@ QT_BEGIN_NAMESPACE
 class GStreamerInputPrivate;
 
 class QGStreamerAudioSource
-    : public QPlatformAudioSource
+    : public QPlatformAudioSource,
+      public QGstreamerBusMessageFilter
 {
     Q_OBJECT
     friend class GStreamerInputPrivate;
@@ -84,6 +85,7 @@ public:
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void startCapturing(QAudioSource::CaptureCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -92,6 +94,7 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat &format) override;
@@ -114,7 +117,8 @@ private:
     bool open();
     void close();
 
-    static gboolean busMessage(GstBus *bus, GstMessage *msg, gpointer user_data);
+    bool processBusMessage(const QGstreamerMessage &message) override;
+    GstMessageType busMessageTypes() const override;
 
     QAudioDevice m_info;
     qint64 m_bytesWritten = 0;
@@ -137,6 +141,10 @@ private:
     QGstPipeline gstPipeline;
     QGstElement gstVolume;
     QGstElement gstAppSink;
+
+    // Called on the appsink streaming thread instead of writing to m_audioSink
+    QAudioSource::CaptureCallback m_captureCallback;
+    QAtomicInteger<qint64> m_framesCaptured = 0;
 };
 
 class GStreamerInputPrivate : public QIODevice
@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include <QDebug>
+#include <QtCore/qbuffer.h>
 
 #include "qgstappsrc_p.h"
 #include "qgstutils_p.h"
@@ -46,6 +47,16 @@
 
 Q_LOGGING_CATEGORY(qLcAppSrc, "qt.multimedia.appsrc")
 
+// Hands the bytes [offset, offset + size) of data to GStreamer without copying
+// them. The buffer keeps a reference to data until GStreamer is done with it.
+static GstBuffer *wrapByteArray(const QByteArray &data, qsizetype offset, qsizetype size)
+{
+    auto *owner = new QByteArray(data);
+    return gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, const_cast<char *>(owner->constData()),
+                                       owner->size(), offset, size, owner,
+                                       [](gpointer d) { delete static_cast<QByteArray *>(d); });
+}
+
 QGstAppSrc::QGstAppSrc(QObject *parent)
     : QObject(parent)
 {
@@ -58,6 +69,7 @@ QGstAppSrc::~QGstAppSrc()
 {
     m_appSrc.setStateSync(GST_STATE_NULL);
     streamDestroyed();
+    releaseBufferPool();
     qCDebug(qLcAppSrc) << "~QGstAppSrc";
 }
 
@@ -142,11 +154,24 @@ QGstElement QGstAppSrc::element()
 
 void QGstAppSrc::write(const char *data, qsizetype size)
 {
-    qCDebug(qLcAppSrc) << "write" << size << m_noMoreData << m_dataRequestSize;
     if (!size)
         return;
+    write(QByteArray(data, size));
+}
+
+/*!
+    \internal
+
+    Queues \a data for pushing into the pipeline. The data is shared, not
+    copied, and is handed to GStreamer as one buffer.
+*/
+void QGstAppSrc::write(const QByteArray &data)
+{
+    qCDebug(qLcAppSrc) << "write" << data.size() << m_noMoreData << m_dataRequestSize;
+    if (data.isEmpty())
+        return;
     Q_ASSERT(!m_stream);
-    m_buffer.append(data, size);
+    m_buffer.append(data);
     m_noMoreData = false;
     pushData();
 }
@@ -191,42 +216,59 @@ void QGstAppSrc::pushData()
     size = qMin(size, (qint64)m_dataRequestSize);
     qCDebug(qLcAppSrc) << "    reading" << size << "bytes" << size << m_dataRequestSize;
 
-    GstBuffer* buffer = gst_buffer_new_and_alloc(size);
+    const quint64 offset = (m_sequential || !m_stream) ? bytesReadSoFar : m_stream->pos();
+    GstBuffer *buffer = nullptr;
+    qint64 bytesRead = 0;
+    QBuffer *device = qobject_cast<QBuffer *>(m_stream);
+    QByteArray deviceData = device ? device->data() : QByteArray();
+
+    if (!m_stream) {
+        // Written data is pushed chunk by chunk, as it was handed to write().
+        // appsrc queues whatever exceeds the requested size.
+        const QByteArray chunk = m_buffer.read();
+        bytesRead = chunk.size();
+        if (bytesRead)
+            buffer = wrapByteArray(chunk, 0, bytesRead);
+    } else if (device && deviceData.data_ptr().d_ptr()) {
+        // The contents of a QBuffer can be shared with GStreamer, unless they
+        // are raw data that the application might free while it's in use.
+        const qint64 pos = device->pos();
+        bytesRead = qBound(qint64(0), qint64(deviceData.size()) - pos, size);
+        if (bytesRead) {
+            buffer = wrapByteArray(deviceData, pos, bytesRead);
+            device->seek(pos + bytesRead);
+        }
+    } else if (size > 0) {
+        buffer = allocateBuffer(size);
+        GstMapInfo mapInfo;
+        gst_buffer_map(buffer, &mapInfo, GST_MAP_WRITE);
+        bytesRead = qMax(m_stream->read(reinterpret_cast<char *>(mapInfo.data), size), qint64(0));
+        gst_buffer_unmap(buffer, &mapInfo);
+        gst_buffer_set_size(buffer, bytesRead);
+    }
+
+    qCDebug(qLcAppSrc) << "pushing bytes into gstreamer" << offset << bytesRead;
+    if (bytesRead == 0) {
+        if (buffer)
+            gst_buffer_unref(buffer);
+        eosOrIdle();
+        qCDebug(qLcAppSrc) << "end pushData" << (m_stream ? m_stream : nullptr) << m_buffer.size();
+        return;
+    }
 
-    if (m_sequential || !m_stream)
-        buffer->offset = bytesReadSoFar;
-    else
-        buffer->offset = m_stream->pos();
+    buffer->offset = offset;
+    buffer->offset_end = offset + bytesRead - 1;
+    bytesReadSoFar += bytesRead;
 
     if (m_format.isValid()) {
         // timestamp raw audio data
-        uint nSamples = size/m_format.bytesPerFrame();
+        uint nSamples = bytesRead/m_format.bytesPerFrame();
 
         GST_BUFFER_TIMESTAMP(buffer) = gst_util_uint64_scale(streamedSamples, GST_SECOND, m_format.sampleRate());
         GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(nSamples, GST_SECOND, m_format.sampleRate());
         streamedSamples += nSamples;
     }
 
-    GstMapInfo mapInfo;
-    gst_buffer_map(buffer, &mapInfo, GST_MAP_WRITE);
-    void* bufferData = mapInfo.data;
-
-    qint64 bytesRead;
-    if (m_stream)
-        bytesRead = m_stream->read((char*)bufferData, size);
-    else
-        bytesRead = m_buffer.read((char*)bufferData, size);
-    buffer->offset_end =  buffer->offset + bytesRead - 1;
-    bytesReadSoFar += bytesRead;
-
-    gst_buffer_unmap(buffer, &mapInfo);
-    qCDebug(qLcAppSrc) << "pushing bytes into gstreamer" << buffer->offset << bytesRead;
-    if (bytesRead == 0) {
-        gst_buffer_unref(buffer);
-        eosOrIdle();
-        qCDebug(qLcAppSrc) << "end pushData" << (m_stream ? m_stream : nullptr) << m_buffer.size();
-        return;
-    }
     m_noMoreData = false;
     emit bytesProcessed(bytesRead);
 
@@ -240,6 +282,42 @@ void QGstAppSrc::pushData()
 
 }
 
+// Buffers read from a device come from a pool, which is recreated whenever a
+// larger buffer than before is needed. The pool resets the size of returned
+// buffers, so a pool buffer can carry any amount of data up to its size.
+GstBuffer *QGstAppSrc::allocateBuffer(qint64 size)
+{
+    if (!m_bufferPool || size > m_poolBufferSize) {
+        releaseBufferPool();
+        m_bufferPool = gst_buffer_pool_new();
+        GstStructure *config = gst_buffer_pool_get_config(m_bufferPool);
+        gst_buffer_pool_config_set_params(config, nullptr, guint(size), 2, 0);
+        if (!gst_buffer_pool_set_config(m_bufferPool, config)
+            || !gst_buffer_pool_set_active(m_bufferPool, TRUE)) {
+            qCDebug(qLcAppSrc) << "could not set up buffer pool for" << size << "bytes";
+            releaseBufferPool();
+            return gst_buffer_new_and_alloc(size);
+        }
+        m_poolBufferSize = size;
+    }
+
+    GstBuffer *buffer = nullptr;
+    if (gst_buffer_pool_acquire_buffer(m_bufferPool, &buffer, nullptr) != GST_FLOW_OK)
+        return gst_buffer_new_and_alloc(size);
+    return buffer;
+}
+
+void QGstAppSrc::releaseBufferPool()
+{
+    if (!m_bufferPool)
+        return;
+    // Buffers still in use are freed when they are returned to the inactive pool
+    gst_buffer_pool_set_active(m_bufferPool, FALSE);
+    gst_object_unref(m_bufferPool);
+    m_bufferPool = nullptr;
+    m_poolBufferSize = 0;
+}
+
 bool QGstAppSrc::doSeek(qint64 value)
 {
     if (isStreamValid())
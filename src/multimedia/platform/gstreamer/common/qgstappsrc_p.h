@@ -80,6 +80,7 @@ public:
     QGstElement element();
 
     void write(const char *data, qsizetype size);
+    void write(const QByteArray &data);
 
     bool canAcceptMoreData() { return m_noMoreData || m_dataRequestSize != 0; }
 
@@ -109,11 +110,15 @@ private:
 
     void sendEOS();
     void eosOrIdle();
+    GstBuffer *allocateBuffer(qint64 size);
+    void releaseBufferPool();
 
     QIODevice *m_stream = nullptr;
     QNetworkReply *m_networkReply = nullptr;
     QRingBuffer m_buffer;
     QAudioFormat m_format;
+    GstBufferPool *m_bufferPool = nullptr;
+    qint64 m_poolBufferSize = 0;
 
     QGstElement m_appSrc;
     bool m_sequential = true;
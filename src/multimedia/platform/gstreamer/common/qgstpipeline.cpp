@@ -38,16 +38,19 @@
 ****************************************************************************/
 
 #include <QtCore/qmap.h>
-#include <QtCore/qtimer.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qlist.h>
-#include <QtCore/qabstracteventdispatcher.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qthread.h>
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qproperty.h>
 
 #include "qgstpipeline_p.h"
 #include "qgstreamermessage_p.h"
 
+#include <mutex>
+
 QT_BEGIN_NAMESPACE
 
 class QGstPipelinePrivate : public QObject
@@ -55,13 +58,25 @@ class QGstPipelinePrivate : public QObject
     Q_OBJECT
 public:
 
-    int m_ref = 0;
-    guint m_tag = 0;
+    // Counters are indexed by the bit of the message type, the last one
+    // collects GST_MESSAGE_UNKNOWN
+    static constexpr int MessageTypeCount = 33;
+
+    QAtomicInt m_ref = 0;
     GstBus *m_bus = nullptr;
-    QTimer *m_intervalTimer = nullptr;
     QMutex filterMutex;
     QList<QGstreamerSyncMessageFilter*> syncFilters;
+    QRecursiveMutex busFilterMutex;
     QList<QGstreamerBusMessageFilter*> busFilters;
+    // Message types any bus filter is interested in, 0 if there are no filters
+    QAtomicInteger<quint32> busMessageTypes = 0;
+
+    QMutex queueMutex;
+    QList<QGstreamerMessage> pendingMessages;
+    QAtomicInteger<quint64> receivedMessages[MessageTypeCount] = {};
+    QAtomicInteger<quint64> droppedMessages[MessageTypeCount] = {};
+    QAtomicInteger<quint64> dispatchedBatches = 0;
+
     bool inStoppedState = true;
     mutable qint64 m_position = 0;
     double m_rate = 1.;
@@ -74,65 +89,103 @@ public:
     QGstPipelinePrivate(GstBus* bus, QObject* parent = 0);
     ~QGstPipelinePrivate();
 
-    void ref() { ++ m_ref; }
-    void deref() { if (!--m_ref) delete this; }
+    void ref() { m_ref.ref(); }
+    void deref()
+    {
+        if (m_ref.deref())
+            return;
+        // The dispatcher might have been moved to another thread
+        if (thread() == QThread::currentThread())
+            delete this;
+        else
+            deleteLater();
+    }
 
     void installMessageFilter(QGstreamerSyncMessageFilter *filter);
     void removeMessageFilter(QGstreamerSyncMessageFilter *filter);
     void installMessageFilter(QGstreamerBusMessageFilter *filter);
     void removeMessageFilter(QGstreamerBusMessageFilter *filter);
+    void updateBusMessageTypes();
+
+    static int typeIndex(GstMessageType type)
+    {
+        return type ? qCountTrailingZeroBits(quint32(type)) : MessageTypeCount - 1;
+    }
 
+    // Runs in the thread posting the message. Sync filters see every message,
+    // everything else is either dropped right here or queued for the bus
+    // filters, so nothing is left on the bus itself.
     static GstBusSyncReply syncGstBusFilter(GstBus* bus, GstMessage* message, QGstPipelinePrivate *d)
     {
         Q_UNUSED(bus);
-        QMutexLocker lock(&d->filterMutex);
-
-        for (QGstreamerSyncMessageFilter *filter : qAsConst(d->syncFilters)) {
-            if (filter->processSyncMessage(QGstreamerMessage(message))) {
-                gst_message_unref(message);
-                return GST_BUS_DROP;
+        const GstMessageType type = GST_MESSAGE_TYPE(message);
+        d->receivedMessages[typeIndex(type)].fetchAndAddRelaxed(1);
+
+        {
+            QMutexLocker lock(&d->filterMutex);
+            for (QGstreamerSyncMessageFilter *filter : qAsConst(d->syncFilters)) {
+                if (filter->processSyncMessage(QGstreamerMessage(message))) {
+                    gst_message_unref(message);
+                    return GST_BUS_DROP;
+                }
             }
         }
 
-        return GST_BUS_PASS;
+        const quint32 wanted = d->busMessageTypes.loadRelaxed();
+        if (wanted && !(quint32(type) & wanted)) {
+            d->droppedMessages[typeIndex(type)].fetchAndAddRelaxed(1);
+            gst_message_unref(message);
+            return GST_BUS_DROP;
+        }
+
+        d->queueMessage(message);
+        gst_message_unref(message);
+        return GST_BUS_DROP;
     }
 
 private Q_SLOTS:
-    void interval()
+    void dispatchMessages()
     {
-        GstMessage* message;
-        while ((message = gst_bus_poll(m_bus, GST_MESSAGE_ANY, 0)) != nullptr) {
-            processMessage(message);
-            gst_message_unref(message);
+        QList<QGstreamerMessage> messages;
+        {
+            QMutexLocker lock(&queueMutex);
+            messages.swap(pendingMessages);
         }
-    }
-    void doProcessMessage(const QGstreamerMessage& msg)
-    {
-        for (QGstreamerBusMessageFilter *filter : qAsConst(busFilters)) {
-            if (filter->processBusMessage(msg))
-                break;
+        if (messages.isEmpty())
+            return;
+        dispatchedBatches.fetchAndAddRelaxed(1);
+
+        // A filter may drop the last QGstPipeline while handling a message,
+        // so stay alive until the filter lock has been released.
+        ref();
+        {
+            // Filters removed from another thread are not called once
+            // removeMessageFilter() returns
+            const std::lock_guard<QRecursiveMutex> lock(busFilterMutex);
+            const auto filters = busFilters;
+            for (const QGstreamerMessage &msg : qAsConst(messages)) {
+                for (QGstreamerBusMessageFilter *filter : filters) {
+                    if (!busFilters.contains(filter))
+                        continue;
+                    if (filter->processBusMessage(msg))
+                        break;
+                }
+            }
         }
+        if (!m_ref.deref())
+            deleteLater();
     }
 
 private:
-    void processMessage(GstMessage* message)
-    {
-        QGstreamerMessage msg(message);
-        doProcessMessage(msg);
-    }
-
+    // Messages arriving while a batch is pending are added to it, so only
+    // one event per batch reaches the dispatching thread.
     void queueMessage(GstMessage* message)
     {
-        QGstreamerMessage msg(message);
-        QMetaObject::invokeMethod(this, "doProcessMessage", Qt::QueuedConnection,
-                                  Q_ARG(QGstreamerMessage, msg));
-    }
-
-    static gboolean busCallback(GstBus *bus, GstMessage *message, gpointer data)
-    {
-        Q_UNUSED(bus);
-        static_cast<QGstPipelinePrivate *>(data)->queueMessage(message);
-        return TRUE;
+        QMutexLocker lock(&queueMutex);
+        const bool schedule = pendingMessages.isEmpty();
+        pendingMessages.append(QGstreamerMessage(message));
+        if (schedule)
+            QMetaObject::invokeMethod(this, "dispatchMessages", Qt::QueuedConnection);
     }
 };
 
@@ -140,28 +193,11 @@ QGstPipelinePrivate::QGstPipelinePrivate(GstBus* bus, QObject* parent)
   : QObject(parent),
     m_bus(bus)
 {
-    // glib event loop can be disabled either by env variable or QT_NO_GLIB define, so check the dispacher
-    QAbstractEventDispatcher *dispatcher = QCoreApplication::eventDispatcher();
-    const bool hasGlib = dispatcher && dispatcher->inherits("QEventDispatcherGlib");
-    if (!hasGlib) {
-        m_intervalTimer = new QTimer(this);
-        m_intervalTimer->setInterval(250);
-        connect(m_intervalTimer, SIGNAL(timeout()), SLOT(interval()));
-        m_intervalTimer->start();
-    } else {
-        m_tag = gst_bus_add_watch_full(bus, G_PRIORITY_DEFAULT, busCallback, this, nullptr);
-    }
-
     gst_bus_set_sync_handler(bus, (GstBusSyncHandler)syncGstBusFilter, this, nullptr);
 }
 
 QGstPipelinePrivate::~QGstPipelinePrivate()
 {
-    delete m_intervalTimer;
-
-    if (m_tag)
-        gst_bus_remove_watch(m_bus);
-
     gst_bus_set_sync_handler(m_bus, nullptr, nullptr, nullptr);
     gst_object_unref(GST_OBJECT(m_bus));
 }
@@ -185,14 +221,29 @@ void QGstPipelinePrivate::removeMessageFilter(QGstreamerSyncMessageFilter *filte
 
 void QGstPipelinePrivate::installMessageFilter(QGstreamerBusMessageFilter *filter)
 {
-    if (filter && !busFilters.contains(filter))
+    const std::lock_guard<QRecursiveMutex> lock(busFilterMutex);
+    if (filter && !busFilters.contains(filter)) {
         busFilters.append(filter);
+        updateBusMessageTypes();
+    }
 }
 
 void QGstPipelinePrivate::removeMessageFilter(QGstreamerBusMessageFilter *filter)
 {
-    if (filter)
+    const std::lock_guard<QRecursiveMutex> lock(busFilterMutex);
+    if (filter) {
         busFilters.removeAll(filter);
+        updateBusMessageTypes();
+    }
+}
+
+// Called with busFilterMutex held
+void QGstPipelinePrivate::updateBusMessageTypes()
+{
+    quint32 types = 0;
+    for (const QGstreamerBusMessageFilter *filter : qAsConst(busFilters))
+        types |= quint32(filter->busMessageTypes());
+    busMessageTypes.storeRelaxed(types);
 }
 
 QGstPipeline::QGstPipeline(const QGstPipeline &o)
@@ -277,6 +328,53 @@ void QGstPipeline::removeMessageFilter(QGstreamerBusMessageFilter *filter)
     d->removeMessageFilter(filter);
 }
 
+/*!
+    \internal
+
+    Dispatches bus messages to the bus filters in \a thread instead of the
+    thread the pipeline was created in. The filters must then be safe to call
+    from \a thread; removeMessageFilter() waits for a running dispatch.
+*/
+void QGstPipeline::setBusDispatchThread(QThread *thread)
+{
+    Q_ASSERT(d);
+    d->moveToThread(thread);
+}
+
+/*!
+    \internal
+
+    Returns the number of messages of \a type posted on the bus.
+*/
+quint64 QGstPipeline::busMessageCount(GstMessageType type) const
+{
+    Q_ASSERT(d);
+    return d->receivedMessages[QGstPipelinePrivate::typeIndex(type)].loadRelaxed();
+}
+
+/*!
+    \internal
+
+    Returns the number of messages of \a type that were dropped when they
+    were posted, because no bus filter is interested in them.
+*/
+quint64 QGstPipeline::droppedBusMessageCount(GstMessageType type) const
+{
+    Q_ASSERT(d);
+    return d->droppedMessages[QGstPipelinePrivate::typeIndex(type)].loadRelaxed();
+}
+
+/*!
+    \internal
+
+    Returns the number of batches in which bus messages have been dispatched.
+*/
+quint64 QGstPipeline::busDispatchCount() const
+{
+    Q_ASSERT(d);
+    return d->dispatchedBatches.loadRelaxed();
+}
+
 GstStateChangeReturn QGstPipeline::setState(GstState state)
 {
     auto retval = gst_element_set_state(element(), state);
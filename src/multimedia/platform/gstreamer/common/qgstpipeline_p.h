@@ -59,6 +59,7 @@
 QT_BEGIN_NAMESPACE
 
 class QGstreamerMessage;
+class QThread;
 
 class QGstreamerSyncMessageFilter {
 public:
@@ -71,11 +72,14 @@ class QGstreamerBusMessageFilter {
 public:
     //returns true if message was processed and should be dropped, false otherwise
     virtual bool processBusMessage(const QGstreamerMessage &message) = 0;
+    //message types processBusMessage() handles. Messages of other types are
+    //dropped as soon as they are posted, unless another filter wants them.
+    virtual GstMessageType busMessageTypes() const { return GST_MESSAGE_ANY; }
 };
 
 class QGstPipelinePrivate;
 
-class QGstPipeline : public QGstBin
+class Q_MULTIMEDIA_EXPORT QGstPipeline : public QGstBin
 {
     QGstPipelinePrivate *d = nullptr;
 public:
@@ -101,6 +105,11 @@ public:
     void installMessageFilter(QGstreamerBusMessageFilter *filter);
     void removeMessageFilter(QGstreamerBusMessageFilter *filter);
 
+    void setBusDispatchThread(QThread *thread);
+    quint64 busMessageCount(GstMessageType type) const;
+    quint64 droppedBusMessageCount(GstMessageType type) const;
+    quint64 busDispatchCount() const;
+
     GstStateChangeReturn setState(GstState state);
 
     GstPipeline *pipeline() const { return GST_PIPELINE_CAST(m_object); }
@@ -266,6 +266,14 @@ void QGstreamerMediaPlayer::stopOrEOS(bool eos)
     mediaStatusChanged(eos ? QMediaPlayer::EndOfMedia : QMediaPlayer::LoadedMedia);
 }
 
+GstMessageType QGstreamerMediaPlayer::busMessageTypes() const
+{
+    return GstMessageType(GST_MESSAGE_TAG | GST_MESSAGE_DURATION_CHANGED | GST_MESSAGE_EOS
+                          | GST_MESSAGE_BUFFERING | GST_MESSAGE_STATE_CHANGED | GST_MESSAGE_ERROR
+                          | GST_MESSAGE_WARNING | GST_MESSAGE_INFO | GST_MESSAGE_SEGMENT_START
+                          | GST_MESSAGE_ELEMENT);
+}
+
 bool QGstreamerMediaPlayer::processBusMessage(const QGstreamerMessage &message)
 {
     if (message.isNull())
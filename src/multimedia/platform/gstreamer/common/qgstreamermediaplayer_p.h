@@ -116,6 +116,7 @@ public:
     void stop() override;
 
     bool processBusMessage(const QGstreamerMessage& message) override;
+    GstMessageType busMessageTypes() const override;
     bool processSyncMessage(const QGstreamerMessage& message) override;
 
     void *nativePipeline() override;
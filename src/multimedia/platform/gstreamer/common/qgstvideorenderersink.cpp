@@ -74,14 +74,25 @@ Q_LOGGING_CATEGORY(qLcGstVideoRenderer, "qt.multimedia.gstvideorenderer")
 
 QT_BEGIN_NAMESPACE
 
+/*
+    By default render() only publishes the buffer in m_pendingBuffer and returns, so that a
+    busy GUI thread never stalls the streaming thread; the mutex is held just for that. If the
+    GUI thread didn't pick up the previous buffer yet, it gets replaced by the new one and
+    counted as dropped.
+
+    Setting QT_MEDIA_BLOCKING_VIDEO_RENDERER=1 restores the old behavior, where render()
+    waits until the frame has been handed to the video sink.
+*/
 QGstVideoRenderer::QGstVideoRenderer(QGstreamerVideoSink *sink)
     : m_sink(sink)
+    , m_blocking(qEnvironmentVariableIntValue("QT_MEDIA_BLOCKING_VIDEO_RENDERER") > 0)
 {
     createSurfaceCaps();
 }
 
 QGstVideoRenderer::~QGstVideoRenderer()
 {
+    discardPendingBuffer();
 }
 
 void QGstVideoRenderer::createSurfaceCaps()
@@ -165,6 +176,8 @@ bool QGstVideoRenderer::start(GstCaps *caps)
         m_flush = true;
         m_stop = true;
     }
+    // A buffer queued under the old caps must not be wrapped with the new format
+    discardPendingBuffer();
 
     m_startCaps = QGstMutableCaps(caps, QGstMutableCaps::NeedsRef);
 
@@ -198,6 +211,10 @@ void QGstVideoRenderer::stop()
     m_stop = true;
 
     m_startCaps = {};
+    discardPendingBuffer();
+
+    qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::stop, frames rendered:" << framesRendered()
+                                 << "dropped:" << framesDropped();
 
     waitForAsyncEvent(&locker, &m_setupCondition, 500);
 }
@@ -223,6 +240,7 @@ void QGstVideoRenderer::flush()
 
     m_flush = true;
     m_renderBuffer = nullptr;
+    discardPendingBuffer();
     m_renderCondition.wakeAll();
 
     notify();
@@ -230,9 +248,29 @@ void QGstVideoRenderer::flush()
 
 GstFlowReturn QGstVideoRenderer::render(GstBuffer *buffer)
 {
-    QMutexLocker locker(&m_mutex);
     qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::render";
 
+    if (!m_blocking) {
+        // Publish under the same lock as the m_active check, so that stop() or
+        // start() can't miss a buffer queued for the caps they replace
+        QMutexLocker locker(&m_mutex);
+        if (!m_active)
+            return GST_FLOW_ERROR;
+
+        gst_buffer_ref(buffer);
+        GstBuffer *previous = std::exchange(m_pendingBuffer, buffer);
+        if (previous) {
+            // The GUI thread is lagging behind, the update it has been posted for
+            // will present the new buffer instead
+            gst_buffer_unref(previous);
+            m_framesDropped.fetchAndAddRelaxed(1);
+        } else {
+            QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+        }
+        return GST_FLOW_OK;
+    }
+
+    QMutexLocker locker(&m_mutex);
     m_renderReturn = GST_FLOW_OK;
     m_renderBuffer = buffer;
 
@@ -314,7 +352,7 @@ bool QGstVideoRenderer::event(QEvent *event)
     if (event->type() == QEvent::UpdateRequest) {
         QMutexLocker locker(&m_mutex);
 
-        if (m_notified) {
+        if (m_notified || m_pendingBuffer) {
             while (handleEvent(&locker)) {}
             m_notified = false;
         }
@@ -369,53 +407,75 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
         m_renderReturn = GST_FLOW_ERROR;
 
         qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::handleEvent(renderBuffer)" << m_active << m_sink;
-        if (m_active && m_sink) {
-            gst_buffer_ref(buffer);
-
-            locker->unlock();
+        if (presentBuffer(locker, buffer))
+            m_renderReturn = GST_FLOW_OK;
 
-            m_flushed = false;
+        m_renderCondition.wakeAll();
+    } else if (GstBuffer *buffer = std::exchange(m_pendingBuffer, nullptr)) {
+        qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::handleEvent(pendingBuffer)" << m_active << m_sink;
+        presentBuffer(locker, buffer);
+        gst_buffer_unref(buffer);
+    } else {
+        m_setupCondition.wakeAll();
 
-            auto meta = gst_buffer_get_video_crop_meta (buffer);
-            if (meta) {
-                QRect vp(meta->x, meta->y, meta->width, meta->height);
-                if (m_format.viewport() != vp) {
-                    qCDebug(qLcGstVideoRenderer) << Q_FUNC_INFO << " Update viewport on Metadata: [" << meta->height << "x" << meta->width << " | " << meta->x << "x" << meta->y << "]";
-                    // Update viewport if data is not the same
-                    m_format.setViewport(vp);
-                }
-            }
+        return false;
+    }
+    return true;
+}
 
-            if (m_sink->inStoppedState()) {
-                qCDebug(qLcGstVideoRenderer) << "    sending empty video frame";
-                m_sink->setVideoFrame(QVideoFrame());
-            } else {
-                QGstVideoBuffer *videoBuffer = new QGstVideoBuffer(buffer, m_videoInfo, m_sink, m_format, memoryFormat);
-                QVideoFrame frame(videoBuffer, m_format);
-                QGstUtils::setFrameTimeStamps(&frame, buffer);
-                frame.setMirrored(m_frameMirrored);
-                frame.setRotationAngle(m_frameRotationAngle);
+// Wraps buffer in a video frame and hands it to the sink, called with the mutex locked
+bool QGstVideoRenderer::presentBuffer(QMutexLocker<QMutex> *locker, GstBuffer *buffer)
+{
+    if (!m_active || !m_sink)
+        return false;
 
-                qCDebug(qLcGstVideoRenderer) << "    sending video frame";
-                m_sink->setVideoFrame(frame);
-            }
+    const bool mirrored = m_frameMirrored;
+    const QVideoFrame::RotationAngle rotationAngle = m_frameRotationAngle;
+    gst_buffer_ref(buffer);
 
-            gst_buffer_unref(buffer);
+    locker->unlock();
 
-            locker->relock();
+    m_flushed = false;
 
-            m_renderReturn = GST_FLOW_OK;
+    auto meta = gst_buffer_get_video_crop_meta (buffer);
+    if (meta) {
+        QRect vp(meta->x, meta->y, meta->width, meta->height);
+        if (m_format.viewport() != vp) {
+            qCDebug(qLcGstVideoRenderer) << Q_FUNC_INFO << " Update viewport on Metadata: [" << meta->height << "x" << meta->width << " | " << meta->x << "x" << meta->y << "]";
+            // Update viewport if data is not the same
+            m_format.setViewport(vp);
         }
+    }
 
-        m_renderCondition.wakeAll();
+    if (m_sink->inStoppedState()) {
+        qCDebug(qLcGstVideoRenderer) << "    sending empty video frame";
+        m_sink->setVideoFrame(QVideoFrame());
     } else {
-        m_setupCondition.wakeAll();
-
-        return false;
+        QGstVideoBuffer *videoBuffer = new QGstVideoBuffer(buffer, m_videoInfo, m_sink, m_format, memoryFormat);
+        QVideoFrame frame(videoBuffer, m_format);
+        QGstUtils::setFrameTimeStamps(&frame, buffer);
+        frame.setMirrored(mirrored);
+        frame.setRotationAngle(rotationAngle);
+
+        qCDebug(qLcGstVideoRenderer) << "    sending video frame";
+        m_sink->setVideoFrame(frame);
+        m_framesRendered.fetchAndAddRelaxed(1);
     }
+
+    gst_buffer_unref(buffer);
+
+    locker->relock();
     return true;
 }
 
+// Drops a buffer published by render() that the GUI thread didn't present yet,
+// called with the mutex locked
+void QGstVideoRenderer::discardPendingBuffer()
+{
+    if (GstBuffer *buffer = std::exchange(m_pendingBuffer, nullptr))
+        gst_buffer_unref(buffer);
+}
+
 void QGstVideoRenderer::notify()
 {
     if (!m_notified) {
@@ -55,6 +55,7 @@
 #include <gst/video/gstvideosink.h>
 #include <gst/video/video.h>
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qqueue.h>
@@ -68,7 +69,7 @@
 QT_BEGIN_NAMESPACE
 class QVideoSink;
 
-class QGstVideoRenderer : public QObject
+class Q_MULTIMEDIA_EXPORT QGstVideoRenderer : public QObject
 {
     Q_OBJECT
 public:
@@ -90,6 +91,9 @@ public:
     bool query(GstQuery *query);
     void gstEvent(GstEvent *event);
 
+    quint64 framesRendered() const { return m_framesRendered.loadRelaxed(); }
+    quint64 framesDropped() const { return m_framesDropped.loadRelaxed(); }
+
 private slots:
     bool handleEvent(QMutexLocker<QMutex> *locker);
 
@@ -97,6 +101,8 @@ private:
     void notify();
     bool waitForAsyncEvent(QMutexLocker<QMutex> *locker, QWaitCondition *condition, unsigned long time);
     void createSurfaceCaps();
+    bool presentBuffer(QMutexLocker<QMutex> *locker, GstBuffer *buffer);
+    void discardPendingBuffer();
 
     QPointer<QGstreamerVideoSink> m_sink;
 
@@ -119,6 +125,15 @@ private:
     bool m_frameMirrored = false;
     QVideoFrame::RotationAngle m_frameRotationAngle = QVideoFrame::Rotation0;
 
+    // holds a reference to the latest buffer from the streaming thread that has
+    // not been presented yet
+    GstBuffer *m_pendingBuffer = nullptr;
+
+    // --- read without the mutex
+    QAtomicInteger<quint64> m_framesRendered;
+    QAtomicInteger<quint64> m_framesDropped;
+    const bool m_blocking;
+
     // --- only accessed from one thread
     QVideoFrameFormat m_format;
     GstVideoInfo m_videoInfo;
@@ -52,6 +52,11 @@
 
 #include <QtCore/qdebug.h>
 
+static QGstreamerMediaDevices *gstDevices()
+{
+    return static_cast<QGstreamerMediaDevices *>(QGstreamerIntegration::instance()->devices());
+}
+
 QGstreamerCamera::QGstreamerCamera(QCamera *camera)
         : QPlatformCamera(camera)
 {
@@ -104,8 +109,7 @@ void QGstreamerCamera::setCamera(const QCameraDevice &camera)
     if (camera.isNull()) {
         gstNewCamera = QGstElement("videotestsrc");
     } else {
-        auto *devices = static_cast<QGstreamerMediaDevices *>(QGstreamerIntegration::instance()->devices());
-        auto *device = devices->videoDevice(camera.id());
+        auto *device = gstDevices()->videoDevice(camera.id());
         gstNewCamera = gst_device_create_element(device, "camerasrc");
         if (QGstStructure properties = gst_device_get_properties(device); !properties.isNull()) {
             if (properties.name() == "v4l2deviceprovider")
@@ -114,7 +118,7 @@ void QGstreamerCamera::setCamera(const QCameraDevice &camera)
         }
     }
 
-    QCameraFormat f = findBestCameraFormat(camera);
+    QCameraFormat f = camera.isNull() ? QCameraFormat() : gstDevices()->defaultCameraFormat(camera.id());
     auto caps = QGstMutableCaps::fromCameraFormat(f);
     auto gstNewDecode = QGstElement(f.pixelFormat() == QVideoFrameFormat::Format_Jpeg ? "jpegdec" : "identity");
 
@@ -152,12 +156,17 @@ void QGstreamerCamera::setCamera(const QCameraDevice &camera)
 
 bool QGstreamerCamera::setCameraFormat(const QCameraFormat &format)
 {
-    if (!format.isNull() && !m_cameraDevice.videoFormats().contains(format))
-        return false;
-
-    QCameraFormat f = format;
-    if (f.isNull())
-        f = findBestCameraFormat(m_cameraDevice);
+    // The formats of the stored device stay valid even if the camera has been unplugged
+    QCameraFormat f;
+    if (!format.isNull()) {
+        f = findCameraFormat(m_cameraDevice.videoFormats(), format);
+        if (f.isNull())
+            return false;
+    } else {
+        f = gstDevices()->defaultCameraFormat(m_cameraDevice.id());
+        if (f.isNull())
+            f = findBestCameraFormat(m_cameraDevice);
+    }
 
     auto caps = QGstMutableCaps::fromCameraFormat(f);
 
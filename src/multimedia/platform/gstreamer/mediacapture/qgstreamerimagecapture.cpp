@@ -49,6 +49,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <qstandardpaths.h>
+#include <qimagewriter.h>
 
 #include <qloggingcategory.h>
 
@@ -56,6 +57,60 @@ QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(qLcImageCapture, "qt.multimedia.imageCapture")
 
+// Upper bound for frames queued for JPEG encoding and for frames waiting to
+// be converted to QImage. Beyond that, captures wait for a later frame.
+static constexpr int maxPendingImages = 8;
+
+static const char *fileExtension(QImageCapture::FileFormat format)
+{
+    switch (format) {
+    case QImageCapture::PNG:
+        return "png";
+    case QImageCapture::WebP:
+        return "webp";
+    case QImageCapture::Tiff:
+        return "tiff";
+    case QImageCapture::UnspecifiedFormat:
+    case QImageCapture::JPEG:
+    default:
+        return "jpg";
+    }
+}
+
+// JPEG is encoded by jpegenc inside the pipeline, everything else by QImageWriter
+static bool encodedByPipeline(QImageCapture::FileFormat format)
+{
+    return format == QImageCapture::UnspecifiedFormat || format == QImageCapture::JPEG;
+}
+
+static int writerQuality(QImageCapture::FileFormat format, QImageCapture::Quality quality)
+{
+    if (format != QImageCapture::WebP)
+        return -1;
+    switch (quality) {
+    case QImageCapture::VeryLowQuality:
+        return 10;
+    case QImageCapture::LowQuality:
+        return 30;
+    case QImageCapture::NormalQuality:
+    default:
+        return 75;
+    case QImageCapture::HighQuality:
+        return 90;
+    case QImageCapture::VeryHighQuality:
+        return 98;
+    }
+}
+
+// Name of frame \a index of a burst saved to \a path
+static QString burstFileName(const QString &path, int index)
+{
+    if (index == 0)
+        return path;
+    QFileInfo info(path);
+    return info.dir().filePath(QStringLiteral("%1_%2.%3").arg(info.completeBaseName()).arg(index).arg(info.suffix()));
+}
+
 QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
   : QPlatformImageCapture(parent),
     QGstreamerBufferProbe(ProbeBuffers)
@@ -70,6 +125,14 @@ QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
     queue.set("max-size-bytes", uint(0));
     queue.set("max-size-time", quint64(0));
 
+    // the probe on the leaky queue only picks frames, this one decouples the
+    // encoder so that a burst can be picked at the camera's frame rate
+    encodeQueue = QGstElement("queue", "imageEncodeQueue");
+    encodeQueue.set("silent", true);
+    encodeQueue.set("max-size-buffers", uint(maxPendingImages));
+    encodeQueue.set("max-size-bytes", uint(0));
+    encodeQueue.set("max-size-time", quint64(0));
+
     videoConvert = QGstElement("videoconvert", "imageCaptureConvert");
     encoder = QGstElement("jpegenc", "jpegEncoder");
     muxer = QGstElement("jifmux", "jpegMuxer");
@@ -78,11 +141,18 @@ QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
     // as no buffer will arrive until capture() is called
     sink.set("async", false);
 
-    bin.add(queue, videoConvert, encoder, muxer, sink);
-    queue.link(videoConvert, encoder, muxer, sink);
+    bin.add(queue, encodeQueue, videoConvert, encoder, muxer, sink);
+    queue.link(encodeQueue, videoConvert, encoder, muxer, sink);
     bin.addGhostPad(queue, "sink");
 
+    // added first, so that probeBuffer() already sees the copy
+    gst_pad_add_probe(queue.staticPad("src").pad(), GST_PAD_PROBE_TYPE_BUFFER,
+                      &QGstreamerImageCapture::copyPooledBufferProbe, this, nullptr);
     addProbeToPad(queue.staticPad("src").pad(), false);
+    gst_pad_add_probe(encodeQueue.staticPad("src").pad(), GST_PAD_PROBE_TYPE_BUFFER,
+                      &QGstreamerImageCapture::encoderProbe, this, nullptr);
+
+    m_conversionPool.setMaxThreadCount(2);
 
     sink.set("signal-handoffs", true);
     g_signal_connect(sink.object(), "handoff", G_CALLBACK(&QGstreamerImageCapture::saveImageFilter), this);
@@ -91,25 +161,38 @@ QGstreamerImageCapture::QGstreamerImageCapture(QImageCapture *parent)
 QGstreamerImageCapture::~QGstreamerImageCapture()
 {
     bin.setStateSync(GST_STATE_NULL);
+    m_conversionPool.waitForDone();
 }
 
 bool QGstreamerImageCapture::isReadyForCapture() const
 {
-    return m_session && !passImage && cameraActive;
+    QMutexLocker locker(&m_mutex);
+    return m_session && pendingImages.isEmpty() && cameraActive;
 }
 
 int QGstreamerImageCapture::capture(const QString &fileName)
 {
-    QString path = QMediaStorageLocation::generateFileName(fileName, QStandardPaths::PicturesLocation, QLatin1String("jpg"));
-    return doCapture(path);
+    return captureBurst(1, fileName);
 }
 
 int QGstreamerImageCapture::captureToBuffer()
 {
-    return doCapture(QString());
+    return doCapture(1, QString());
+}
+
+int QGstreamerImageCapture::captureBurst(int count, const QString &fileName)
+{
+    QString path = QMediaStorageLocation::generateFileName(fileName, QStandardPaths::PicturesLocation,
+                                                           QLatin1String(fileExtension(m_settings.format())));
+    return doCapture(count, path);
+}
+
+int QGstreamerImageCapture::captureBurstToBuffer(int count)
+{
+    return doCapture(count, QString());
 }
 
-int QGstreamerImageCapture::doCapture(const QString &fileName)
+int QGstreamerImageCapture::doCapture(int count, const QString &fileName)
 {
     qCDebug(qLcImageCapture) << "do capture";
     if (!m_session) {
@@ -134,7 +217,7 @@ int QGstreamerImageCapture::doCapture(const QString &fileName)
         qCDebug(qLcImageCapture) << "error 2";
         return -1;
     }
-    if (passImage) {
+    if (!isReadyForCapture()) {
         //emit error in the next event loop,
         //so application can associate it with returned request id.
         QMetaObject::invokeMethod(this, "error", Qt::QueuedConnection,
@@ -145,25 +228,41 @@ int QGstreamerImageCapture::doCapture(const QString &fileName)
         qCDebug(qLcImageCapture) << "error 3";
         return -1;
     }
-    m_lastId++;
-
-    pendingImages.enqueue({m_lastId, fileName, QMediaMetaData{}});
-    // let one image pass the pipeline
-    passImage = true;
+    const int firstId = m_lastId + 1;
+    {
+        QMutexLocker locker(&m_mutex);
+        // let count images pass the pipeline
+        for (int i = 0; i < count; ++i) {
+            const QString name = fileName.isEmpty() ? QString() : burstFileName(fileName, i);
+            pendingImages.enqueue({++m_lastId, name, QMediaMetaData{}, m_settings.format(), m_settings.quality()});
+        }
+    }
 
     emit readyForCaptureChanged(false);
-    return m_lastId;
+    return firstId;
+}
+
+// Must be called with m_mutex locked
+bool QGstreamerImageCapture::takesNextBuffer() const
+{
+    // Don't let a burst outrun the conversion pool, the request will use
+    // one of the next frames instead
+    return !pendingImages.isEmpty() && m_pendingConversions.loadRelaxed() < maxPendingImages;
 }
 
 bool QGstreamerImageCapture::probeBuffer(GstBuffer *buffer)
 {
-    if (!passImage)
+    QMutexLocker locker(&m_mutex);
+    if (!takesNextBuffer())
         return false;
     qCDebug(qLcImageCapture) << "probe buffer";
 
-    passImage = false;
+    PendingImage imageData = pendingImages.dequeue();
+    const bool lastPending = pendingImages.isEmpty();
+    locker.unlock();
 
-    emit readyForCaptureChanged(isReadyForCapture());
+    if (lastPending)
+        emit readyForCaptureChanged(isReadyForCapture());
 
     QGstCaps caps = gst_pad_get_current_caps(bin.staticPad("sink").pad());
     GstVideoInfo previewInfo;
@@ -174,35 +273,103 @@ bool QGstreamerImageCapture::probeBuffer(GstBuffer *buffer)
     auto *sink = m_session->gstreamerVideoSink();
     auto *gstBuffer = new QGstVideoBuffer(buffer, previewInfo, sink, fmt, memoryFormat);
     QVideoFrame frame(gstBuffer, fmt);
-    QImage img = frame.toImage();
-    if (img.isNull()) {
-        qDebug() << "received a null image";
-        return true;
-    }
-
-    auto &imageData = pendingImages.head();
 
     emit imageExposed(imageData.id);
 
+    // The frame wraps the GstBuffer without copying it, the QImage is
+    // produced on the conversion pool
     qCDebug(qLcImageCapture) << "Image available!";
     emit imageAvailable(imageData.id, frame);
 
-    emit imageCaptured(imageData.id, img);
-
     QMediaMetaData metaData = this->metaData();
     metaData.insert(QMediaMetaData::Date, QDateTime::currentDateTime());
     metaData.insert(QMediaMetaData::Resolution, frame.size());
     imageData.metaData = metaData;
 
-    // ensure taginject injects this metaData
-    const auto &md = static_cast<const QGstreamerMetaData &>(metaData);
-    md.setMetaData(muxer.element());
-
     emit imageMetadataAvailable(imageData.id, metaData);
 
+    const bool encodeInPipeline = !imageData.filename.isEmpty() && encodedByPipeline(imageData.format);
+
+    m_pendingConversions.ref();
+    m_conversionPool.start([this, id = imageData.id, frame,
+                            fileName = encodeInPipeline ? QString() : imageData.filename,
+                            format = imageData.format, quality = imageData.quality]() {
+        convertImage(id, frame, fileName, format, quality);
+        m_pendingConversions.deref();
+    });
+
+    if (!encodeInPipeline)
+        return false;
+
+    locker.relock();
+    encodingImages.enqueue(imageData);
     return true;
 }
 
+void QGstreamerImageCapture::convertImage(int id, const QVideoFrame &frame, const QString &fileName,
+                                          QImageCapture::FileFormat format, QImageCapture::Quality quality)
+{
+    QImage img = frame.toImage();
+    if (img.isNull()) {
+        qDebug() << "received a null image";
+        return;
+    }
+
+    emit imageCaptured(id, img);
+
+    if (fileName.isEmpty())
+        return;
+
+    qCDebug(qLcImageCapture) << "saving image as" << fileName;
+
+    QImageWriter writer(fileName, fileExtension(format));
+    writer.setQuality(writerQuality(format, quality));
+    if (writer.write(img)) {
+        emit imageSaved(id, fileName);
+    } else {
+        const auto errorCode = writer.error() == QImageWriter::UnsupportedFormatError
+                ? QImageCapture::FormatError : QImageCapture::ResourceError;
+        emit error(id, errorCode, writer.errorString());
+    }
+}
+
+GstPadProbeReturn QGstreamerImageCapture::copyPooledBufferProbe(GstPad *, GstPadProbeInfo *info, gpointer appdata)
+{
+    QGstreamerImageCapture *capture = static_cast<QGstreamerImageCapture *>(appdata);
+
+    // Camera sources usually hand out buffers from a small, fixed pool. A picked
+    // frame is held until it is converted and encoded, which for a burst could
+    // drain that pool and stall the preview, so hold a copy instead.
+    GstBuffer *buffer = gst_pad_probe_info_get_buffer(info);
+    if (!buffer || !buffer->pool)
+        return GST_PAD_PROBE_OK;
+    {
+        QMutexLocker locker(&capture->m_mutex);
+        if (!capture->takesNextBuffer())
+            return GST_PAD_PROBE_OK;
+    }
+    if (GstBuffer *copy = gst_buffer_copy_deep(buffer)) {
+        gst_buffer_unref(buffer);
+        GST_PAD_PROBE_INFO_DATA(info) = copy;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn QGstreamerImageCapture::encoderProbe(GstPad *, GstPadProbeInfo *, gpointer appdata)
+{
+    QGstreamerImageCapture *capture = static_cast<QGstreamerImageCapture *>(appdata);
+
+    // The buffer leaving the encode queue belongs to the oldest image in
+    // encodingImages, it is muxed and saved before the next one is pushed.
+    // Ensure the muxer injects its metadata.
+    QMutexLocker locker(&capture->m_mutex);
+    if (!capture->encodingImages.isEmpty()) {
+        const auto &md = static_cast<const QGstreamerMetaData &>(capture->encodingImages.head().metaData);
+        md.setMetaData(capture->muxer.element());
+    }
+    return GST_PAD_PROBE_OK;
+}
+
 void QGstreamerImageCapture::setCaptureSession(QPlatformMediaCaptureSession *session)
 {
     QGstreamerMediaCapture *captureSession = static_cast<QGstreamerMediaCapture *>(session);
@@ -213,8 +380,9 @@ void QGstreamerImageCapture::setCaptureSession(QPlatformMediaCaptureSession *ses
     if (m_session) {
         disconnect(m_session, nullptr, this, nullptr);
         m_lastId = 0;
+        QMutexLocker locker(&m_mutex);
         pendingImages.clear();
-        passImage = false;
+        encodingImages.clear();
         cameraActive = false;
     }
 
@@ -258,16 +426,12 @@ gboolean QGstreamerImageCapture::saveImageFilter(GstElement *element,
     Q_UNUSED(pad);
     QGstreamerImageCapture *capture = static_cast<QGstreamerImageCapture *>(appdata);
 
-    capture->passImage = false;
-
-    if (capture->pendingImages.isEmpty()) {
+    QMutexLocker locker(&capture->m_mutex);
+    if (capture->encodingImages.isEmpty())
         return true;
-    }
 
-    auto imageData = capture->pendingImages.dequeue();
-    if (imageData.filename.isEmpty()) {
-        return true;
-    }
+    auto imageData = capture->encodingImages.dequeue();
+    locker.unlock();
 
     qCDebug(qLcImageCapture) << "saving image as" << imageData.filename;
 
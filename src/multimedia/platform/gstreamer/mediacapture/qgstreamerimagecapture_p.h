@@ -57,6 +57,8 @@
 #include "private/qgstreamerbufferprobe_p.h"
 
 #include <qqueue.h>
+#include <qmutex.h>
+#include <qthreadpool.h>
 
 #include <private/qgst_p.h>
 #include <gst/video/video.h>
@@ -74,6 +76,8 @@ public:
     bool isReadyForCapture() const override;
     int capture(const QString &fileName) override;
     int captureToBuffer() override;
+    int captureBurst(int count, const QString &fileName) override;
+    int captureBurstToBuffer(int count) override;
 
     QImageEncoderSettings imageSettings() const override;
     void setImageSettings(const QImageEncoderSettings &settings) override;
@@ -89,8 +93,13 @@ public Q_SLOTS:
     void onCameraChanged();
 
 private:
-    int doCapture(const QString &fileName);
+    int doCapture(int count, const QString &fileName);
+    void convertImage(int id, const QVideoFrame &frame, const QString &fileName,
+                      QImageCapture::FileFormat format, QImageCapture::Quality quality);
     static gboolean saveImageFilter(GstElement *element, GstBuffer *buffer, GstPad *pad, void *appdata);
+    static GstPadProbeReturn copyPooledBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer appdata);
+    static GstPadProbeReturn encoderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer appdata);
+    bool takesNextBuffer() const;
 
     QGstreamerMediaCapture *m_session = nullptr;
     int m_lastId = 0;
@@ -100,19 +109,31 @@ private:
         int id;
         QString filename;
         QMediaMetaData metaData;
+        QImageCapture::FileFormat format = QImageCapture::UnspecifiedFormat;
+        QImageCapture::Quality quality = QImageCapture::NormalQuality;
     };
 
+    // pendingImages and encodingImages are shared with the streaming threads
+    mutable QMutex m_mutex;
+    // requests still waiting for a frame
     QQueue<PendingImage> pendingImages;
+    // frames passed on to the JPEG encoder, waiting to be saved
+    QQueue<PendingImage> encodingImages;
+
+    // converts frames to QImage and encodes the formats GStreamer doesn't
+    // encode for us, so that the probe never blocks the capture queue
+    QThreadPool m_conversionPool;
+    QAtomicInt m_pendingConversions;
 
     QGstBin bin;
     QGstElement queue;
+    QGstElement encodeQueue;
     QGstElement videoConvert;
     QGstElement encoder;
     QGstElement muxer;
     QGstElement sink;
     QGstPad videoSrcPad;
 
-    bool passImage = false;
     bool cameraActive = false;
 };
 
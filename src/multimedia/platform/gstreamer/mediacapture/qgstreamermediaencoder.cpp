@@ -88,6 +88,12 @@ void QGstreamerMediaEncoder::handleSessionError(QMediaRecorder::Error code, cons
     stop();
 }
 
+GstMessageType QGstreamerMediaEncoder::busMessageTypes() const
+{
+    // EOS and errors of the encoding bin arrive forwarded in element messages
+    return GstMessageType(GST_MESSAGE_ELEMENT | GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+}
+
 bool QGstreamerMediaEncoder::processBusMessage(const QGstreamerMessage &message)
 {
     if (message.isNull())
@@ -140,7 +146,7 @@ qint64 QGstreamerMediaEncoder::duration() const
 
 static GstEncodingContainerProfile *createContainerProfile(const QMediaEncoderSettings &settings)
 {
-    auto *formatInfo = QGstreamerIntegration::instance()->m_formatsInfo;
+    auto *formatInfo = QGstreamerIntegration::instance()->gstFormatsInfo();
 
     QGstMutableCaps caps = formatInfo->formatCaps(settings.fileFormat());
 
@@ -154,7 +160,7 @@ static GstEncodingContainerProfile *createContainerProfile(const QMediaEncoderSe
 
 static GstEncodingProfile *createVideoProfile(const QMediaEncoderSettings &settings)
 {
-    auto *formatInfo = QGstreamerIntegration::instance()->m_formatsInfo;
+    auto *formatInfo = QGstreamerIntegration::instance()->gstFormatsInfo();
 
     QGstMutableCaps caps = formatInfo->videoCaps(settings.mediaFormat());
     if (caps.isNull())
@@ -174,7 +180,7 @@ static GstEncodingProfile *createVideoProfile(const QMediaEncoderSettings &setti
 
 static GstEncodingProfile *createAudioProfile(const QMediaEncoderSettings &settings)
 {
-    auto *formatInfo = QGstreamerIntegration::instance()->m_formatsInfo;
+    auto *formatInfo = QGstreamerIntegration::instance()->gstFormatsInfo();
 
     auto caps = formatInfo->audioCaps(settings.mediaFormat());
     if (caps.isNull())
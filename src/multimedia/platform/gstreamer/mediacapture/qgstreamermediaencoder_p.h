@@ -89,6 +89,7 @@ public:
     QGstElement getEncoder() { return gstEncoder; }
 private:
     bool processBusMessage(const QGstreamerMessage& message) override;
+    GstMessageType busMessageTypes() const override;
 
 private:
     struct PauseControl {
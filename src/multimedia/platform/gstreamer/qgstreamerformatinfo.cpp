@@ -41,8 +41,23 @@
 
 #include "private/qgstutils_p.h"
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstandardpaths.h>
+
 QT_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcGstFormatInfo, "qt.multimedia.gstreamer.formatinfo")
+
+// Bump whenever the scan logic or the serialized layout below changes
+static constexpr quint32 formatCacheMagic = 0x51474649; // 'QGFI'
+static constexpr quint32 formatCacheVersion = 1;
+
 QMediaFormat::AudioCodec QGstreamerFormatInfo::audioCodecForCaps(QGstStructure structure)
 {
     const char *name = structure.name().data();
@@ -373,7 +388,172 @@ static void dumpMuxers(const QList<QPlatformMediaFormatInfo::CodecMap> &muxerLis
 }
 #endif
 
-QGstreamerFormatInfo::QGstreamerFormatInfo()
+/*!
+    \internal
+
+    Returns a hash identifying the current state of the GStreamer registry. It
+    changes whenever GStreamer itself is updated or a plugin is added, removed,
+    upgraded or has the rank of one of its element factories changed, which is
+    exactly when the result of the registry scan can change.
+
+    Walking the feature list is cheap compared to the scan itself, which has to
+    parse the static caps of every pad template of every element factory.
+*/
+static QByteArray registryKey()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char *>(&formatCacheVersion), sizeof(formatCacheVersion));
+
+    gchar *version = gst_version_string();
+    hash.addData(version, int(qstrlen(version)));
+    g_free(version);
+
+    GstRegistry *registry = gst_registry_get();
+
+    GList *pluginList = gst_registry_get_plugin_list(registry);
+    for (GList *plugin = pluginList; plugin; plugin = plugin->next) {
+        auto *p = GST_PLUGIN(plugin->data);
+        for (const gchar *s : { gst_plugin_get_name(p), gst_plugin_get_version(p), gst_plugin_get_filename(p) }) {
+            if (s)
+                hash.addData(s, int(qstrlen(s)) + 1);
+        }
+    }
+    gst_plugin_list_free(pluginList);
+
+    GList *featureList = gst_registry_get_feature_list(registry, GST_TYPE_ELEMENT_FACTORY);
+    for (GList *feature = featureList; feature; feature = feature->next) {
+        auto *f = GST_PLUGIN_FEATURE(feature->data);
+        const gchar *name = gst_plugin_feature_get_name(f);
+        hash.addData(name, int(qstrlen(name)) + 1);
+        const guint rank = gst_plugin_feature_get_rank(f);
+        hash.addData(reinterpret_cast<const char *>(&rank), sizeof(rank));
+    }
+    gst_plugin_feature_list_free(featureList);
+
+    return hash.result();
+}
+
+static QString cacheFileName()
+{
+    if (qEnvironmentVariableIsSet("QT_GSTREAMER_DISABLE_FORMAT_CACHE"))
+        return {};
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (dir.isEmpty())
+        return {};
+    return dir + QLatin1String("/qtmultimedia/gstreamer-formatinfo.cache");
+}
+
+template<typename T>
+static void writeEnumList(QDataStream &stream, const QList<T> &list)
+{
+    stream << quint32(list.size());
+    for (const auto &e : list)
+        stream << qint32(e);
+}
+
+template<typename T>
+static QList<T> readEnumList(QDataStream &stream, int last)
+{
+    quint32 size = 0;
+    stream >> size;
+    QList<T> list;
+    for (quint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i) {
+        qint32 e = -1;
+        stream >> e;
+        if (e < 0 || e > last) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        list.append(T(e));
+    }
+    return list;
+}
+
+static void writeCodecMaps(QDataStream &stream, const QList<QPlatformMediaFormatInfo::CodecMap> &maps)
+{
+    stream << quint32(maps.size());
+    for (const auto &m : maps) {
+        stream << qint32(m.format);
+        writeEnumList(stream, m.audio);
+        writeEnumList(stream, m.video);
+    }
+}
+
+static QList<QPlatformMediaFormatInfo::CodecMap> readCodecMaps(QDataStream &stream)
+{
+    quint32 size = 0;
+    stream >> size;
+    QList<QPlatformMediaFormatInfo::CodecMap> maps;
+    for (quint32 i = 0; i < size && stream.status() == QDataStream::Ok; ++i) {
+        qint32 format = -1;
+        stream >> format;
+        if (format < 0 || format > QMediaFormat::LastFileFormat) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        QPlatformMediaFormatInfo::CodecMap m;
+        m.format = QMediaFormat::FileFormat(format);
+        m.audio = readEnumList<QMediaFormat::AudioCodec>(stream, int(QMediaFormat::AudioCodec::LastAudioCodec));
+        m.video = readEnumList<QMediaFormat::VideoCodec>(stream, int(QMediaFormat::VideoCodec::LastVideoCodec));
+        maps.append(m);
+    }
+    return maps;
+}
+
+bool QGstreamerFormatInfo::loadCache(const QString &fileName, const QByteArray &key)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray cachedKey;
+    stream >> magic >> version >> cachedKey;
+    if (magic != formatCacheMagic || version != formatCacheVersion || cachedKey != key)
+        return false;
+
+    auto cachedDecoders = readCodecMaps(stream);
+    auto cachedEncoders = readCodecMaps(stream);
+    auto cachedImageFormats = readEnumList<QImageCapture::FileFormat>(stream, QImageCapture::LastFileFormat);
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    decoders = std::move(cachedDecoders);
+    encoders = std::move(cachedEncoders);
+    imageFormats = std::move(cachedImageFormats);
+    return true;
+}
+
+void QGstreamerFormatInfo::saveCache(const QString &fileName, const QByteArray &key) const
+{
+    if (!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+        return;
+
+    // QSaveFile so that a concurrently starting process never sees a partial file
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << formatCacheMagic << formatCacheVersion << key;
+    writeCodecMaps(stream, decoders);
+    writeCodecMaps(stream, encoders);
+    writeEnumList(stream, imageFormats);
+
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return;
+    }
+    if (!file.commit())
+        qCDebug(qLcGstFormatInfo) << "Could not write format cache" << fileName << file.errorString();
+}
+
+void QGstreamerFormatInfo::scanRegistry()
 {
     auto codecs = getCodecsList(/*decode = */ true);
     decoders = getMuxerList(true, codecs.first, codecs.second);
@@ -387,6 +567,33 @@ QGstreamerFormatInfo::QGstreamerFormatInfo()
     imageFormats = getImageFormatList();
 }
 
+/*!
+    \internal
+
+    Finding out which formats are supported requires scanning all element
+    factories of the GStreamer registry. As the result only depends on the
+    installed plugins, it is cached on disk and only recomputed when
+    registryKey() changes. Setting QT_GSTREAMER_DISABLE_FORMAT_CACHE disables
+    the cache.
+*/
+QGstreamerFormatInfo::QGstreamerFormatInfo()
+{
+    const QString fileName = cacheFileName();
+    if (fileName.isEmpty()) {
+        scanRegistry();
+        return;
+    }
+
+    const QByteArray key = registryKey();
+    if (loadCache(fileName, key)) {
+        qCDebug(qLcGstFormatInfo) << "Using cached format info from" << fileName;
+        return;
+    }
+
+    scanRegistry();
+    saveCache(fileName, key);
+}
+
 QGstreamerFormatInfo::~QGstreamerFormatInfo() = default;
 
 QGstMutableCaps QGstreamerFormatInfo::formatCaps(const QMediaFormat &f) const
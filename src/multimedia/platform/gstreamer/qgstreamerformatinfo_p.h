@@ -74,6 +74,11 @@ public:
     static QImageCapture::FileFormat imageFormatForCaps(QGstStructure structure);
 
     QList<CodecMap> getMuxerList(bool demuxer, QList<QMediaFormat::AudioCodec> audioCodecs, QList<QMediaFormat::VideoCodec> videoCodecs);
+
+private:
+    void scanRegistry();
+    bool loadCache(const QString &fileName, const QByteArray &key);
+    void saveCache(const QString &fileName, const QByteArray &key) const;
 };
 
 QT_END_NAMESPACE
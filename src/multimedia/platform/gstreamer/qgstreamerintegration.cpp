@@ -56,13 +56,12 @@ QGstreamerIntegration::QGstreamerIntegration()
 {
     gst_init(nullptr, nullptr);
     m_devices = new QGstreamerMediaDevices();
-    m_formatsInfo = new QGstreamerFormatInfo();
 }
 
 QGstreamerIntegration::~QGstreamerIntegration()
 {
     delete m_devices;
-    delete m_formatsInfo;
+    delete m_formatsInfo.loadRelaxed();
 }
 
 QPlatformMediaDevices *QGstreamerIntegration::devices()
@@ -72,7 +71,24 @@ QPlatformMediaDevices *QGstreamerIntegration::devices()
 
 QPlatformMediaFormatInfo *QGstreamerIntegration::formatInfo()
 {
-    return m_formatsInfo;
+    return gstFormatsInfo();
+}
+
+QGstreamerFormatInfo *QGstreamerIntegration::gstFormatsInfo()
+{
+    // Created on first use, so that applications that never query formats or
+    // record anything don't pay for the registry scan at startup
+    QGstreamerFormatInfo *info = m_formatsInfo.loadAcquire();
+    if (info)
+        return info;
+
+    QMutexLocker locker(&m_formatsInfoMutex);
+    info = m_formatsInfo.loadRelaxed();
+    if (!info) {
+        info = new QGstreamerFormatInfo();
+        m_formatsInfo.storeRelease(info);
+    }
+    return info;
 }
 
 QPlatformAudioDecoder *QGstreamerIntegration::createAudioDecoder(QAudioDecoder *decoder)
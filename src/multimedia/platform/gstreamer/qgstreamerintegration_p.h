@@ -52,6 +52,8 @@
 //
 
 #include <private/qplatformmediaintegration_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -68,6 +70,7 @@ public:
     static QGstreamerIntegration *instance() { return static_cast<QGstreamerIntegration *>(QPlatformMediaIntegration::instance()); }
     QPlatformMediaDevices *devices() override;
     QPlatformMediaFormatInfo *formatInfo() override;
+    QGstreamerFormatInfo *gstFormatsInfo();
 
     QPlatformAudioDecoder *createAudioDecoder(QAudioDecoder *decoder) override;
     QPlatformMediaCaptureSession *createCaptureSession() override;
@@ -82,7 +85,9 @@ public:
     QPlatformAudioOutput *createAudioOutput(QAudioOutput *) override;
 
     QGstreamerMediaDevices *m_devices = nullptr;
-    QGstreamerFormatInfo *m_formatsInfo = nullptr;
+    // Reached from several threads, created under m_formatsInfoMutex
+    QAtomicPointer<QGstreamerFormatInfo> m_formatsInfo = nullptr;
+    QMutex m_formatsInfoMutex;
 };
 
 QT_END_NAMESPACE
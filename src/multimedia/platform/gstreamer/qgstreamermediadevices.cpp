@@ -45,6 +45,9 @@
 #include "private/qgstreameraudiosink_p.h"
 #include "private/qgstreameraudiodevice_p.h"
 #include "private/qgstutils_p.h"
+#include "private/qplatformcamera_p.h"
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -134,58 +137,77 @@ QList<QAudioDevice> QGstreamerMediaDevices::audioOutputs() const
 
 QList<QCameraDevice> QGstreamerMediaDevices::videoInputs() const
 {
-    QList<QCameraDevice> devices;
-
-    for (auto device : m_videoSources) {
-        QCameraDevicePrivate *info = new QCameraDevicePrivate;
-        auto *desc = gst_device_get_display_name(device.gstDevice);
-        info->description = QString::fromUtf8(desc);
-        g_free(desc);
-        info->id = device.id;
-
-        if (QGstStructure properties = gst_device_get_properties(device.gstDevice); !properties.isNull()) {
-            auto def = properties["is-default"].toBool();
-            info->isDefault = def && *def;
-            properties.free();
+    return m_videoInputs;
+}
+
+static QCameraDevice cameraDeviceForGstDevice(GstDevice *device, const QByteArray &id)
+{
+    QCameraDevicePrivate *info = new QCameraDevicePrivate;
+    auto *desc = gst_device_get_display_name(device);
+    info->description = QString::fromUtf8(desc);
+    g_free(desc);
+    info->id = id;
+
+    if (QGstStructure properties = gst_device_get_properties(device); !properties.isNull()) {
+        auto def = properties["is-default"].toBool();
+        info->isDefault = def && *def;
+        properties.free();
+    }
+
+    QGstCaps caps = gst_device_get_caps(device);
+    if (!caps.isNull()) {
+        QList<QCameraFormat> formats;
+        QList<QSize> photoResolutions;
+
+        int size = caps.size();
+        for (int i = 0; i < size; ++i) {
+            auto cap = caps.at(i);
+
+            QSize resolution = cap.resolution();
+            if (!resolution.isValid())
+                continue;
+
+            auto pixelFormat = cap.pixelFormat();
+            auto frameRate = cap.frameRateRange();
+
+            auto *f = new QCameraFormatPrivate{
+                QSharedData(),
+                pixelFormat,
+                resolution,
+                frameRate.min,
+                frameRate.max
+            };
+            formats << f->create();
+            photoResolutions << resolution;
         }
 
-        if (info->isDefault)
-            devices.prepend(info->create());
+        // Cameras commonly list the same format several times, e.g. once per
+        // framerate in a list that maps onto the same range
+        QPlatformCamera::sortCameraFormats(formats);
+
+        std::sort(photoResolutions.begin(), photoResolutions.end(), [](const QSize &a, const QSize &b) {
+            const qint64 areaA = qint64(a.width()) * a.height();
+            const qint64 areaB = qint64(b.width()) * b.height();
+            return areaA != areaB ? areaA > areaB : a.width() > b.width();
+        });
+        photoResolutions.erase(std::unique(photoResolutions.begin(), photoResolutions.end()), photoResolutions.end());
+
+        info->videoFormats = formats;
+        info->photoResolutions = photoResolutions;
+    }
+    return info->create();
+}
+
+void QGstreamerMediaDevices::updateVideoInputs()
+{
+    m_videoInputs.clear();
+    m_videoInputs.reserve(qsizetype(m_videoSources.size()));
+    for (const auto &device : m_videoSources) {
+        if (device.cameraDevice.isDefault())
+            m_videoInputs.prepend(device.cameraDevice);
         else
-            devices.append(info->create());
-
-        QGstCaps caps = gst_device_get_caps(device.gstDevice);
-        if (!caps.isNull()) {
-            QList<QCameraFormat> formats;
-            QSet<QSize> photoResolutions;
-
-            int size = caps.size();
-            for (int i = 0; i < size; ++i) {
-                auto cap = caps.at(i);
-
-                QSize resolution = cap.resolution();
-                if (!resolution.isValid())
-                    continue;
-
-                auto pixelFormat = cap.pixelFormat();
-                auto frameRate = cap.frameRateRange();
-
-                auto *f = new QCameraFormatPrivate{
-                    QSharedData(),
-                    pixelFormat,
-                    resolution,
-                    frameRate.min,
-                    frameRate.max
-                };
-                formats << f->create();
-                photoResolutions.insert(resolution);
-            }
-            info->videoFormats = formats;
-            // ### sort resolutions?
-            info->photoResolutions = photoResolutions.values();
-        }
+            m_videoInputs.append(device.cameraDevice);
     }
-    return devices;
 }
 
 QPlatformAudioSource *QGstreamerMediaDevices::createAudioSource(const QAudioDevice &deviceInfo)
@@ -204,9 +226,14 @@ void QGstreamerMediaDevices::addDevice(GstDevice *device)
 //    qDebug() << "adding device:" << device << type << gst_device_get_display_name(device) << gst_structure_to_string(gst_device_get_properties(device));
     gst_object_ref(device);
     if (!strcmp(type, "Video/Source")) {
-        m_videoSources.push_back({device, QByteArray::number(m_idGenerator)});
-        videoInputsChanged();
+        // Probe the caps once here instead of on every videoInputs() call
+        QGstDevice source{device, QByteArray::number(m_idGenerator), {}, {}};
+        source.cameraDevice = cameraDeviceForGstDevice(device, source.id);
+        source.defaultFormat = QPlatformCamera::findBestCameraFormat(source.cameraDevice);
+        m_videoSources.push_back(std::move(source));
         m_idGenerator++;
+        updateVideoInputs();
+        videoInputsChanged();
     } else if (!strcmp(type, "Audio/Source")) {
         m_audioSources.insert(device);
         audioInputsChanged();
@@ -227,11 +254,15 @@ void QGstreamerMediaDevices::removeDevice(GstDevice *device)
 
     if (it != m_videoSources.end()) {
         m_videoSources.erase(it);
+        updateVideoInputs();
         videoInputsChanged();
     } else if (m_audioSources.remove(device)) {
         audioInputsChanged();
     } else if (m_audioSinks.remove(device)) {
         audioOutputsChanged();
+    } else {
+        // not one of ours, we don't hold a reference to it
+        return;
     }
 
     gst_object_unref(device);
@@ -263,11 +294,29 @@ GstDevice *QGstreamerMediaDevices::audioDevice(const QByteArray &id, QAudioDevic
     return getDevice(devices, "device.bus_path", id);
 }
 
-GstDevice *QGstreamerMediaDevices::videoDevice(const QByteArray &id) const
+const QGstreamerMediaDevices::QGstDevice *QGstreamerMediaDevices::videoSource(const QByteArray &id) const
 {
     auto it = std::find_if(m_videoSources.begin(), m_videoSources.end(),
                            [=](const QGstDevice &a) { return a.id == id; });
-    return it != m_videoSources.end() ? it->gstDevice : nullptr;
+    return it != m_videoSources.end() ? &*it : nullptr;
+}
+
+GstDevice *QGstreamerMediaDevices::videoDevice(const QByteArray &id) const
+{
+    auto *source = videoSource(id);
+    return source ? source->gstDevice : nullptr;
+}
+
+/*!
+    \internal
+
+    Returns the format QPlatformCamera::findBestCameraFormat() picks for the
+    camera \a id. It is computed once when the device is added.
+*/
+QCameraFormat QGstreamerMediaDevices::defaultCameraFormat(const QByteArray &id) const
+{
+    auto *source = videoSource(id);
+    return source ? source->defaultFormat : QCameraFormat();
 }
 
 QT_END_NAMESPACE
@@ -55,6 +55,7 @@
 #include <gst/gst.h>
 #include <qset.h>
 #include <qaudiodevice.h>
+#include <qcameradevice.h>
 #include <vector>
 
 QT_BEGIN_NAMESPACE
@@ -76,14 +77,22 @@ public:
     GstDevice *audioDevice(const QByteArray &id, QAudioDevice::Mode mode) const;
     GstDevice *videoDevice(const QByteArray &id) const;
 
+    QCameraFormat defaultCameraFormat(const QByteArray &id) const;
+
 private:
     struct QGstDevice {
         GstDevice *gstDevice = nullptr;
         QByteArray id;
+        QCameraDevice cameraDevice;
+        QCameraFormat defaultFormat;
     };
 
+    const QGstDevice *videoSource(const QByteArray &id) const;
+    void updateVideoInputs();
+
     quint64 m_idGenerator = 0;
     std::vector<QGstDevice> m_videoSources;
+    QList<QCameraDevice> m_videoInputs;
 
     QSet<GstDevice *> m_audioSources;
     QSet<GstDevice *> m_audioSinks;
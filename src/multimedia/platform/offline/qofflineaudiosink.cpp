@@ -0,0 +1,427 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qofflineaudiosink_p.h"
+#include "qofflineintegration_p.h"
+
+#include <private/qaudiohelpers_p.h>
+#include <qwavedecoder.h>
+#include <QtCore/qfile.h>
+
+QT_BEGIN_NAMESPACE
+
+// How often a paced sink hands data to its virtual device
+static constexpr int PacedInterval = 10;
+
+QOfflineAudioSink::QOfflineAudioSink(QObject *parent)
+    : QPlatformAudioSink(parent),
+      m_integration(QOfflineMediaIntegration::instance())
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &QOfflineAudioSink::process);
+}
+
+QOfflineAudioSink::~QOfflineAudioSink()
+{
+    close();
+    delete m_pushDevice;
+}
+
+void QOfflineAudioSink::start(QIODevice *device)
+{
+    if (m_state != QAudio::StoppedState)
+        stop();
+
+    delete m_pushDevice;
+    m_pushDevice = nullptr;
+
+    m_source = device;
+    m_pullMode = true;
+    if (!open())
+        return;
+
+    setStateAndError(QAudio::ActiveState, QAudio::NoError);
+    updateTimer();
+}
+
+QIODevice *QOfflineAudioSink::start()
+{
+    if (m_state != QAudio::StoppedState)
+        stop();
+
+    delete m_pushDevice;
+    m_pushDevice = new QOfflineAudioSinkDevice(this);
+    m_pushDevice->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+    m_source = nullptr;
+    m_pullMode = false;
+    if (!open())
+        return m_pushDevice;
+
+    setStateAndError(QAudio::IdleState, QAudio::NoError);
+    updateTimer();
+    return m_pushDevice;
+}
+
+void QOfflineAudioSink::stop()
+{
+    if (m_state == QAudio::StoppedState)
+        return;
+    close();
+    setStateAndError(QAudio::StoppedState, QAudio::NoError);
+}
+
+void QOfflineAudioSink::reset()
+{
+    m_buffer.clear();
+    stop();
+}
+
+void QOfflineAudioSink::suspend()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+    m_timer.stop();
+    setStateAndError(QAudio::SuspendedState, QAudio::NoError);
+}
+
+void QOfflineAudioSink::resume()
+{
+    if (m_state != QAudio::SuspendedState)
+        return;
+    m_clock.restart();
+    m_clockFrames = 0;
+    const bool active = m_pullMode || !m_buffer.isEmpty();
+    setStateAndError(active ? QAudio::ActiveState : QAudio::IdleState, QAudio::NoError);
+    updateTimer();
+}
+
+qsizetype QOfflineAudioSink::bytesFree() const
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+    return m_bufferSize - m_buffer.size();
+}
+
+void QOfflineAudioSink::setBufferSize(qsizetype value)
+{
+    if (m_state == QAudio::StoppedState)
+        m_bufferSize = value;
+}
+
+qsizetype QOfflineAudioSink::bufferSize() const
+{
+    return m_bufferSize;
+}
+
+qint64 QOfflineAudioSink::processedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+    return m_processedFrames * 1000000 / m_format.sampleRate();
+}
+
+QAudio::Error QOfflineAudioSink::error() const
+{
+    return m_error;
+}
+
+QAudio::State QOfflineAudioSink::state() const
+{
+    return m_state;
+}
+
+void QOfflineAudioSink::setFormat(const QAudioFormat &format)
+{
+    if (m_state == QAudio::StoppedState)
+        m_format = format;
+}
+
+QAudioFormat QOfflineAudioSink::format() const
+{
+    return m_format;
+}
+
+void QOfflineAudioSink::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0.), volume, qreal(1.));
+}
+
+qreal QOfflineAudioSink::volume() const
+{
+    return m_volume;
+}
+
+QByteArray QOfflineAudioSink::recentOutput() const
+{
+    if (!m_ringFull)
+        return m_ring.left(m_ringPos);
+    return m_ring.mid(m_ringPos) + m_ring.left(m_ringPos);
+}
+
+qint64 QOfflineAudioSink::write(const char *data, qint64 len)
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return 0;
+
+    len = m_format.bytesForFrames(m_format.framesForBytes(int(qMin<qint64>(len, bytesFree()))));
+    if (len <= 0)
+        return 0;
+    m_buffer.append(data, len);
+
+    if (m_state == QAudio::IdleState)
+        setStateAndError(QAudio::ActiveState, QAudio::NoError);
+
+    // Without pacing the virtual device consumes everything right away, so
+    // the writer is only limited by how fast it can produce data.
+    if (!m_integration || m_integration->options().rate <= 0.)
+        output(m_buffer.size());
+    else
+        updateTimer();
+    return len;
+}
+
+void QOfflineAudioSink::process()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    bool gotData = false;
+    if (m_pullMode && m_source) {
+        const qsizetype free = m_format.bytesForFrames(m_format.framesForBytes(int(bytesFree())));
+        if (free > 0) {
+            const qsizetype old = m_buffer.size();
+            m_buffer.resize(old + free);
+            const qint64 read = m_source->read(m_buffer.data() + old, free);
+            if (read < 0) {
+                m_buffer.resize(old);
+                close();
+                setStateAndError(QAudio::StoppedState, QAudio::IOError);
+                return;
+            }
+            m_buffer.resize(old + read);
+            gotData = read > 0;
+            if (gotData && m_state == QAudio::IdleState)
+                setStateAndError(QAudio::ActiveState, QAudio::NoError);
+        }
+    }
+
+    qsizetype len = m_buffer.size();
+    const double rate = m_integration ? m_integration->options().rate : 0.;
+    if (rate > 0.) {
+        const qint64 due = qint64(m_clock.nsecsElapsed() / 1e9 * rate * m_format.sampleRate())
+                - m_clockFrames;
+        len = qMin<qsizetype>(len, m_format.bytesForFrames(qBound(qint64(0), due, qint64(INT_MAX))));
+    }
+    output(len);
+
+    if (m_buffer.isEmpty()) {
+        // Don't let a paced device catch up on the time it had nothing to play
+        m_clock.restart();
+        m_clockFrames = 0;
+        if (m_state == QAudio::ActiveState && (m_pullMode ? !gotData : rate > 0.))
+            setStateAndError(QAudio::IdleState, QAudio::UnderrunError);
+    }
+    updateTimer();
+}
+
+bool QOfflineAudioSink::open()
+{
+    if (!m_format.isValid()) {
+        qWarning("QAudioSink: open error, invalid format.");
+        setStateAndError(QAudio::StoppedState, QAudio::OpenError);
+        return false;
+    }
+
+    if (m_bufferSize <= 0)
+        m_bufferSize = m_format.bytesForDuration(100000);
+    m_bufferSize = qMax(m_format.bytesForFrames(m_format.framesForBytes(int(m_bufferSize))),
+                        m_format.bytesPerFrame());
+    m_buffer.clear();
+    m_buffer.reserve(m_bufferSize);
+
+    const QString fileName = m_integration ? m_integration->options().outputFile : QString();
+    if (!fileName.isEmpty()) {
+        // QWaveDecoder only writes 16 bit files
+        QAudioFormat fileFormat = m_format;
+        fileFormat.setSampleFormat(QAudioFormat::Int16);
+        m_file = new QFile(fileName);
+        m_writer = new QWaveDecoder(m_file, fileFormat);
+        if (!m_file->open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || !m_writer->open(QIODevice::WriteOnly)) {
+            qWarning() << "QAudioSink: cannot write to" << fileName;
+            close();
+            setStateAndError(QAudio::StoppedState, QAudio::OpenError);
+            return false;
+        }
+        m_converter.setFormats(m_format, fileFormat);
+    } else {
+        m_ring.resize(m_integration ? m_integration->options().ringSize : 0);
+        m_ringPos = 0;
+        m_ringFull = false;
+    }
+
+    m_processedFrames = 0;
+    m_clock.start();
+    m_clockFrames = 0;
+    m_activeTime.start();
+    return true;
+}
+
+void QOfflineAudioSink::close()
+{
+    m_timer.stop();
+
+    if (m_writer) {
+        if (m_writer->isOpen()) {
+            if (!m_converter.isPassthrough())
+                m_writer->write(m_converter.flush());
+            m_writer->close();
+        }
+        delete m_writer;
+        m_writer = nullptr;
+    }
+    delete m_file;
+    m_file = nullptr;
+    m_converter.reset();
+
+    if (m_activeTime.isValid()) {
+        const qint64 elapsed = m_activeTime.nsecsElapsed() / 1000;
+        const double framesPerSecond = elapsed > 0 ? m_processedFrames * 1e6 / elapsed : 0.;
+        qCDebug(qLcOfflineMedia).nospace()
+                << "audio sink wrote " << m_processedFrames << " frames in " << elapsed / 1000
+                << " ms (" << framesPerSecond << " frames/s, "
+                << framesPerSecond * m_format.channelCount() << " samples/s)";
+        m_activeTime.invalidate();
+    }
+}
+
+void QOfflineAudioSink::output(qsizetype len)
+{
+    if (len <= 0)
+        return;
+
+    char *data = m_buffer.data();
+    if (!qFuzzyCompare(m_volume, qreal(1.)))
+        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, data, int(len));
+
+    if (m_writer) {
+        if (m_converter.isPassthrough())
+            m_writer->write(data, len);
+        else
+            m_writer->write(m_converter.convert(QByteArrayView(data, len)));
+    } else {
+        writeToRing(data, len);
+    }
+
+    const qint64 frames = m_format.framesForBytes(int(len));
+    m_processedFrames += frames;
+    m_clockFrames += frames;
+    if (m_integration)
+        m_integration->addAudioFramesWritten(frames, m_format.channelCount());
+    m_buffer.remove(0, len);
+}
+
+void QOfflineAudioSink::writeToRing(const char *data, qsizetype len)
+{
+    const qsizetype size = m_ring.size();
+    if (!size)
+        return;
+    if (len >= size) {
+        memcpy(m_ring.data(), data + len - size, size);
+        m_ringPos = 0;
+        m_ringFull = true;
+        return;
+    }
+    const qsizetype first = qMin(len, size - m_ringPos);
+    memcpy(m_ring.data() + m_ringPos, data, first);
+    memcpy(m_ring.data(), data + first, len - first);
+    m_ringPos += len;
+    if (m_ringPos >= size) {
+        m_ringPos -= size;
+        m_ringFull = true;
+    }
+}
+
+void QOfflineAudioSink::setStateAndError(QAudio::State state, QAudio::Error error)
+{
+    const bool errorDiffers = m_error != error;
+    const bool stateDiffers = m_state != state;
+    m_error = error;
+    m_state = state;
+    if (errorDiffers)
+        emit errorChanged(error);
+    if (stateDiffers)
+        emit stateChanged(state);
+}
+
+void QOfflineAudioSink::updateTimer()
+{
+    const bool running = m_state == QAudio::ActiveState || m_state == QAudio::IdleState;
+    const bool paced = m_integration && m_integration->options().rate > 0.;
+    // An unpaced push sink outputs everything from write() and needs no timer
+    if (!running || (!m_pullMode && !paced)) {
+        m_timer.stop();
+        return;
+    }
+    // An unpaced pull sink reads again as soon as the event loop is free
+    const int interval = (paced || m_state == QAudio::IdleState) ? PacedInterval : 0;
+    if (!m_timer.isActive() || m_timer.interval() != interval)
+        m_timer.start(interval);
+}
+
+QOfflineAudioSinkDevice::QOfflineAudioSinkDevice(QOfflineAudioSink *sink)
+    : m_sink(sink)
+{
+}
+
+qint64 QOfflineAudioSinkDevice::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return 0;
+}
+
+qint64 QOfflineAudioSinkDevice::writeData(const char *data, qint64 len)
+{
+    return m_sink->write(data, len);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,155 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QOFFLINEAUDIOSINK_P_H
+#define QOFFLINEAUDIOSINK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qaudiosystem_p.h>
+#include <private/qaudioconverter_p.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QFile;
+class QWaveDecoder;
+class QOfflineMediaIntegration;
+
+class QOfflineAudioSink : public QPlatformAudioSink
+{
+    Q_OBJECT
+public:
+    QOfflineAudioSink(QObject *parent = nullptr);
+    ~QOfflineAudioSink();
+
+    void start(QIODevice *device) override;
+    QIODevice *start() override;
+    void stop() override;
+    void reset() override;
+    void suspend() override;
+    void resume() override;
+    qsizetype bytesFree() const override;
+    void setBufferSize(qsizetype value) override;
+    qsizetype bufferSize() const override;
+    qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override { return 0; }
+    QAudio::Error error() const override;
+    QAudio::State state() const override;
+    void setFormat(const QAudioFormat &format) override;
+    QAudioFormat format() const override;
+    void setVolume(qreal volume) override;
+    qreal volume() const override;
+
+    // Contents of the memory ring, oldest data first. Empty when writing to a file.
+    QByteArray recentOutput() const;
+
+    qint64 write(const char *data, qint64 len);
+
+private slots:
+    void process();
+
+private:
+    bool open();
+    void close();
+    void output(qsizetype len);
+    void writeToRing(const char *data, qsizetype len);
+    void setStateAndError(QAudio::State state, QAudio::Error error);
+    void updateTimer();
+
+    QOfflineMediaIntegration *m_integration = nullptr;
+    QAudioFormat m_format;
+    QAudio::State m_state = QAudio::StoppedState;
+    QAudio::Error m_error = QAudio::NoError;
+    qreal m_volume = 1.;
+
+    QPointer<QIODevice> m_source;
+    QIODevice *m_pushDevice = nullptr;
+    bool m_pullMode = false;
+
+    qsizetype m_bufferSize = 0;
+    QByteArray m_buffer;
+    QTimer m_timer;
+
+    // Pacing: frames output since m_clock was started
+    QElapsedTimer m_clock;
+    qint64 m_clockFrames = 0;
+
+    qint64 m_processedFrames = 0;
+    QElapsedTimer m_activeTime;
+
+    QFile *m_file = nullptr;
+    QWaveDecoder *m_writer = nullptr;
+    QAudioConverter m_converter;
+    QByteArray m_ring;
+    qsizetype m_ringPos = 0;
+    bool m_ringFull = false;
+};
+
+class QOfflineAudioSinkDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    QOfflineAudioSinkDevice(QOfflineAudioSink *sink);
+
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    QOfflineAudioSink *m_sink;
+};
+
+QT_END_NAMESPACE
+
+#endif // QOFFLINEAUDIOSINK_P_H
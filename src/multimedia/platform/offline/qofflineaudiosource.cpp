@@ -0,0 +1,391 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qofflineaudiosource_p.h"
+#include "qofflineintegration_p.h"
+
+#include <private/qaudiohelpers_p.h>
+#include <qwavedecoder.h>
+#include <QtCore/qfile.h>
+
+QT_BEGIN_NAMESPACE
+
+// How often a paced source produces data
+static constexpr int PacedInterval = 10;
+
+QOfflineAudioSource::QOfflineAudioSource()
+    : m_integration(QOfflineMediaIntegration::instance())
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &QOfflineAudioSource::process);
+}
+
+QOfflineAudioSource::~QOfflineAudioSource()
+{
+    close();
+    delete m_device;
+}
+
+void QOfflineAudioSource::start(QIODevice *device)
+{
+    if (m_state != QAudio::StoppedState)
+        stop();
+
+    delete m_device;
+    m_device = nullptr;
+
+    m_sink = device;
+    m_pullMode = true;
+    if (!open())
+        return;
+
+    setStateAndError(QAudio::ActiveState, QAudio::NoError);
+    updateTimer();
+}
+
+QIODevice *QOfflineAudioSource::start()
+{
+    if (m_state != QAudio::StoppedState)
+        stop();
+
+    delete m_device;
+    m_device = new QOfflineAudioSourceDevice(this);
+    m_device->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    m_sink = nullptr;
+    m_pullMode = false;
+    if (!open())
+        return m_device;
+
+    setStateAndError(QAudio::ActiveState, QAudio::NoError);
+    updateTimer();
+    return m_device;
+}
+
+void QOfflineAudioSource::stop()
+{
+    if (m_state == QAudio::StoppedState)
+        return;
+    close();
+    setStateAndError(QAudio::StoppedState, QAudio::NoError);
+}
+
+void QOfflineAudioSource::reset()
+{
+    m_buffer.clear();
+    stop();
+}
+
+void QOfflineAudioSource::suspend()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+    m_timer.stop();
+    setStateAndError(QAudio::SuspendedState, QAudio::NoError);
+}
+
+void QOfflineAudioSource::resume()
+{
+    if (m_state != QAudio::SuspendedState)
+        return;
+    m_clock.restart();
+    m_clockFrames = 0;
+    setStateAndError(m_atEnd ? QAudio::IdleState : QAudio::ActiveState, QAudio::NoError);
+    updateTimer();
+}
+
+qsizetype QOfflineAudioSource::bytesReady() const
+{
+    if (m_pullMode || (m_state != QAudio::ActiveState && m_state != QAudio::IdleState))
+        return 0;
+    return m_buffer.size();
+}
+
+void QOfflineAudioSource::setBufferSize(qsizetype value)
+{
+    if (m_state == QAudio::StoppedState)
+        m_bufferSize = value;
+}
+
+qsizetype QOfflineAudioSource::bufferSize() const
+{
+    return m_bufferSize;
+}
+
+qint64 QOfflineAudioSource::processedUSecs() const
+{
+    if (m_format.sampleRate() <= 0)
+        return 0;
+    return m_processedFrames * 1000000 / m_format.sampleRate();
+}
+
+QAudio::Error QOfflineAudioSource::error() const
+{
+    return m_error;
+}
+
+QAudio::State QOfflineAudioSource::state() const
+{
+    return m_state;
+}
+
+void QOfflineAudioSource::setFormat(const QAudioFormat &format)
+{
+    if (m_state == QAudio::StoppedState)
+        m_format = format;
+}
+
+QAudioFormat QOfflineAudioSource::format() const
+{
+    return m_format;
+}
+
+void QOfflineAudioSource::setVolume(qreal volume)
+{
+    m_volume = qBound(qreal(0.), volume, qreal(1.));
+}
+
+qreal QOfflineAudioSource::volume() const
+{
+    return m_volume;
+}
+
+qint64 QOfflineAudioSource::read(char *data, qint64 len)
+{
+    const qsizetype n = qMin<qsizetype>(len, m_buffer.size());
+    if (n <= 0)
+        return 0;
+    memcpy(data, m_buffer.constData(), n);
+    m_buffer.remove(0, n);
+    updateTimer();
+    return n;
+}
+
+void QOfflineAudioSource::process()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+
+    qsizetype len = m_pullMode ? m_bufferSize : m_bufferSize - m_buffer.size();
+    const double rate = m_integration ? m_integration->options().rate : 0.;
+    if (rate > 0.) {
+        const qint64 due = qint64(m_clock.nsecsElapsed() / 1e9 * rate * m_format.sampleRate())
+                - m_clockFrames;
+        const qsizetype dueBytes = m_format.bytesForFrames(qBound(qint64(0), due, qint64(INT_MAX)));
+        // A reader that can't keep up loses data on a real device. Don't make
+        // it up later in one burst either.
+        if (dueBytes > len) {
+            m_clock.restart();
+            m_clockFrames = 0;
+        }
+        len = qMin(len, dueBytes);
+    }
+
+    if (len > 0) {
+        const qsizetype old = m_pullMode ? 0 : m_buffer.size();
+        m_buffer.resize(old + len);
+        const qsizetype produced = produce(m_buffer.data() + old, len);
+        m_buffer.resize(old + produced);
+
+        if (produced > 0) {
+            if (m_pullMode) {
+                if (m_sink)
+                    m_sink->write(m_buffer.constData(), produced);
+                m_buffer.clear();
+            } else {
+                emit m_device->readyRead();
+            }
+        }
+    }
+
+    if (m_atEnd && m_converted.isEmpty() && m_buffer.isEmpty() && m_state == QAudio::ActiveState)
+        setStateAndError(QAudio::IdleState, QAudio::NoError);
+    updateTimer();
+}
+
+bool QOfflineAudioSource::open()
+{
+    if (!m_format.isValid()) {
+        qWarning("QAudioSource: open error, invalid format.");
+        setStateAndError(QAudio::StoppedState, QAudio::OpenError);
+        return false;
+    }
+
+    if (m_bufferSize <= 0)
+        m_bufferSize = m_format.bytesForDuration(100000);
+    m_bufferSize = qMax(m_format.bytesForFrames(m_format.framesForBytes(int(m_bufferSize))),
+                        m_format.bytesPerFrame());
+    m_buffer.clear();
+    m_buffer.reserve(m_bufferSize);
+    m_converted.clear();
+    m_atEnd = false;
+
+    const QString fileName = m_integration ? m_integration->options().inputFile : QString();
+    if (!fileName.isEmpty()) {
+        m_file = new QFile(fileName);
+        m_reader = new QWaveDecoder(m_file);
+        if (!m_file->open(QIODevice::ReadOnly) || !m_reader->open(QIODevice::ReadOnly)
+            || !m_reader->audioFormat().isValid()) {
+            qWarning() << "QAudioSource: cannot read WAV data from" << fileName;
+            close();
+            setStateAndError(QAudio::StoppedState, QAudio::OpenError);
+            return false;
+        }
+        m_converter.setFormats(m_reader->audioFormat(), m_format);
+    }
+
+    m_processedFrames = 0;
+    m_clock.start();
+    m_clockFrames = 0;
+    m_activeTime.start();
+    return true;
+}
+
+void QOfflineAudioSource::close()
+{
+    m_timer.stop();
+
+    delete m_reader;
+    m_reader = nullptr;
+    delete m_file;
+    m_file = nullptr;
+    m_converter.reset();
+
+    if (m_activeTime.isValid()) {
+        const qint64 elapsed = m_activeTime.nsecsElapsed() / 1000;
+        const double framesPerSecond = elapsed > 0 ? m_processedFrames * 1e6 / elapsed : 0.;
+        qCDebug(qLcOfflineMedia).nospace()
+                << "audio source read " << m_processedFrames << " frames in " << elapsed / 1000
+                << " ms (" << framesPerSecond << " frames/s, "
+                << framesPerSecond * m_format.channelCount() << " samples/s)";
+        m_activeTime.invalidate();
+    }
+}
+
+qsizetype QOfflineAudioSource::produce(char *data, qsizetype len)
+{
+    len = m_format.bytesForFrames(m_format.framesForBytes(int(len)));
+
+    qsizetype produced = 0;
+    if (!m_reader) {
+        // Without an input file the device records silence
+        memset(data, m_format.sampleFormat() == QAudioFormat::UInt8 ? 0x80 : 0, len);
+        produced = len;
+    } else if (m_converter.isPassthrough()) {
+        produced = qMax(m_reader->read(data, len), qint64(0));
+        if (produced < len)
+            m_atEnd = true;
+    } else {
+        const QAudioFormat inputFormat = m_converter.inputFormat();
+        while (m_converted.size() < len && !m_atEnd) {
+            const qint64 missing = m_format.durationForBytes(int(len - m_converted.size()));
+            const qint64 bytes = qMax(inputFormat.bytesForDuration(missing), inputFormat.bytesPerFrame());
+            const QByteArray input = m_reader->read(bytes);
+            if (input.isEmpty()) {
+                m_atEnd = true;
+                m_converted += m_converter.flush();
+                break;
+            }
+            m_converted += m_converter.convert(input);
+        }
+        produced = qMin(len, m_converted.size());
+        memcpy(data, m_converted.constData(), produced);
+        m_converted.remove(0, produced);
+    }
+
+    if (produced <= 0)
+        return 0;
+    if (!qFuzzyCompare(m_volume, qreal(1.)))
+        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, data, int(produced));
+
+    const qint64 frames = m_format.framesForBytes(int(produced));
+    m_processedFrames += frames;
+    m_clockFrames += frames;
+    if (m_integration)
+        m_integration->addAudioFramesRead(frames, m_format.channelCount());
+    return produced;
+}
+
+void QOfflineAudioSource::setStateAndError(QAudio::State state, QAudio::Error error)
+{
+    const bool errorDiffers = m_error != error;
+    const bool stateDiffers = m_state != state;
+    m_error = error;
+    m_state = state;
+    if (errorDiffers)
+        emit errorChanged(error);
+    if (stateDiffers)
+        emit stateChanged(state);
+}
+
+void QOfflineAudioSource::updateTimer()
+{
+    const bool running = m_state == QAudio::ActiveState;
+    if (!running) {
+        m_timer.stop();
+        return;
+    }
+    const bool paced = m_integration && m_integration->options().rate > 0.;
+    // Unpaced, produce again as soon as the event loop is free, unless the
+    // reader has not made room for more yet
+    const bool full = !m_pullMode && m_buffer.size() >= m_bufferSize;
+    const int interval = (paced || full) ? PacedInterval : 0;
+    if (!m_timer.isActive() || m_timer.interval() != interval)
+        m_timer.start(interval);
+}
+
+QOfflineAudioSourceDevice::QOfflineAudioSourceDevice(QOfflineAudioSource *source)
+    : m_source(source)
+{
+}
+
+qint64 QOfflineAudioSourceDevice::readData(char *data, qint64 len)
+{
+    return m_source->read(data, len);
+}
+
+qint64 QOfflineAudioSourceDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return 0;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,169 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qofflineintegration_p.h"
+#include "qofflinemediadevices_p.h"
+#include "qofflinevideosink_p.h"
+
+#include <private/qplatformmediaformatinfo_p.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcOfflineMedia, "qt.multimedia.offline")
+
+static QOfflineMediaIntegration *s_instance = nullptr;
+
+/*!
+    \class QOfflineMediaIntegration
+    \internal
+
+    The offline integration is configured through the environment:
+
+    \list
+    \li \c QT_OFFLINE_MEDIA_OUTPUT: WAV file audio sinks write to. Without it
+        the output goes to a memory ring of \c QT_OFFLINE_MEDIA_RING_SIZE bytes.
+    \li \c QT_OFFLINE_MEDIA_INPUT: WAV file audio sources read from. Without
+        it the sources produce silence.
+    \li \c QT_OFFLINE_MEDIA_RATE: speed relative to real time. 1 paces the
+        audio like a sound card would, 0 (the default) runs as fast as the
+        application can produce or consume the data.
+    \endlist
+*/
+QOfflineMediaIntegration::Options QOfflineMediaIntegration::Options::fromEnvironment()
+{
+    Options options;
+    options.outputFile = qEnvironmentVariable("QT_OFFLINE_MEDIA_OUTPUT");
+    options.inputFile = qEnvironmentVariable("QT_OFFLINE_MEDIA_INPUT");
+
+    bool ok = false;
+    double rate = qEnvironmentVariable("QT_OFFLINE_MEDIA_RATE").toDouble(&ok);
+    if (ok && rate >= 0.)
+        options.rate = rate;
+    int ringSize = qEnvironmentVariableIntValue("QT_OFFLINE_MEDIA_RING_SIZE", &ok);
+    if (ok && ringSize > 0)
+        options.ringSize = ringSize;
+    return options;
+}
+
+QOfflineMediaIntegration::QOfflineMediaIntegration(const Options &options)
+    : m_options(options)
+{
+    m_elapsed.start();
+    s_instance = this;
+}
+
+QOfflineMediaIntegration::~QOfflineMediaIntegration()
+{
+    reportStatistics();
+    delete m_devices;
+    delete m_formatInfo;
+    if (s_instance == this)
+        s_instance = nullptr;
+}
+
+QOfflineMediaIntegration *QOfflineMediaIntegration::instance()
+{
+    return s_instance;
+}
+
+QPlatformMediaDevices *QOfflineMediaIntegration::devices()
+{
+    if (!m_devices)
+        m_devices = new QOfflineMediaDevices();
+    return m_devices;
+}
+
+QPlatformMediaFormatInfo *QOfflineMediaIntegration::formatInfo()
+{
+    if (!m_formatInfo) {
+        m_formatInfo = new QPlatformMediaFormatInfo();
+        m_formatInfo->decoders = { { QMediaFormat::Wave, { QMediaFormat::AudioCodec::Wave }, {} } };
+        m_formatInfo->encoders = m_formatInfo->decoders;
+    }
+    return m_formatInfo;
+}
+
+QPlatformVideoSink *QOfflineMediaIntegration::createVideoSink(QVideoSink *sink)
+{
+    return new QOfflineVideoSink(sink);
+}
+
+void QOfflineMediaIntegration::addVideoFrame(qint64 latencyUSecs)
+{
+    m_videoFrames.fetchAndAddRelaxed(1);
+    if (latencyUSecs < 0)
+        return;
+    m_timedVideoFrames.fetchAndAddRelaxed(1);
+    m_videoLatencySum.fetchAndAddRelaxed(latencyUSecs);
+    qint64 max = m_videoLatencyMax.loadRelaxed();
+    while (latencyUSecs > max && !m_videoLatencyMax.testAndSetRelaxed(max, latencyUSecs, max))
+        ;
+}
+
+QOfflineMediaStatistics QOfflineMediaIntegration::statistics() const
+{
+    QOfflineMediaStatistics stats;
+    stats.elapsedUSecs = m_elapsed.nsecsElapsed() / 1000;
+    stats.audioFramesWritten = m_audioFramesWritten.loadRelaxed();
+    stats.audioFramesRead = m_audioFramesRead.loadRelaxed();
+    stats.audioSamplesWritten = m_audioSamplesWritten.loadRelaxed();
+    stats.audioSamplesRead = m_audioSamplesRead.loadRelaxed();
+    stats.videoFrames = m_videoFrames.loadRelaxed();
+    const qint64 timedFrames = m_timedVideoFrames.loadRelaxed();
+    if (timedFrames)
+        stats.averageVideoLatencyUSecs = m_videoLatencySum.loadRelaxed() / timedFrames;
+    stats.maximumVideoLatencyUSecs = m_videoLatencyMax.loadRelaxed();
+    return stats;
+}
+
+void QOfflineMediaIntegration::reportStatistics() const
+{
+    const QOfflineMediaStatistics stats = statistics();
+    qCInfo(qLcOfflineMedia).nospace()
+            << "processed in " << stats.elapsedUSecs / 1000 << " ms: "
+            << stats.audioFramesWritten << " audio frames written (" << stats.audioFramesWrittenPerSecond() << " frames/s, "
+            << stats.audioSamplesWrittenPerSecond() << " samples/s), "
+            << stats.audioFramesRead << " audio frames read (" << stats.audioFramesReadPerSecond() << " frames/s, "
+            << stats.audioSamplesReadPerSecond() << " samples/s), "
+            << stats.videoFrames << " video frames (" << stats.videoFramesPerSecond() << " frames/s, latency avg "
+            << stats.averageVideoLatencyUSecs << " us, max " << stats.maximumVideoLatencyUSecs << " us)";
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,160 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QOFFLINEINTEGRATION_P_H
+#define QOFFLINEINTEGRATION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qplatformmediaintegration_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(qLcOfflineMedia)
+
+class QOfflineMediaDevices;
+class QPlatformMediaFormatInfo;
+
+// Throughput of everything that went through the offline backend since it
+// was created. Rates are averaged over the time the backend has existed.
+struct QOfflineMediaStatistics
+{
+    qint64 elapsedUSecs = 0;
+    qint64 audioFramesWritten = 0;
+    qint64 audioFramesRead = 0;
+    // Frames times the channel count of the device that processed them
+    qint64 audioSamplesWritten = 0;
+    qint64 audioSamplesRead = 0;
+    qint64 videoFrames = 0;
+    qint64 averageVideoLatencyUSecs = 0;
+    qint64 maximumVideoLatencyUSecs = 0;
+
+    double audioFramesWrittenPerSecond() const { return perSecond(audioFramesWritten); }
+    double audioFramesReadPerSecond() const { return perSecond(audioFramesRead); }
+    double audioSamplesWrittenPerSecond() const { return perSecond(audioSamplesWritten); }
+    double audioSamplesReadPerSecond() const { return perSecond(audioSamplesRead); }
+    double videoFramesPerSecond() const { return perSecond(videoFrames); }
+
+private:
+    double perSecond(qint64 count) const
+    {
+        return elapsedUSecs > 0 ? count * 1e6 / elapsedUSecs : 0.;
+    }
+};
+
+// A backend without any real devices: audio sinks write to a WAV file or a
+// memory ring, audio sources read from a WAV file, video sinks only count
+// frames. Selected with QT_MEDIA_BACKEND=offline, it lets throughput and
+// latency be measured on machines without sound or video hardware.
+class Q_MULTIMEDIA_EXPORT QOfflineMediaIntegration : public QPlatformMediaIntegration
+{
+public:
+    struct Options
+    {
+        // WAV file written by audio sinks; a memory ring is used when empty
+        QString outputFile;
+        // WAV file read by audio sources; silence is produced when empty
+        QString inputFile;
+        // Playback speed relative to real time; 0 runs as fast as possible
+        double rate = 0.;
+        // Size of the memory ring audio sinks write to when there is no file
+        qsizetype ringSize = 1024 * 1024;
+
+        static Options fromEnvironment();
+    };
+
+    QOfflineMediaIntegration(const Options &options = Options::fromEnvironment());
+    ~QOfflineMediaIntegration();
+
+    static QOfflineMediaIntegration *instance();
+
+    QPlatformMediaDevices *devices() override;
+    QPlatformMediaFormatInfo *formatInfo() override;
+    QPlatformVideoSink *createVideoSink(QVideoSink *sink) override;
+
+    const Options &options() const { return m_options; }
+
+    QOfflineMediaStatistics statistics() const;
+    void reportStatistics() const;
+
+    void addAudioFramesWritten(qint64 frames, int channels)
+    {
+        m_audioFramesWritten.fetchAndAddRelaxed(frames);
+        m_audioSamplesWritten.fetchAndAddRelaxed(frames * channels);
+    }
+    void addAudioFramesRead(qint64 frames, int channels)
+    {
+        m_audioFramesRead.fetchAndAddRelaxed(frames);
+        m_audioSamplesRead.fetchAndAddRelaxed(frames * channels);
+    }
+    void addVideoFrame(qint64 latencyUSecs);
+
+private:
+    Options m_options;
+    QOfflineMediaDevices *m_devices = nullptr;
+    QPlatformMediaFormatInfo *m_formatInfo = nullptr;
+
+    QElapsedTimer m_elapsed;
+    QAtomicInteger<qint64> m_audioFramesWritten = 0;
+    QAtomicInteger<qint64> m_audioFramesRead = 0;
+    QAtomicInteger<qint64> m_audioSamplesWritten = 0;
+    QAtomicInteger<qint64> m_audioSamplesRead = 0;
+    QAtomicInteger<qint64> m_videoFrames = 0;
+    QAtomicInteger<qint64> m_timedVideoFrames = 0;
+    QAtomicInteger<qint64> m_videoLatencySum = 0;
+    QAtomicInteger<qint64> m_videoLatencyMax = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QOFFLINEINTEGRATION_P_H
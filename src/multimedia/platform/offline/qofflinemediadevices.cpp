@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qofflinemediadevices_p.h"
+#include "qofflineintegration_p.h"
+#include "qofflineaudiosink_p.h"
+#include "qofflineaudiosource_p.h"
+
+#include <private/qaudiodevice_p.h>
+#include <qcameradevice.h>
+#include <qwavedecoder.h>
+#include <QtCore/qfile.h>
+
+QT_BEGIN_NAMESPACE
+
+static QAudioDevice offlineDevice(const QByteArray &id, const QString &description,
+                                  QAudioDevice::Mode mode, const QAudioFormat &preferredFormat)
+{
+    auto *info = new QAudioDevicePrivate(id, mode);
+    info->description = description;
+    info->isDefault = true;
+    info->preferredFormat = preferredFormat;
+    info->minimumSampleRate = 1;
+    info->maximumSampleRate = 384000;
+    info->minimumChannelCount = 1;
+    info->maximumChannelCount = 8;
+    info->supportedSampleFormats = { QAudioFormat::UInt8, QAudioFormat::Int16,
+                                     QAudioFormat::Int32, QAudioFormat::Float };
+    return info->create();
+}
+
+// The input prefers whatever the input file contains, so that reading it
+// does not need a conversion.
+static QAudioFormat inputFileFormat(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return {};
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QWaveDecoder decoder(&file);
+    if (!decoder.open(QIODevice::ReadOnly))
+        return {};
+    return decoder.audioFormat();
+}
+
+QOfflineMediaDevices::QOfflineMediaDevices()
+    : QPlatformMediaDevices()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    m_output = offlineDevice("offline-output", QStringLiteral("Offline audio output"),
+                             QAudioDevice::Output, format);
+
+    const auto *integration = QOfflineMediaIntegration::instance();
+    const QAudioFormat inputFormat = inputFileFormat(integration ? integration->options().inputFile : QString());
+    m_input = offlineDevice("offline-input", QStringLiteral("Offline audio input"),
+                            QAudioDevice::Input, inputFormat.isValid() ? inputFormat : format);
+}
+
+QList<QAudioDevice> QOfflineMediaDevices::audioInputs() const
+{
+    return { m_input };
+}
+
+QList<QAudioDevice> QOfflineMediaDevices::audioOutputs() const
+{
+    return { m_output };
+}
+
+QList<QCameraDevice> QOfflineMediaDevices::videoInputs() const
+{
+    return {};
+}
+
+QPlatformAudioSource *QOfflineMediaDevices::createAudioSource(const QAudioDevice &deviceInfo)
+{
+    Q_UNUSED(deviceInfo);
+    return new QOfflineAudioSource();
+}
+
+QPlatformAudioSink *QOfflineMediaDevices::createAudioSink(const QAudioDevice &deviceInfo)
+{
+    Q_UNUSED(deviceInfo);
+    return new QOfflineAudioSink();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qofflinevideosink_p.h"
+#include "qofflineintegration_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QOfflineVideoSink::QOfflineVideoSink(QVideoSink *parent)
+    : QPlatformVideoSink(parent),
+      m_integration(QOfflineMediaIntegration::instance())
+{
+    m_clock.start();
+    connect(parent, &QVideoSink::videoFrameChanged, this, &QOfflineVideoSink::frameReceived,
+            Qt::DirectConnection);
+}
+
+QOfflineVideoSink::~QOfflineVideoSink()
+{
+    const qint64 elapsed = m_clock.nsecsElapsed() / 1000;
+    qCDebug(qLcOfflineMedia).nospace()
+            << "video sink received " << m_frames << " frames in " << elapsed / 1000 << " ms ("
+            << (elapsed > 0 ? m_frames * 1e6 / elapsed : 0.) << " frames/s, max latency "
+            << m_maxLatency << " us)";
+}
+
+void QOfflineVideoSink::frameReceived(const QVideoFrame &frame)
+{
+    if (!frame.isValid())
+        return;
+    ++m_frames;
+
+    qint64 latency = -1;
+    if (frame.startTime() >= 0) {
+        const qint64 offset = m_clock.nsecsElapsed() / 1000 - frame.startTime();
+        m_minimumOffset = qMin(m_minimumOffset, offset);
+        latency = offset - m_minimumOffset;
+        m_maxLatency = qMax(m_maxLatency, latency);
+    }
+    if (m_integration)
+        m_integration->addVideoFrame(latency);
+}
+
+QT_END_NAMESPACE
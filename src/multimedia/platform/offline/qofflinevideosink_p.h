@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QOFFLINEVIDEOSINK_P_H
+#define QOFFLINEVIDEOSINK_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qplatformvideosink_p.h>
+#include <QtCore/qelapsedtimer.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+class QOfflineMediaIntegration;
+
+// Doesn't render anything, it only counts the frames it receives and how late
+// they arrive compared to their start times.
+class QOfflineVideoSink : public QPlatformVideoSink
+{
+    Q_OBJECT
+public:
+    explicit QOfflineVideoSink(QVideoSink *parent);
+    ~QOfflineVideoSink();
+
+    qint64 frameCount() const { return m_frames; }
+    qint64 maximumLatencyUSecs() const { return m_maxLatency; }
+
+private:
+    void frameReceived(const QVideoFrame &frame);
+
+    QOfflineMediaIntegration *m_integration = nullptr;
+    QElapsedTimer m_clock;
+    qint64 m_frames = 0;
+    // Smallest difference between arrival and start time seen so far. Later
+    // frames are late by how much more they take.
+    qint64 m_minimumOffset = std::numeric_limits<qint64>::max();
+    qint64 m_maxLatency = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QOFFLINEVIDEOSINK_P_H
@@ -59,8 +59,8 @@ static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *u
 {
     Q_UNUSED(stream);
     Q_UNUSED(length);
-    Q_UNUSED(userdata);
 //    qDebug() << "write callback!" << length;
+    ((QPulseAudioSink*)userdata)->streamWriteCallback(length);
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
@@ -166,9 +166,10 @@ QPulseAudioSink::QPulseAudioSink(const QByteArray &device)
     , m_maxBufferSize(0)
     , m_totalTimeValue(0)
     , m_tickTimer(new QTimer(this))
-    , m_audioBuffer(nullptr)
     , m_resuming(false)
+    , m_eventDriven(false)
     , m_volume(1.0)
+    , m_appliedVolume(1.0)
 {
     connect(m_tickTimer, SIGNAL(timeout()), SLOT(userFeed()));
 }
@@ -216,6 +217,46 @@ void QPulseAudioSink::streamUnderflowCallback()
     }
 }
 
+/*!
+    \internal
+
+    Called on the mainloop thread whenever the server asks for \a length more bytes.
+    A render callback fills the buffers of pa_stream_begin_write() right here. In event
+    driven pull mode this schedules a single userFeed() on the sink's thread; further
+    requests are coalesced until that feed has run.
+*/
+void QPulseAudioSink::streamWriteCallback(size_t length)
+{
+    if (m_renderCallback) {
+        const size_t frameSize = pa_frame_size(&m_spec);
+        while (length >= frameSize) {
+            void *dest = nullptr;
+            size_t nbytes = length;
+            if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0)
+                return;
+            nbytes = qMin(nbytes, length);
+            nbytes -= nbytes % frameSize;
+            if (nbytes == 0) {
+                pa_stream_cancel_write(m_stream);
+                return;
+            }
+            m_renderCallback(QAudioFrameSpan(dest, qsizetype(nbytes / frameSize), m_format));
+            applyVolume(dest, dest, int(nbytes));
+            if (pa_stream_write(m_stream, dest, nbytes, nullptr, 0, PA_SEEK_RELATIVE) < 0)
+                return;
+            m_totalTimeValue += nbytes;
+            length -= nbytes;
+        }
+        return;
+    }
+
+    if (!m_eventDriven || !m_pullMode)
+        return;
+
+    if (m_feedPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
 void QPulseAudioSink::start(QIODevice *device)
 {
     setState(QAudio::StoppedState);
@@ -231,6 +272,7 @@ void QPulseAudioSink::start(QIODevice *device)
 
     m_pullMode = true;
     m_audioSource = device;
+    m_renderCallback = nullptr;
 
     if (!open()) {
         m_audioSource = nullptr;
@@ -240,6 +282,31 @@ void QPulseAudioSink::start(QIODevice *device)
     setState(QAudio::ActiveState);
 }
 
+void QPulseAudioSink::startRendering(QAudioSink::RenderCallback &&callback)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    // Handle change of mode
+    if (m_audioSource && !m_pullMode) {
+        delete m_audioSource;
+    }
+    m_audioSource = nullptr;
+
+    // Only replace the callback once close() stopped the mainloop from calling it
+    close();
+
+    m_pullMode = true;
+    m_renderCallback = std::move(callback);
+
+    if (!open()) {
+        m_renderCallback = nullptr;
+        return;
+    }
+
+    setState(QAudio::ActiveState);
+}
+
 QIODevice *QPulseAudioSink::start()
 {
     setState(QAudio::StoppedState);
@@ -254,6 +321,7 @@ QIODevice *QPulseAudioSink::start()
     close();
 
     m_pullMode = false;
+    m_renderCallback = nullptr;
 
     if (!open())
         return nullptr;
@@ -291,6 +359,8 @@ bool QPulseAudioSink::open()
 
     m_spec = spec;
     m_totalTimeValue = 0;
+    m_eventDriven = QPulseAudioInternal::useEventDrivenStreams();
+    m_feedPending.storeRelaxed(0);
 
     if (m_streamName.isNull())
         m_streamName = QString(QLatin1String("QtmPulseStream-%1-%2")).arg(::getpid()).arg(quintptr(this)).toUtf8();
@@ -390,7 +460,9 @@ bool QPulseAudioSink::open()
     m_periodSize = pa_usec_to_bytes(m_periodTime*1000, &m_spec);
     m_bufferSize = buffer->tlength;
     m_maxBufferSize = buffer->maxlength;
-    m_audioBuffer = new char[m_maxBufferSize];
+    m_partialFrame.clear();
+    if (m_pullMode && !m_renderCallback)
+        m_partialFrame.reserve(pa_frame_size(&m_spec));
 
     const qint64 streamSize = m_audioSource ? m_audioSource->size() : 0;
     if (m_pullMode && streamSize > 0 && static_cast<qint64>(buffer->prebuf) > streamSize) {
@@ -417,7 +489,13 @@ bool QPulseAudioSink::open()
 
     m_opened = true;
 
-    m_tickTimer->start(m_periodTime);
+    // In event driven mode the timer only retries a pull that found the source empty
+    m_tickTimer->setSingleShot(m_eventDriven);
+    // A render callback is driven by the server's write requests alone
+    if (m_eventDriven && !m_renderCallback)
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+    else if (!m_renderCallback)
+        m_tickTimer->start(m_periodTime);
 
     m_elapsedTimeOffset = 0;
 
@@ -459,21 +537,32 @@ void QPulseAudioSink::close()
         delete m_audioSource;
         m_audioSource = nullptr;
     }
+    m_partialFrame.clear();
     m_opened = false;
-    if (m_audioBuffer) {
-        delete[] m_audioBuffer;
-        m_audioBuffer = nullptr;
-    }
 }
 
 void QPulseAudioSink::userFeed()
 {
+    m_feedPending.storeRelease(0);
+
     if (m_deviceState == QAudio::StoppedState || m_deviceState == QAudio::SuspendedState)
         return;
 
     m_resuming = false;
 
+    if (m_renderCallback)
+        return;
+
     if (m_pullMode) {
+        if (m_eventDriven) {
+            // Fill everything the server asked for; if the source ran dry, try again a
+            // period later since no new write request arrives for data we did not write.
+            const qint64 writableSize = bytesFree();
+            if (writableSize > 0 && pullFromSource(writableSize) < writableSize)
+                m_tickTimer->start(m_periodTime);
+            return;
+        }
+
         int writableSize = bytesFree();
         int chunks = writableSize / m_periodSize;
         if (chunks == 0)
@@ -483,22 +572,10 @@ void QPulseAudioSink::userFeed()
         if (input > m_maxBufferSize)
             input = m_maxBufferSize;
 
-        int audioBytesPulled = m_audioSource->read(m_audioBuffer, input);
-        Q_ASSERT(audioBytesPulled <= input);
-        if (m_audioBuffer && audioBytesPulled > 0) {
-            if (audioBytesPulled > input) {
-                qWarning() << "QPulseAudioSink::userFeed() - Invalid audio data size provided from user:"
-                           << audioBytesPulled << "should be less than" << input;
-                audioBytesPulled = input;
-            }
-            qint64 bytesWritten = write(m_audioBuffer, audioBytesPulled);
-            Q_ASSERT(bytesWritten == audioBytesPulled); //unfinished write should not happen since the data provided is less than writableSize
-            Q_UNUSED(bytesWritten);
-
-            if (chunks > 1) {
-                // PulseAudio needs more data. Ask for it immediately.
-                QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
-            }
+        qint64 audioBytesPulled = pullFromSource(input);
+        if (audioBytesPulled > 0 && chunks > 1) {
+            // PulseAudio needs more data. Ask for it immediately.
+            QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
         }
     }
 
@@ -506,6 +583,92 @@ void QPulseAudioSink::userFeed()
         return;
 }
 
+/*!
+    \internal
+
+    Reads up to \a maxLength bytes from the pull mode source straight into the buffer
+    of pa_stream_begin_write(). The source is user code that may itself use PulseAudio,
+    so the mainloop lock is only held around beginning and committing the write, not
+    while reading. Bytes after the last complete frame are kept in m_partialFrame and
+    put in front of the next read, so nothing has to be given back to the source,
+    which might be sequential. Returns the number of bytes written to the stream.
+*/
+qint64 QPulseAudioSink::pullFromSource(qint64 maxLength)
+{
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const qint64 frameSize = pa_frame_size(&m_spec);
+    qint64 written = 0;
+    while (m_stream && maxLength - written >= frameSize) {
+        void *dest = nullptr;
+        size_t nbytes = size_t(maxLength - written);
+        pulseEngine->lock();
+        if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
+            qWarning("QAudioSink(pulseaudio): pa_stream_begin_write, error = %s",
+                     pa_strerror(pa_context_errno(pulseEngine->context())));
+            pulseEngine->unlock();
+            setError(QAudio::IOError);
+            break;
+        }
+        const qint64 requested = qMin(qint64(nbytes), maxLength - written);
+        if (requested < frameSize) {
+            pa_stream_cancel_write(m_stream);
+            pulseEngine->unlock();
+            break;
+        }
+        pulseEngine->unlock();
+
+        char *data = static_cast<char *>(dest);
+        const qint64 carried = m_partialFrame.size();
+        memcpy(data, m_partialFrame.constData(), carried);
+        const qint64 pulled = qMax<qint64>(m_audioSource->read(data + carried, requested - carried), 0);
+        // reading can take a while and the stream may have been stopped
+        if (!m_stream)
+            break;
+
+        const qint64 available = carried + pulled;
+        const qint64 length = available - available % frameSize;
+        m_partialFrame.resize(available - length);
+        memcpy(m_partialFrame.data(), data + length, available - length);
+
+        pulseEngine->lock();
+        if (length == 0) {
+            pa_stream_cancel_write(m_stream);
+            pulseEngine->unlock();
+            break;
+        }
+        applyVolume(data, data, int(length));
+        if (pa_stream_write(m_stream, data, length, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
+            qWarning("QAudioSink(pulseaudio): pa_stream_write, error = %s",
+                     pa_strerror(pa_context_errno(pulseEngine->context())));
+            pulseEngine->unlock();
+            setError(QAudio::IOError);
+            break;
+        }
+        pulseEngine->unlock();
+
+        m_totalTimeValue += length;
+        written += length;
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+        if (carried + pulled < requested)
+            break;
+    }
+    return written;
+}
+
+void QPulseAudioSink::applyVolume(const void *src, void *dest, int len)
+{
+    if (m_volume < 1.0f || m_appliedVolume < 1.0f) {
+        // Don't use PulseAudio volume, as it might affect all other streams of the same category
+        // or even affect the system volume if flat volumes are enabled.
+        // Ramp from the previously applied volume to avoid clicks on volume changes.
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, m_format, src, dest, len);
+    } else if (src != dest) {
+        memcpy(dest, src, len);
+    }
+    m_appliedVolume = m_volume;
+}
+
 qint64 QPulseAudioSink::write(const char *data, qint64 len)
 {
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
@@ -518,25 +681,21 @@ qint64 QPulseAudioSink::write(const char *data, qint64 len)
     if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
         qWarning("QAudioSink(pulseaudio): pa_stream_begin_write, error = %s",
                  pa_strerror(pa_context_errno(pulseEngine->context())));
+        pulseEngine->unlock();
         setError(QAudio::IOError);
         return 0;
     }
 
     len = qMin(len, qint64(nbytes));
 
-    if (m_volume < 1.0f) {
-        // Don't use PulseAudio volume, as it might affect all other streams of the same category
-        // or even affect the system volume if flat volumes are enabled
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
-    } else {
-        memcpy(dest, data, len);
-    }
+    applyVolume(data, dest, int(len));
 
     data = reinterpret_cast<char *>(dest);
 
     if ((pa_stream_write(m_stream, data, len, nullptr, 0, PA_SEEK_RELATIVE)) < 0) {
         qWarning("QAudioSink(pulseaudio): pa_stream_write, error = %s",
                  pa_strerror(pa_context_errno(pulseEngine->context())));
+        pulseEngine->unlock();
         setError(QAudio::IOError);
         return 0;
     }
@@ -598,6 +757,46 @@ qint64 QPulseAudioSink::processedUSecs() const
     return usecs;
 }
 
+qint64 QPulseAudioSink::latencyUSecs() const
+{
+    if (!m_stream)
+        return -1;
+
+    // A render callback runs on the mainloop thread, which already holds the lock
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    pa_usec_t latency = 0;
+    int negative = 0;
+    if (lock)
+        pulseEngine->lock();
+    const int result = pa_stream_get_latency(m_stream, &latency, &negative);
+    if (lock)
+        pulseEngine->unlock();
+    if (result != 0)
+        return -1;
+    return negative ? 0 : qint64(latency);
+}
+
+QAudioTimestamp QPulseAudioSink::timestamp() const
+{
+    if (!m_stream || !elapsedTime.isValid())
+        return {};
+
+    // The interpolated stream time is the position being heard right now
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    pa_usec_t usecs = 0;
+    if (lock)
+        pulseEngine->lock();
+    const int result = pa_stream_get_time(m_stream, &usecs);
+    const qint64 now = elapsedTime.nsecsElapsed() / 1000;
+    if (lock)
+        pulseEngine->unlock();
+    if (result != 0)
+        return {};
+    return { qint64(pa_usec_to_bytes(usecs, &m_spec) / pa_frame_size(&m_spec)), now };
+}
+
 void QPulseAudioSink::resume()
 {
     if (m_deviceState == QAudio::SuspendedState) {
@@ -617,7 +816,10 @@ void QPulseAudioSink::resume()
 
         pulseEngine->unlock();
 
-        m_tickTimer->start(m_periodTime);
+        if (m_eventDriven || m_renderCallback)
+            QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+        else
+            m_tickTimer->start(m_periodTime);
 
         setState(m_pullMode ? QAudio::ActiveState : QAudio::IdleState);
         setError(QAudio::NoError);
@@ -695,7 +897,14 @@ void QPulseAudioSink::setVolume(qreal vol)
     if (qFuzzyCompare(m_volume, vol))
         return;
 
+    // A render callback applies the volume on the mainloop thread
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = m_renderCallback && !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    if (lock)
+        pulseEngine->lock();
     m_volume = qBound(qreal(0), vol, qreal(1));
+    if (lock)
+        pulseEngine->unlock();
 }
 
 qreal QPulseAudioSink::volume() const
@@ -57,6 +57,7 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qatomic.h>
 
 #include "qaudio.h"
 #include "qaudiodevice.h"
@@ -77,6 +78,7 @@ public:
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void startRendering(QAudioSink::RenderCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -85,6 +87,8 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
+    QAudioTimestamp timestamp() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat &format) override;
@@ -95,6 +99,7 @@ public:
 
 public:
     void streamUnderflowCallback();
+    void streamWriteCallback(size_t length);
 
 private:
     void setState(QAudio::State state);
@@ -103,6 +108,8 @@ private:
     bool open();
     void close();
     qint64 write(const char *data, qint64 len);
+    qint64 pullFromSource(qint64 maxLength);
+    void applyVolume(const void *src, void *dest, int len);
 
 private Q_SLOTS:
     void userFeed();
@@ -123,13 +130,19 @@ private:
     int m_periodSize;
     int m_bufferSize;
     int m_maxBufferSize;
+    // The incomplete frame at the end of the last read from m_audioSource
+    QByteArray m_partialFrame;
     qint64 m_totalTimeValue;
     QTimer *m_tickTimer;
-    char *m_audioBuffer;
     qint64 m_elapsedTimeOffset;
     bool m_resuming;
+    bool m_eventDriven;
+    QAtomicInt m_feedPending;
+    // Called on the mainloop thread instead of pulling from m_audioSource
+    QAudioSink::RenderCallback m_renderCallback;
 
     qreal m_volume;
+    qreal m_appliedVolume;
     pa_sample_spec m_spec;
 };
 
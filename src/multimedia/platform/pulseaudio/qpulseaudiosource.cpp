@@ -55,9 +55,9 @@ const int PeriodTimeMs = 50;
 
 static void inputStreamReadCallback(pa_stream *stream, size_t length, void *userdata)
 {
-    Q_UNUSED(userdata);
     Q_UNUSED(length);
     Q_UNUSED(stream);
+    static_cast<QPulseAudioSource *>(userdata)->streamReadCallback();
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
@@ -131,8 +131,10 @@ QPulseAudioSource::QPulseAudioSource(const QByteArray &device)
     , m_errorState(QAudio::NoError)
     , m_deviceState(QAudio::StoppedState)
     , m_volume(qreal(1.0f))
+    , m_appliedVolume(qreal(1.0f))
     , m_pullMode(true)
     , m_opened(false)
+    , m_eventDriven(false)
     , m_bytesAvailable(0)
     , m_bufferSize(0)
     , m_periodSize(0)
@@ -203,6 +205,8 @@ void QPulseAudioSource::start(QIODevice *device)
 
     close();
 
+    m_captureCallback = nullptr;
+
     if (!open())
         return;
 
@@ -212,6 +216,31 @@ void QPulseAudioSource::start(QIODevice *device)
     setState(QAudio::ActiveState);
 }
 
+void QPulseAudioSource::startCapturing(QAudioSource::CaptureCallback &&callback)
+{
+    setState(QAudio::StoppedState);
+    setError(QAudio::NoError);
+
+    if (!m_pullMode && m_audioSource) {
+        delete m_audioSource;
+        m_audioSource = nullptr;
+    }
+
+    // Only replace the callback once close() stopped the mainloop from calling it
+    close();
+
+    m_pullMode = true;
+    m_audioSource = nullptr;
+    m_captureCallback = std::move(callback);
+
+    if (!open()) {
+        m_captureCallback = nullptr;
+        return;
+    }
+
+    setState(QAudio::ActiveState);
+}
+
 QIODevice *QPulseAudioSource::start()
 {
     setState(QAudio::StoppedState);
@@ -224,6 +253,8 @@ QIODevice *QPulseAudioSource::start()
 
     close();
 
+    m_captureCallback = nullptr;
+
     if (!open())
         return nullptr;
 
@@ -269,6 +300,8 @@ bool QPulseAudioSource::open()
     }
 
     m_spec = spec;
+    m_eventDriven = QPulseAudioInternal::useEventDrivenStreams();
+    m_feedPending.storeRelaxed(0);
 
 #ifdef DEBUG_PULSE
 //    QTime now(QTime::currentTime());
@@ -342,12 +375,17 @@ bool QPulseAudioSource::open()
     if (actualBufferAttr->tlength != (uint32_t)-1)
         m_bufferSize = actualBufferAttr->tlength;
 
+    // The capture callback scales into this on the mainloop thread, one fragment at a time
+    if (m_captureCallback)
+        m_adjustedBuffer.resize(qMax<qsizetype>(m_periodSize, pa_frame_size(&spec)));
+
     pulseEngine->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSource::onPulseContextFailed);
 
     m_opened = true;
-    m_timer->start(m_periodTime);
+    if (!m_eventDriven && !m_captureCallback)
+        m_timer->start(m_periodTime);
 
     m_elapsedTimeOffset = 0;
     m_totalTimeValue = 0;
@@ -452,11 +490,30 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
             return 0;
         }
 
+        if (readLength == 0) {
+            pulseEngine->unlock();
+            break;
+        }
+
+        if (!audioBuffer) {
+            // A hole in the record stream, there is nothing to deliver for it
+            pa_stream_drop(m_stream);
+            pulseEngine->unlock();
+            continue;
+        }
+
         qint64 actualLength = 0;
         if (m_pullMode) {
-            QByteArray adjusted(readLength, Qt::Uninitialized);
-            applyVolume(audioBuffer, adjusted.data(), readLength);
-            actualLength = m_audioSource->write(adjusted);
+            // Hand the peeked fragment over as is when no volume has to be applied, otherwise
+            // scale it into a scratch buffer that is reused across fragments.
+            const char *fragment = static_cast<const char *>(audioBuffer);
+            if (m_volume < 1.f || m_appliedVolume < 1.f) {
+                if (m_adjustedBuffer.size() < qsizetype(readLength))
+                    m_adjustedBuffer.resize(readLength);
+                applyVolume(audioBuffer, m_adjustedBuffer.data(), readLength);
+                fragment = m_adjustedBuffer.constData();
+            }
+            actualLength = m_audioSource->write(fragment, readLength);
 
             if (actualLength < qint64(readLength)) {
                 pulseEngine->unlock();
@@ -506,10 +563,11 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
 void QPulseAudioSource::applyVolume(const void *src, void *dest, int len)
 {
     Q_ASSERT((src && dest) || len == 0);
-    if (m_volume < 1.f)
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, src, dest, len);
+    if (m_volume < 1.f || m_appliedVolume < 1.f)
+        QAudioHelperInternal::qMultiplySamples(m_appliedVolume, m_volume, m_format, src, dest, len);
     else if (len)
         memcpy(dest, src, len);
+    m_appliedVolume = m_volume;
 }
 
 void QPulseAudioSource::resume()
@@ -526,7 +584,10 @@ void QPulseAudioSource::resume()
 
         pulseEngine->unlock();
 
-        m_timer->start(m_periodTime);
+        if (m_eventDriven)
+            QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+        else if (!m_captureCallback)
+            m_timer->start(m_periodTime);
 
         setState(QAudio::ActiveState);
         setError(QAudio::NoError);
@@ -538,7 +599,14 @@ void QPulseAudioSource::setVolume(qreal vol)
     if (qFuzzyCompare(m_volume, vol))
         return;
 
+    // A capture callback applies the volume on the mainloop thread
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = m_captureCallback && !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    if (lock)
+        pulseEngine->lock();
     m_volume = qBound(qreal(0), vol, qreal(1));
+    if (lock)
+        pulseEngine->unlock();
 }
 
 qreal QPulseAudioSource::volume() const
@@ -567,6 +635,46 @@ qint64 QPulseAudioSource::processedUSecs() const
     return usecs;
 }
 
+qint64 QPulseAudioSource::latencyUSecs() const
+{
+    if (!m_stream)
+        return -1;
+
+    // A capture callback runs on the mainloop thread, which already holds the lock
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    pa_usec_t latency = 0;
+    int negative = 0;
+    if (lock)
+        pulseEngine->lock();
+    const int result = pa_stream_get_latency(m_stream, &latency, &negative);
+    if (lock)
+        pulseEngine->unlock();
+    if (result != 0)
+        return -1;
+    return negative ? 0 : qint64(latency);
+}
+
+QAudioTimestamp QPulseAudioSource::timestamp() const
+{
+    if (!m_stream || !elapsedTime.isValid())
+        return {};
+
+    // The interpolated stream time is the position being recorded right now
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    const bool lock = !pa_threaded_mainloop_in_thread(pulseEngine->mainloop());
+    pa_usec_t usecs = 0;
+    if (lock)
+        pulseEngine->lock();
+    const int result = pa_stream_get_time(m_stream, &usecs);
+    const qint64 now = elapsedTime.nsecsElapsed() / 1000;
+    if (lock)
+        pulseEngine->unlock();
+    if (result != 0)
+        return {};
+    return { qint64(pa_usec_to_bytes(usecs, &m_spec) / pa_frame_size(&m_spec)), now };
+}
+
 void QPulseAudioSource::suspend()
 {
     if (m_deviceState == QAudio::ActiveState) {
@@ -588,10 +696,61 @@ void QPulseAudioSource::suspend()
     }
 }
 
+/*!
+    \internal
+
+    Called on the mainloop thread when new fragments can be read. A capture callback is
+    handed the peeked fragments right here. In event driven mode this schedules a single
+    userFeed() on the source's thread; further notifications are coalesced until that feed
+    has run.
+*/
+void QPulseAudioSource::streamReadCallback()
+{
+    if (m_captureCallback) {
+        const size_t frameSize = pa_frame_size(&m_spec);
+        while (pa_stream_readable_size(m_stream) > 0) {
+            const void *audioBuffer = nullptr;
+            size_t readLength = 0;
+            if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0 || readLength == 0)
+                return;
+            // Holes in the stream have no data to hand over
+            if (audioBuffer && readLength >= frameSize) {
+                if (m_volume < 1.f || m_appliedVolume < 1.f) {
+                    // Scale larger fragments in chunks rather than growing the buffer here
+                    const size_t chunk = m_adjustedBuffer.size() - m_adjustedBuffer.size() % frameSize;
+                    const char *src = static_cast<const char *>(audioBuffer);
+                    for (size_t offset = 0; offset + frameSize <= readLength; offset += chunk) {
+                        const size_t length = qMin(chunk, readLength - offset);
+                        applyVolume(src + offset, m_adjustedBuffer.data(), int(length));
+                        m_captureCallback(QAudioFrameSpan(m_adjustedBuffer.data(),
+                                                          qsizetype(length / frameSize), m_format));
+                    }
+                } else {
+                    m_captureCallback(QAudioFrameSpan(const_cast<void *>(audioBuffer),
+                                                      qsizetype(readLength / frameSize), m_format));
+                }
+                m_totalTimeValue += readLength;
+            }
+            pa_stream_drop(m_stream);
+        }
+        return;
+    }
+
+    if (!m_eventDriven)
+        return;
+
+    if (m_feedPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
 void QPulseAudioSource::userFeed()
 {
+    m_feedPending.storeRelease(0);
+
     if (m_deviceState == QAudio::StoppedState || m_deviceState == QAudio::SuspendedState)
         return;
+    if (m_captureCallback)
+        return;
 #ifdef DEBUG_PULSE
 //    QTime now(QTime::currentTime());
 //    qDebug()<< now.second() << "s " << now.msec() << "ms :userFeed() IN";
@@ -57,6 +57,7 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qatomic.h>
 
 #include "qaudio.h"
 #include "qaudiodevice.h"
@@ -77,9 +78,11 @@ public:
     ~QPulseAudioSource();
 
     qint64 read(char *data, qint64 len);
+    void streamReadCallback();
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    void startCapturing(QAudioSource::CaptureCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -88,6 +91,8 @@ public:
     void setBufferSize(qsizetype value) override;
     qsizetype bufferSize() const override;
     qint64 processedUSecs() const override;
+    qint64 latencyUSecs() const override;
+    QAudioTimestamp timestamp() const override;
     QAudio::Error error() const override;
     QAudio::State state() const override;
     void setFormat(const QAudioFormat &format) override;
@@ -102,6 +107,7 @@ public:
     QAudio::Error m_errorState;
     QAudio::State m_deviceState;
     qreal m_volume;
+    qreal m_appliedVolume;
 
 private slots:
     void userFeed();
@@ -120,6 +126,8 @@ private:
 
     bool m_pullMode;
     bool m_opened;
+    bool m_eventDriven;
+    QAtomicInt m_feedPending;
     int m_bytesAvailable;
     int m_bufferSize;
     int m_periodSize;
@@ -130,6 +138,9 @@ private:
     QByteArray m_streamName;
     QByteArray m_device;
     QByteArray m_tempBuffer;
+    QByteArray m_adjustedBuffer;
+    // Called on the mainloop thread instead of writing to m_audioSource
+    QAudioSource::CaptureCallback m_captureCallback;
     pa_sample_spec m_spec;
 };
 
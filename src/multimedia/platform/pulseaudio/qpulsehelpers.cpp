@@ -96,6 +96,12 @@ QAudioFormat sampleSpecToAudioFormat(const pa_sample_spec &spec)
     return format;
 }
 
+bool useEventDrivenStreams()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_PULSEAUDIO_EVENT_DRIVEN") != 0;
+    return enabled;
+}
+
 #ifdef DEBUG_PULSE
 QString stateToQString(pa_stream_state_t state)
 {
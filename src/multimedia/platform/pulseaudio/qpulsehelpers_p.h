@@ -61,6 +61,8 @@ namespace QPulseAudioInternal
 {
 pa_sample_spec audioFormatToSampleSpec(const QAudioFormat &format);
 QAudioFormat sampleSpecToAudioFormat(const pa_sample_spec &spec);
+// Drive streams from the mainloop's write/read callbacks instead of polling them from a timer
+bool useEventDrivenStreams();
 QString stateToQString(pa_stream_state_t state);
 QString stateToQString(pa_context_state_t state);
 QString sampleFormatToQString(pa_sample_format format);
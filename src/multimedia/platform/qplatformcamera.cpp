@@ -39,6 +39,8 @@
 
 #include "qplatformcamera_p.h"
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -82,6 +84,128 @@ QCameraFormat QPlatformCamera::findBestCameraFormat(const QCameraDevice &camera)
     return f;
 }
 
+/*
+    Formats are kept sorted by decreasing resolution, then by decreasing frame
+    rate, so that findCameraFormat() can binary search for a resolution and
+    equal formats end up next to each other.
+*/
+static bool cameraFormatLessThan(const QCameraFormat &a, const QCameraFormat &b)
+{
+    const QSize ra = a.resolution();
+    const QSize rb = b.resolution();
+    const qint64 areaA = qint64(ra.width()) * ra.height();
+    const qint64 areaB = qint64(rb.width()) * rb.height();
+    if (areaA != areaB)
+        return areaA > areaB;
+    if (ra.width() != rb.width())
+        return ra.width() > rb.width();
+    if (a.maxFrameRate() != b.maxFrameRate())
+        return a.maxFrameRate() > b.maxFrameRate();
+    if (a.minFrameRate() != b.minFrameRate())
+        return a.minFrameRate() > b.minFrameRate();
+    return a.pixelFormat() < b.pixelFormat();
+}
+
+/*!
+    \internal
+
+    Sorts \a formats the way findCameraFormat() expects them and removes
+    duplicates.
+*/
+void QPlatformCamera::sortCameraFormats(QList<QCameraFormat> &formats)
+{
+    std::sort(formats.begin(), formats.end(), cameraFormatLessThan);
+    formats.erase(std::unique(formats.begin(), formats.end()), formats.end());
+}
+
+using CameraFormatRange = std::pair<QList<QCameraFormat>::const_iterator, QList<QCameraFormat>::const_iterator>;
+
+// The formats with the resolution findCameraFormat() settles on for resolution
+static CameraFormatRange cameraFormatsForResolution(const QList<QCameraFormat> &formats, const QSize &resolution)
+{
+    // formats sorted before any format of resolution r
+    auto before = [](const QSize &r) {
+        const qint64 area = qint64(r.width()) * r.height();
+        return [=](const QCameraFormat &f) {
+            const qint64 a = qint64(f.resolution().width()) * f.resolution().height();
+            return a > area || (a == area && f.resolution().width() > r.width());
+        };
+    };
+
+    auto it = std::partition_point(formats.begin(), formats.end(), before(resolution));
+    QSize match;
+    if (it != formats.end() && it->resolution() == resolution)
+        match = resolution;
+    else if (it != formats.begin())
+        match = std::prev(it)->resolution();
+    else
+        match = formats.first().resolution();
+
+    // formats of one resolution are contiguous and sorted by decreasing frame rate
+    auto begin = match == resolution ? it : std::partition_point(formats.begin(), it, before(match));
+    auto end = std::find_if(begin, formats.end(),
+                            [&](const QCameraFormat &f) { return f.resolution() != match; });
+    return { begin, end };
+}
+
+/*!
+    \internal
+
+    Returns the format in \a formats, sorted by sortCameraFormats(), that best
+    matches \a resolution, \a frameRate and \a pixelFormat. An exact resolution
+    match is preferred, otherwise the smallest larger resolution is used, or the
+    largest one if nothing is as large. Within a resolution, a format supporting
+    \a frameRate and having \a pixelFormat is preferred. A zero \a frameRate or
+    a Format_Invalid \a pixelFormat match anything.
+
+    This is a binary search and a scan over the formats of a single resolution.
+*/
+QCameraFormat QPlatformCamera::findCameraFormat(const QList<QCameraFormat> &formats, const QSize &resolution,
+                                                float frameRate, QVideoFrameFormat::PixelFormat pixelFormat)
+{
+    if (formats.isEmpty() || !resolution.isValid())
+        return {};
+
+    const auto [begin, end] = cameraFormatsForResolution(formats, resolution);
+
+    auto frameRateMatches = [&](const QCameraFormat &f) {
+        return frameRate <= 0 || (f.minFrameRate() <= frameRate && f.maxFrameRate() >= frameRate);
+    };
+    auto pixelFormatMatches = [&](const QCameraFormat &f) {
+        return pixelFormat == QVideoFrameFormat::Format_Invalid || f.pixelFormat() == pixelFormat;
+    };
+
+    QCameraFormat best = *begin;
+    int bestScore = -1;
+    for (auto f = begin; f != end; ++f) {
+        const int score = (frameRateMatches(*f) ? 2 : 0) + (pixelFormatMatches(*f) ? 1 : 0);
+        if (score > bestScore) {
+            best = *f;
+            bestScore = score;
+            if (score == 3)
+                break;
+        }
+    }
+    return best;
+}
+
+/*!
+    \internal
+
+    \overload
+
+    Returns the entry of \a formats equal to \a format, or a null format if
+    there is none.
+*/
+QCameraFormat QPlatformCamera::findCameraFormat(const QList<QCameraFormat> &formats, const QCameraFormat &format)
+{
+    if (formats.isEmpty() || format.isNull())
+        return {};
+    const auto [begin, end] = cameraFormatsForResolution(formats, format.resolution());
+    auto it = std::find(begin, end, format);
+    return it != end ? *it : QCameraFormat();
+}
+
 /*!
     \fn void QPlatformCamera::error(int error, const QString &errorString)
 
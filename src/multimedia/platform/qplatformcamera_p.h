@@ -148,6 +148,12 @@ public:
     void colorTemperatureChanged(int temperature);
 
     static int colorTemperatureForWhiteBalance(QCamera::WhiteBalanceMode mode);
+    static QCameraFormat findBestCameraFormat(const QCameraDevice &camera);
+    static void sortCameraFormats(QList<QCameraFormat> &formats);
+    static QCameraFormat findCameraFormat(const QList<QCameraFormat> &formats, const QSize &resolution,
+                                          float frameRate = 0,
+                                          QVideoFrameFormat::PixelFormat pixelFormat = QVideoFrameFormat::Format_Invalid);
+    static QCameraFormat findCameraFormat(const QList<QCameraFormat> &formats, const QCameraFormat &format);
 
 Q_SIGNALS:
     void activeChanged(bool);
@@ -156,7 +162,6 @@ Q_SIGNALS:
 protected:
     explicit QPlatformCamera(QCamera *parent);
 
-    static QCameraFormat findBestCameraFormat(const QCameraDevice &camera);
 private:
     QCamera *m_camera = nullptr;
     QCamera::Features m_supportedFeatures = {};
@@ -64,6 +64,11 @@ QString QPlatformImageCapture::msgImageCaptureNotSet()
     return QImageCapture::tr("No instance of QImageCapture set on QMediaCaptureSession.");
 }
 
+QString QPlatformImageCapture::msgBurstNotSupported()
+{
+    return QImageCapture::tr("Burst capture is not supported.");
+}
+
 /*!
     Constructs a new image capture control object with the given \a parent
 */
@@ -112,6 +117,36 @@ QPlatformImageCapture::QPlatformImageCapture(QImageCapture *parent)
     with imageExposed(), imageCaptured() and imageSaved() signals.
 */
 
+/*!
+    Initiates the capture of \a count consecutive frames, saving frame \c i
+    to \a fileName with \c _i appended to its base name for \c i > 0.
+
+    The frames get consecutive request ids, the id of the first one is
+    returned. Each frame is reported with the usual signals.
+
+    The default implementation reports a NotSupportedFeatureError and
+    returns -1.
+*/
+int QPlatformImageCapture::captureBurst(int count, const QString &fileName)
+{
+    Q_UNUSED(count);
+    Q_UNUSED(fileName);
+    QMetaObject::invokeMethod(this, "error", Qt::QueuedConnection,
+                              Q_ARG(int, -1),
+                              Q_ARG(int, QImageCapture::NotSupportedFeatureError),
+                              Q_ARG(QString, msgBurstNotSupported()));
+    return -1;
+}
+
+/*!
+    Like captureBurst(), but the \a count frames are only made available
+    through imageAvailable() and imageCaptured() and not saved.
+*/
+int QPlatformImageCapture::captureBurstToBuffer(int count)
+{
+    return captureBurst(count, QString());
+}
+
 /*!
     \fn QPlatformImageCapture::imageExposed(int requestId)
 
@@ -95,6 +95,8 @@ public:
 
     virtual int capture(const QString &fileName) = 0;
     virtual int captureToBuffer() = 0;
+    virtual int captureBurst(int count, const QString &fileName);
+    virtual int captureBurstToBuffer(int count);
 
     virtual QImageEncoderSettings imageSettings() const = 0;
     virtual void setImageSettings(const QImageEncoderSettings &settings) = 0;
@@ -106,6 +108,7 @@ public:
 
     static QString msgCameraNotReady();
     static QString msgImageCaptureNotSet();
+    static QString msgBurstNotSupported();
 
 Q_SIGNALS:
     void readyForCaptureChanged(bool ready);
@@ -44,6 +44,7 @@
 #include <qmediadevices.h>
 #include <qaudiodevice.h>
 #include <private/qmemoryvideobuffer_p.h>
+#include <private/qvideoframepool_p.h>
 #include <private/qwindowsmfdefs_p.h>
 #include <private/qwindowsiupointer_p.h>
 #include <QtCore/qdebug.h>
@@ -990,9 +991,14 @@ STDMETHODIMP QWindowsMediaDeviceReader::OnReadSample(HRESULT hrStatus, DWORD dwS
                     BYTE *buffer = nullptr;
 
                     if (SUCCEEDED(mediaBuffer->Lock(&buffer, nullptr, &bufLen))) {
-                        auto bytes = QByteArray(reinterpret_cast<char*>(buffer), bufLen);
-
-                        QVideoFrame frame(new QMemoryVideoBuffer(bytes, m_stride),
+                        auto *pool = QVideoFramePool::instance();
+                        QByteArray bytes = pool ? pool->acquire(bufLen) : QByteArray(int(bufLen), Qt::Uninitialized);
+                        memcpy(bytes.data(), buffer, bufLen);
+
+                        auto *videoBuffer = new QMemoryVideoBuffer(bytes, m_stride);
+                        videoBuffer->returnToPool = pool != nullptr;
+                        bytes.clear(); // the buffer must be the only owner to be recycled
+                        QVideoFrame frame(videoBuffer,
                                           QVideoFrameFormat(QSize(m_frameWidth, m_frameHeight), m_pixelFormat));
 
                         // WMF uses 100-nanosecond units, Qt uses microseconds
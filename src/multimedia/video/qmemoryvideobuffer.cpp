@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qmemoryvideobuffer_p.h"
+#include "qvideoframepool_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -48,6 +49,9 @@ QT_BEGIN_NAMESPACE
 
     QMemoryVideoBuffer is the default video buffer for allocating system memory.  It may be used to
     allocate memory for a QVideoFrame without implementing your own QAbstractVideoBuffer.
+
+    If returnToPool is set, the data is handed back to QVideoFramePool when the
+    buffer is destroyed, so that it can be reused for a later frame.
 */
 
 /*!
@@ -63,7 +67,13 @@ QMemoryVideoBuffer::QMemoryVideoBuffer(const QByteArray &array, int bytesPerLine
 /*!
     Destroys a system memory allocated video buffer.
 */
-QMemoryVideoBuffer::~QMemoryVideoBuffer() = default;
+QMemoryVideoBuffer::~QMemoryVideoBuffer()
+{
+    if (returnToPool) {
+        if (auto *pool = QVideoFramePool::instance())
+            pool->release(std::move(data));
+    }
+}
 
 /*!
     \reimp
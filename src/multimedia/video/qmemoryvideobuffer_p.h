@@ -70,6 +70,7 @@ public:
     int bytesPerLine = 0;
     QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
     QByteArray data;
+    bool returnToPool = false;
 };
 
 QT_END_NAMESPACE
@@ -42,10 +42,13 @@
 #include "qvideotexturehelper_p.h"
 #include "qmemoryvideobuffer_p.h"
 #include "qvideoframeconversionhelper_p.h"
+#include "qvideoframepool_p.h"
 #include "qvideoframeformat.h"
 #include "qpainter.h"
+#include <qpaintdevice.h>
 #include <qtextlayout.h>
 
+#include <qatomic.h>
 #include <qimage.h>
 #include <qmutex.h>
 #include <qpair.h>
@@ -120,6 +123,23 @@ public:
     QString subtitleText;
     QVideoFrame::RotationAngle rotationAngle = QVideoFrame::Rotation0;
     bool mirrored = false;
+
+    // Bumped whenever the frame is mapped for writing, so that paint() can
+    // tell whether its cached image still shows the frame's contents
+    QAtomicInteger<quint32> contentVersion = 0;
+
+    // Software rendering repaints the same frame on every expose, keep the
+    // last converted image and the subtitle layout around for paint()
+    struct PaintCache {
+        QImage image;
+        QSize imageSize;
+        QVideoFrame::RotationAngle rotationAngle = QVideoFrame::Rotation0;
+        bool mirrored = false;
+        quint32 contentVersion = 0;
+    };
+    QMutex paintMutex;
+    PaintCache paintCache;
+    QVideoTextureHelper::SubtitleLayout subtitleLayout;
 private:
     Q_DISABLE_COPY(QVideoFramePrivate)
 };
@@ -201,11 +221,18 @@ QVideoFrame::QVideoFrame(const QVideoFrameFormat &format)
     qsizetype bytes = textureDescription->bytesForSize(format.frameSize());
     if (bytes > 0) {
         QByteArray data;
-        data.resize(bytes);
+        auto *pool = QVideoFramePool::instance();
+        if (pool)
+            data = pool->acquire(bytes);
+        else
+            data.resize(bytes);
 
         // Check the memory was successfully allocated.
-        if (!data.isEmpty())
-            d->buffer = new QMemoryVideoBuffer(data, textureDescription->strideForWidth(format.frameWidth()));
+        if (!data.isEmpty()) {
+            auto *buffer = new QMemoryVideoBuffer(data, textureDescription->strideForWidth(format.frameWidth()));
+            buffer->returnToPool = pool != nullptr;
+            d->buffer = buffer;
+        }
     }
 }
 
@@ -438,6 +465,9 @@ bool QVideoFrame::map(QVideoFrame::MapMode mode)
     Q_ASSERT(d->mapData.nPlanes == 0);
     Q_ASSERT(d->mapData.size[0] == 0);
 
+    if (mode & QVideoFrame::WriteOnly)
+        d->contentVersion.fetchAndAddRelaxed(1);
+
     d->mapData = d->buffer->map(mode);
     if (d->mapData.nPlanes == 0)
         return false;
@@ -747,46 +777,87 @@ bool QVideoFrame::mirrored() const
     return d && d->mirrored;
 }
 
-/*!
-    Based on the pixel format converts current video frame to image.
-    \since 5.15
-*/
-QImage QVideoFrame::toImage() const
+static QImage convertToImage(const QVideoFrame &videoFrame, const QSize &targetSize,
+                             QVideoFrame::RotationAngle rotation, bool mirrored,
+                             QThreadPool *threadPool)
 {
-    QVideoFrame frame = *this;
+    QVideoFrame frame = videoFrame;
     QImage result;
 
     if (!frame.isValid() || !frame.map(QVideoFrame::ReadOnly))
         return result;
 
+    const bool flipped = frame.surfaceFormat().scanLineDirection() != QVideoFrameFormat::TopToBottom;
+    const QSize rotatedSize = rotation % 180 ? frame.size().transposed() : frame.size();
+    const QSize size = targetSize.isEmpty() ? rotatedSize : targetSize;
+
     if (frame.pixelFormat() == QVideoFrameFormat::Format_Jpeg) {
         // Load from JPG
         result.loadFromData(frame.bits(0), frame.mappedBytes(0), "JPG");
+        frame.unmap();
+
+        QTransform t;
+        if (mirrored)
+            t.scale(-1.f, 1.f);
+        if (rotation != QVideoFrame::Rotation0)
+            t.rotate(float(rotation));
+        if (flipped)
+            t.scale(1.f, -1.f);
+        if (!t.isIdentity())
+            result = result.transformed(t);
+        if (!result.isNull() && result.size() != size)
+            result = result.scaled(size);
+        return result;
     }
 
     // Need conversion
-    else {
-        VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
-        if (!convert) {
-            qWarning() << Q_FUNC_INFO << ": unsupported pixel format" << frame.pixelFormat();
-        } else {
-            auto format = pixelFormatHasAlpha[frame.pixelFormat()] ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
-            result = QImage(frame.width(), frame.height(), format);
-            convert(frame, result.bits());
+    VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
+    if (!convert) {
+        qWarning() << Q_FUNC_INFO << ": unsupported pixel format" << frame.pixelFormat();
+    } else {
+        auto format = pixelFormatHasAlpha[frame.pixelFormat()] ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+        auto *pool = QVideoFramePool::instance();
+        result = pool ? pool->acquireImage(size, format) : QImage(size, format);
+        if (!result.isNull()) {
+            if (!mirrored && !flipped && rotation == QVideoFrame::Rotation0 && size == frame.size())
+                qConvertFrameInStripes(frame, convert, result.bits(), threadPool);
+            else
+                qConvertFrameTransformed(frame, convert, result, rotation, mirrored);
         }
     }
 
     frame.unmap();
+    return result;
+}
 
-    QTransform t;
-    if (mirrored())
-        t.scale(-1.f, 1.f);
-    if (rotationAngle() != Rotation0)
-        t.rotate(float(rotationAngle()));
-    if (surfaceFormat().scanLineDirection() != QVideoFrameFormat::TopToBottom)
-        t.scale(1.f, -1.f);
+QImage qImageFromVideoFrame(const QVideoFrame &frame, const QSize &targetSize,
+                            QVideoFrame::RotationAngle rotation, bool mirrored)
+{
+    return convertToImage(frame, targetSize, rotation, mirrored, nullptr);
+}
 
-    return t.isIdentity() ? result : result.transformed(t);
+/*!
+    Based on the pixel format converts current video frame to image.
+    \since 5.15
+*/
+QImage QVideoFrame::toImage() const
+{
+    return toImage(nullptr);
+}
+
+/*!
+    Based on the pixel format converts current video frame to image.
+
+    Large frames are split into horizontal stripes that are converted in
+    parallel on \a threadPool, with the calling thread converting one of
+    the stripes itself. Frames too small to benefit from this, or a null
+    \a threadPool, are converted on the calling thread only.
+
+    \since 6.3
+*/
+QImage QVideoFrame::toImage(QThreadPool *threadPool) const
+{
+    return convertToImage(*this, QSize(), rotationAngle(), mirrored(), threadPool);
 }
 
 /*!
@@ -814,6 +885,10 @@ void QVideoFrame::setSubtitleText(const QString &text)
 
     \note that rendering will usually happen without hardware acceleration when
     using this method.
+
+    The converted image and the subtitle layout are kept with the frame, so
+    painting the same frame again at the same size doesn't convert it again.
+    Mapping the frame for writing invalidates the cached image.
 */
 void QVideoFrame::paint(QPainter *painter, const QRectF &rect, const PaintOptions &options)
 {
@@ -853,17 +928,41 @@ void QVideoFrame::paint(QPainter *painter, const QRectF &rect, const PaintOption
         }
     }
 
-    if (map(QVideoFrame::ReadOnly)) {
-        const QTransform oldTransform = painter->transform();
+    const QTransform oldTransform = painter->transform();
+    // Convert straight to the painted size in device pixels, only upscaling is left to drawImage().
+    // The conversion samples nearest neighbour, so smooth scaling stays with drawImage().
+    const QSizeF deviceSize = oldTransform.mapRect(QRectF({}, size)).size()
+            * painter->device()->devicePixelRatio();
+    const QSize rotatedSize = rotationAngle() % 180 ? this->size().transposed() : this->size();
+    const QSize imageSize = painter->testRenderHint(QPainter::SmoothPixmapTransform)
+            ? rotatedSize
+            : rotatedSize.boundedTo(deviceSize.toSize().expandedTo({1, 1}));
+    const quint32 contentVersion = d->contentVersion.loadRelaxed();
+
+    QImage image;
+    {
+        QMutexLocker locker(&d->paintMutex);
+        const auto &cache = d->paintCache;
+        if (cache.imageSize == imageSize && cache.rotationAngle == rotationAngle()
+            && cache.mirrored == mirrored() && cache.contentVersion == contentVersion)
+            image = cache.image;
+    }
+
+    if (image.isNull() && map(QVideoFrame::ReadOnly)) {
+        image = qImageFromVideoFrame(*this, imageSize, rotationAngle(), mirrored());
+        unmap();
+
+        QMutexLocker locker(&d->paintMutex);
+        d->paintCache = { image, imageSize, rotationAngle(), mirrored(), contentVersion };
+    }
+
+    if (!image.isNull()) {
         QTransform transform = oldTransform;
         transform.translate(targetRect.center().x() - size.width()/2,
                             targetRect.center().y() - size.height()/2);
         painter->setTransform(transform);
-        QImage image = toImage();
         painter->drawImage({{}, size}, image, {{},image.size()});
         painter->setTransform(oldTransform);
-
-        unmap();
     } else if (isValid()) {
         // #### error handling
     } else {
@@ -873,13 +972,10 @@ void QVideoFrame::paint(QPainter *painter, const QRectF &rect, const PaintOption
     if ((options.paintFlags & PaintOptions::DontDrawSubtitles) || d->subtitleText.isEmpty())
         return;
 
-    // draw subtitles
-    auto text = d->subtitleText;
-    text.replace(QLatin1Char('\n'), QChar::LineSeparator);
-
-    QVideoTextureHelper::SubtitleLayout layout;
-    layout.update(targetRect.size().toSize(), this->subtitleText());
-    layout.draw(painter, targetRect.topLeft());
+    // draw subtitles, the layout is only redone when the text or size changes
+    QMutexLocker locker(&d->paintMutex);
+    d->subtitleLayout.update(targetRect.size().toSize(), d->subtitleText);
+    d->subtitleLayout.draw(painter, targetRect.topLeft());
 }
 
 #ifndef QT_NO_DEBUG_STREAM
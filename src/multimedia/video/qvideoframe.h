@@ -55,6 +55,7 @@ class QAbstractVideoBuffer;
 class QRhi;
 class QRhiResourceUpdateBatch;
 class QRhiTexture;
+class QThreadPool;
 
 QT_DECLARE_QESDP_SPECIALIZATION_DTOR_WITH_EXPORT(QVideoFramePrivate, Q_MULTIMEDIA_EXPORT)
 
@@ -141,6 +142,7 @@ public:
     bool mirrored() const;
 
     QImage toImage() const;
+    QImage toImage(QThreadPool *threadPool) const;
 
     struct PaintOptions {
         QColor backgroundColor = Qt::transparent;
@@ -38,32 +38,41 @@
 ****************************************************************************/
 
 #include "qvideoframeconversionhelper_p.h"
+#include "qabstractvideobuffer_p.h"
 #include "qrgb.h"
 
-QT_BEGIN_NAMESPACE
-
-#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
+#include <qimage.h>
+#include <qsemaphore.h>
+#include <qthreadpool.h>
+#include <qvarlengtharray.h>
 
-#define EXPAND_UV(u, v) \
-    int uu = u - 128; \
-    int vv = v - 128; \
-    int rv = 409 * vv + 128; \
-    int guv = 100 * uu + 208 * vv + 128; \
-    int bu = 516 * uu + 128; \
+QT_BEGIN_NAMESPACE
 
-static inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
+const YCbCrCoefficients &qYCbCrCoefficients(QVideoFrameFormat::YCbCrColorSpace colorSpace)
 {
-    int yy = (y - 16) * 298;
-    return (a << 24)
-            | CLAMP((yy + rv) >> 8) << 16
-            | CLAMP((yy - guv) >> 8) << 8
-            | CLAMP((yy + bu) >> 8);
+    static const YCbCrCoefficients bt601 = { 16, 298, 409, 100, 208, 516 };
+    static const YCbCrCoefficients bt709 = { 16, 298, 459, 55, 136, 541 };
+    static const YCbCrCoefficients bt2020 = { 16, 298, 430, 48, 167, 548 };
+    static const YCbCrCoefficients jpeg = { 0, 256, 359, 88, 183, 454 };
+
+    switch (colorSpace) {
+    case QVideoFrameFormat::YCbCr_JPEG:
+        return jpeg;
+    case QVideoFrameFormat::YCbCr_BT709:
+    case QVideoFrameFormat::YCbCr_xvYCC709:
+        return bt709;
+    case QVideoFrameFormat::YCbCr_BT2020:
+        return bt2020;
+    default: //BT 601:
+        return bt601;
+    }
 }
 
 static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
+                                          const YCbCrCoefficients &coeffs,
                                           quint32 *rgb,
                                           int width, int height)
 {
@@ -77,14 +86,14 @@ static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(*lineU, *lineV, coeffs);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0++, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(coeffs, *lineY1++, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(coeffs, *lineY1++, rv, guv, bu);
         }
 
         y += yStride << 1; // stride * 2
@@ -99,6 +108,7 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
+                                          const YCbCrCoefficients &coeffs,
                                           quint32 *rgb,
                                           int width, int height)
 {
@@ -110,18 +120,17 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(*lineU, *lineV, coeffs);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0++, rv, guv, bu);
         }
 
-        y += yStride; // stride * 2
+        y += yStride;
         u += uStride;
         v += vStride;
-        rgb0 += width;
     }
 }
 
@@ -130,10 +139,12 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
 static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -141,10 +152,12 @@ static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, u
 static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV422_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -153,10 +166,12 @@ static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, u
 static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane3, plane3Stride,
                            plane2, plane2Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -164,6 +179,7 @@ static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
     quint32 *rgb = reinterpret_cast<quint32*>(output);
@@ -177,9 +193,9 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(u, v, coeffs);
 
-            *rgb++ = qPremultiply(qYUVToARGB32(y, rv, guv, bu, a));
+            *rgb++ = qPremultiply(qYUVToARGB32(coeffs, y, rv, guv, bu, a));
         }
 
         src += stride;
@@ -189,6 +205,7 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
     quint32 *rgb = reinterpret_cast<quint32*>(output);
@@ -202,9 +219,9 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(u, v, coeffs);
 
-            *rgb++ = qYUVToARGB32(y, rv, guv, bu, a);
+            *rgb++ = qYUVToARGB32(coeffs, y, rv, guv, bu, a);
         }
 
         src += stride;
@@ -214,6 +231,7 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
 static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
     quint32 *rgb = reinterpret_cast<quint32*>(output);
@@ -227,10 +245,10 @@ static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, ucha
             int v = *lineSrc++;
             int y1 = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(u, v, coeffs);
 
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y1, rv, guv, bu);
         }
 
         src += stride;
@@ -240,6 +258,7 @@ static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
     quint32 *rgb = reinterpret_cast<quint32*>(output);
@@ -253,10 +272,10 @@ static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, ucha
             int y1 = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(u, v, coeffs);
 
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y1, rv, guv, bu);
         }
 
         src += stride;
@@ -266,10 +285,12 @@ static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane2 + 1, plane2Stride,
                            2,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -277,10 +298,12 @@ static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2 + 1, plane2Stride,
                            plane2, plane2Stride,
                            2,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -288,6 +311,7 @@ static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
     Q_ASSERT(plane1Stride == plane3Stride);
 
@@ -295,6 +319,7 @@ static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, ucha
                            plane3, plane3Stride,
                            plane2, plane2Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -302,12 +327,14 @@ static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
 
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2 + (plane1Stride >> 1), plane1Stride,
                            plane2, plane1Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -315,6 +342,7 @@ static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
     Q_ASSERT(plane1Stride == plane3Stride);
 
@@ -322,6 +350,7 @@ static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2, plane2Stride,
                            plane3, plane3Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -329,12 +358,14 @@ static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, ucha
 static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
 
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane1Stride,
                            plane2 + (plane1Stride >> 1), plane1Stride,
                            1,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 }
@@ -410,6 +441,7 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
                                                   const uchar *u, int uStride,
                                                   const uchar *v, int vStride,
                                                   int uvPixelStride,
+                                          const YCbCrCoefficients &coeffs,
                                           quint32 *rgb,
                                           int width, int height)
 {
@@ -423,17 +455,17 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(*lineU, *lineV, coeffs);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0, rv, guv, bu);
             lineY0 += 2;
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(coeffs, *lineY0, rv, guv, bu);
             lineY0 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(coeffs, *lineY1, rv, guv, bu);
             lineY1 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(coeffs, *lineY1, rv, guv, bu);
             lineY1 += 2;
         }
 
@@ -448,10 +480,12 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
 static void QT_FASTCALL qt_convert_P016_to_ARGB32(const QVideoFrame &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
     planarYUV420_16bit_to_ARGB32(plane1 + 1, plane1Stride,
                            plane2 + 1, plane2Stride,
                            plane2 + 3, plane2Stride,
                            4,
+                           coeffs,
                            reinterpret_cast<quint32*>(output),
                            width, height);
 
@@ -531,6 +565,13 @@ static void qInitConvertFuncsAsm()
     extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
     if (qCpuHasFeature(SSE2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_sse2;
@@ -542,6 +583,14 @@ static void qInitConvertFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_BGRA8888] = qt_convert_BGRA8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_BGRA8888] = qt_convert_BGRA8888_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_sse2;
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_SSSE3
@@ -567,6 +616,13 @@ static void qInitConvertFuncsAsm()
     extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
     if (qCpuHasFeature(AVX2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_avx2;
@@ -578,8 +634,33 @@ static void qInitConvertFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_BGRA8888] = qt_convert_BGRA8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_BGRA8888] = qt_convert_BGRA8888_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_avx2;
     }
 #endif
+#if defined(__ARM_NEON)
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_neon(const QVideoFrame &frame, uchar *output);
+    qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_neon;
+#endif
 }
 
 VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format)
@@ -593,5 +674,191 @@ VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format)
     return convert;
 }
 
+namespace {
+
+// Exposes a range of rows of an already mapped frame
+class QVideoFrameStripeBuffer : public QAbstractVideoBuffer
+{
+public:
+    QVideoFrameStripeBuffer(const MapData &mapData)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+          m_mapData(mapData)
+    {}
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        if (mode != QVideoFrame::ReadOnly)
+            return {};
+        m_mapMode = mode;
+        return m_mapData;
+    }
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    MapData m_mapData;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+};
+
+bool hasVerticallySubsampledChroma(QVideoFrameFormat::PixelFormat format)
+{
+    switch (format) {
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QVideoFrame stripeOfFrame(const QVideoFrame &frame, int firstRow, int rowCount)
+{
+    const int chromaShift = hasVerticallySubsampledChroma(frame.pixelFormat()) ? 1 : 0;
+
+    QAbstractVideoBuffer::MapData mapData;
+    mapData.nPlanes = frame.planeCount();
+    for (int plane = 0; plane < mapData.nPlanes; ++plane) {
+        const int rowOffset = plane == 0 ? firstRow : (firstRow >> chromaShift);
+        const int offset = rowOffset * frame.bytesPerLine(plane);
+        mapData.bytesPerLine[plane] = frame.bytesPerLine(plane);
+        mapData.data[plane] = const_cast<uchar *>(frame.bits(plane)) + offset;
+        mapData.size[plane] = frame.mappedBytes(plane) - offset;
+    }
+
+    QVideoFrameFormat format = frame.surfaceFormat();
+    format.setFrameSize(frame.width(), rowCount);
+    return QVideoFrame(new QVideoFrameStripeBuffer(mapData), format);
+}
+
+void convertStripe(QVideoFrame stripe, VideoFrameConvertFunc convert, uchar *output)
+{
+    if (stripe.map(QVideoFrame::ReadOnly)) {
+        convert(stripe, output);
+        stripe.unmap();
+    }
+}
+
+}
+
+void qConvertFrameInStripes(const QVideoFrame &frame, VideoFrameConvertFunc convert,
+                            uchar *output, QThreadPool *threadPool)
+{
+    // Below this many pixels per stripe, dispatching costs more than it saves
+    constexpr int minStripeSize = 256 * 1024;
+
+    const int width = frame.width();
+    const int height = frame.height();
+    int stripeCount = threadPool ? qMin(threadPool->maxThreadCount() + 1, width * height / minStripeSize) : 1;
+    if (stripeCount < 2 || height < 2 * stripeCount) {
+        convert(frame, output);
+        return;
+    }
+
+    // Keep stripes at an even number of rows so chroma rows of 4:2:0 formats are not split
+    const int stripeHeight = ((height + stripeCount - 1) / stripeCount + 1) & ~1;
+    const int outputStride = width * 4;
+
+    QSemaphore done;
+    int started = 0;
+    int firstRow = 0;
+    for (; firstRow + stripeHeight < height; firstRow += stripeHeight) {
+        QVideoFrame stripe = stripeOfFrame(frame, firstRow, stripeHeight);
+        uchar *stripeOutput = output + firstRow * outputStride;
+        // Run the stripe here if the pool is busy, waiting for it could dead lock
+        // when called from one of its threads.
+        const bool queued = threadPool->tryStart([stripe, convert, stripeOutput, &done] {
+            convertStripe(stripe, convert, stripeOutput);
+            done.release();
+        });
+        if (queued)
+            ++started;
+        else
+            convertStripe(stripe, convert, stripeOutput);
+    }
+
+    convertStripe(stripeOfFrame(frame, firstRow, height - firstRow), convert,
+                  output + firstRow * outputStride);
+    done.acquire(started);
+}
+
+void qConvertFrameTransformed(const QVideoFrame &frame, VideoFrameConvertFunc convert,
+                              QImage &output, QVideoFrame::RotationAngle rotation, bool mirrored)
+{
+    const int width = frame.width();
+    const int height = frame.height();
+    const int targetWidth = output.width();
+    const int targetHeight = output.height();
+    if (width <= 0 || height <= 0 || output.isNull())
+        return;
+
+    const bool transposed = rotation % 180;
+    const int rotatedWidth = transposed ? height : width;
+    const int rotatedHeight = transposed ? width : height;
+    const bool flipped = frame.surfaceFormat().scanLineDirection() != QVideoFrameFormat::TopToBottom;
+
+    // Sample positions in the rotated frame, taken at the center of every target pixel
+    QVarLengthArray<int, 1024> columns(targetWidth);
+    for (int x = 0; x < targetWidth; ++x) {
+        const int rx = int((2 * qint64(x) + 1) * rotatedWidth / (2 * targetWidth));
+        columns[x] = mirrored ? rotatedWidth - 1 - rx : rx;
+    }
+    QVarLengthArray<int, 1024> rows(targetHeight);
+    for (int y = 0; y < targetHeight; ++y)
+        rows[y] = int((2 * qint64(y) + 1) * rotatedHeight / (2 * targetHeight));
+
+    // Undo the rotation. With a transposed frame, target columns select source rows and
+    // target rows select source columns.
+    QVarLengthArray<int, 1024> &sourceRowOf = transposed ? columns : rows;
+    QVarLengthArray<int, 1024> &sourceColumnOf = transposed ? rows : columns;
+    for (int &row : sourceRowOf) {
+        if (rotation == QVideoFrame::Rotation180 || rotation == QVideoFrame::Rotation90)
+            row = height - 1 - row;
+        if (flipped)
+            row = height - 1 - row;
+    }
+    for (int &column : sourceColumnOf) {
+        if (rotation == QVideoFrame::Rotation180 || rotation == QVideoFrame::Rotation270)
+            column = width - 1 - column;
+    }
+
+    // Rows are converted in pairs so chroma rows of 4:2:0 formats are not split
+    QVarLengthArray<quint32, 4096> rowPair(width * 2);
+    int convertedPair = -1;
+    auto sourceLine = [&](int row) -> const quint32 * {
+        const int firstRow = row & ~1;
+        if (firstRow != convertedPair) {
+            convertStripe(stripeOfFrame(frame, firstRow, qMin(2, height - firstRow)), convert,
+                          reinterpret_cast<uchar *>(rowPair.data()));
+            convertedPair = firstRow;
+        }
+        return rowPair.constData() + (row - firstRow) * width;
+    };
+
+    if (!transposed) {
+        for (int y = 0; y < targetHeight; ++y) {
+            const quint32 *line = sourceLine(sourceRowOf[y]);
+            quint32 *target = reinterpret_cast<quint32 *>(output.scanLine(y));
+            for (int x = 0; x < targetWidth; ++x)
+                target[x] = line[sourceColumnOf[x]];
+        }
+    } else {
+        const qsizetype targetStride = output.bytesPerLine() / 4;
+        quint32 *bits = reinterpret_cast<quint32 *>(output.bits());
+        for (int x = 0; x < targetWidth; ++x) {
+            const quint32 *line = sourceLine(sourceRowOf[x]);
+            quint32 *target = bits + x;
+            for (int y = 0; y < targetHeight; ++y, target += targetStride)
+                *target = line[sourceColumnOf[y]];
+        }
+    }
+}
 
 QT_END_NAMESPACE
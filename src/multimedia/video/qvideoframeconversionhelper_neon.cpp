@@ -0,0 +1,313 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qvideoframeconversionhelper_p.h"
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace  {
+
+// Converts 8 pixels to ARGB32. u and v hold one chroma sample per pixel.
+// Uses the same fixed point math as qYUVToARGB32(), so the results are bit exact.
+inline void yuvToARGB32_neon(const YCbCrCoefficients &coeffs, uint8x8_t y, uint8x8_t u, uint8x8_t v, quint32 *argb)
+{
+    const int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(coeffs.yOffset));
+    const int16x8_t uu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+    const int16x8_t vv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+
+    const int32x4_t yyLo = vmull_n_s16(vget_low_s16(yy), coeffs.y);
+    const int32x4_t yyHi = vmull_n_s16(vget_high_s16(yy), coeffs.y);
+    const int32x4_t rvLo = vmull_n_s16(vget_low_s16(vv), coeffs.rv);
+    const int32x4_t rvHi = vmull_n_s16(vget_high_s16(vv), coeffs.rv);
+    const int32x4_t guvLo = vmlal_n_s16(vmull_n_s16(vget_low_s16(uu), coeffs.gu), vget_low_s16(vv), coeffs.gv);
+    const int32x4_t guvHi = vmlal_n_s16(vmull_n_s16(vget_high_s16(uu), coeffs.gu), vget_high_s16(vv), coeffs.gv);
+    const int32x4_t buLo = vmull_n_s16(vget_low_s16(uu), coeffs.bu);
+    const int32x4_t buHi = vmull_n_s16(vget_high_s16(uu), coeffs.bu);
+
+    // the rounding constant of rv, guv and bu is folded into luma
+    const int32x4_t round = vdupq_n_s32(128);
+    const int32x4_t yyPlusLo = vaddq_s32(yyLo, round);
+    const int32x4_t yyPlusHi = vaddq_s32(yyHi, round);
+    const int32x4_t yyMinusLo = vsubq_s32(yyLo, round);
+    const int32x4_t yyMinusHi = vsubq_s32(yyHi, round);
+
+    const int16x8_t r = vcombine_s16(vmovn_s32(vshrq_n_s32(vaddq_s32(yyPlusLo, rvLo), 8)),
+                                     vmovn_s32(vshrq_n_s32(vaddq_s32(yyPlusHi, rvHi), 8)));
+    const int16x8_t g = vcombine_s16(vmovn_s32(vshrq_n_s32(vsubq_s32(yyMinusLo, guvLo), 8)),
+                                     vmovn_s32(vshrq_n_s32(vsubq_s32(yyMinusHi, guvHi), 8)));
+    const int16x8_t b = vcombine_s16(vmovn_s32(vshrq_n_s32(vaddq_s32(yyPlusLo, buLo), 8)),
+                                     vmovn_s32(vshrq_n_s32(vaddq_s32(yyPlusHi, buHi), 8)));
+
+    uint8x8x4_t pixels;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    pixels.val[0] = vqmovun_s16(b);
+    pixels.val[1] = vqmovun_s16(g);
+    pixels.val[2] = vqmovun_s16(r);
+    pixels.val[3] = vdup_n_u8(0xff);
+#else
+    pixels.val[0] = vdup_n_u8(0xff);
+    pixels.val[1] = vqmovun_s16(r);
+    pixels.val[2] = vqmovun_s16(g);
+    pixels.val[3] = vqmovun_s16(b);
+#endif
+    vst4_u8(reinterpret_cast<uint8_t *>(argb), pixels);
+}
+
+// Converts 16 pixels, y holds the luma samples in order, u and v one sample per pixel pair
+inline void yuvToARGB32x16_neon(const YCbCrCoefficients &coeffs, uint8x8x2_t y, uint8x8_t u, uint8x8_t v, quint32 *argb)
+{
+    const uint8x8x2_t uu = vzip_u8(u, u);
+    const uint8x8x2_t vv = vzip_u8(v, v);
+    yuvToARGB32_neon(coeffs, y.val[0], uu.val[0], vv.val[0], argb);
+    yuvToARGB32_neon(coeffs, y.val[1], uu.val[1], vv.val[1], argb + 8);
+}
+
+inline uint8x8x2_t split_neon(uint8x16_t y)
+{
+    uint8x8x2_t result;
+    result.val[0] = vget_low_u8(y);
+    result.val[1] = vget_high_u8(y);
+    return result;
+}
+
+// uvPixelStride is 1 for planar and 2 for semi planar (NV12/NV21) chroma
+template<int uvPixelStride>
+void planarYUV420_to_ARGB32_neon(const uchar *y, int yStride,
+                                 const uchar *u, int uStride,
+                                 const uchar *v, int vStride,
+                                 const YCbCrCoefficients &coeffs,
+                                 quint32 *rgb,
+                                 int width, int height)
+{
+    for (int j = 0; j < height; j += 2) {
+        const uchar *lineY0 = y;
+        const uchar *lineY1 = y + yStride;
+        quint32 *rgb0 = rgb;
+        quint32 *rgb1 = rgb + width;
+        const bool lastRow = j + 1 >= height;
+
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            uint8x8_t uu, vv;
+            if (uvPixelStride == 1) {
+                uu = vld1_u8(u + x / 2);
+                vv = vld1_u8(v + x / 2);
+            } else {
+                // u and v are interleaved, the one at the lower address comes first
+                const uint8x8x2_t uv = vld2_u8(u < v ? u + x : v + x);
+                uu = u < v ? uv.val[0] : uv.val[1];
+                vv = u < v ? uv.val[1] : uv.val[0];
+            }
+
+            yuvToARGB32x16_neon(coeffs, split_neon(vld1q_u8(lineY0 + x)), uu, vv, rgb0 + x);
+            if (!lastRow)
+                yuvToARGB32x16_neon(coeffs, split_neon(vld1q_u8(lineY1 + x)), uu, vv, rgb1 + x);
+        }
+
+        // leftovers
+        for (; x < width; x += 2) {
+            EXPAND_UV(u[x / 2 * uvPixelStride], v[x / 2 * uvPixelStride], coeffs);
+            const bool hasPair = x + 1 < width;
+            rgb0[x] = qYUVToARGB32(coeffs, lineY0[x], rv, guv, bu);
+            if (hasPair)
+                rgb0[x + 1] = qYUVToARGB32(coeffs, lineY0[x + 1], rv, guv, bu);
+            if (!lastRow) {
+                rgb1[x] = qYUVToARGB32(coeffs, lineY1[x], rv, guv, bu);
+                if (hasPair)
+                    rgb1[x + 1] = qYUVToARGB32(coeffs, lineY1[x + 1], rv, guv, bu);
+            }
+        }
+
+        y += yStride << 1; // stride * 2
+        u += uStride;
+        v += vStride;
+        rgb += width << 1;
+    }
+}
+
+// yIndex is 0 for YUYV and 1 for UYVY
+template<int yIndex>
+void packedYUV422_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    quint32 *rgb = reinterpret_cast<quint32 *>(output);
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const uint8x8x4_t data = vld4_u8(lineSrc);
+            lineSrc += 32;
+            const uint8x8x2_t yy = vzip_u8(data.val[yIndex], data.val[2 + yIndex]);
+            yuvToARGB32x16_neon(coeffs, yy, data.val[1 - yIndex], data.val[3 - yIndex], rgb);
+            rgb += 16;
+        }
+
+        // leftovers
+        for (; x < width; x += 2) {
+            const int y0 = lineSrc[yIndex];
+            const int u = lineSrc[1 - yIndex];
+            const int y1 = lineSrc[2 + yIndex];
+            const int v = lineSrc[3 - yIndex];
+            lineSrc += 4;
+
+            EXPAND_UV(u, v, coeffs);
+
+            *rgb++ = qYUVToARGB32(coeffs, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y1, rv, guv, bu);
+        }
+
+        src += stride;
+    }
+}
+
+}
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_neon<1>(plane1, plane1Stride,
+                                   plane2, plane2Stride,
+                                   plane3, plane3Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_neon<1>(plane1, plane1Stride,
+                                   plane3, plane3Stride,
+                                   plane2, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_neon<2>(plane1, plane1Stride,
+                                   plane2, plane2Stride,
+                                   plane2 + 1, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_neon<2>(plane1, plane1Stride,
+                                   plane2 + 1, plane2Stride,
+                                   plane2, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    packedYUV422_to_ARGB32_neon<0>(frame, output);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    packedYUV422_to_ARGB32_neon<1>(frame, output);
+}
+
+// Only the most significant byte of every 16 bit sample is used, as in the generic version
+void QT_FASTCALL qt_convert_P016_to_ARGB32_neon(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    quint32 *rgb = reinterpret_cast<quint32 *>(output);
+
+    for (int j = 0; j < height; j += 2) {
+        const bool lastRow = j + 1 >= height;
+        const quint16 *uv = reinterpret_cast<const quint16 *>(plane2);
+
+        for (int row = 0; row < (lastRow ? 1 : 2); ++row) {
+            const quint16 *lineY = reinterpret_cast<const quint16 *>(plane1 + row * plane1Stride);
+            quint32 *line = rgb + row * width;
+
+            int x = 0;
+            for (; x < width - 15; x += 16) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+                const int msb = 1;
+#else
+                const int msb = 0;
+#endif
+                const uint8x16x2_t yy = vld2q_u8(reinterpret_cast<const uint8_t *>(lineY + x));
+                const uint8x8x4_t uvData = vld4_u8(reinterpret_cast<const uint8_t *>(uv + x));
+                yuvToARGB32x16_neon(coeffs, split_neon(yy.val[msb]), uvData.val[msb], uvData.val[2 + msb], line + x);
+            }
+
+            // leftovers
+            for (; x < width; x += 2) {
+                const int u = uv[x] >> 8;
+                const int v = uv[x + 1] >> 8;
+                EXPAND_UV(u, v, coeffs);
+                line[x] = qYUVToARGB32(coeffs, lineY[x] >> 8, rv, guv, bu);
+                if (x + 1 < width)
+                    line[x + 1] = qYUVToARGB32(coeffs, lineY[x + 1] >> 8, rv, guv, bu);
+            }
+        }
+
+        plane1 += plane1Stride << 1; // stride * 2
+        plane2 += plane2Stride;
+        rgb += width << 1;
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif
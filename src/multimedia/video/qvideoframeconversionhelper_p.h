@@ -56,10 +56,28 @@
 
 QT_BEGIN_NAMESPACE
 
+class QThreadPool;
+
 // Converts to RGB32 or ARGB32_Premultiplied
 typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output);
 
-VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format);
+Q_MULTIMEDIA_EXPORT VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format);
+
+// Runs convert on horizontal stripes of the mapped frame, on threadPool and the calling
+// thread. Small frames, or a null threadPool, are converted in one go on the calling thread.
+void qConvertFrameInStripes(const QVideoFrame &frame, VideoFrameConvertFunc convert,
+                            uchar *output, QThreadPool *threadPool);
+
+// Converts the mapped frame into output, scaling it to the size of output with nearest
+// neighbour sampling and applying rotation, mirroring and the scan line direction of the
+// frame on the way. Only the source rows that are sampled get converted.
+void qConvertFrameTransformed(const QVideoFrame &frame, VideoFrameConvertFunc convert,
+                              QImage &output, QVideoFrame::RotationAngle rotation, bool mirrored);
+
+// Converts frame to an image of targetSize in a single pass, see qConvertFrameTransformed().
+// An empty targetSize keeps the size of the rotated frame.
+Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrame(const QVideoFrame &frame, const QSize &targetSize,
+                                                QVideoFrame::RotationAngle rotation, bool mirrored);
 
 template<int a, int r, int g, int b>
 struct RgbPixel
@@ -135,6 +153,42 @@ using BGRX8888 = RgbPixel<-1, 2, 1, 0>;
 #define ALIGN(boundary, ptr, x, length) \
     for (; ((reinterpret_cast<qintptr>(ptr) & (boundary - 1)) != 0) && x < length; ++x)
 
+// YCbCr to RGB coefficients in fixed point with 8 fractional bits, matching the color
+// matrices used for rendering in QVideoTextureHelper. Full range color spaces have a
+// yOffset of 0. All factors fit into 16 bit for the SIMD versions.
+struct YCbCrCoefficients
+{
+    int yOffset;
+    int y;
+    int rv;
+    int gu;
+    int gv;
+    int bu;
+};
+
+const YCbCrCoefficients &qYCbCrCoefficients(QVideoFrameFormat::YCbCrColorSpace colorSpace);
+
+#define FETCH_YUV_COEFFICIENTS(frame) \
+    const YCbCrCoefficients &coeffs = qYCbCrCoefficients(frame.surfaceFormat().yCbCrColorSpace());
+
+#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
+
+#define EXPAND_UV(u, v, coeffs) \
+    int uu = u - 128; \
+    int vv = v - 128; \
+    int rv = coeffs.rv * vv + 128; \
+    int guv = coeffs.gu * uu + coeffs.gv * vv + 128; \
+    int bu = coeffs.bu * uu + 128; \
+
+static inline quint32 qYUVToARGB32(const YCbCrCoefficients &coeffs, int y, int rv, int guv, int bu, int a = 0xff)
+{
+    int yy = (y - coeffs.yOffset) * coeffs.y;
+    return (a << 24)
+            | CLAMP((yy + rv) >> 8) << 16
+            | CLAMP((yy - guv) >> 8) << 8
+            | CLAMP((yy + bu) >> 8);
+}
+
 QT_END_NAMESPACE
 
 #endif // QVIDEOFRAMECONVERSIONHELPER_P_H
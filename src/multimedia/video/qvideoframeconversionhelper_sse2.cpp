@@ -94,6 +94,195 @@ void convert_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
     }
 }
 
+// YCbCrCoefficients broadcast to all lanes
+struct YCbCrVectors_sse2
+{
+    YCbCrVectors_sse2(const YCbCrCoefficients &coeffs)
+        : yOffset(_mm_set1_epi16(coeffs.yOffset)),
+          y(_mm_set1_epi16(coeffs.y)),
+          rv(_mm_set1_epi16(coeffs.rv)),
+          bu(_mm_set1_epi16(coeffs.bu)),
+          guv(_mm_set1_epi32((coeffs.gv << 16) | coeffs.gu))
+    {}
+
+    __m128i yOffset;
+    __m128i y;
+    __m128i rv;
+    __m128i bu;
+    __m128i guv; // gu and gv interleaved for _mm_madd_epi16()
+};
+
+inline void mul32_sse2(__m128i a, __m128i f, __m128i &lo, __m128i &hi)
+{
+    const __m128i l = _mm_mullo_epi16(a, f);
+    const __m128i h = _mm_mulhi_epi16(a, f);
+    lo = _mm_unpacklo_epi16(l, h);
+    hi = _mm_unpackhi_epi16(l, h);
+}
+
+// Converts 8 pixels to ARGB32. y holds 8 luma samples as 16 bit values, u and v hold
+// 4 chroma samples in their low 4 lanes, each shared by two horizontally adjacent pixels.
+// Uses the same fixed point math as qYUVToARGB32(), so the results are bit exact.
+inline void yuvToARGB32_sse2(const YCbCrVectors_sse2 &coeffs, __m128i y, __m128i u, __m128i v, quint32 *argb)
+{
+    y = _mm_sub_epi16(y, coeffs.yOffset);
+    u = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    v = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    u = _mm_unpacklo_epi16(u, u);
+    v = _mm_unpacklo_epi16(v, v);
+
+    __m128i yyLo, yyHi, rvLo, rvHi, buLo, buHi;
+    mul32_sse2(y, coeffs.y, yyLo, yyHi);
+    mul32_sse2(v, coeffs.rv, rvLo, rvHi);
+    mul32_sse2(u, coeffs.bu, buLo, buHi);
+    const __m128i guvLo = _mm_madd_epi16(_mm_unpacklo_epi16(u, v), coeffs.guv);
+    const __m128i guvHi = _mm_madd_epi16(_mm_unpackhi_epi16(u, v), coeffs.guv);
+
+    // the rounding constant of rv, guv and bu is folded into luma
+    const __m128i round = _mm_set1_epi32(128);
+    const __m128i yyPlusLo = _mm_add_epi32(yyLo, round);
+    const __m128i yyPlusHi = _mm_add_epi32(yyHi, round);
+    const __m128i yyMinusLo = _mm_sub_epi32(yyLo, round);
+    const __m128i yyMinusHi = _mm_sub_epi32(yyHi, round);
+
+    __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yyPlusLo, rvLo), 8),
+                                _mm_srai_epi32(_mm_add_epi32(yyPlusHi, rvHi), 8));
+    __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_sub_epi32(yyMinusLo, guvLo), 8),
+                                _mm_srai_epi32(_mm_sub_epi32(yyMinusHi, guvHi), 8));
+    __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yyPlusLo, buLo), 8),
+                                _mm_srai_epi32(_mm_add_epi32(yyPlusHi, buHi), 8));
+    r = _mm_packus_epi16(r, r);
+    g = _mm_packus_epi16(g, g);
+    b = _mm_packus_epi16(b, b);
+
+    const __m128i bg = _mm_unpacklo_epi8(b, g);
+    const __m128i ra = _mm_unpacklo_epi8(r, _mm_set1_epi8(char(0xff)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(argb), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(argb + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+// Splits 4 interleaved pairs of 16 bit chroma values into u and v
+inline void splitUV_sse2(__m128i uv, __m128i &u, __m128i &v)
+{
+    const __m128i zero = _mm_setzero_si128();
+    u = _mm_packs_epi32(_mm_and_si128(uv, _mm_set1_epi32(0xffff)), zero);
+    v = _mm_packs_epi32(_mm_srli_epi32(uv, 16), zero);
+}
+
+// uvPixelStride is 1 for planar and 2 for semi planar (NV12/NV21) chroma
+template<int uvPixelStride>
+void planarYUV420_to_ARGB32_sse2(const uchar *y, int yStride,
+                                 const uchar *u, int uStride,
+                                 const uchar *v, int vStride,
+                                 const YCbCrCoefficients &coeffs,
+                                 quint32 *rgb,
+                                 int width, int height)
+{
+    const YCbCrVectors_sse2 vectors(coeffs);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+
+    for (int j = 0; j < height; j += 2) {
+        const uchar *lineY0 = y;
+        const uchar *lineY1 = y + yStride;
+        quint32 *rgb0 = rgb;
+        quint32 *rgb1 = rgb + width;
+        const bool lastRow = j + 1 >= height;
+
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            __m128i uu, vv;
+            if (uvPixelStride == 1) {
+                uu = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)), zero);
+                vv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)), zero);
+            } else {
+                // u and v are interleaved, the one at the lower address comes first
+                const uchar *uv = u < v ? u : v;
+                const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+                const __m128i first = _mm_and_si128(data, lowBytes);
+                const __m128i second = _mm_srli_epi16(data, 8);
+                uu = u < v ? first : second;
+                vv = u < v ? second : first;
+            }
+            const __m128i uuHi = _mm_srli_si128(uu, 8);
+            const __m128i vvHi = _mm_srli_si128(vv, 8);
+
+            __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lineY0 + x));
+            yuvToARGB32_sse2(vectors, _mm_unpacklo_epi8(yy, zero), uu, vv, rgb0 + x);
+            yuvToARGB32_sse2(vectors, _mm_unpackhi_epi8(yy, zero), uuHi, vvHi, rgb0 + x + 8);
+            if (!lastRow) {
+                yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lineY1 + x));
+                yuvToARGB32_sse2(vectors, _mm_unpacklo_epi8(yy, zero), uu, vv, rgb1 + x);
+                yuvToARGB32_sse2(vectors, _mm_unpackhi_epi8(yy, zero), uuHi, vvHi, rgb1 + x + 8);
+            }
+        }
+
+        // leftovers
+        for (; x < width; x += 2) {
+            EXPAND_UV(u[x / 2 * uvPixelStride], v[x / 2 * uvPixelStride], coeffs);
+            const bool hasPair = x + 1 < width;
+            rgb0[x] = qYUVToARGB32(coeffs, lineY0[x], rv, guv, bu);
+            if (hasPair)
+                rgb0[x + 1] = qYUVToARGB32(coeffs, lineY0[x + 1], rv, guv, bu);
+            if (!lastRow) {
+                rgb1[x] = qYUVToARGB32(coeffs, lineY1[x], rv, guv, bu);
+                if (hasPair)
+                    rgb1[x + 1] = qYUVToARGB32(coeffs, lineY1[x + 1], rv, guv, bu);
+            }
+        }
+
+        y += yStride << 1; // stride * 2
+        u += uStride;
+        v += vStride;
+        rgb += width << 1;
+    }
+}
+
+// yIndex is 0 for YUYV and 1 for UYVY
+template<int yIndex>
+void packedYUV422_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_PACKED(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    quint32 *rgb = reinterpret_cast<quint32 *>(output);
+
+    const YCbCrVectors_sse2 vectors(coeffs);
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+
+        int x = 0;
+        for (; x < width - 7; x += 8) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lineSrc));
+            lineSrc += 16;
+            const __m128i yy = yIndex ? _mm_srli_epi16(data, 8) : _mm_and_si128(data, lowBytes);
+            const __m128i uv = yIndex ? _mm_and_si128(data, lowBytes) : _mm_srli_epi16(data, 8);
+            __m128i uu, vv;
+            splitUV_sse2(uv, uu, vv);
+            yuvToARGB32_sse2(vectors, yy, uu, vv, rgb);
+            rgb += 8;
+        }
+
+        // leftovers
+        for (; x < width; x += 2) {
+            const int y0 = lineSrc[yIndex];
+            const int u = lineSrc[1 - yIndex];
+            const int y1 = lineSrc[2 + yIndex];
+            const int v = lineSrc[3 - yIndex];
+            lineSrc += 4;
+
+            EXPAND_UV(u, v, coeffs);
+
+            *rgb++ = qYUVToARGB32(coeffs, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(coeffs, y1, rv, guv, bu);
+        }
+
+        src += stride;
+    }
+}
+
 }
 
 void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
@@ -116,6 +305,106 @@ void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uc
     convert_to_ARGB32_sse2<3, 2, 1, 0>(frame, output);
 }
 
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_sse2<1>(plane1, plane1Stride,
+                                   plane2, plane2Stride,
+                                   plane3, plane3Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_sse2<1>(plane1, plane1Stride,
+                                   plane3, plane3Stride,
+                                   plane2, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_sse2<2>(plane1, plane1Stride,
+                                   plane2, plane2Stride,
+                                   plane2 + 1, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    planarYUV420_to_ARGB32_sse2<2>(plane1, plane1Stride,
+                                   plane2 + 1, plane2Stride,
+                                   plane2, plane2Stride,
+                                   coeffs,
+                                   reinterpret_cast<quint32 *>(output),
+                                   width, height);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    packedYUV422_to_ARGB32_sse2<0>(frame, output);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    packedYUV422_to_ARGB32_sse2<1>(frame, output);
+}
+
+// Only the most significant byte of every 16 bit sample is used, as in the generic version
+void QT_FASTCALL qt_convert_P016_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    FETCH_YUV_COEFFICIENTS(frame)
+    quint32 *rgb = reinterpret_cast<quint32 *>(output);
+    const YCbCrVectors_sse2 vectors(coeffs);
+
+    for (int j = 0; j < height; j += 2) {
+        const bool lastRow = j + 1 >= height;
+        const quint16 *uv = reinterpret_cast<const quint16 *>(plane2);
+
+        for (int row = 0; row < (lastRow ? 1 : 2); ++row) {
+            const quint16 *lineY = reinterpret_cast<const quint16 *>(plane1 + row * plane1Stride);
+            quint32 *line = rgb + row * width;
+
+            int x = 0;
+            for (; x < width - 7; x += 8) {
+                const __m128i yy = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lineY + x)), 8);
+                const __m128i uvData = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x)), 8);
+                __m128i uu, vv;
+                splitUV_sse2(uvData, uu, vv);
+                yuvToARGB32_sse2(vectors, yy, uu, vv, line + x);
+            }
+
+            // leftovers
+            for (; x < width; x += 2) {
+                const int u = uv[x] >> 8;
+                const int v = uv[x + 1] >> 8;
+                EXPAND_UV(u, v, coeffs);
+                line[x] = qYUVToARGB32(coeffs, lineY[x] >> 8, rv, guv, bu);
+                if (x + 1 < width)
+                    line[x + 1] = qYUVToARGB32(coeffs, lineY[x + 1] >> 8, rv, guv, bu);
+            }
+        }
+
+        plane1 += plane1Stride << 1; // stride * 2
+        plane2 += plane2Stride;
+        rgb += width << 1;
+    }
+}
+
 QT_END_NAMESPACE
 
 #endif
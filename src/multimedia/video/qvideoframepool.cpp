@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qvideoframepool_p.h"
+
+#include <QtCore/qglobalstatic.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(QVideoFramePool, videoFramePool)
+
+/*!
+    \class QVideoFramePool
+    \brief The QVideoFramePool class recycles the system memory used by video frames.
+    \internal
+
+    Allocating and freeing a buffer for every software video frame is expensive for
+    large frames, both because of the allocator itself and because the kernel has to
+    fault in fresh pages on first touch. QVideoFramePool keeps buffers that are no
+    longer used by any frame around, so that the next frame of the same size can reuse
+    them.
+
+    Buffers are matched by their exact size. When the pool holds more than
+    maximumBytes(), the least recently released buffers are freed first.
+
+    The pool is thread safe.
+*/
+
+/*!
+    Constructs an empty pool.
+
+    The maximum size defaults to 64 MB and can be changed with the
+    \c QT_VIDEO_FRAME_POOL_SIZE environment variable, in megabytes.
+    A value of 0 disables pooling.
+*/
+QVideoFramePool::QVideoFramePool()
+{
+    bool ok = false;
+    const int megabytes = qEnvironmentVariableIntValue("QT_VIDEO_FRAME_POOL_SIZE", &ok);
+    m_maximumBytes = qsizetype(ok ? qMax(megabytes, 0) : 64) * 1024 * 1024;
+}
+
+/*!
+    Destroys the pool and frees all pooled buffers.
+*/
+QVideoFramePool::~QVideoFramePool() = default;
+
+/*!
+    Returns the pool shared by all video frames, or \c nullptr during application
+    shutdown after it has been destroyed.
+*/
+QVideoFramePool *QVideoFramePool::instance()
+{
+    return videoFramePool();
+}
+
+/*!
+    Returns a buffer of \a size bytes. The contents of the buffer are undefined.
+
+    The buffer is taken from the pool if one of the same size is available,
+    otherwise a new one is allocated. Returns a null byte array if the allocation
+    fails.
+*/
+QByteArray QVideoFramePool::acquire(qsizetype size)
+{
+    if (size <= 0)
+        return {};
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (qsizetype i = m_buffers.size() - 1; i >= 0; --i) {
+            if (m_buffers.at(i).size() == size) {
+                QByteArray data = m_buffers.takeAt(i);
+                ++m_statistics.hits;
+                --m_statistics.pooledBuffers;
+                m_statistics.pooledBytes -= size;
+                return data;
+            }
+        }
+        ++m_statistics.misses;
+    }
+
+    QByteArray data;
+    data.resize(size);
+    return data;
+}
+
+/*!
+    Returns \a data to the pool.
+
+    The buffer is freed instead if it is still shared with another byte array or
+    if it alone exceeds maximumBytes().
+*/
+void QVideoFramePool::release(QByteArray &&data)
+{
+    if (data.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (!data.isDetached() || data.size() > m_maximumBytes) {
+        ++m_statistics.discarded;
+        return;
+    }
+
+    ++m_statistics.recycled;
+    ++m_statistics.pooledBuffers;
+    m_statistics.pooledBytes += data.size();
+    m_buffers.append(std::move(data));
+    trimLocked();
+}
+
+namespace {
+
+struct PooledImageData
+{
+    QByteArray data;
+};
+
+void releasePooledImageData(void *info)
+{
+    auto *imageData = static_cast<PooledImageData *>(info);
+    if (auto *pool = QVideoFramePool::instance())
+        pool->release(std::move(imageData->data));
+    delete imageData;
+}
+
+}
+
+/*!
+    Returns an image of the given \a size and \a format whose pixel data is taken
+    from the pool. The data goes back to the pool when the last copy of the image
+    is destroyed. The contents of the image are undefined.
+*/
+QImage QVideoFramePool::acquireImage(const QSize &size, QImage::Format format)
+{
+    if (size.isEmpty() || format == QImage::Format_Invalid)
+        return {};
+
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    // QImage requires 32 bit aligned scan lines
+    const qsizetype bytesPerLine = ((qsizetype(size.width()) * depth + 31) >> 5) << 2;
+
+    auto *imageData = new PooledImageData{ acquire(bytesPerLine * size.height()) };
+    if (imageData->data.isEmpty()) {
+        delete imageData;
+        return {};
+    }
+
+    return QImage(reinterpret_cast<uchar *>(imageData->data.data()), size.width(), size.height(),
+                  bytesPerLine, format, releasePooledImageData, imageData);
+}
+
+/*!
+    Returns the maximum number of bytes kept in the pool.
+*/
+qsizetype QVideoFramePool::maximumBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumBytes;
+}
+
+/*!
+    Sets the maximum number of bytes kept in the pool to \a bytes, freeing the
+    least recently released buffers if the pool is larger than that.
+*/
+void QVideoFramePool::setMaximumBytes(qsizetype bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumBytes = qMax(bytes, qsizetype(0));
+    trimLocked();
+}
+
+/*!
+    Frees all pooled buffers. Buffers in use are not affected.
+*/
+void QVideoFramePool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_buffers.clear();
+    m_statistics.pooledBuffers = 0;
+    m_statistics.pooledBytes = 0;
+}
+
+/*!
+    Returns the hit, miss and recycling counts since the last call to
+    resetStatistics(), together with the current size of the pool.
+*/
+QVideoFramePool::Statistics QVideoFramePool::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+/*!
+    Resets the hit, miss and recycling counts to zero.
+*/
+void QVideoFramePool::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_statistics.hits = 0;
+    m_statistics.misses = 0;
+    m_statistics.recycled = 0;
+    m_statistics.discarded = 0;
+}
+
+void QVideoFramePool::trimLocked()
+{
+    while (m_statistics.pooledBytes > m_maximumBytes) {
+        m_statistics.pooledBytes -= m_buffers.takeFirst().size();
+        --m_statistics.pooledBuffers;
+        ++m_statistics.discarded;
+    }
+}
+
+QT_END_NAMESPACE
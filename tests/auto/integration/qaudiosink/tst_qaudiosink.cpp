@@ -81,6 +81,12 @@ private slots:
     void volume_data();
     void volume();
 
+    void renderCallback_data(){generate_audiofile_testrows();}
+    void renderCallback();
+
+    void pullAfterRenderCallback_data(){generate_audiofile_testrows();}
+    void pullAfterRenderCallback();
+
 private:
     using FilePtr = QSharedPointer<QFile>;
 
@@ -852,6 +858,79 @@ void tst_QAudioSink::volume()
     QTRY_VERIFY(qRound(audioOutput.volume()*10.0f) == expectedInt);
 }
 
+void tst_QAudioSink::renderCallback()
+{
+    QFETCH(QAudioFormat, audioFormat);
+
+    QAudioSink audioOutput(audioFormat, this);
+    audioOutput.setVolume(0.1f);
+
+    // The callback may run on the backend's audio thread
+    QAtomicInt calls = 0;
+    QAtomicInt badSpans = 0;
+    const char silence = audioFormat.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : 0;
+    audioOutput.start([&](QAudioFrameSpan frames) {
+        if (frames.isEmpty() || !frames.data() || frames.format() != audioFormat
+            || frames.byteCount() != frames.frameCount() * audioFormat.bytesPerFrame()) {
+            badSpans.ref();
+            return;
+        }
+        memset(frames.data(), silence, frames.byteCount());
+        calls.ref();
+    });
+
+    QVERIFY2((audioOutput.error() == QAudio::NoError), "error state is not equal to QAudio::NoError after start()");
+    QVERIFY2((audioOutput.state() != QAudio::StoppedState), "didn't start rendering");
+    QTRY_VERIFY2((calls.loadRelaxed() > 2), "render callback was not called");
+    QCOMPARE(badSpans.loadRelaxed(), 0);
+    QTRY_VERIFY2((audioOutput.processedUSecs() > 0), "processedUSecs() is still zero after start()");
+
+    audioOutput.stop();
+    QVERIFY2((audioOutput.state() == QAudio::StoppedState), "didn't transitions to StoppedState after stop()");
+
+    // Nothing may be rendered once stop() returned
+    const int callsAtStop = calls.loadRelaxed();
+    QTest::qWait(100);
+    QCOMPARE(calls.loadRelaxed(), callsAtStop);
+    QCOMPARE(badSpans.loadRelaxed(), 0);
+}
+
+void tst_QAudioSink::pullAfterRenderCallback()
+{
+    QFETCH(FilePtr, audioFile);
+    QFETCH(QAudioFormat, audioFormat);
+
+    QAudioSink audioOutput(audioFormat, this);
+    audioOutput.setVolume(0.1f);
+
+    QAtomicInt calls = 0;
+    const char silence = audioFormat.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : 0;
+    audioOutput.start([&](QAudioFrameSpan frames) {
+        memset(frames.data(), silence, frames.byteCount());
+        calls.ref();
+    });
+    QTRY_VERIFY2((calls.loadRelaxed() > 0), "render callback was not called");
+
+    // Switching to pull mode without a stop() in between drops the callback
+    audioFile->close();
+    audioFile->open(QIODevice::ReadOnly);
+    audioFile->seek(QWaveDecoder::headerLength());
+
+    audioOutput.start(audioFile.data());
+    const int callsAtRestart = calls.loadRelaxed();
+
+    QVERIFY2((audioOutput.error() == QAudio::NoError), "error state is not equal to QAudio::NoError after start()");
+    QVERIFY2((audioOutput.state() == QAudio::ActiveState), "didn't transition to ActiveState after start()");
+
+    QTRY_VERIFY2(audioFile->atEnd(), "didn't play to EOF");
+    QTRY_VERIFY2((audioOutput.state() == QAudio::IdleState), "didn't transitions to IdleState when at EOF");
+    QCOMPARE(calls.loadRelaxed(), callsAtRestart);
+    QCOMPARE(audioOutput.processedUSecs(), 1000000);
+
+    audioOutput.stop();
+    audioFile->close();
+}
+
 QTEST_MAIN(tst_QAudioSink)
 
 #include "tst_qaudiosink.moc"
@@ -86,6 +86,12 @@ private slots:
     void volume_data(){generate_audiofile_testrows();}
     void volume();
 
+    void captureCallback_data(){generate_audiofile_testrows();}
+    void captureCallback();
+
+    void pullAfterCaptureCallback_data(){generate_audiofile_testrows();}
+    void pullAfterCaptureCallback();
+
 private:
     using FilePtr = QSharedPointer<QFile>;
 
@@ -764,6 +770,69 @@ void tst_QAudioSource::volume()
     audioInput.setVolume(volume);
 }
 
+void tst_QAudioSource::captureCallback()
+{
+    QFETCH(QAudioFormat, audioFormat);
+
+    QAudioSource audioInput(audioFormat, this);
+    audioInput.setVolume(0.5f);
+
+    // The callback may run on the backend's audio thread
+    QAtomicInt calls = 0;
+    QAtomicInt badSpans = 0;
+    QAtomicInteger<qint64> frameCount = 0;
+    audioInput.start([&](QAudioFrameSpan frames) {
+        if (frames.isEmpty() || !frames.data() || frames.format() != audioFormat
+            || frames.byteCount() != frames.frameCount() * audioFormat.bytesPerFrame()) {
+            badSpans.ref();
+            return;
+        }
+        frameCount.fetchAndAddRelaxed(frames.frameCount());
+        calls.ref();
+    });
+
+    QVERIFY2((audioInput.error() == QAudio::NoError), "error state is not equal to QAudio::NoError after start()");
+    QVERIFY2((audioInput.state() != QAudio::StoppedState), "didn't start capturing");
+    QTRY_VERIFY2((calls.loadRelaxed() > 2), "capture callback was not called");
+    QCOMPARE(badSpans.loadRelaxed(), 0);
+
+    audioInput.stop();
+    QVERIFY2((audioInput.state() == QAudio::StoppedState), "didn't transitions to StoppedState after stop()");
+    QVERIFY(frameCount.loadRelaxed() > 0);
+
+    // Nothing may be delivered once stop() returned
+    const int callsAtStop = calls.loadRelaxed();
+    QTest::qWait(100);
+    QCOMPARE(calls.loadRelaxed(), callsAtStop);
+    QCOMPARE(badSpans.loadRelaxed(), 0);
+}
+
+void tst_QAudioSource::pullAfterCaptureCallback()
+{
+    QFETCH(QAudioFormat, audioFormat);
+
+    QAudioSource audioInput(audioFormat, this);
+
+    QAtomicInt calls = 0;
+    audioInput.start([&](QAudioFrameSpan) { calls.ref(); });
+    QTRY_VERIFY2((calls.loadRelaxed() > 0), "capture callback was not called");
+
+    // Switching to pull mode without a stop() in between drops the callback
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    audioInput.start(&buffer);
+    const int callsAtRestart = calls.loadRelaxed();
+
+    QVERIFY2((audioInput.error() == QAudio::NoError), "error state is not equal to QAudio::NoError after start()");
+    QVERIFY2((audioInput.state() == QAudio::ActiveState || audioInput.state() == QAudio::IdleState),
+             "didn't transition to ActiveState or IdleState after start()");
+    QTRY_VERIFY2((buffer.size() > 0), "nothing was captured into the device");
+    QCOMPARE(buffer.size() % audioFormat.bytesPerFrame(), 0);
+    QCOMPARE(calls.loadRelaxed(), callsAtRestart);
+
+    audioInput.stop();
+}
+
 QTEST_MAIN(tst_QAudioSource)
 
 #include "tst_qaudiosource.moc"
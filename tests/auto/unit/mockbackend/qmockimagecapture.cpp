@@ -43,13 +43,19 @@ bool QMockImageCapture::isReadyForCapture() const
 }
 
 int QMockImageCapture::capture(const QString &fileName)
+{
+    return captureBurst(1, fileName);
+}
+
+int QMockImageCapture::captureBurst(int count, const QString &fileName)
 {
     if (isReadyForCapture()) {
         m_fileName = fileName;
-        m_captureRequest++;
+        m_burstCount = count;
+        m_captureRequest += count;
         emit readyForCaptureChanged(m_ready = false);
         QTimer::singleShot(5, this, SLOT(captured()));
-        return m_captureRequest;
+        return m_captureRequest - count + 1;
     } else {
         emit error(-1, QImageCapture::NotReadyError,
                    QLatin1String("Could not capture in stopped state"));
@@ -60,19 +66,22 @@ int QMockImageCapture::capture(const QString &fileName)
 
 void QMockImageCapture::captured()
 {
-    emit imageCaptured(m_captureRequest, QImage());
+    const bool wasReady = m_ready;
+    for (int id = m_captureRequest - m_burstCount + 1; id <= m_captureRequest; ++id) {
+        emit imageCaptured(id, QImage());
 
-    QMediaMetaData metaData;
-    metaData.insert(QMediaMetaData::Author, QString::fromUtf8("Author"));
-    metaData.insert(QMediaMetaData::Date, QDateTime(QDate(2021, 1, 1), QTime()));
+        QMediaMetaData metaData;
+        metaData.insert(QMediaMetaData::Author, QString::fromUtf8("Author"));
+        metaData.insert(QMediaMetaData::Date, QDateTime(QDate(2021, 1, 1), QTime()));
 
-    emit imageMetadataAvailable(m_captureRequest, metaData);
+        emit imageMetadataAvailable(id, metaData);
 
-    if (!m_ready)
-    {
-        emit readyForCaptureChanged(m_ready = true);
-        emit imageExposed(m_captureRequest);
-    }
+        if (!wasReady) {
+            if (id == m_captureRequest)
+                emit readyForCaptureChanged(m_ready = true);
+            emit imageExposed(id);
+        }
 
-    emit imageSaved(m_captureRequest, m_fileName);
+        emit imageSaved(id, m_fileName);
+    }
 }
@@ -30,6 +30,23 @@
 #include <QtTest/QtTest>
 
 #include <qaudiobuffer.h>
+#include <private/qabstractaudiobuffer_p.h>
+
+// Samples owned by someone else, counting when they are released
+class ExternalAudioBuffer : public QAbstractAudioBuffer
+{
+public:
+    ExternalAudioBuffer(const QByteArray &samples, int *released)
+        : m_samples(samples), m_released(released) {}
+    ~ExternalAudioBuffer() override { ++*m_released; }
+
+    const void *constData() const override { return m_samples.constData(); }
+    qsizetype byteCount() const override { return m_samples.size(); }
+
+private:
+    const QByteArray m_samples;
+    int *m_released;
+};
 
 class tst_QAudioBuffer : public QObject
 {
@@ -48,6 +65,8 @@ private Q_SLOTS:
     void durations();
     void durations_data();
     void stereoSample();
+    void externalBuffer();
+    void externalBufferWrite();
 
 private:
     QAudioFormat mFormat;
@@ -333,6 +352,58 @@ void tst_QAudioBuffer::stereoSample()
     QCOMPARE(f32s[QAudioFormat::FrontRight], 0.0f);
 }
 
+void tst_QAudioBuffer::externalBuffer()
+{
+    int released = 0;
+    const QByteArray samples(400, char(0x10));
+    {
+        QAudioBuffer buffer(new ExternalAudioBuffer(samples, &released), mFormat, 1000);
+        QVERIFY(buffer.isValid());
+        QCOMPARE(buffer.byteCount(), 400);
+        QCOMPARE(buffer.frameCount(), 100);
+        QCOMPARE(buffer.startTime(), 1000);
+
+        // no copy is made
+        QCOMPARE(buffer.constData<char>(), samples.constData());
+
+        QAudioBuffer copy = buffer;
+        buffer = QAudioBuffer();
+        QCOMPARE(released, 0);
+        QCOMPARE(copy.constData<char>(), samples.constData());
+
+        // detaching copies the samples, but the original stays alive for the other copies
+        QAudioBuffer detached = copy;
+        detached.detach();
+        QVERIFY(detached.constData<char>() != samples.constData());
+        QCOMPARE(QByteArray(detached.constData<char>(), detached.byteCount()), samples);
+        QCOMPARE(released, 0);
+    }
+    // released with the last reference
+    QCOMPARE(released, 1);
+
+    // empty buffers are rejected, and released right away
+    QAudioBuffer empty(new ExternalAudioBuffer(QByteArray(), &released), mFormat);
+    QVERIFY(!empty.isValid());
+    QCOMPARE(released, 2);
+}
+
+void tst_QAudioBuffer::externalBufferWrite()
+{
+    int released = 0;
+    const QByteArray samples(400, char(0x10));
+    QAudioBuffer buffer(new ExternalAudioBuffer(samples, &released), mFormat);
+    const char *before = buffer.constData<char>();
+
+    // writing goes to a copy, the external samples are read only
+    char *data = buffer.data<char>();
+    QVERIFY(data != samples.constData());
+    data[0] = 0x20;
+    QCOMPARE(buffer.constData<char>()[0], char(0x20));
+    QCOMPARE(samples.at(0), char(0x10));
+    QCOMPARE(before[0], char(0x10));
+    QCOMPARE(buffer.byteCount(), 400);
+    QCOMPARE(released, 0);
+}
 
 QTEST_APPLESS_MAIN(tst_QAudioBuffer);
 
@@ -0,0 +1,353 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+
+#include <qaudiobuffer.h>
+#include <qaudioformat.h>
+#include <private/qaudioconverter_p.h>
+
+#include <cmath>
+
+class tst_QAudioConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void passthrough();
+    void sampleFormats_data();
+    void sampleFormats();
+    void int16RoundTrip();
+    void channelMatrix_data();
+    void channelMatrix();
+    void mixChannels();
+    void resample_data();
+    void resample();
+    void removesAliases();
+    void streaming();
+    void audioBuffer();
+
+private:
+    static QAudioFormat format(QAudioFormat::SampleFormat sampleFormat, int channels, int rate);
+    static QByteArray sine(const QAudioFormat &format, double frequency, double amplitude, int frames);
+    static double maximumError(const QByteArray &floats, int channels, int channel, double frequency,
+                               double amplitude, int rate, int margin);
+};
+
+QAudioFormat tst_QAudioConverter::format(QAudioFormat::SampleFormat sampleFormat, int channels,
+                                         int rate)
+{
+    QAudioFormat f;
+    f.setSampleFormat(sampleFormat);
+    f.setChannelCount(channels);
+    f.setSampleRate(rate);
+    return f;
+}
+
+// A sine on all channels, as floats
+QByteArray tst_QAudioConverter::sine(const QAudioFormat &format, double frequency, double amplitude,
+                                     int frames)
+{
+    QByteArray data(frames * format.channelCount() * sizeof(float), Qt::Uninitialized);
+    float *samples = reinterpret_cast<float *>(data.data());
+    for (int i = 0; i < frames; ++i) {
+        const float v = float(amplitude * std::sin(2 * M_PI * frequency * i / format.sampleRate()));
+        for (int c = 0; c < format.channelCount(); ++c)
+            *samples++ = v;
+    }
+    return data;
+}
+
+double tst_QAudioConverter::maximumError(const QByteArray &floats, int channels, int channel,
+                                         double frequency, double amplitude, int rate, int margin)
+{
+    const float *samples = reinterpret_cast<const float *>(floats.constData());
+    const int frames = int(floats.size() / sizeof(float) / channels);
+    double error = 0.;
+    for (int i = margin; i < frames - margin; ++i) {
+        const double expected = amplitude * std::sin(2 * M_PI * frequency * i / rate);
+        error = qMax(error, qAbs(samples[i * channels + channel] - expected));
+    }
+    return error;
+}
+
+void tst_QAudioConverter::passthrough()
+{
+    const QAudioFormat f = format(QAudioFormat::Int16, 2, 44100);
+    QAudioConverter converter(f, f);
+    QVERIFY(converter.isValid());
+    QVERIFY(converter.isPassthrough());
+
+    const QByteArray data("\x01\x02\x03\x04\x05\x06\x07\x08", 8);
+    QCOMPARE(converter.convert(data), data);
+    QCOMPARE(converter.flush(), QByteArray());
+
+    QVERIFY(!QAudioConverter(f, format(QAudioFormat::Float, 2, 44100)).isPassthrough());
+    QVERIFY(!QAudioConverter(f, format(QAudioFormat::Int16, 1, 44100)).isPassthrough());
+    QVERIFY(!QAudioConverter(f, format(QAudioFormat::Int16, 2, 48000)).isPassthrough());
+    QVERIFY(!QAudioConverter(f, QAudioFormat()).isValid());
+}
+
+void tst_QAudioConverter::sampleFormats_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+    QTest::addColumn<QByteArray>("samples");
+    QTest::addColumn<QList<float>>("floats");
+
+    const quint8 uint8[] = { 0x00, 0x40, 0x80, 0xc0, 0xff };
+    QTest::newRow("uint8") << QAudioFormat::UInt8
+                           << QByteArray(reinterpret_cast<const char *>(uint8), sizeof(uint8))
+                           << QList<float>{ -1.f, -0.5f, 0.f, 0.5f, 127.f / 128 };
+    const qint16 int16[] = { -32768, -16384, 0, 16384, 32767 };
+    QTest::newRow("int16") << QAudioFormat::Int16
+                           << QByteArray(reinterpret_cast<const char *>(int16), sizeof(int16))
+                           << QList<float>{ -1.f, -0.5f, 0.f, 0.5f, 32767.f / 32768 };
+    const qint32 int32[] = { std::numeric_limits<qint32>::min(), -0x40000000, 0, 0x40000000 };
+    QTest::newRow("int32") << QAudioFormat::Int32
+                           << QByteArray(reinterpret_cast<const char *>(int32), sizeof(int32))
+                           << QList<float>{ -1.f, -0.5f, 0.f, 0.5f };
+}
+
+void tst_QAudioConverter::sampleFormats()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+    QFETCH(QByteArray, samples);
+    QFETCH(QList<float>, floats);
+
+    const QAudioFormat in = format(sampleFormat, 1, 8000);
+    const QAudioFormat out = format(QAudioFormat::Float, 1, 8000);
+
+    const QByteArray converted = QAudioConverter::convert(samples, in, out);
+    QCOMPARE(converted.size(), floats.size() * qsizetype(sizeof(float)));
+    const float *values = reinterpret_cast<const float *>(converted.constData());
+    for (int i = 0; i < floats.size(); ++i)
+        QCOMPARE(values[i], floats.at(i));
+
+    // and back, exactly
+    QCOMPARE(QAudioConverter::convert(converted, out, in), samples);
+}
+
+void tst_QAudioConverter::int16RoundTrip()
+{
+    // every 16 bit value survives the trip through float, also in the vectorized code
+    QList<qint16> samples(0x10000 + 3);
+    for (int i = 0; i < samples.size(); ++i)
+        samples[i] = qint16(i);
+    const QByteArray data(reinterpret_cast<const char *>(samples.constData()),
+                          samples.size() * sizeof(qint16));
+
+    const QAudioFormat in = format(QAudioFormat::Int16, 1, 48000);
+    const QAudioFormat out = format(QAudioFormat::Float, 1, 48000);
+    QCOMPARE(QAudioConverter::convert(QAudioConverter::convert(data, in, out), out, in), data);
+
+    // out of range floats saturate
+    const float loud[] = { 2.f, -2.f, 1.f, -1.f };
+    const QByteArray clipped = QAudioConverter::convert(
+            QByteArray(reinterpret_cast<const char *>(loud), sizeof(loud)), out, in);
+    const qint16 *values = reinterpret_cast<const qint16 *>(clipped.constData());
+    QCOMPARE(values[0], qint16(32767));
+    QCOMPARE(values[1], qint16(-32768));
+    QCOMPARE(values[2], qint16(32767));
+    QCOMPARE(values[3], qint16(-32768));
+}
+
+void tst_QAudioConverter::channelMatrix_data()
+{
+    QTest::addColumn<int>("inChannels");
+    QTest::addColumn<int>("outChannels");
+    QTest::addColumn<QList<float>>("matrix");
+
+    constexpr float h = 0.5f;
+    QTest::newRow("mono to stereo") << 1 << 2 << QList<float>{ 1, 1 };
+    QTest::newRow("stereo to mono") << 2 << 1 << QList<float>{ h, h };
+    QTest::newRow("stereo to 5.1") << 2 << 6 << QList<float>{ 1, 0,
+                                                               0, 1,
+                                                               0, 0,
+                                                               0, 0,
+                                                               0, 0,
+                                                               0, 0 };
+    QTest::newRow("mono to 5.1") << 1 << 6 << QList<float>{ 0, 0, 1, 0, 0, 0 };
+    QTest::newRow("unknown layout") << 4 << 2 << QList<float>{ 1, 0, 0, 0,
+                                                               0, 1, 0, 0 };
+}
+
+void tst_QAudioConverter::channelMatrix()
+{
+    QFETCH(int, inChannels);
+    QFETCH(int, outChannels);
+    QFETCH(QList<float>, matrix);
+
+    const QList<float> actual = QAudioConverter::channelMatrix(
+            format(QAudioFormat::Float, inChannels, 48000),
+            format(QAudioFormat::Float, outChannels, 48000));
+    QCOMPARE(actual, matrix);
+}
+
+void tst_QAudioConverter::mixChannels()
+{
+    // 5.1 to stereo: center and surround are folded into the front channels,
+    // LFE is dropped, and nothing can clip
+    const QList<float> matrix = QAudioConverter::channelMatrix(
+            format(QAudioFormat::Float, 6, 48000), format(QAudioFormat::Float, 2, 48000));
+    QCOMPARE(matrix.size(), 12);
+    for (int o = 0; o < 2; ++o) {
+        float sum = 0.f;
+        for (int i = 0; i < 6; ++i)
+            sum += matrix.at(o * 6 + i);
+        QVERIFY(sum <= 1.f + 1e-6f);
+    }
+    // FL FR FC LFE BL BR
+    QVERIFY(matrix.at(0) > 0.f);
+    QCOMPARE(matrix.at(1), 0.f);
+    QVERIFY(matrix.at(2) > 0.f);
+    QCOMPARE(matrix.at(3), 0.f);
+    QVERIFY(matrix.at(4) > 0.f);
+    QCOMPARE(matrix.at(5), 0.f);
+    QCOMPARE(matrix.at(6 + 2), matrix.at(2));
+
+    // an explicit channel config is honoured
+    QAudioFormat in = format(QAudioFormat::Int16, 2, 48000);
+    in.setChannelConfig(QAudioFormat::channelConfig(QAudioFormat::FrontCenter, QAudioFormat::LFE));
+    const QList<float> centerToStereo = QAudioConverter::channelMatrix(
+            in, format(QAudioFormat::Int16, 2, 48000));
+    QCOMPARE(centerToStereo.at(1), 0.f);
+    QCOMPARE(centerToStereo.at(3), 0.f);
+    QCOMPARE(centerToStereo.at(0), centerToStereo.at(2));
+
+    const qint16 stereo[] = { 1000, 3000, -2000, 2000 };
+    const QByteArray mono = QAudioConverter::convert(
+            QByteArray(reinterpret_cast<const char *>(stereo), sizeof(stereo)),
+            format(QAudioFormat::Int16, 2, 48000), format(QAudioFormat::Int16, 1, 48000));
+    QCOMPARE(mono.size(), 4);
+    QCOMPARE(reinterpret_cast<const qint16 *>(mono.constData())[0], qint16(2000));
+    QCOMPARE(reinterpret_cast<const qint16 *>(mono.constData())[1], qint16(0));
+}
+
+void tst_QAudioConverter::resample_data()
+{
+    QTest::addColumn<int>("inRate");
+    QTest::addColumn<int>("outRate");
+    QTest::addColumn<double>("frequency");
+
+    QTest::newRow("44100 to 48000") << 44100 << 48000 << 1000.;
+    QTest::newRow("48000 to 44100") << 48000 << 44100 << 1000.;
+    QTest::newRow("8000 to 48000") << 8000 << 48000 << 440.;
+    QTest::newRow("48000 to 16000") << 48000 << 16000 << 3000.;
+    QTest::newRow("high treble") << 44100 << 48000 << 15000.;
+    QTest::newRow("many phases") << 44100 << 47999 << 1000.;
+}
+
+void tst_QAudioConverter::resample()
+{
+    QFETCH(int, inRate);
+    QFETCH(int, outRate);
+    QFETCH(double, frequency);
+
+    const QAudioFormat in = format(QAudioFormat::Float, 2, inRate);
+    const QAudioFormat out = format(QAudioFormat::Float, 2, outRate);
+
+    const QByteArray input = sine(in, frequency, 0.5, inRate);
+    const QByteArray output = QAudioConverter::convert(input, in, out);
+
+    // one second in, one second out, and still the same sine
+    QCOMPARE(output.size(), qsizetype(outRate * out.bytesPerFrame()));
+    QVERIFY(maximumError(output, 2, 0, frequency, 0.5, outRate, 200) < 1e-3);
+    QVERIFY(maximumError(output, 2, 1, frequency, 0.5, outRate, 200) < 1e-3);
+}
+
+void tst_QAudioConverter::removesAliases()
+{
+    // 5 kHz can't be represented at 8 kHz and must be filtered out
+    const QAudioFormat in = format(QAudioFormat::Float, 1, 48000);
+    const QAudioFormat out = format(QAudioFormat::Float, 1, 8000);
+
+    QByteArray input = sine(in, 5000, 0.5, 48000);
+    const QByteArray tone = sine(in, 440, 0.25, 48000);
+    float *samples = reinterpret_cast<float *>(input.data());
+    for (int i = 0; i < 48000; ++i)
+        samples[i] += reinterpret_cast<const float *>(tone.constData())[i];
+
+    const QByteArray output = QAudioConverter::convert(input, in, out);
+    QCOMPARE(output.size(), qsizetype(8000 * sizeof(float)));
+    QVERIFY(maximumError(output, 1, 0, 440, 0.25, 8000, 200) < 1e-3);
+}
+
+void tst_QAudioConverter::streaming()
+{
+    const QAudioFormat in = format(QAudioFormat::Int16, 2, 22050);
+    const QAudioFormat out = format(QAudioFormat::Float, 1, 48000);
+
+    const QByteArray floats = sine(format(QAudioFormat::Float, 2, 22050), 440, 0.5, 22050);
+    const QByteArray input = QAudioConverter::convert(floats, format(QAudioFormat::Float, 2, 22050), in);
+    const QByteArray oneShot = QAudioConverter::convert(input, in, out);
+
+    // feeding the input in odd sized pieces gives the same result
+    QAudioConverter converter(in, out);
+    QByteArray streamed;
+    const int pieces[] = { 1, 7, 100, 3000, 5 };
+    qsizetype offset = 0;
+    for (int i = 0; offset < input.size(); ++i) {
+        const qsizetype bytes = qMin(qsizetype(pieces[i % 5] * in.bytesPerFrame()),
+                                     input.size() - offset);
+        const qsizetype maximumFrames = converter.maximumOutputFrames(bytes / in.bytesPerFrame());
+        const QByteArray converted = converter.convert(QByteArrayView(input.constData() + offset, bytes));
+        QVERIFY(converted.size() / out.bytesPerFrame() <= maximumFrames);
+        streamed += converted;
+        offset += bytes;
+    }
+    streamed += converter.flush();
+    QCOMPARE(streamed, oneShot);
+}
+
+void tst_QAudioConverter::audioBuffer()
+{
+    const QAudioFormat in = format(QAudioFormat::Int16, 1, 24000);
+    const QAudioFormat out = format(QAudioFormat::Int16, 1, 48000);
+    QAudioConverter converter(in, out);
+
+    const QAudioBuffer first(QByteArray(2400 * 2, 0), in, 1000000);
+    const QAudioBuffer converted = converter.convert(first);
+    QVERIFY(converted.isValid());
+    QCOMPARE(converted.format(), out);
+    QCOMPARE(converted.startTime(), 1000000);
+    QVERIFY(converted.frameCount() > 0);
+
+    // the next buffer starts right after the output produced so far
+    const QAudioBuffer second = converter.convert(QAudioBuffer(QByteArray(2400 * 2, 0), in, 1100000));
+    QCOMPARE(second.startTime(), 1000000 + out.durationForFrames(converted.frameCount()));
+
+    // buffers in the wrong format are rejected
+    QVERIFY(!converter.convert(QAudioBuffer(QByteArray(4, 0), out)).isValid());
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioConverter)
+
+#include "tst_qaudioconverter.moc"
@@ -0,0 +1,250 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+
+#include <qaudioformat.h>
+#include <private/qaudiohelpers_p.h>
+
+#include <algorithm>
+#include <limits>
+
+class tst_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplySamples_data();
+    void multiplySamples();
+    void saturation();
+    void unityGainCopies();
+    void ramp();
+    void benchmarkMultiplySamples_data();
+    void benchmarkMultiplySamples();
+
+private:
+    static QAudioFormat format(QAudioFormat::SampleFormat sampleFormat, int channels = 1);
+    static QByteArray noise(QAudioFormat::SampleFormat sampleFormat, int samples);
+    static double sample(QAudioFormat::SampleFormat sampleFormat, const QByteArray &data, int i);
+};
+
+QAudioFormat tst_QAudioHelpers::format(QAudioFormat::SampleFormat sampleFormat, int channels)
+{
+    QAudioFormat f;
+    f.setSampleRate(48000);
+    f.setChannelCount(channels);
+    f.setSampleFormat(sampleFormat);
+    return f;
+}
+
+QByteArray tst_QAudioHelpers::noise(QAudioFormat::SampleFormat sampleFormat, int samples)
+{
+    QAudioFormat f = format(sampleFormat);
+    QByteArray data(samples * f.bytesPerSample(), Qt::Uninitialized);
+    QRandomGenerator rng(42);
+    for (int i = 0; i < samples; ++i) {
+        const quint32 r = rng.generate();
+        switch (sampleFormat) {
+        case QAudioFormat::UInt8:
+            reinterpret_cast<quint8 *>(data.data())[i] = quint8(r);
+            break;
+        case QAudioFormat::Int16:
+            reinterpret_cast<qint16 *>(data.data())[i] = qint16(r);
+            break;
+        case QAudioFormat::Int32:
+            reinterpret_cast<qint32 *>(data.data())[i] = qint32(r);
+            break;
+        case QAudioFormat::Float:
+            reinterpret_cast<float *>(data.data())[i] = float(rng.generateDouble() * 2. - 1.);
+            break;
+        default:
+            break;
+        }
+    }
+    // make sure the extremes are covered
+    if (samples >= 2 && sampleFormat == QAudioFormat::Int16) {
+        reinterpret_cast<qint16 *>(data.data())[0] = std::numeric_limits<qint16>::min();
+        reinterpret_cast<qint16 *>(data.data())[1] = std::numeric_limits<qint16>::max();
+    } else if (samples >= 2 && sampleFormat == QAudioFormat::Int32) {
+        reinterpret_cast<qint32 *>(data.data())[0] = std::numeric_limits<qint32>::min();
+        reinterpret_cast<qint32 *>(data.data())[1] = std::numeric_limits<qint32>::max();
+    }
+    return data;
+}
+
+double tst_QAudioHelpers::sample(QAudioFormat::SampleFormat sampleFormat, const QByteArray &data, int i)
+{
+    switch (sampleFormat) {
+    case QAudioFormat::UInt8:
+        return int(reinterpret_cast<const quint8 *>(data.constData())[i]) - 0x80;
+    case QAudioFormat::Int16:
+        return reinterpret_cast<const qint16 *>(data.constData())[i];
+    case QAudioFormat::Int32:
+        return reinterpret_cast<const qint32 *>(data.constData())[i];
+    case QAudioFormat::Float:
+        return reinterpret_cast<const float *>(data.constData())[i];
+    default:
+        return 0;
+    }
+}
+
+void tst_QAudioHelpers::multiplySamples_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+    QTest::addColumn<qreal>("factor");
+    QTest::addColumn<double>("tolerance");
+
+    for (qreal factor : { 0., 0.001, 0.25, 0.5, 0.7071, 0.999 }) {
+        const QByteArray f = QByteArray::number(factor);
+        QTest::newRow("uint8 " + f) << QAudioFormat::UInt8 << factor << 1.;
+        QTest::newRow("int16 " + f) << QAudioFormat::Int16 << factor << 1.;
+        QTest::newRow("int32 " + f) << QAudioFormat::Int32 << factor << 1.;
+        QTest::newRow("float " + f) << QAudioFormat::Float << factor << 1e-6;
+    }
+}
+
+void tst_QAudioHelpers::multiplySamples()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+    QFETCH(qreal, factor);
+    QFETCH(double, tolerance);
+
+    // odd length to exercise the tails of the vectorized loops
+    const int samples = 1031;
+    const QByteArray input = noise(sampleFormat, samples);
+    QByteArray output(input.size(), 0);
+
+    QAudioHelperInternal::qMultiplySamples(factor, format(sampleFormat), input.constData(),
+                                           output.data(), input.size());
+
+    // the fixed point gain is quantized, allow for that on top of rounding
+    const double quantization = sampleFormat == QAudioFormat::Float ? 0 : 1. / 0x8000;
+    for (int i = 0; i < samples; ++i) {
+        const double in = sample(sampleFormat, input, i);
+        const double expected = in * factor;
+        const double actual = sample(sampleFormat, output, i);
+        QVERIFY2(qAbs(actual - expected) <= tolerance + qAbs(in) * quantization,
+                 qPrintable(QStringLiteral("sample %1: %2 * %3 gave %4")
+                                    .arg(i).arg(in).arg(factor).arg(actual)));
+    }
+
+    // in place operation gives the same result
+    QByteArray inPlace = input;
+    QAudioHelperInternal::qMultiplySamples(factor, format(sampleFormat), inPlace.constData(),
+                                           inPlace.data(), inPlace.size());
+    QCOMPARE(inPlace, output);
+}
+
+void tst_QAudioHelpers::saturation()
+{
+    const qint16 input[] = { 20000, -20000, 100, -32768 };
+    qint16 output[4];
+    QAudioHelperInternal::qMultiplySamples(2., format(QAudioFormat::Int16), input, output,
+                                           sizeof(input));
+    QCOMPARE(output[0], qint16(32767));
+    QCOMPARE(output[1], qint16(-32768));
+    QCOMPARE(output[2], qint16(200));
+    QCOMPARE(output[3], qint16(-32768));
+
+    const quint8 input8[] = { 0xf0, 0x10, 0x81 };
+    quint8 output8[3];
+    QAudioHelperInternal::qMultiplySamples(4., format(QAudioFormat::UInt8), input8, output8,
+                                           sizeof(input8));
+    QCOMPARE(output8[0], quint8(0xff));
+    QCOMPARE(output8[1], quint8(0x00));
+    QCOMPARE(output8[2], quint8(0x84));
+}
+
+void tst_QAudioHelpers::unityGainCopies()
+{
+    const QByteArray input = noise(QAudioFormat::Int32, 100);
+    QByteArray output(input.size(), 0);
+    QAudioHelperInternal::qMultiplySamples(1., format(QAudioFormat::Int32), input.constData(),
+                                           output.data(), input.size());
+    QCOMPARE(output, input);
+}
+
+void tst_QAudioHelpers::ramp()
+{
+    // stereo, 1000 frames of constant full scale input
+    const QAudioFormat f = format(QAudioFormat::Int16, 2);
+    const int frames = 1000;
+    QList<qint16> input(frames * 2, 16384);
+    QList<qint16> output(frames * 2, 0);
+
+    QAudioHelperInternal::qMultiplySamples(0., 1., f, input.constData(), output.data(),
+                                           frames * f.bytesPerFrame());
+
+    // both channels get the same gain, and the gain never decreases
+    for (int i = 0; i < frames; ++i) {
+        QCOMPARE(output.at(2 * i), output.at(2 * i + 1));
+        if (i > 0)
+            QVERIFY(output.at(2 * i) >= output.at(2 * i - 2));
+    }
+    // never jumps by more than one block worth of gain
+    QVERIFY(output.first() < 16384 / 16);
+    QCOMPARE(output.last(), qint16(16384));
+
+    // a ramp between equal factors is a constant gain
+    QList<qint16> constant(frames * 2, 0);
+    QAudioHelperInternal::qMultiplySamples(0.5, 0.5, f, input.constData(), constant.data(),
+                                           frames * f.bytesPerFrame());
+    QVERIFY(std::all_of(constant.cbegin(), constant.cend(), [](qint16 s) { return s == 8192; }));
+}
+
+void tst_QAudioHelpers::benchmarkMultiplySamples_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+
+    QTest::newRow("uint8") << QAudioFormat::UInt8;
+    QTest::newRow("int16") << QAudioFormat::Int16;
+    QTest::newRow("int32") << QAudioFormat::Int32;
+    QTest::newRow("float") << QAudioFormat::Float;
+}
+
+void tst_QAudioHelpers::benchmarkMultiplySamples()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+
+    // one second of stereo audio
+    const QByteArray input = noise(sampleFormat, 2 * 48000);
+    QByteArray output(input.size(), 0);
+    const QAudioFormat f = format(sampleFormat, 2);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qMultiplySamples(0.5, f, input.constData(), output.data(),
+                                               input.size());
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioHelpers)
+
+#include "tst_qaudiohelpers.moc"
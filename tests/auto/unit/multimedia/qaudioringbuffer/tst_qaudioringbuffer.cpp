@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qthread.h>
+
+#include <private/qaudioringbuffer_p.h>
+
+class tst_QAudioRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyAndFull();
+    void wrapAround();
+    void regions();
+    void concurrentTransfer();
+};
+
+void tst_QAudioRingBuffer::emptyAndFull()
+{
+    QAudioRingBuffer ring(8);
+    QVERIFY(ring.isEmpty());
+    QCOMPARE(ring.free(), 8);
+
+    QCOMPARE(ring.write("abcdefghij", 10), 8);
+    QCOMPARE(ring.used(), 8);
+    QCOMPARE(ring.free(), 0);
+    QCOMPARE(ring.write("x", 1), 0);
+
+    char data[10] = {};
+    QCOMPARE(ring.read(data, 10), 8);
+    QCOMPARE(QByteArray(data, 8), QByteArray("abcdefgh"));
+    QVERIFY(ring.isEmpty());
+    QCOMPARE(ring.read(data, 1), 0);
+}
+
+void tst_QAudioRingBuffer::wrapAround()
+{
+    QAudioRingBuffer ring(5);
+    char data[5] = {};
+    for (int i = 0; i < 20; ++i) {
+        const QByteArray in = QByteArray::number(100 + i);
+        QCOMPARE(ring.write(in.constData(), in.size()), 3);
+        QCOMPARE(ring.read(data, 5), 3);
+        QCOMPARE(QByteArray(data, 3), in);
+    }
+
+    ring.clear();
+    QVERIFY(ring.isEmpty());
+    QCOMPARE(ring.free(), 5);
+}
+
+void tst_QAudioRingBuffer::regions()
+{
+    QAudioRingBuffer ring(6);
+    QCOMPARE(ring.write("abcd", 4), 4);
+    char data[4];
+    QCOMPARE(ring.read(data, 3), 3);
+
+    // Free space is split at the end of the storage
+    QAudioRingBuffer::Region region = ring.writeRegion();
+    QCOMPARE(region.size, 2);
+    memcpy(region.data, "ef", 2);
+    ring.commit(2);
+    region = ring.writeRegion();
+    QCOMPARE(region.size, 3);
+    memcpy(region.data, "ghi", 3);
+    ring.commit(3);
+    QCOMPARE(ring.free(), 0);
+
+    region = ring.readRegion();
+    QCOMPARE(QByteArray(region.data, region.size), QByteArray("def"));
+    ring.consume(region.size);
+    region = ring.readRegion();
+    QCOMPARE(QByteArray(region.data, region.size), QByteArray("ghi"));
+    ring.consume(region.size);
+    QVERIFY(ring.isEmpty());
+}
+
+void tst_QAudioRingBuffer::concurrentTransfer()
+{
+    QAudioRingBuffer ring(1000);
+    constexpr qsizetype total = 4 * 1024 * 1024;
+
+    QScopedPointer<QThread> producer(QThread::create([&ring] {
+        char chunk[333];
+        qsizetype written = 0;
+        while (written < total) {
+            const qsizetype n = qMin<qsizetype>(sizeof(chunk), total - written);
+            for (qsizetype i = 0; i < n; ++i)
+                chunk[i] = char((written + i) % 251);
+            qsizetype done = 0;
+            while (done < n)
+                done += ring.write(chunk + done, n - done);
+            written += n;
+        }
+    }));
+    producer->start();
+
+    qsizetype read = 0;
+    bool ok = true;
+    while (read < total) {
+        const QAudioRingBuffer::Region region = ring.readRegion();
+        for (qsizetype i = 0; i < region.size; ++i)
+            ok &= region.data[i] == char((read + i) % 251);
+        ring.consume(region.size);
+        read += region.size;
+    }
+    producer->wait();
+
+    QVERIFY(ok);
+    QVERIFY(ring.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_QAudioRingBuffer)
+
+#include "tst_qaudioringbuffer.moc"
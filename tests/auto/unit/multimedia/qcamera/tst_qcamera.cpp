@@ -33,6 +33,7 @@
 
 #include <qvideosink.h>
 #include <private/qplatformcamera_p.h>
+#include <private/qcameradevice_p.h>
 #include <private/qplatformimagecapture_p.h>
 #include <qcamera.h>
 #include <qcameradevice.h>
@@ -86,6 +87,7 @@ private slots:
 
     // Test cases for QPlatformCamera class.
     void testCameraControl();
+    void testFindCameraFormat();
 
     void testSetVideoOutput();
     void testSetVideoOutputDestruction();
@@ -734,6 +736,65 @@ void tst_QCamera::testSetCameraFormat()
     QCOMPARE(spy.count(), 2);
 }
 
+static QCameraFormat makeCameraFormat(QVideoFrameFormat::PixelFormat pixelFormat, const QSize &resolution,
+                                      float minFrameRate, float maxFrameRate)
+{
+    auto *f = new QCameraFormatPrivate{ QSharedData(), pixelFormat, resolution, minFrameRate, maxFrameRate };
+    return f->create();
+}
+
+void tst_QCamera::testFindCameraFormat()
+{
+    const auto yuyv = QVideoFrameFormat::Format_YUYV;
+    const auto jpeg = QVideoFrameFormat::Format_Jpeg;
+
+    QList<QCameraFormat> formats = {
+        makeCameraFormat(yuyv, QSize(640, 480), 5, 30),
+        makeCameraFormat(jpeg, QSize(1920, 1080), 30, 30),
+        makeCameraFormat(yuyv, QSize(1920, 1080), 5, 5),
+        makeCameraFormat(yuyv, QSize(320, 240), 5, 30),
+        makeCameraFormat(jpeg, QSize(640, 480), 30, 60),
+        makeCameraFormat(yuyv, QSize(640, 480), 5, 30),
+        makeCameraFormat(yuyv, QSize(1280, 720), 5, 10),
+        makeCameraFormat(jpeg, QSize(1920, 1080), 30, 30),
+    };
+    QPlatformCamera::sortCameraFormats(formats);
+
+    // Sorted by decreasing resolution and frame rate, without duplicates
+    QCOMPARE(formats.size(), 6);
+    QCOMPARE(formats.at(0), makeCameraFormat(jpeg, QSize(1920, 1080), 30, 30));
+    QCOMPARE(formats.at(1), makeCameraFormat(yuyv, QSize(1920, 1080), 5, 5));
+    QCOMPARE(formats.at(2), makeCameraFormat(yuyv, QSize(1280, 720), 5, 10));
+    QCOMPARE(formats.at(3), makeCameraFormat(jpeg, QSize(640, 480), 30, 60));
+    QCOMPARE(formats.at(4), makeCameraFormat(yuyv, QSize(640, 480), 5, 30));
+    QCOMPARE(formats.at(5), makeCameraFormat(yuyv, QSize(320, 240), 5, 30));
+
+    // Exact resolution, preferring a frame rate and pixel format match
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(640, 480)), formats.at(3));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(640, 480), 15), formats.at(4));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(640, 480), 60), formats.at(3));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(640, 480), 0, yuyv), formats.at(4));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(1920, 1080), 5, jpeg), formats.at(1));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(1920, 1080), 30, yuyv), formats.at(0));
+
+    // The smallest larger resolution, or the largest one if nothing is as large
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(800, 600)), formats.at(2));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(160, 120)), formats.at(5));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize(3840, 2160), 0, yuyv), formats.at(1));
+
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QSize()), QCameraFormat());
+    QCOMPARE(QPlatformCamera::findCameraFormat({}, QSize(640, 480)), QCameraFormat());
+
+    // Looking up a format only finds an equal one
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, makeCameraFormat(yuyv, QSize(640, 480), 5, 30)),
+             formats.at(4));
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, makeCameraFormat(yuyv, QSize(640, 480), 5, 60)),
+             QCameraFormat());
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, makeCameraFormat(yuyv, QSize(800, 600), 5, 10)),
+             QCameraFormat());
+    QCOMPARE(QPlatformCamera::findCameraFormat(formats, QCameraFormat()), QCameraFormat());
+}
+
 //Added this code to cover QCamera::FocusModeHyperfocal and QCamera::FocusModeAutoNear
 //As the FocusModeHyperfocal and FocusModeAutoNear are not supported we can not set the focus mode to these Focus Modes
 void tst_QCamera::testFocusMode()
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <private/qgstpipeline_p.h>
+#include <private/qgstreamermessage_p.h>
+
+class BusMessageFilter : public QGstreamerBusMessageFilter
+{
+public:
+    explicit BusMessageFilter(GstMessageType types) : types(types) {}
+
+    bool processBusMessage(const QGstreamerMessage &message) override
+    {
+        QMutexLocker locker(&mutex);
+        received.append(message.type());
+        thread = QThread::currentThread();
+        return false;
+    }
+    GstMessageType busMessageTypes() const override { return types; }
+
+    qsizetype count(GstMessageType type)
+    {
+        QMutexLocker locker(&mutex);
+        return received.count(type);
+    }
+
+    const GstMessageType types;
+    QMutex mutex;
+    QList<GstMessageType> received;
+    QThread *thread = nullptr;
+};
+
+class tst_QGstPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void countsMessagesPerType();
+    void dropsMessagesNoFilterHandles();
+    void dispatchesQueuedMessagesInOneBatch();
+    void dispatchesInBusDispatchThread();
+
+private:
+    void postApplicationMessage();
+    void postQosMessage();
+
+    QGstPipeline pipeline;
+};
+
+void tst_QGstPipeline::initTestCase()
+{
+    gst_init(nullptr, nullptr);
+}
+
+void tst_QGstPipeline::init()
+{
+    pipeline = QGstPipeline("pipeline");
+}
+
+void tst_QGstPipeline::cleanup()
+{
+    pipeline = {};
+}
+
+void tst_QGstPipeline::postApplicationMessage()
+{
+    GstObject *source = GST_OBJECT(pipeline.element());
+    gst_element_post_message(pipeline.element(),
+                             gst_message_new_application(source, gst_structure_new_empty("test")));
+}
+
+void tst_QGstPipeline::postQosMessage()
+{
+    GstObject *source = GST_OBJECT(pipeline.element());
+    gst_element_post_message(pipeline.element(),
+                             gst_message_new_qos(source, FALSE, 0, 0, 0, 0));
+}
+
+void tst_QGstPipeline::countsMessagesPerType()
+{
+    BusMessageFilter filter(GST_MESSAGE_ANY);
+    pipeline.installMessageFilter(&filter);
+
+    for (int i = 0; i < 3; ++i)
+        postApplicationMessage();
+    postQosMessage();
+
+    QCOMPARE(pipeline.busMessageCount(GST_MESSAGE_APPLICATION), quint64(3));
+    QCOMPARE(pipeline.busMessageCount(GST_MESSAGE_QOS), quint64(1));
+    QCOMPARE(pipeline.busMessageCount(GST_MESSAGE_EOS), quint64(0));
+    QCOMPARE(pipeline.droppedBusMessageCount(GST_MESSAGE_APPLICATION), quint64(0));
+    QCOMPARE(pipeline.droppedBusMessageCount(GST_MESSAGE_QOS), quint64(0));
+
+    QTRY_COMPARE(filter.received.size(), 4);
+    QCOMPARE(filter.count(GST_MESSAGE_APPLICATION), 3);
+    QCOMPARE(filter.count(GST_MESSAGE_QOS), 1);
+
+    pipeline.removeMessageFilter(&filter);
+}
+
+void tst_QGstPipeline::dropsMessagesNoFilterHandles()
+{
+    // The combined mask of all filters decides what gets through
+    BusMessageFilter applicationFilter(GST_MESSAGE_APPLICATION);
+    BusMessageFilter eosFilter(GST_MESSAGE_EOS);
+    pipeline.installMessageFilter(&applicationFilter);
+    pipeline.installMessageFilter(&eosFilter);
+
+    postApplicationMessage();
+    postQosMessage();
+    postQosMessage();
+
+    QCOMPARE(pipeline.busMessageCount(GST_MESSAGE_APPLICATION), quint64(1));
+    QCOMPARE(pipeline.busMessageCount(GST_MESSAGE_QOS), quint64(2));
+    QCOMPARE(pipeline.droppedBusMessageCount(GST_MESSAGE_APPLICATION), quint64(0));
+    QCOMPARE(pipeline.droppedBusMessageCount(GST_MESSAGE_QOS), quint64(2));
+
+    QTRY_COMPARE(applicationFilter.received.size(), 1);
+    QCOMPARE(applicationFilter.count(GST_MESSAGE_APPLICATION), 1);
+    QCOMPARE(applicationFilter.count(GST_MESSAGE_QOS), 0);
+
+    // Without the application filter nobody wants application messages
+    pipeline.removeMessageFilter(&applicationFilter);
+    postApplicationMessage();
+    QCOMPARE(pipeline.droppedBusMessageCount(GST_MESSAGE_APPLICATION), quint64(1));
+
+    pipeline.removeMessageFilter(&eosFilter);
+    QCoreApplication::processEvents();
+    QCOMPARE(applicationFilter.received.size(), 1);
+}
+
+void tst_QGstPipeline::dispatchesQueuedMessagesInOneBatch()
+{
+    BusMessageFilter filter(GST_MESSAGE_APPLICATION);
+    pipeline.installMessageFilter(&filter);
+
+    // Nothing is dispatched before the event loop runs, so all of these
+    // end up in the same batch
+    for (int i = 0; i < 10; ++i)
+        postApplicationMessage();
+    QCOMPARE(pipeline.busDispatchCount(), quint64(0));
+
+    QTRY_COMPARE(filter.received.size(), 10);
+    QCOMPARE(pipeline.busDispatchCount(), quint64(1));
+
+    postApplicationMessage();
+    QTRY_COMPARE(filter.received.size(), 11);
+    QCOMPARE(pipeline.busDispatchCount(), quint64(2));
+
+    pipeline.removeMessageFilter(&filter);
+}
+
+void tst_QGstPipeline::dispatchesInBusDispatchThread()
+{
+    QThread dispatchThread;
+    dispatchThread.start();
+
+    BusMessageFilter filter(GST_MESSAGE_APPLICATION);
+    pipeline.installMessageFilter(&filter);
+    pipeline.setBusDispatchThread(&dispatchThread);
+
+    for (int i = 0; i < 3; ++i)
+        postApplicationMessage();
+    QTRY_COMPARE(filter.count(GST_MESSAGE_APPLICATION), 3);
+    QCOMPARE(filter.thread, &dispatchThread);
+    QCOMPARE(pipeline.busDispatchCount(), quint64(1));
+
+    pipeline.removeMessageFilter(&filter);
+
+    // The dispatcher can only be moved back from the thread it lives in
+    QObject context;
+    context.moveToThread(&dispatchThread);
+    QThread *mainThread = QThread::currentThread();
+    QMetaObject::invokeMethod(&context, [&] {
+        pipeline.setBusDispatchThread(mainThread);
+        context.moveToThread(mainThread);
+    }, Qt::BlockingQueuedConnection);
+
+    dispatchThread.quit();
+    QVERIFY(dispatchThread.wait());
+}
+
+QTEST_GUILESS_MAIN(tst_QGstPipeline)
+
+#include "tst_qgstpipeline.moc"
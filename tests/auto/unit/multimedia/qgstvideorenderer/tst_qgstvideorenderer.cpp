@@ -0,0 +1,189 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qvideosink.h>
+#include <private/qgstpipeline_p.h>
+#include <private/qgstreamervideosink_p.h>
+#include <private/qgstvideorenderersink_p.h>
+
+class tst_QGstVideoRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void dropsFramesWhileGuiThreadIsBusy();
+    void stopDiscardsPendingFrame();
+    void restartDiscardsPendingFrame();
+    void blockingRenderer();
+
+private:
+    GstCaps *createCaps() const;
+    GstBuffer *createBuffer() const;
+
+    QVideoSink *videoSink = nullptr;
+    QGstreamerVideoSink *gstSink = nullptr;
+    QGstPipeline pipeline;
+};
+
+void tst_QGstVideoRenderer::initTestCase()
+{
+    gst_init(nullptr, nullptr);
+}
+
+void tst_QGstVideoRenderer::init()
+{
+    videoSink = new QVideoSink;
+    gstSink = new QGstreamerVideoSink(videoSink);
+    pipeline = QGstPipeline("renderer");
+    // Frames are only counted as rendered while the pipeline is playing
+    pipeline.setInStoppedState(false);
+    gstSink->setPipeline(pipeline);
+}
+
+void tst_QGstVideoRenderer::cleanup()
+{
+    delete gstSink;
+    gstSink = nullptr;
+    delete videoSink;
+    videoSink = nullptr;
+    pipeline = {};
+    qunsetenv("QT_MEDIA_BLOCKING_VIDEO_RENDERER");
+}
+
+GstCaps *tst_QGstVideoRenderer::createCaps() const
+{
+    return gst_caps_from_string("video/x-raw, format=RGBx, width=16, height=16, framerate=30/1");
+}
+
+GstBuffer *tst_QGstVideoRenderer::createBuffer() const
+{
+    return gst_buffer_new_allocate(nullptr, 16 * 16 * 4, nullptr);
+}
+
+void tst_QGstVideoRenderer::dropsFramesWhileGuiThreadIsBusy()
+{
+    QGstVideoRenderer renderer(gstSink);
+    GstCaps *caps = createCaps();
+    QVERIFY(renderer.start(caps));
+    gst_caps_unref(caps);
+
+    // Without the event loop running, every buffer replaces the one
+    // published before it
+    for (int i = 0; i < 3; ++i) {
+        GstBuffer *buffer = createBuffer();
+        QCOMPARE(renderer.render(buffer), GST_FLOW_OK);
+        gst_buffer_unref(buffer);
+    }
+    QCOMPARE(renderer.framesDropped(), quint64(2));
+    QCOMPARE(renderer.framesRendered(), quint64(0));
+
+    QTRY_COMPARE(renderer.framesRendered(), quint64(1));
+    QCOMPARE(renderer.framesDropped(), quint64(2));
+
+    GstBuffer *buffer = createBuffer();
+    QCOMPARE(renderer.render(buffer), GST_FLOW_OK);
+    gst_buffer_unref(buffer);
+    QTRY_COMPARE(renderer.framesRendered(), quint64(2));
+    QCOMPARE(renderer.framesDropped(), quint64(2));
+
+    renderer.stop();
+}
+
+void tst_QGstVideoRenderer::stopDiscardsPendingFrame()
+{
+    QGstVideoRenderer renderer(gstSink);
+    GstCaps *caps = createCaps();
+    QVERIFY(renderer.start(caps));
+    gst_caps_unref(caps);
+
+    GstBuffer *buffer = createBuffer();
+    QCOMPARE(renderer.render(buffer), GST_FLOW_OK);
+    renderer.stop();
+
+    QCOMPARE(renderer.render(buffer), GST_FLOW_ERROR);
+    gst_buffer_unref(buffer);
+
+    QCoreApplication::sendPostedEvents(&renderer);
+    QCOMPARE(renderer.framesRendered(), quint64(0));
+    QCOMPARE(renderer.framesDropped(), quint64(0));
+}
+
+void tst_QGstVideoRenderer::restartDiscardsPendingFrame()
+{
+    QGstVideoRenderer renderer(gstSink);
+    GstCaps *caps = createCaps();
+    QVERIFY(renderer.start(caps));
+
+    GstBuffer *buffer = createBuffer();
+    QCOMPARE(renderer.render(buffer), GST_FLOW_OK);
+    gst_buffer_unref(buffer);
+
+    // The buffer was published for the previous caps
+    QVERIFY(renderer.start(caps));
+    gst_caps_unref(caps);
+
+    QCoreApplication::sendPostedEvents(&renderer);
+    QCOMPARE(renderer.framesRendered(), quint64(0));
+
+    renderer.stop();
+}
+
+void tst_QGstVideoRenderer::blockingRenderer()
+{
+    qputenv("QT_MEDIA_BLOCKING_VIDEO_RENDERER", "1");
+    QGstVideoRenderer renderer(gstSink);
+    GstCaps *caps = createCaps();
+    QVERIFY(renderer.start(caps));
+    gst_caps_unref(caps);
+
+    // render() is called on the renderer's thread, so each frame is
+    // presented before it returns
+    for (int i = 0; i < 3; ++i) {
+        GstBuffer *buffer = createBuffer();
+        QCOMPARE(renderer.render(buffer), GST_FLOW_OK);
+        gst_buffer_unref(buffer);
+        QCOMPARE(renderer.framesRendered(), quint64(i + 1));
+    }
+    QCOMPARE(renderer.framesDropped(), quint64(0));
+
+    renderer.stop();
+    GstBuffer *buffer = createBuffer();
+    QCOMPARE(renderer.render(buffer), GST_FLOW_ERROR);
+    gst_buffer_unref(buffer);
+}
+
+QTEST_GUILESS_MAIN(tst_QGstVideoRenderer)
+
+#include "tst_qgstvideorenderer.moc"
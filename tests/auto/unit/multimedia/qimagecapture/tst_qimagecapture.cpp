@@ -63,6 +63,7 @@ private slots:
     void imageExposed();
     void imageSaved();
     void readyForCaptureChanged();
+    void captureBurst();
 
 private:
     QMockIntegration *mockIntegration;
@@ -329,6 +330,45 @@ void tst_QImageCapture::readyForCaptureChanged()
     spy.clear();
 }
 
+void tst_QImageCapture::captureBurst()
+{
+    QMediaCaptureSession session;
+    QCamera camera;
+    QImageCapture imageCapture;
+    session.setCamera(&camera);
+    session.setImageCapture(&imageCapture);
+
+    QSignalSpy errorSpy(&imageCapture, SIGNAL(errorOccurred(int,QImageCapture::Error,QString)));
+    QCOMPARE(imageCapture.captureBurstToFile(0), -1);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(imageCapture.error(), QImageCapture::NotSupportedFeatureError);
+
+    camera.start();
+    QTRY_VERIFY(imageCapture.isReadyForCapture());
+
+    QSignalSpy capturedSpy(&imageCapture, SIGNAL(imageCaptured(int,QImage)));
+    QSignalSpy exposedSpy(&imageCapture, SIGNAL(imageExposed(int)));
+    QSignalSpy savedSpy(&imageCapture, SIGNAL(imageSaved(int,QString)));
+
+    const int id = imageCapture.captureBurstToFile(3, QString::fromLatin1("/usr/share"));
+    QVERIFY(id > 0);
+    QCOMPARE(imageCapture.error(), QImageCapture::NoError);
+    QTRY_VERIFY(imageCapture.isReadyForCapture());
+
+    QCOMPARE(capturedSpy.count(), 3);
+    QCOMPARE(exposedSpy.count(), 3);
+    QCOMPARE(savedSpy.count(), 3);
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(capturedSpy.at(i).at(0).toInt(), id + i);
+        QCOMPARE(savedSpy.at(i).at(0).toInt(), id + i);
+    }
+
+    // the next capture continues after the burst
+    QCOMPARE(imageCapture.captureToFile(), id + 3);
+    QTRY_VERIFY(imageCapture.isReadyForCapture());
+    camera.stop();
+}
+
 QTEST_MAIN(tst_QImageCapture)
 
 #include "tst_qimagecapture.moc"
@@ -0,0 +1,308 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qaudiosink.h>
+#include <qaudiosource.h>
+#include <qvideosink.h>
+#include <qvideoframe.h>
+#include <private/qofflineintegration_p.h>
+
+class tst_QOfflineMediaIntegration : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void pushToMemory();
+    void pullToFileAndReadBack();
+    void silenceWithoutInput();
+    void pacedOutput();
+    void stereoSampleCounts();
+    void renderCallback();
+    void captureCallback();
+    void latency();
+    void videoFrames();
+
+private:
+    void createIntegration(const QOfflineMediaIntegration::Options &options);
+    QByteArray ramp(int frames) const;
+
+    QOfflineMediaIntegration *integration = nullptr;
+    QTemporaryDir dir;
+    QAudioFormat format;
+};
+
+void tst_QOfflineMediaIntegration::init()
+{
+    format.setSampleRate(8000);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+}
+
+void tst_QOfflineMediaIntegration::cleanup()
+{
+    QPlatformMediaIntegration::setIntegration(nullptr);
+    delete integration;
+    integration = nullptr;
+}
+
+void tst_QOfflineMediaIntegration::createIntegration(const QOfflineMediaIntegration::Options &options)
+{
+    integration = new QOfflineMediaIntegration(options);
+    QPlatformMediaIntegration::setIntegration(integration);
+}
+
+QByteArray tst_QOfflineMediaIntegration::ramp(int frames) const
+{
+    QByteArray data(frames * format.bytesPerFrame(), Qt::Uninitialized);
+    qint16 *samples = reinterpret_cast<qint16 *>(data.data());
+    for (int i = 0; i < frames; ++i)
+        samples[i] = qint16(i * 7);
+    return data;
+}
+
+void tst_QOfflineMediaIntegration::pushToMemory()
+{
+    createIntegration({});
+
+    QAudioSink sink(format);
+    QIODevice *device = sink.start();
+    QVERIFY(device);
+    QCOMPARE(sink.state(), QAudio::IdleState);
+
+    // Unpaced, everything written is consumed immediately
+    const QByteArray data = ramp(800);
+    QCOMPARE(device->write(data), data.size());
+    QCOMPARE(device->write(data), data.size());
+    QCOMPARE(sink.processedUSecs(), 200000);
+    QCOMPARE(sink.bytesFree(), sink.bufferSize());
+    QCOMPARE(sink.xrunCount(), 0);
+
+    sink.stop();
+    const QOfflineMediaStatistics stats = integration->statistics();
+    QCOMPARE(stats.audioFramesWritten, 1600);
+    QCOMPARE(stats.audioSamplesWritten, 1600);
+}
+
+void tst_QOfflineMediaIntegration::pullToFileAndReadBack()
+{
+    QOfflineMediaIntegration::Options options;
+    options.outputFile = dir.filePath(QStringLiteral("output.wav"));
+    options.inputFile = options.outputFile;
+    createIntegration(options);
+
+    QByteArray data = ramp(4000);
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+
+        QAudioSink sink(format);
+        sink.start(&buffer);
+        QCOMPARE(sink.state(), QAudio::ActiveState);
+        QTRY_COMPARE(sink.state(), QAudio::IdleState);
+        QCOMPARE(sink.error(), QAudio::UnderrunError);
+        QCOMPARE(sink.processedUSecs(), 500000);
+        sink.stop();
+    }
+
+    QAudioSource source(format);
+    QIODevice *device = source.start();
+    QVERIFY(device);
+    QByteArray read;
+    QTRY_VERIFY((read += device->readAll()).size() >= data.size());
+    QCOMPARE(read, data);
+    QTRY_COMPARE(source.state(), QAudio::IdleState);
+
+    const QOfflineMediaStatistics stats = integration->statistics();
+    QCOMPARE(stats.audioFramesWritten, 4000);
+    QCOMPARE(stats.audioFramesRead, 4000);
+    QVERIFY(stats.audioFramesWrittenPerSecond() > 0.);
+    QCOMPARE(stats.audioSamplesWrittenPerSecond(), stats.audioFramesWrittenPerSecond());
+    QCOMPARE(stats.audioSamplesReadPerSecond(), stats.audioFramesReadPerSecond());
+}
+
+void tst_QOfflineMediaIntegration::silenceWithoutInput()
+{
+    createIntegration({});
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QAudioSource source(format);
+    source.start(&buffer);
+    QTRY_VERIFY(buffer.size() >= 1600);
+
+    const QByteArray recorded = buffer.data();
+    QCOMPARE(recorded.count('\0'), recorded.size());
+    QCOMPARE(source.processedUSecs(), format.durationForBytes(recorded.size()));
+}
+
+void tst_QOfflineMediaIntegration::pacedOutput()
+{
+    QOfflineMediaIntegration::Options options;
+    options.rate = 1.;
+    createIntegration(options);
+
+    QAudioSink sink(format);
+    sink.setBufferSize(format.bytesForDuration(1000000));
+    QIODevice *device = sink.start();
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(device->write(ramp(800)), 1600);
+
+    // A tenth of a second of audio takes about a tenth of a second to play
+    QCOMPARE(sink.processedUSecs(), 0);
+    QTRY_COMPARE(sink.processedUSecs(), 100000);
+    QVERIFY(timer.elapsed() >= 90);
+    QTRY_COMPARE(sink.state(), QAudio::IdleState);
+}
+
+void tst_QOfflineMediaIntegration::stereoSampleCounts()
+{
+    createIntegration({});
+    format.setChannelCount(2);
+
+    QAudioSink sink(format);
+    QIODevice *device = sink.start();
+    QVERIFY(device);
+    const QByteArray data(800 * format.bytesPerFrame(), '\0');
+    QCOMPARE(device->write(data), data.size());
+    sink.stop();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QAudioSource source(format);
+    source.start(&buffer);
+    QTRY_VERIFY(buffer.size() >= data.size());
+    source.stop();
+
+    // Every frame carries one sample per channel
+    const QOfflineMediaStatistics stats = integration->statistics();
+    QCOMPARE(stats.audioFramesWritten, 800);
+    QCOMPARE(stats.audioSamplesWritten, 1600);
+    QCOMPARE(stats.audioFramesRead, format.framesForBytes(int(buffer.size())));
+    QCOMPARE(stats.audioSamplesRead, 2 * stats.audioFramesRead);
+    QVERIFY(stats.audioSamplesWrittenPerSecond() > stats.audioFramesWrittenPerSecond());
+    QVERIFY(stats.audioSamplesReadPerSecond() > stats.audioFramesReadPerSecond());
+}
+
+void tst_QOfflineMediaIntegration::renderCallback()
+{
+    createIntegration({});
+
+    // The offline sink has no audio thread, so this goes through the generic fallback
+    QAudioSink sink(format);
+    qint64 frames = 0;
+    bool formatMatches = true;
+    sink.start([&](QAudioFrameSpan span) {
+        formatMatches &= span.format() == format;
+        qint16 *samples = span.data<qint16>();
+        for (qsizetype i = 0; i < span.frameCount(); ++i)
+            samples[i] = qint16(frames + i);
+        frames += span.frameCount();
+    });
+    QCOMPARE(sink.state(), QAudio::ActiveState);
+    QTRY_VERIFY(frames >= 1600);
+    sink.stop();
+
+    QVERIFY(formatMatches);
+    QCOMPARE(integration->statistics().audioFramesWritten, frames);
+}
+
+void tst_QOfflineMediaIntegration::captureCallback()
+{
+    createIntegration({});
+
+    QAudioSource source(format);
+    qint64 frames = 0;
+    bool silent = true;
+    source.start([&](QAudioFrameSpan span) {
+        const qint16 *samples = span.data<const qint16>();
+        for (qsizetype i = 0; i < span.sampleCount(); ++i)
+            silent &= samples[i] == 0;
+        frames += span.frameCount();
+    });
+    QTRY_VERIFY(frames >= 800);
+
+    QVERIFY(silent);
+    QCOMPARE(source.processedUSecs(), format.durationForFrames(qint32(frames)));
+}
+
+void tst_QOfflineMediaIntegration::latency()
+{
+    createIntegration({});
+
+    QAudioSink sink(format);
+    QCOMPARE(sink.latencyUSecs(), -1);
+    QCOMPARE(sink.presentationUSecs(0), -1);
+
+    QIODevice *device = sink.start();
+    QCOMPARE(device->write(ramp(800)), 1600);
+    QCOMPARE(sink.latencyUSecs(), 0);
+
+    // Nothing is buffered, so frame 800 is heard right now and the
+    // next 800 frames take another tenth of a second
+    const qint64 before = sink.elapsedUSecs();
+    const qint64 next = sink.presentationUSecs(1600);
+    const qint64 after = sink.elapsedUSecs();
+    QVERIFY(next >= before + 100000);
+    QVERIFY(next <= after + 100000);
+    sink.stop();
+    QCOMPARE(sink.latencyUSecs(), -1);
+
+    QAudioSource source(format);
+    source.start();
+    QCOMPARE(source.latencyUSecs(), 0);
+    QVERIFY(source.captureUSecs(0) <= source.elapsedUSecs());
+}
+
+void tst_QOfflineMediaIntegration::videoFrames()
+{
+    createIntegration({});
+
+    QVideoSink sink;
+    QVideoFrameFormat frameFormat(QSize(16, 16), QVideoFrameFormat::Format_ARGB8888);
+    for (int i = 0; i < 5; ++i) {
+        QVideoFrame frame(frameFormat);
+        frame.setStartTime(i * 40000);
+        sink.setVideoFrame(frame);
+    }
+
+    const QOfflineMediaStatistics stats = integration->statistics();
+    QCOMPARE(stats.videoFrames, 5);
+    QVERIFY(stats.averageVideoLatencyUSecs >= 0);
+    QVERIFY(stats.maximumVideoLatencyUSecs >= stats.averageVideoLatencyUSecs);
+}
+
+QTEST_GUILESS_MAIN(tst_QOfflineMediaIntegration)
+
+#include "tst_qofflinemediaintegration.moc"
@@ -44,8 +44,16 @@ private slots:
     void testEnoughCapacity();
     void testNotEnoughCapacity();
     void testInvalidFile();
+    void testLeastRecentlyUsedEviction();
+    void testParallelLoading();
+    void testSampleData();
+
+    void benchmarkPreload_data();
+    void benchmarkPreload();
+    void benchmarkEviction();
 
 private:
+    QList<QUrl> copyTestFile(const QTemporaryDir &dir, int count);
 
 };
 
@@ -166,6 +174,150 @@ void tst_QSampleCache::testInvalidFile()
     QVERIFY(!cache.isCached(QUrl::fromLocalFile("invalid")));
 }
 
+QList<QUrl> tst_QSampleCache::copyTestFile(const QTemporaryDir &dir, int count)
+{
+    QList<QUrl> urls;
+    const QString source = QFINDTESTDATA("testdata/test.wav");
+    for (int i = 0; i < count; ++i) {
+        const QString target = dir.filePath(QString::fromLatin1("sample%1.wav").arg(i));
+        if (!QFile::copy(source, target))
+            return {};
+        urls.append(QUrl::fromLocalFile(target));
+    }
+    return urls;
+}
+
+void tst_QSampleCache::testLeastRecentlyUsedEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QList<QUrl> urls = copyTestFile(dir, 3);
+    QCOMPARE(urls.size(), 3);
+
+    QSampleCache cache;
+    QSample *sample = cache.requestSample(urls[0]);
+    QTRY_VERIFY(!cache.isLoading());
+    const qint64 sampleSize = sample->data().size();
+    QVERIFY(sampleSize > 0);
+    sample->release();
+    cache.setCapacity(sampleSize * 2);
+
+    for (int i = 0; i < 2; ++i) {
+        sample = cache.requestSample(urls[i]);
+        QTRY_VERIFY(!cache.isLoading());
+        sample->release();
+    }
+
+    // Touch the first sample, which makes the second one the least recently used
+    sample = cache.requestSample(urls[0]);
+    QTRY_VERIFY(!cache.isLoading());
+    sample->release();
+
+    sample = cache.requestSample(urls[2]);
+    QTRY_VERIFY(!cache.isLoading());
+    sample->release();
+
+    QVERIFY(cache.isCached(urls[0]));
+    QVERIFY(!cache.isCached(urls[1]));
+    QVERIFY(cache.isCached(urls[2]));
+    QCOMPARE(cache.usage(), sampleSize * 2);
+}
+
+void tst_QSampleCache::testParallelLoading()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QList<QUrl> urls = copyTestFile(dir, 16);
+    QCOMPARE(urls.size(), 16);
+
+    QSampleCache cache;
+    cache.setLoaderThreadCount(4);
+    QCOMPARE(cache.loaderThreadCount(), 4);
+
+    QList<QSample *> samples;
+    for (const QUrl &url : urls)
+        samples.append(cache.requestSample(url));
+    QTRY_VERIFY(!cache.isLoading());
+
+    const QByteArray data = samples.first()->data();
+    for (QSample *sample : qAsConst(samples)) {
+        QCOMPARE(sample->state(), QSample::Ready);
+        QCOMPARE(sample->data(), data);
+        sample->release();
+    }
+}
+
+void tst_QSampleCache::testSampleData()
+{
+    QFile file(QFINDTESTDATA("testdata/test.wav"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    // 16 bit mono PCM with a canonical 44 byte header
+    const QByteArray expected = file.readAll().mid(44);
+
+    QSampleCache cache;
+    QSample *sample = cache.requestSample(QUrl::fromLocalFile(file.fileName()));
+    QTRY_COMPARE(sample->state(), QSample::Ready);
+    QCOMPARE(sample->format().sampleFormat(), QAudioFormat::Int16);
+    QCOMPARE(sample->format().channelCount(), 1);
+    QCOMPARE(sample->data(), expected);
+    sample->release();
+}
+
+void tst_QSampleCache::benchmarkPreload_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("4 threads") << 4;
+}
+
+void tst_QSampleCache::benchmarkPreload()
+{
+    QFETCH(int, threads);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QList<QUrl> urls = copyTestFile(dir, 200);
+    QCOMPARE(urls.size(), 200);
+
+    QBENCHMARK {
+        QSampleCache cache;
+        cache.setLoaderThreadCount(threads);
+        QList<QSample *> samples;
+        for (const QUrl &url : urls)
+            samples.append(cache.requestSample(url));
+        for (QSample *sample : qAsConst(samples)) {
+            while (sample->state() != QSample::Ready && sample->state() != QSample::Error)
+                QThread::yieldCurrentThread();
+        }
+        for (QSample *sample : qAsConst(samples))
+            sample->release();
+    }
+}
+
+void tst_QSampleCache::benchmarkEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QList<QUrl> urls = copyTestFile(dir, 200);
+    QCOMPARE(urls.size(), 200);
+
+    QSampleCache cache;
+    cache.setCapacity(qint64(1) << 40);
+    for (const QUrl &url : urls) {
+        QSample *sample = cache.requestSample(url);
+        QTRY_VERIFY(!cache.isLoading());
+        sample->release();
+    }
+
+    // Shrinking the capacity evicts samples from the front of the list
+    QBENCHMARK_ONCE {
+        cache.setCapacity(cache.usage() / 2);
+    }
+    QVERIFY(!cache.isCached(urls.first()));
+    QVERIFY(cache.isCached(urls.last()));
+}
+
 QTEST_MAIN(tst_QSampleCache)
 
 #include "tst_qsamplecache.moc"
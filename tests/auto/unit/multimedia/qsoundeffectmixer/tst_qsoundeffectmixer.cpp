@@ -0,0 +1,213 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qaudioformat.h>
+#include <qsoundeffect.h>
+#include <private/qsoundeffectmixer_p.h>
+
+#include "qmockintegration_p.h"
+
+class tst_QSoundEffectMixer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void sharedMixer();
+    void mixVoices();
+    void volumeAndMute();
+    void saturation();
+    void loops();
+    void infiniteLoop();
+    void restartFromSignal();
+
+private:
+    QByteArray samples(std::initializer_list<qint16> values) const;
+    QList<qint16> readMix(QSoundEffectMixer *mixer, int frames) const;
+
+    QMockIntegration mockIntegration;
+    QAudioFormat format;
+};
+
+void tst_QSoundEffectMixer::init()
+{
+    format.setSampleRate(8000);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+}
+
+QByteArray tst_QSoundEffectMixer::samples(std::initializer_list<qint16> values) const
+{
+    return QByteArray(reinterpret_cast<const char *>(values.begin()), int(values.size() * sizeof(qint16)));
+}
+
+QList<qint16> tst_QSoundEffectMixer::readMix(QSoundEffectMixer *mixer, int frames) const
+{
+    QByteArray data(frames * format.bytesPerFrame(), Qt::Uninitialized);
+    const qint64 read = mixer->read(data.data(), data.size());
+    if (read <= 0)
+        return {};
+    const qint16 *mix = reinterpret_cast<const qint16 *>(data.constData());
+    return QList<qint16>(mix, mix + read / sizeof(qint16));
+}
+
+void tst_QSoundEffectMixer::sharedMixer()
+{
+    QSoundEffectVoice a;
+    QSoundEffectVoice b;
+    QSoundEffectVoice c;
+    a.setSample(QAudioDevice(), format, samples({ 1, 2 }));
+    b.setSample(QAudioDevice(), format, samples({ 3 }));
+
+    QAudioFormat stereo = format;
+    stereo.setChannelCount(2);
+    c.setSample(QAudioDevice(), stereo, samples({ 1, 2 }));
+
+    QVERIFY(a.mixer());
+    QCOMPARE(a.mixer(), b.mixer());
+    QVERIFY(a.mixer() != c.mixer());
+    QCOMPARE(c.mixer()->format(), stereo);
+}
+
+void tst_QSoundEffectMixer::mixVoices()
+{
+    QSoundEffectVoice a;
+    QSoundEffectVoice b;
+    a.setSample(QAudioDevice(), format, samples({ 1000, 1000, 1000, 1000 }));
+    b.setSample(QAudioDevice(), format, samples({ 2000, -2000 }));
+    QSignalSpy finishedA(&a, &QSoundEffectVoice::finished);
+    QSignalSpy finishedB(&b, &QSoundEffectVoice::finished);
+
+    QSoundEffectMixer *mixer = a.mixer();
+    QVERIFY(readMix(mixer, 4).isEmpty());
+
+    a.play(1);
+    b.play(1);
+    QCOMPARE(mixer->playingVoices(), 2);
+
+    QCOMPARE(readMix(mixer, 3), QList<qint16>({ 3000, -1000, 1000 }));
+    QCOMPARE(finishedA.count(), 0);
+    QCOMPARE(finishedB.count(), 1);
+    QVERIFY(a.isPlaying());
+    QVERIFY(!b.isPlaying());
+    QCOMPARE(mixer->playingVoices(), 1);
+
+    // A read past the end of the last voice returns what is left
+    QCOMPARE(readMix(mixer, 3), QList<qint16>({ 1000 }));
+    QCOMPARE(finishedA.count(), 1);
+    QCOMPARE(mixer->playingVoices(), 0);
+    QVERIFY(readMix(mixer, 3).isEmpty());
+}
+
+void tst_QSoundEffectMixer::volumeAndMute()
+{
+    QSoundEffectVoice voice;
+    voice.setSample(QAudioDevice(), format, samples({ 1000, 1000, 1000, 1000 }));
+    voice.setVolume(0.5f);
+    voice.play(1);
+
+    QCOMPARE(readMix(voice.mixer(), 1), QList<qint16>({ 500 }));
+
+    // Muted voices keep playing silently
+    voice.setMuted(true);
+    QCOMPARE(readMix(voice.mixer(), 2), QList<qint16>({ 0, 0 }));
+    voice.setMuted(false);
+    QCOMPARE(readMix(voice.mixer(), 2), QList<qint16>({ 500 }));
+}
+
+void tst_QSoundEffectMixer::saturation()
+{
+    QSoundEffectVoice a;
+    QSoundEffectVoice b;
+    a.setSample(QAudioDevice(), format, samples({ 30000, -30000 }));
+    b.setSample(QAudioDevice(), format, samples({ 30000, -30000 }));
+    a.play(1);
+    b.play(1);
+
+    QCOMPARE(readMix(a.mixer(), 2), QList<qint16>({ 32767, -32768 }));
+}
+
+void tst_QSoundEffectMixer::loops()
+{
+    QSoundEffectVoice voice;
+    voice.setSample(QAudioDevice(), format, samples({ 100, 200 }));
+    QSignalSpy loopsChanged(&voice, &QSoundEffectVoice::loopsRemainingChanged);
+    QSignalSpy finished(&voice, &QSoundEffectVoice::finished);
+
+    voice.play(3);
+    QCOMPARE(readMix(voice.mixer(), 3), QList<qint16>({ 100, 200, 100 }));
+    QCOMPARE(voice.loopsRemaining(), 2);
+    QCOMPARE(loopsChanged.count(), 1);
+
+    QCOMPARE(readMix(voice.mixer(), 8), QList<qint16>({ 200, 100, 200 }));
+    QCOMPARE(voice.loopsRemaining(), 0);
+    QCOMPARE(loopsChanged.count(), 2);
+    QCOMPARE(finished.count(), 1);
+}
+
+void tst_QSoundEffectMixer::infiniteLoop()
+{
+    QSoundEffectVoice voice;
+    voice.setSample(QAudioDevice(), format, samples({ 7, 8, 9 }));
+    QSignalSpy loopsChanged(&voice, &QSoundEffectVoice::loopsRemainingChanged);
+
+    voice.play(QSoundEffect::Infinite);
+    QCOMPARE(readMix(voice.mixer(), 7), QList<qint16>({ 7, 8, 9, 7, 8, 9, 7 }));
+    QVERIFY(voice.isPlaying());
+    QCOMPARE(voice.loopsRemaining(), int(QSoundEffect::Infinite));
+    QCOMPARE(loopsChanged.count(), 0);
+
+    voice.stop();
+    QVERIFY(readMix(voice.mixer(), 7).isEmpty());
+}
+
+void tst_QSoundEffectMixer::restartFromSignal()
+{
+    QSoundEffectVoice voice;
+    voice.setSample(QAudioDevice(), format, samples({ 5, 6 }));
+    int restarts = 0;
+    connect(&voice, &QSoundEffectVoice::finished, this, [&]() {
+        if (restarts++ == 0)
+            voice.play(1);
+    });
+
+    voice.play(1);
+    QCOMPARE(readMix(voice.mixer(), 4), QList<qint16>({ 5, 6 }));
+    QVERIFY(voice.isPlaying());
+    QCOMPARE(readMix(voice.mixer(), 4), QList<qint16>({ 5, 6 }));
+    QVERIFY(!voice.isPlaying());
+    QCOMPARE(restarts, 2);
+}
+
+QTEST_MAIN(tst_QSoundEffectMixer)
+
+#include "tst_qsoundeffectmixer.moc"
@@ -33,8 +33,12 @@
 #include <qvideoframe.h>
 #include <qvideoframeformat.h>
 #include "private/qmemoryvideobuffer_p.h"
+#include "private/qvideoframeconversionhelper_p.h"
+#include "private/qvideoframepool_p.h"
 #include <QtGui/QImage>
+#include <QtGui/QPainter>
 #include <QtCore/QPointer>
+#include <QtCore/QThreadPool>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
 
 // Adds an enum, and the stringized version
@@ -85,6 +89,24 @@ private slots:
     void image_data();
     void image();
 
+    void yuvConversion_data();
+    void yuvConversion();
+
+    void yuvColorSpaces_data();
+    void yuvColorSpaces();
+
+    void imageInStripes_data();
+    void imageInStripes();
+
+    void imageTransformed_data();
+    void imageTransformed();
+    void imageScaled();
+    void paintCache();
+
+    void framePoolRecyclesBuffers();
+    void framePoolKeepsSharedBuffers();
+    void framePoolLimit();
+
     void emptyData();
 };
 
@@ -997,6 +1019,363 @@ void tst_QVideoFrame::image()
     QCOMPARE(img.size(), size);
 }
 
+// Reference implementation of the BT.601 conversion done by the generic converters
+static QRgb referenceYUVToRgb(int y, int u, int v)
+{
+    auto clamp = [](int n) { return qBound(0, n >> 8, 255); };
+    const int yy = (y - 16) * 298;
+    const int uu = u - 128;
+    const int vv = v - 128;
+    return qRgb(clamp(yy + 409 * vv + 128),
+                clamp(yy - 100 * uu - 208 * vv - 128),
+                clamp(yy + 516 * uu + 128));
+}
+
+static void referenceYUV(const QVideoFrame &frame, int x, int y, int &Y, int &U, int &V)
+{
+    auto sample16 = [](const uchar *data) { return *reinterpret_cast<const quint16 *>(data) >> 8; };
+    const uchar *line0 = frame.bits(0) + y * frame.bytesPerLine(0);
+
+    switch (frame.pixelFormat()) {
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YV12: {
+        const bool yv12 = frame.pixelFormat() == QVideoFrameFormat::Format_YV12;
+        Y = line0[x];
+        U = frame.bits(yv12 ? 2 : 1)[y / 2 * frame.bytesPerLine(1) + x / 2];
+        V = frame.bits(yv12 ? 1 : 2)[y / 2 * frame.bytesPerLine(2) + x / 2];
+        break;
+    }
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21: {
+        const bool nv21 = frame.pixelFormat() == QVideoFrameFormat::Format_NV21;
+        const uchar *uv = frame.bits(1) + y / 2 * frame.bytesPerLine(1) + x / 2 * 2;
+        Y = line0[x];
+        U = uv[nv21 ? 1 : 0];
+        V = uv[nv21 ? 0 : 1];
+        break;
+    }
+    case QVideoFrameFormat::Format_YUYV:
+        Y = line0[x * 2];
+        U = line0[x / 2 * 4 + 1];
+        V = line0[x / 2 * 4 + 3];
+        break;
+    case QVideoFrameFormat::Format_UYVY:
+        Y = line0[x * 2 + 1];
+        U = line0[x / 2 * 4];
+        V = line0[x / 2 * 4 + 2];
+        break;
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016: {
+        const uchar *uv = frame.bits(1) + y / 2 * frame.bytesPerLine(1) + x / 2 * 4;
+        Y = sample16(line0 + x * 2);
+        U = sample16(uv);
+        V = sample16(uv + 2);
+        break;
+    }
+    default:
+        QFAIL("Unexpected pixel format");
+    }
+}
+
+void tst_QVideoFrame::yuvConversion_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+
+    // 70x38 leaves leftovers after the vectorized loops
+    for (const QSize size : { QSize(64, 64), QSize(70, 38) }) {
+        for (const auto pixelFormat : { QVideoFrameFormat::Format_YUV420P,
+                                        QVideoFrameFormat::Format_YV12,
+                                        QVideoFrameFormat::Format_NV12,
+                                        QVideoFrameFormat::Format_NV21,
+                                        QVideoFrameFormat::Format_YUYV,
+                                        QVideoFrameFormat::Format_UYVY,
+                                        QVideoFrameFormat::Format_P010,
+                                        QVideoFrameFormat::Format_P016 }) {
+            const QByteArray name = QByteArray::number(size.width()) + "x"
+                    + QByteArray::number(size.height()) + " "
+                    + QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1();
+            QTest::newRow(name.constData()) << size << pixelFormat;
+        }
+    }
+}
+
+void tst_QVideoFrame::yuvConversion()
+{
+    QFETCH(QSize, size);
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *data = frame.bits(plane);
+        for (int i = 0; i < frame.mappedBytes(plane); ++i)
+            data[i] = uchar((i * 7 + (i >> 5) * 13 + plane * 29) & 0xff);
+    }
+    frame.unmap();
+
+    const QImage img = frame.toImage();
+    QCOMPARE(img.size(), size);
+
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            int Y, U, V;
+            referenceYUV(frame, x, y, Y, U, V);
+            if (img.pixel(x, y) != referenceYUVToRgb(Y, U, V)) {
+                frame.unmap();
+                QFAIL(qPrintable(QStringLiteral("Pixel (%1, %2) differs: %3 != %4")
+                                 .arg(x).arg(y)
+                                 .arg(img.pixel(x, y), 8, 16)
+                                 .arg(referenceYUVToRgb(Y, U, V), 8, 16)));
+            }
+        }
+    }
+    frame.unmap();
+}
+
+void tst_QVideoFrame::yuvColorSpaces_data()
+{
+    QTest::addColumn<QVideoFrameFormat::YCbCrColorSpace>("colorSpace");
+    QTest::addColumn<QVector<float>>("matrix"); // kr, kgu, kgv, kb, luma scale, luma offset
+
+    QTest::newRow("BT601") << QVideoFrameFormat::YCbCr_BT601
+                           << QVector<float>{ 1.596f, 0.392f, 0.813f, 2.017f, 1.164f, 16.f };
+    QTest::newRow("BT709") << QVideoFrameFormat::YCbCr_BT709
+                           << QVector<float>{ 1.7928f, 0.2132f, 0.5329f, 2.1124f, 1.1644f, 16.f };
+    QTest::newRow("BT2020") << QVideoFrameFormat::YCbCr_BT2020
+                            << QVector<float>{ 1.6787f, 0.1874f, 0.6511f, 2.1418f, 1.1644f, 16.f };
+    QTest::newRow("JPEG") << QVideoFrameFormat::YCbCr_JPEG
+                          << QVector<float>{ 1.402f, 0.344f, 0.714f, 1.772f, 1.f, 0.f };
+}
+
+void tst_QVideoFrame::yuvColorSpaces()
+{
+    QFETCH(QVideoFrameFormat::YCbCrColorSpace, colorSpace);
+    QFETCH(QVector<float>, matrix);
+
+    // Same matrices as used by the shaders in qvideotexturehelper.cpp
+    auto referenceRgb = [&](int y, int u, int v) {
+        const float yy = (y - matrix[5]) * matrix[4];
+        const float uu = u - 128;
+        const float vv = v - 128;
+        auto clamp = [](float n) { return qBound(0, qRound(n), 255); };
+        return qRgb(clamp(yy + matrix[0] * vv),
+                    clamp(yy - matrix[1] * uu - matrix[2] * vv),
+                    clamp(yy + matrix[3] * uu));
+    };
+
+    QVideoFrameFormat format(QSize(70, 38), QVideoFrameFormat::Format_NV12);
+    format.setYCbCrColorSpace(colorSpace);
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *data = frame.bits(plane);
+        for (int i = 0; i < frame.mappedBytes(plane); ++i)
+            data[i] = uchar((i * 7 + (i >> 5) * 13 + plane * 29) & 0xff);
+    }
+    frame.unmap();
+
+    const QImage img = frame.toImage();
+    QCOMPARE(img.size(), format.frameSize());
+
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    for (int y = 0; y < img.height(); ++y) {
+        for (int x = 0; x < img.width(); ++x) {
+            int Y, U, V;
+            referenceYUV(frame, x, y, Y, U, V);
+            const QRgb expected = referenceRgb(Y, U, V);
+            const QRgb actual = img.pixel(x, y);
+            if (qAbs(qRed(actual) - qRed(expected)) > 2
+                    || qAbs(qGreen(actual) - qGreen(expected)) > 2
+                    || qAbs(qBlue(actual) - qBlue(expected)) > 2) {
+                frame.unmap();
+                QFAIL(qPrintable(QStringLiteral("Pixel (%1, %2) differs: %3 != %4")
+                                 .arg(x).arg(y)
+                                 .arg(actual, 8, 16)
+                                 .arg(expected, 8, 16)));
+            }
+        }
+    }
+    frame.unmap();
+}
+
+void tst_QVideoFrame::imageInStripes_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+
+    QTest::newRow("ARGB8888") << QVideoFrameFormat::Format_ARGB8888;
+    QTest::newRow("YUV420P") << QVideoFrameFormat::Format_YUV420P;
+    QTest::newRow("YUV422P") << QVideoFrameFormat::Format_YUV422P;
+    QTest::newRow("NV12") << QVideoFrameFormat::Format_NV12;
+    QTest::newRow("YUYV") << QVideoFrameFormat::Format_YUYV;
+    QTest::newRow("P010") << QVideoFrameFormat::Format_P010;
+}
+
+void tst_QVideoFrame::imageInStripes()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+
+    // Large enough to be split, with a height that does not divide evenly into stripes
+    QVideoFrame frame(QVideoFrameFormat(QSize(1920, 1082), pixelFormat));
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *data = frame.bits(plane);
+        for (int i = 0; i < frame.mappedBytes(plane); ++i)
+            data[i] = uchar((i * 7 + (i >> 11) * 13 + plane * 29) & 0xff);
+    }
+    frame.unmap();
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(3);
+
+    const QImage expected = frame.toImage();
+    const QImage image = frame.toImage(&threadPool);
+    QCOMPARE(image.format(), expected.format());
+    QCOMPARE(image, expected);
+
+    // Without a thread pool the frame is converted in one go
+    QCOMPARE(frame.toImage(nullptr), expected);
+}
+
+static QVideoFrame patternFrame(const QVideoFrameFormat &format)
+{
+    QVideoFrame frame(format);
+    if (frame.map(QVideoFrame::WriteOnly)) {
+        for (int plane = 0; plane < frame.planeCount(); ++plane) {
+            uchar *data = frame.bits(plane);
+            for (int i = 0; i < frame.mappedBytes(plane); ++i)
+                data[i] = uchar((i * 7 + (i >> 6) * 13 + plane * 29) & 0xff);
+        }
+        frame.unmap();
+    }
+    return frame;
+}
+
+void tst_QVideoFrame::imageTransformed_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QVideoFrame::RotationAngle>("rotation");
+    QTest::addColumn<bool>("mirrored");
+    QTest::addColumn<bool>("bottomToTop");
+
+    for (const auto pixelFormat : { QVideoFrameFormat::Format_ARGB8888,
+                                    QVideoFrameFormat::Format_YUV420P }) {
+        for (const auto rotation : { QVideoFrame::Rotation0, QVideoFrame::Rotation90,
+                                     QVideoFrame::Rotation180, QVideoFrame::Rotation270 }) {
+            for (const bool mirrored : { false, true }) {
+                for (const bool bottomToTop : { false, true }) {
+                    const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1()
+                            + " " + QByteArray::number(rotation)
+                            + (mirrored ? " mirrored" : "") + (bottomToTop ? " bottomToTop" : "");
+                    QTest::newRow(name.constData()) << pixelFormat << rotation << mirrored << bottomToTop;
+                }
+            }
+        }
+    }
+}
+
+void tst_QVideoFrame::imageTransformed()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QVideoFrame::RotationAngle, rotation);
+    QFETCH(bool, mirrored);
+    QFETCH(bool, bottomToTop);
+
+    QVideoFrameFormat format(QSize(64, 48), pixelFormat);
+    const QImage plain = patternFrame(format).toImage();
+
+    if (bottomToTop)
+        format.setScanLineDirection(QVideoFrameFormat::BottomToTop);
+    QVideoFrame frame = patternFrame(format);
+    frame.setRotationAngle(rotation);
+    frame.setMirrored(mirrored);
+
+    QTransform t;
+    if (mirrored)
+        t.scale(-1.f, 1.f);
+    if (rotation != QVideoFrame::Rotation0)
+        t.rotate(float(rotation));
+    if (bottomToTop)
+        t.scale(1.f, -1.f);
+
+    QCOMPARE(frame.toImage(), plain.transformed(t));
+}
+
+void tst_QVideoFrame::imageScaled()
+{
+    QVideoFrame frame = patternFrame(QVideoFrameFormat(QSize(64, 48), QVideoFrameFormat::Format_NV12));
+    const QImage full = frame.toImage();
+
+    const QImage scaled = qImageFromVideoFrame(frame, QSize(32, 24), QVideoFrame::Rotation0, false);
+    QCOMPARE(scaled.size(), QSize(32, 24));
+    QCOMPARE(scaled.format(), full.format());
+    for (int y = 0; y < scaled.height(); ++y) {
+        for (int x = 0; x < scaled.width(); ++x)
+            QCOMPARE(scaled.pixel(x, y), full.pixel(2 * x + 1, 2 * y + 1));
+    }
+
+    // An empty target size keeps the rotated size of the frame
+    const QImage rotated = qImageFromVideoFrame(frame, QSize(), QVideoFrame::Rotation90, false);
+    QCOMPARE(rotated.size(), QSize(48, 64));
+    QCOMPARE(rotated, full.transformed(QTransform().rotate(90)));
+}
+
+class CountingVideoBuffer : public QMemoryVideoBuffer
+{
+public:
+    using QMemoryVideoBuffer::QMemoryVideoBuffer;
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        ++mapCount;
+        return QMemoryVideoBuffer::map(mode);
+    }
+
+    int mapCount = 0;
+};
+
+void tst_QVideoFrame::paintCache()
+{
+    const QSize size(64, 48);
+    const QVideoFrameFormat format(size, QVideoFrameFormat::Format_XRGB8888);
+    auto *buffer = new CountingVideoBuffer(QByteArray(size.width() * size.height() * 4, char(0x40)),
+                                           size.width() * 4);
+    QVideoFrame frame(buffer, format);
+
+    auto paint = [&](QVideoFrame &f, const QSize &target) {
+        QImage image(target, QImage::Format_RGB32);
+        image.fill(Qt::red);
+        QPainter painter(&image);
+        f.paint(&painter, QRectF(QPointF(), target), { Qt::black, Qt::IgnoreAspectRatio });
+        return image;
+    };
+
+    const QImage first = paint(frame, size);
+    QCOMPARE(buffer->mapCount, 1);
+
+    // Repainting the same frame, or a copy of it, at the same size reuses the image
+    QCOMPARE(paint(frame, size), first);
+    QVideoFrame copy = frame;
+    QCOMPARE(paint(copy, size), first);
+    QCOMPARE(buffer->mapCount, 1);
+
+    // A different size needs a new conversion
+    paint(frame, size / 2);
+    QCOMPARE(buffer->mapCount, 2);
+    paint(frame, size / 2);
+    QCOMPARE(buffer->mapCount, 2);
+
+    // Writing to the frame invalidates the cache
+    QVERIFY(frame.map(QVideoFrame::ReadWrite));
+    memset(frame.bits(0), 0xff, frame.mappedBytes(0));
+    frame.unmap();
+    const int mapCount = buffer->mapCount;
+    const QImage written = paint(frame, size / 2);
+    QCOMPARE(buffer->mapCount, mapCount + 1);
+    QCOMPARE(written.pixel(0, 0), qRgb(0xff, 0xff, 0xff));
+}
+
 void tst_QVideoFrame::emptyData()
 {
     QByteArray data(nullptr, 0);
@@ -1005,6 +1384,102 @@ void tst_QVideoFrame::emptyData()
     QVERIFY(!f.map(QVideoFrame::ReadOnly));
 }
 
+void tst_QVideoFrame::framePoolRecyclesBuffers()
+{
+    QVideoFramePool *pool = QVideoFramePool::instance();
+    QVERIFY(pool);
+    pool->clear();
+    pool->resetStatistics();
+
+    const QVideoFrameFormat format(QSize(320, 240), QVideoFrameFormat::Format_NV12);
+    const uchar *bits = nullptr;
+    {
+        QVideoFrame frame(format);
+        QVERIFY(frame.map(QVideoFrame::WriteOnly));
+        bits = frame.bits(0);
+        frame.unmap();
+
+        QVideoFrame copy = frame;
+        frame = QVideoFrame();
+        QCOMPARE(pool->statistics().pooledBuffers, 0);
+    }
+
+    QVideoFramePool::Statistics stats = pool->statistics();
+    QCOMPARE(stats.misses, 1u);
+    QCOMPARE(stats.hits, 0u);
+    QCOMPARE(stats.recycled, 1u);
+    QCOMPARE(stats.pooledBuffers, 1);
+
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+    QCOMPARE(frame.bits(0), bits);
+    frame.unmap();
+
+    // A frame of a different size can't use the pooled buffer
+    QVideoFrame other(QVideoFrameFormat(QSize(640, 480), QVideoFrameFormat::Format_NV12));
+
+    stats = pool->statistics();
+    QCOMPARE(stats.hits, 1u);
+    QCOMPARE(stats.misses, 2u);
+    QCOMPARE(stats.pooledBuffers, 0);
+    QCOMPARE(stats.pooledBytes, 0);
+
+    // Converted images draw from the pool as well
+    pool->resetStatistics();
+    QImage image = frame.toImage();
+    QVERIFY(!image.isNull());
+    image = QImage();
+    QCOMPARE(pool->statistics().recycled, 1u);
+    QVERIFY(!frame.toImage().isNull());
+    QCOMPARE(pool->statistics().hits, 1u);
+}
+
+void tst_QVideoFrame::framePoolKeepsSharedBuffers()
+{
+    QVideoFramePool pool;
+    QByteArray data = pool.acquire(1024);
+    QCOMPARE(data.size(), 1024);
+
+    QByteArray copy = data;
+    pool.release(std::move(data));
+    QCOMPARE(pool.statistics().discarded, 1u);
+    QCOMPARE(pool.statistics().pooledBuffers, 0);
+
+    pool.release(std::move(copy));
+    QCOMPARE(pool.statistics().recycled, 1u);
+    QCOMPARE(pool.statistics().pooledBuffers, 1);
+    QCOMPARE(pool.statistics().pooledBytes, 1024);
+}
+
+void tst_QVideoFrame::framePoolLimit()
+{
+    QVideoFramePool pool;
+    pool.setMaximumBytes(3000);
+
+    QByteArray a = pool.acquire(1000);
+    QByteArray b = pool.acquire(1000);
+    QByteArray c = pool.acquire(2500);
+    const char *newest = c.constData();
+    pool.release(std::move(a));
+    pool.release(std::move(b));
+    pool.release(std::move(c));
+
+    // The least recently released buffers are freed first
+    QVideoFramePool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.pooledBuffers, 1);
+    QCOMPARE(stats.pooledBytes, 2500);
+    QCOMPARE(stats.discarded, 2u);
+    QCOMPARE(pool.acquire(2500).constData(), newest);
+
+    QByteArray tooLarge = pool.acquire(4000);
+    pool.release(std::move(tooLarge));
+    QCOMPARE(pool.statistics().pooledBuffers, 0);
+
+    pool.setMaximumBytes(0);
+    pool.release(pool.acquire(10));
+    QCOMPARE(pool.statistics().pooledBuffers, 0);
+}
+
 QTEST_MAIN(tst_QVideoFrame)
 
 #include "tst_qvideoframe.moc"
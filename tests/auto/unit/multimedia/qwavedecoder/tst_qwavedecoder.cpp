@@ -65,6 +65,14 @@ private slots:
 
     void readAllAtOnce();
     void readPerByte();
+
+    void decode24Bit_data();
+    void decode24Bit();
+    void decodeFloat_data();
+    void decodeFloat();
+    void decodeBigEndian16Bit();
+    void unsupportedFormat();
+    void bufferFilledAfterOpen();
 };
 
 void tst_QWaveDecoder::init()
@@ -96,33 +104,32 @@ void tst_QWaveDecoder::file_data()
     QTest::addColumn<int>("channels");
     QTest::addColumn<int>("samplesize");
     QTest::addColumn<int>("samplerate");
-    QTest::addColumn<QAudioFormat::Endian>("byteorder");
-
-    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100 << QAudioFormat::BigEndian;
+
+    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1;
+    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1;
+    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1;
+    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1;
+
+    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000;
+    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100;
+    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000;
+    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100;
+
+    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000;
+    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100;
+    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000;
+    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100;
     // The next file has extra data in the wave header.
-    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
+    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100;
 
-    // 32 bit waves are not supported
-    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 44100 << QAudioFormat::BigEndian;
+    // 32 bit waves use WAVE_FORMAT_EXTENSIBLE
+    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 8000;
+    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 44100;
+    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 8000;
+    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 44100;
 }
 
 void tst_QWaveDecoder::file()
@@ -132,7 +139,6 @@ void tst_QWaveDecoder::file()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -143,6 +149,7 @@ void tst_QWaveDecoder::file()
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -174,11 +181,8 @@ void tst_QWaveDecoder::file()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
     }
 
     stream.close();
@@ -191,7 +195,6 @@ void tst_QWaveDecoder::http()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -206,6 +209,7 @@ void tst_QWaveDecoder::http()
     QWaveDecoder waveDecoder(reply);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -237,11 +241,8 @@ void tst_QWaveDecoder::http()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
     }
 
     delete reply;
@@ -257,6 +258,7 @@ void tst_QWaveDecoder::readAllAtOnce()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -283,6 +285,7 @@ void tst_QWaveDecoder::readPerByte()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -297,6 +300,226 @@ void tst_QWaveDecoder::readPerByte()
     stream.close();
 }
 
+// Builds a WAV file in memory. The fmt chunk uses WAVE_FORMAT_EXTENSIBLE when
+// \a extensible is set, with \a formatTag as the sub format.
+static QByteArray makeWav(quint16 formatTag, int bitsPerSample, int channels, int sampleRate,
+                          const QByteArray &samples, bool bigEndian = false, bool extensible = false)
+{
+    QByteArray wav;
+    QDataStream stream(&wav, QIODevice::WriteOnly);
+    stream.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+
+    const quint32 fmtSize = extensible ? 40 : 16;
+    const quint16 blockAlign = quint16(channels * bitsPerSample / 8);
+
+    stream.writeRawData(bigEndian ? "RIFX" : "RIFF", 4);
+    stream << quint32(4 + 8 + fmtSize + 8 + samples.size());
+    stream.writeRawData("WAVE", 4);
+
+    stream.writeRawData("fmt ", 4);
+    stream << fmtSize << quint16(extensible ? 0xfffe : formatTag) << quint16(channels)
+           << quint32(sampleRate) << quint32(sampleRate * blockAlign) << blockAlign
+           << quint16(bitsPerSample);
+    if (extensible) {
+        stream << quint16(22) << quint16(bitsPerSample) << quint32(0) << formatTag;
+        stream.writeRawData("\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71", 14);
+    }
+
+    stream.writeRawData("data", 4);
+    stream << quint32(samples.size());
+    stream.writeRawData(samples.constData(), samples.size());
+    return wav;
+}
+
+static QByteArray readAll(QWaveDecoder &decoder, qint64 blockSize)
+{
+    QByteArray result;
+    QByteArray block(blockSize, Qt::Uninitialized);
+    qint64 read;
+    while ((read = decoder.read(block.data(), blockSize)) > 0)
+        result.append(block.constData(), read);
+    return result;
+}
+
+void tst_QWaveDecoder::decode24Bit_data()
+{
+    QTest::addColumn<bool>("bigEndian");
+    QTest::addColumn<bool>("extensible");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("le") << false << false << 4096;
+    QTest::newRow("le, one sample per read") << false << false << 4;
+    QTest::newRow("be") << true << false << 4096;
+    QTest::newRow("extensible le") << false << true << 4096;
+    QTest::newRow("extensible be") << true << true << 1000;
+}
+
+void tst_QWaveDecoder::decode24Bit()
+{
+    QFETCH(bool, bigEndian);
+    QFETCH(bool, extensible);
+    QFETCH(int, blockSize);
+
+    // Longer than the decoder's internal block, with a tail that isn't a
+    // multiple of any vector width
+    const int frames = 5003;
+    const int channels = 2;
+    QList<qint32> expected;
+    QByteArray samples;
+    for (int i = 0; i < frames * channels; ++i) {
+        const qint32 value = ((i * 7919) % 0x1000000) - 0x800000;
+        expected.append(value * 256);
+        const quint32 raw = quint32(value) & 0xffffff;
+        const char bytes[3] = { char(raw), char(raw >> 8), char(raw >> 16) };
+        if (bigEndian) {
+            samples.append(bytes[2]);
+            samples.append(bytes[1]);
+            samples.append(bytes[0]);
+        } else {
+            samples.append(bytes, 3);
+        }
+    }
+
+    QBuffer buffer;
+    buffer.setData(makeWav(1, 24, channels, 48000, samples, bigEndian, extensible));
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QWaveDecoder decoder(&buffer);
+    QSignalSpy validFormatSpy(&decoder, SIGNAL(formatKnown()));
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QCOMPARE(validFormatSpy.count(), 1);
+
+    const QAudioFormat format = decoder.audioFormat();
+    QCOMPARE(format.sampleFormat(), QAudioFormat::Int32);
+    QCOMPARE(format.channelCount(), channels);
+    QCOMPARE(format.sampleRate(), 48000);
+    QCOMPARE(decoder.size(), qint64(frames * channels * 4));
+    QCOMPARE(decoder.bytesAvailable(), decoder.size());
+
+    const QByteArray data = readAll(decoder, blockSize);
+    QCOMPARE(data.size(), frames * channels * 4);
+    const qint32 *decoded = reinterpret_cast<const qint32 *>(data.constData());
+    for (int i = 0; i < expected.size(); ++i)
+        QCOMPARE(decoded[i], expected.at(i));
+}
+
+void tst_QWaveDecoder::decodeFloat_data()
+{
+    QTest::addColumn<int>("bitsPerSample");
+    QTest::addColumn<bool>("bigEndian");
+    QTest::addColumn<bool>("extensible");
+
+    QTest::newRow("32 bit le") << 32 << false << false;
+    QTest::newRow("32 bit be") << 32 << true << false;
+    QTest::newRow("32 bit extensible") << 32 << false << true;
+    QTest::newRow("64 bit le") << 64 << false << false;
+    QTest::newRow("64 bit be") << 64 << true << true;
+}
+
+void tst_QWaveDecoder::decodeFloat()
+{
+    QFETCH(int, bitsPerSample);
+    QFETCH(bool, bigEndian);
+    QFETCH(bool, extensible);
+
+    const int count = 3001;
+    QList<float> expected;
+    QByteArray samples;
+    QDataStream stream(&samples, QIODevice::WriteOnly);
+    stream.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(bitsPerSample == 32 ? QDataStream::SinglePrecision
+                                                         : QDataStream::DoublePrecision);
+    for (int i = 0; i < count; ++i) {
+        const float value = qSin(i * 0.01f);
+        expected.append(value);
+        if (bitsPerSample == 32)
+            stream << value;
+        else
+            stream << double(value);
+    }
+
+    QBuffer buffer;
+    buffer.setData(makeWav(3, bitsPerSample, 1, 44100, samples, bigEndian, extensible));
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Float);
+    QCOMPARE(decoder.size(), qint64(count * 4));
+
+    const QByteArray data = readAll(decoder, 4096);
+    QCOMPARE(data.size(), count * 4);
+    const float *decoded = reinterpret_cast<const float *>(data.constData());
+    for (int i = 0; i < count; ++i)
+        QCOMPARE(decoded[i], expected.at(i));
+}
+
+void tst_QWaveDecoder::decodeBigEndian16Bit()
+{
+    QByteArray samples;
+    QDataStream stream(&samples, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int i = 0; i < 1001; ++i)
+        stream << qint16(i * 31 - 16000);
+
+    QBuffer buffer;
+    buffer.setData(makeWav(1, 16, 1, 8000, samples, true));
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QWaveDecoder decoder(&buffer);
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Int16);
+
+    const QByteArray data = readAll(decoder, 4096);
+    QCOMPARE(data.size(), 1001 * 2);
+    const qint16 *decoded = reinterpret_cast<const qint16 *>(data.constData());
+    for (int i = 0; i < 1001; ++i)
+        QCOMPARE(decoded[i], qint16(i * 31 - 16000));
+}
+
+void tst_QWaveDecoder::unsupportedFormat()
+{
+    // 64 bit integer samples and 16 bit floats have no QAudioFormat equivalent
+    const QList<QPair<quint16, int>> formats = { { 1, 64 }, { 3, 16 }, { 2, 16 } };
+    for (const auto &f : formats) {
+        QBuffer buffer;
+        buffer.setData(makeWav(f.first, f.second, 1, 8000, QByteArray(64, 0)));
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+        QWaveDecoder decoder(&buffer);
+        QSignalSpy parsingErrorSpy(&decoder, SIGNAL(parsingError()));
+        decoder.open(QIODevice::ReadOnly);
+        QCOMPARE(parsingErrorSpy.count(), 1);
+    }
+}
+
+void tst_QWaveDecoder::bufferFilledAfterOpen()
+{
+    QByteArray samples;
+    QDataStream stream(&samples, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    for (int i = 0; i < 100; ++i)
+        stream << qint16(i);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+
+    // Nothing to parse yet, so the decoder has to wait for readyRead()
+    QWaveDecoder decoder(&buffer);
+    QSignalSpy validFormatSpy(&decoder, SIGNAL(formatKnown()));
+    QSignalSpy parsingErrorSpy(&decoder, SIGNAL(parsingError()));
+    QVERIFY(decoder.open(QIODevice::ReadOnly));
+    QCOMPARE(validFormatSpy.count(), 0);
+    QCOMPARE(parsingErrorSpy.count(), 0);
+
+    buffer.write(makeWav(1, 16, 1, 8000, samples));
+    buffer.seek(0);
+    QTRY_COMPARE(validFormatSpy.count(), 1);
+    QCOMPARE(parsingErrorSpy.count(), 0);
+    QCOMPARE(decoder.audioFormat().sampleFormat(), QAudioFormat::Int16);
+    QCOMPARE(readAll(decoder, 4096), samples);
+}
+
 QTEST_MAIN(tst_QWaveDecoder)
 
 #include "tst_qwavedecoder.moc"
@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qaudioformat.h>
+#include <private/qaudiohelpers_p.h>
+
+class tst_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplySamples_data();
+    void multiplySamples();
+    void multiplySamplesRamp_data();
+    void multiplySamplesRamp();
+};
+
+Q_DECLARE_METATYPE(QAudioFormat::SampleFormat)
+
+static QAudioFormat format(QAudioFormat::SampleFormat sampleFormat)
+{
+    QAudioFormat f;
+    f.setSampleFormat(sampleFormat);
+    f.setChannelCount(2);
+    f.setSampleRate(48000);
+    return f;
+}
+
+static void addRows()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+    QTest::addColumn<qreal>("factor");
+
+    const std::pair<const char *, QAudioFormat::SampleFormat> formats[] = {
+        { "uint8", QAudioFormat::UInt8 },
+        { "int16", QAudioFormat::Int16 },
+        { "int32", QAudioFormat::Int32 },
+        { "float", QAudioFormat::Float },
+    };
+    for (const auto &f : formats) {
+        // unity gain is a plain copy, anything else goes through the kernels
+        for (qreal factor : { 0.5, 1. }) {
+            const QByteArray name = QByteArray(f.first) + ' ' + QByteArray::number(factor);
+            QTest::newRow(name.constData()) << f.second << factor;
+        }
+    }
+}
+
+// One second of stereo audio at 48kHz
+static QByteArray buffer(QAudioFormat::SampleFormat sampleFormat)
+{
+    const QAudioFormat f = format(sampleFormat);
+    QByteArray data(f.bytesForDuration(1000000), Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char((i * 37) & 0x7f);
+    return data;
+}
+
+void tst_QAudioHelpers::multiplySamples_data()
+{
+    addRows();
+}
+
+void tst_QAudioHelpers::multiplySamples()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+    QFETCH(qreal, factor);
+
+    const QByteArray input = buffer(sampleFormat);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qMultiplySamples(factor, format(sampleFormat), input.constData(),
+                                               output.data(), input.size());
+    }
+}
+
+void tst_QAudioHelpers::multiplySamplesRamp_data()
+{
+    addRows();
+}
+
+void tst_QAudioHelpers::multiplySamplesRamp()
+{
+    QFETCH(QAudioFormat::SampleFormat, sampleFormat);
+    QFETCH(qreal, factor);
+
+    const QByteArray input = buffer(sampleFormat);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qMultiplySamples(0., factor, format(sampleFormat), input.constData(),
+                                               output.data(), input.size());
+    }
+}
+
+QTEST_MAIN(tst_QAudioHelpers)
+
+#include "tst_bench_qaudiohelpers.moc"
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qmediatimerange.h>
+
+class tst_QMediaTimeRange : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void addInterval_data();
+    void addInterval();
+    void removeInterval_data();
+    void removeInterval();
+    void unite_data();
+    void unite();
+    void contains_data();
+    void contains();
+};
+
+// A buffered range with many small holes, as a player receiving data out of order builds up
+static QMediaTimeRange fragmentedRange(int intervals)
+{
+    QMediaTimeRange range;
+    for (int i = 0; i < intervals; ++i)
+        range.addInterval(qint64(i) * 100, qint64(i) * 100 + 49);
+    return range;
+}
+
+static void addSizeRows()
+{
+    QTest::addColumn<int>("intervals");
+    for (int intervals : { 10, 100, 1000 })
+        QTest::newRow(QByteArray::number(intervals).constData()) << intervals;
+}
+
+void tst_QMediaTimeRange::addInterval_data()
+{
+    addSizeRows();
+}
+
+void tst_QMediaTimeRange::addInterval()
+{
+    QFETCH(int, intervals);
+
+    QBENCHMARK {
+        QMediaTimeRange range = fragmentedRange(intervals);
+        Q_UNUSED(range);
+    }
+}
+
+void tst_QMediaTimeRange::removeInterval_data()
+{
+    addSizeRows();
+}
+
+void tst_QMediaTimeRange::removeInterval()
+{
+    QFETCH(int, intervals);
+
+    const QMediaTimeRange range = fragmentedRange(intervals);
+
+    QBENCHMARK {
+        QMediaTimeRange r = range;
+        // cut every interval in two
+        for (int i = 0; i < intervals; ++i)
+            r.removeInterval(qint64(i) * 100 + 20, qint64(i) * 100 + 29);
+    }
+}
+
+void tst_QMediaTimeRange::unite_data()
+{
+    addSizeRows();
+}
+
+void tst_QMediaTimeRange::unite()
+{
+    QFETCH(int, intervals);
+
+    const QMediaTimeRange a = fragmentedRange(intervals);
+    QMediaTimeRange b;
+    for (int i = 0; i < intervals; ++i)
+        b.addInterval(qint64(i) * 100 + 40, qint64(i) * 100 + 79);
+
+    QBENCHMARK {
+        QMediaTimeRange r = a + b;
+        Q_UNUSED(r);
+    }
+}
+
+void tst_QMediaTimeRange::contains_data()
+{
+    addSizeRows();
+}
+
+void tst_QMediaTimeRange::contains()
+{
+    QFETCH(int, intervals);
+
+    const QMediaTimeRange range = fragmentedRange(intervals);
+    const qint64 end = qint64(intervals) * 100;
+
+    QBENCHMARK {
+        int found = 0;
+        for (qint64 t = 0; t < end; t += 7)
+            found += range.contains(t);
+        Q_UNUSED(found);
+    }
+}
+
+QTEST_MAIN(tst_QMediaTimeRange)
+
+#include "tst_bench_qmediatimerange.moc"
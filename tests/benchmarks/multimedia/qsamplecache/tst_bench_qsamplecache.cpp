@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <private/qsamplecache_p.h>
+
+class tst_QSampleCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void requestCached();
+    void requestLoad_data();
+    void requestLoad();
+    void requestEvict();
+
+private:
+    QTemporaryDir m_dir;
+    QList<QUrl> m_urls;
+};
+
+static bool waitForSample(QSample *sample)
+{
+    QDeadlineTimer deadline(10000);
+    while (sample->state() != QSample::Ready && sample->state() != QSample::Error) {
+        if (deadline.hasExpired())
+            return false;
+        QThread::yieldCurrentThread();
+    }
+    return sample->state() == QSample::Ready;
+}
+
+void tst_QSampleCache::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    // 64 distinct half second, 16 bit stereo files
+    const int dataSize = 48000 * 2 * 2 / 2;
+    for (int i = 0; i < 64; ++i) {
+        QByteArray wav;
+        QDataStream stream(&wav, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData("RIFF", 4);
+        stream << quint32(4 + 8 + 16 + 8 + dataSize);
+        stream.writeRawData("WAVE", 4);
+        stream.writeRawData("fmt ", 4);
+        stream << quint32(16) << quint16(1) << quint16(2) << quint32(48000) << quint32(48000 * 4)
+               << quint16(4) << quint16(16);
+        stream.writeRawData("data", 4);
+        stream << quint32(dataSize);
+        wav.append(QByteArray(dataSize, char(i)));
+
+        QFile file(m_dir.filePath(QStringLiteral("sample%1.wav").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(wav), qint64(wav.size()));
+        m_urls.append(QUrl::fromLocalFile(file.fileName()));
+    }
+}
+
+void tst_QSampleCache::requestCached()
+{
+    QSampleCache cache;
+    QSample *sample = cache.requestSample(m_urls.first());
+    QVERIFY(waitForSample(sample));
+    QTRY_VERIFY(!cache.isLoading());
+
+    // a hit only looks the sample up and takes a reference
+    QBENCHMARK {
+        QSample *s = cache.requestSample(m_urls.first());
+        s->release();
+    }
+
+    sample->release();
+}
+
+void tst_QSampleCache::requestLoad_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("4 threads") << 4;
+}
+
+void tst_QSampleCache::requestLoad()
+{
+    QFETCH(int, threads);
+
+    QBENCHMARK {
+        QSampleCache cache;
+        cache.setLoaderThreadCount(threads);
+        QList<QSample *> samples;
+        for (const QUrl &url : qAsConst(m_urls))
+            samples.append(cache.requestSample(url));
+        for (QSample *sample : qAsConst(samples))
+            QVERIFY(waitForSample(sample));
+        for (QSample *sample : qAsConst(samples))
+            sample->release();
+    }
+}
+
+void tst_QSampleCache::requestEvict()
+{
+    QSampleCache cache;
+    // room for about 8 of the samples, so that cycling through all of them
+    // keeps evicting the least recently used ones
+    cache.setCapacity(8 * 48000 * 2);
+
+    QBENCHMARK {
+        for (const QUrl &url : qAsConst(m_urls)) {
+            QSample *sample = cache.requestSample(url);
+            QVERIFY(waitForSample(sample));
+            sample->release();
+        }
+    }
+}
+
+QTEST_MAIN(tst_QSampleCache)
+
+#include "tst_bench_qsamplecache.moc"
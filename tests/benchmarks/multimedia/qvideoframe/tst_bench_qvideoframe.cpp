@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qvideoframe.h>
+#include <qvideoframeformat.h>
+#include <private/qvideoframeconversionhelper_p.h>
+#include <QtCore/qthreadpool.h>
+
+class tst_QVideoFrame : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convert_data();
+    void convert();
+    void toImage_data();
+    void toImage();
+    void toImageThreaded_data();
+    void toImageThreaded();
+
+private:
+    void addFormatRows(const QList<QSize> &sizes);
+};
+
+static QVideoFrame patternFrame(const QVideoFrameFormat &format)
+{
+    QVideoFrame frame(format);
+    if (frame.map(QVideoFrame::WriteOnly)) {
+        for (int plane = 0; plane < frame.planeCount(); ++plane) {
+            uchar *data = frame.bits(plane);
+            for (int i = 0; i < frame.mappedBytes(plane); ++i)
+                data[i] = uchar((i * 7 + (i >> 6) * 13 + plane * 29) & 0xff);
+        }
+        frame.unmap();
+    }
+    return frame;
+}
+
+void tst_QVideoFrame::addFormatRows(const QList<QSize> &sizes)
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        // Jpeg and the texture only formats have no software converter
+        if (!qConverterForFormat(pixelFormat))
+            continue;
+        for (const QSize &size : sizes) {
+            const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1()
+                    + ' ' + QByteArray::number(size.height()) + 'p';
+            QTest::newRow(name.constData()) << pixelFormat << size;
+        }
+    }
+}
+
+void tst_QVideoFrame::convert_data()
+{
+    addFormatRows({ QSize(640, 480), QSize(1920, 1080), QSize(3840, 2160) });
+}
+
+void tst_QVideoFrame::convert()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame = patternFrame(QVideoFrameFormat(size, pixelFormat));
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+
+    VideoFrameConvertFunc convert = qConverterForFormat(pixelFormat);
+    QImage output(size, QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        convert(frame, output.bits());
+    }
+
+    frame.unmap();
+}
+
+void tst_QVideoFrame::toImage_data()
+{
+    addFormatRows({ QSize(1920, 1080) });
+}
+
+void tst_QVideoFrame::toImage()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame = patternFrame(QVideoFrameFormat(size, pixelFormat));
+
+    QBENCHMARK {
+        QImage image = frame.toImage();
+        Q_UNUSED(image);
+    }
+}
+
+void tst_QVideoFrame::toImageThreaded_data()
+{
+    addFormatRows({ QSize(3840, 2160) });
+}
+
+void tst_QVideoFrame::toImageThreaded()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame = patternFrame(QVideoFrameFormat(size, pixelFormat));
+
+    QBENCHMARK {
+        QImage image = frame.toImage(QThreadPool::globalInstance());
+        Q_UNUSED(image);
+    }
+}
+
+QTEST_MAIN(tst_QVideoFrame)
+
+#include "tst_bench_qvideoframe.moc"
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qvideoframe.h>
+#include <qvideoframeformat.h>
+#include <private/qvideotexturehelper_p.h>
+#include <private/qrhinull_p.h>
+
+#include <memory>
+
+class tst_QVideoTextureHelper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void updateRhiTextures_data();
+    void updateRhiTextures();
+
+private:
+    std::unique_ptr<QRhi> m_rhi;
+};
+
+void tst_QVideoTextureHelper::initTestCase()
+{
+    // The Null backend measures the CPU side of the upload path without a GPU
+    QRhiNullInitParams params;
+    m_rhi.reset(QRhi::create(QRhi::Null, &params));
+    QVERIFY(m_rhi);
+}
+
+void tst_QVideoTextureHelper::updateRhiTextures_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+
+    for (int i = QVideoFrameFormat::Format_Invalid + 1; i < QVideoFrameFormat::NPixelFormats; ++i) {
+        const auto pixelFormat = QVideoFrameFormat::PixelFormat(i);
+        switch (pixelFormat) {
+        case QVideoFrameFormat::Format_Jpeg:
+        case QVideoFrameFormat::Format_SamplerExternalOES:
+        case QVideoFrameFormat::Format_SamplerRect:
+            // no textures to upload from memory
+            continue;
+        default:
+            break;
+        }
+        for (const QSize size : { QSize(1920, 1080), QSize(3840, 2160) }) {
+            const QByteArray name = QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1()
+                    + ' ' + QByteArray::number(size.height()) + 'p';
+            QTest::newRow(name.constData()) << pixelFormat << size;
+        }
+    }
+}
+
+void tst_QVideoTextureHelper::updateRhiTextures()
+{
+    QFETCH(QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(QSize, size);
+
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    for (int plane = 0; plane < frame.planeCount(); ++plane)
+        memset(frame.bits(plane), 0x80, frame.mappedBytes(plane));
+    frame.unmap();
+
+    QRhiTexture *textures[QVideoTextureHelper::TextureDescription::maxPlanes] = {};
+
+    QBENCHMARK {
+        QRhiCommandBuffer *cb = nullptr;
+        QCOMPARE(m_rhi->beginOffscreenFrame(&cb), QRhi::FrameOpSuccess);
+        QRhiResourceUpdateBatch *rub = m_rhi->nextResourceUpdateBatch();
+        QVERIFY(QVideoTextureHelper::updateRhiTextures(frame, m_rhi.get(), rub, textures) > 0);
+        cb->resourceUpdate(rub);
+        m_rhi->endOffscreenFrame();
+    }
+
+    for (auto *texture : textures)
+        delete texture;
+}
+
+QTEST_MAIN(tst_QVideoTextureHelper)
+
+#include "tst_bench_qvideotexturehelper.moc"
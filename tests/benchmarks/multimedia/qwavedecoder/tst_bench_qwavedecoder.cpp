@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qwavedecoder.h>
+#include <QtCore/qbuffer.h>
+
+class tst_QWaveDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decode_data();
+    void decode();
+};
+
+// A canonical RIFF/RIFX file, with a WAVE_FORMAT_EXTENSIBLE header if extensible is set
+static QByteArray makeWav(quint16 formatTag, int bitsPerSample, int channels, int sampleRate,
+                          const QByteArray &samples, bool bigEndian = false, bool extensible = false)
+{
+    QByteArray wav;
+    QDataStream stream(&wav, QIODevice::WriteOnly);
+    stream.setByteOrder(bigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+
+    const quint32 fmtSize = extensible ? 40 : 16;
+    const quint16 blockAlign = quint16(channels * bitsPerSample / 8);
+
+    stream.writeRawData(bigEndian ? "RIFX" : "RIFF", 4);
+    stream << quint32(4 + 8 + fmtSize + 8 + samples.size());
+    stream.writeRawData("WAVE", 4);
+
+    stream.writeRawData("fmt ", 4);
+    stream << fmtSize << quint16(extensible ? 0xfffe : formatTag) << quint16(channels)
+           << quint32(sampleRate) << quint32(sampleRate * blockAlign) << blockAlign
+           << quint16(bitsPerSample);
+    if (extensible) {
+        stream << quint16(22) << quint16(bitsPerSample) << quint32(0) << formatTag;
+        stream.writeRawData("\x00\x00\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71", 14);
+    }
+
+    stream.writeRawData("data", 4);
+    stream << quint32(samples.size());
+    stream.writeRawData(samples.constData(), samples.size());
+    return wav;
+}
+
+void tst_QWaveDecoder::decode_data()
+{
+    QTest::addColumn<QByteArray>("wav");
+    QTest::addColumn<int>("blockSize");
+
+    // ten seconds of stereo audio at 48kHz
+    const int samples = 10 * 48000 * 2;
+    auto data = [&](int bytesPerSample) {
+        QByteArray d(samples * bytesPerSample, Qt::Uninitialized);
+        for (int i = 0; i < d.size(); ++i)
+            d[i] = char((i * 37) & 0x7f);
+        return d;
+    };
+
+    const struct {
+        const char *name;
+        quint16 formatTag;
+        int bits;
+        bool bigEndian;
+        bool extensible;
+    } formats[] = {
+        { "uint8", 1, 8, false, false },
+        { "int16", 1, 16, false, false },
+        { "int16 rifx", 1, 16, true, false },
+        { "int24", 1, 24, false, false },
+        { "int24 rifx", 1, 24, true, false },
+        { "int32 extensible", 1, 32, false, true },
+        { "float32", 3, 32, false, false },
+        { "float64", 3, 64, false, false },
+    };
+
+    for (const auto &f : formats) {
+        const QByteArray wav = makeWav(f.formatTag, f.bits, 2, 48000, data(f.bits / 8),
+                                       f.bigEndian, f.extensible);
+        for (int blockSize : { 4096, 65536 }) {
+            const QByteArray name = QByteArray(f.name) + ' ' + QByteArray::number(blockSize);
+            QTest::newRow(name.constData()) << wav << blockSize;
+        }
+    }
+}
+
+void tst_QWaveDecoder::decode()
+{
+    QFETCH(QByteArray, wav);
+    QFETCH(int, blockSize);
+
+    QByteArray block(blockSize, Qt::Uninitialized);
+
+    QBENCHMARK {
+        QBuffer buffer(&wav);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QWaveDecoder decoder(&buffer);
+        QVERIFY(decoder.open(QIODevice::ReadOnly));
+        qint64 total = 0;
+        qint64 read;
+        while ((read = decoder.read(block.data(), blockSize)) > 0)
+            total += read;
+        QCOMPARE(total, decoder.size());
+    }
+}
+
+QTEST_MAIN(tst_QWaveDecoder)
+
+#include "tst_bench_qwavedecoder.moc"